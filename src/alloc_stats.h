@@ -0,0 +1,270 @@
+// 分配统计 - 可选构建模式（-DTV_ALLOC_STATS），按作用域统计 operator new 次数与字节数
+//
+// 只统计经过 C++ operator new 的分配（wxString、wx 对象、STL 容器等），
+// 平台 GDI/GDI+ 内部的分配不在其中。计数是进程级的原子量：线程进入作用域（ALLOC_SCOPE）或给自己打上
+// 作用域标记（ALLOC_TAG，如 server 线程解析命令）后，它的分配都记到该作用域，其他线程的分配不混进来。
+// 注意：开启时本头文件定义全局 operator new/delete，只能被一个编译单元（main.cpp）包含。
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace AllocStats {
+    enum Scope {
+        Command,    // 处理一条遥控器命令（server 线程解析投递 + OnSocketCommand）
+        Paint,      // 一次 TileButton::OnPaint
+        ShowPage,   // 一次 MyFrame::ShowPage（不含首次访问时的建页）
+        BuildPage,  // 首次访问时构建一个页面
+        ScopeCount
+    };
+
+    const char* const kScopeNames[ScopeCount] = { "command", "paint", "show_page", "build_page" };
+
+    // 每次操作允许的平均分配次数，超出即视为热路径回归；0 表示不检查。
+    // 默认都不检查，只报告：预算须以分配统计构建回放录制命令时 CheckBudgets 报告的 allocs/op 为准，
+    // 由 --alloc-budget 传入实测值加余量
+    inline double* Budgets()
+    {
+        static double budgets[ScopeCount] = {};
+        return budgets;
+    }
+
+    // 解析 "<scope>=<次数>"，如 "show_page=128"
+    inline bool SetBudget(const char* text)
+    {
+        const char* eq = std::strchr(text, '=');
+        if (!eq) return false;
+        for (int i = 0; i < ScopeCount; ++i) {
+            if (std::strlen(kScopeNames[i]) == size_t(eq - text) && std::strncmp(kScopeNames[i], text, eq - text) == 0) {
+                char* end = nullptr;
+                double budget = std::strtod(eq + 1, &end);
+                if (end == eq + 1 || *end || budget < 0) return false;
+                Budgets()[i] = budget;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct Totals {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> allocs{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> maxAllocs{0};   // 单次操作（本线程内）的最大分配次数
+    };
+
+    inline Totals* AllTotals()
+    {
+        static Totals totals[ScopeCount];
+        return totals;
+    }
+
+    // 每个线程当前所在的作用域（位掩码，嵌套作用域同时计数）及本线程在各作用域内的分配次数
+    struct ThreadState {
+        unsigned mask;
+        uint64_t allocs[ScopeCount];
+    };
+
+    inline ThreadState& Thread()
+    {
+        static thread_local ThreadState state = {};
+        return state;
+    }
+
+    inline void Record(std::size_t size)
+    {
+        ThreadState& state = Thread();
+        if (!state.mask) return;
+        Totals* totals = AllTotals();
+        for (int i = 0; i < ScopeCount; ++i) {
+            if (state.mask & (1u << i)) {
+                ++state.allocs[i];
+                totals[i].allocs.fetch_add(1, std::memory_order_relaxed);
+                totals[i].bytes.fetch_add(size, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 给当前线程打上作用域标记，不计操作次数（如 server 线程为一条命令做的解析与投递）
+    class TagGuard
+    {
+    public:
+        explicit TagGuard(Scope scope)
+            : m_savedMask(Thread().mask)
+        {
+            Thread().mask |= 1u << scope;
+        }
+
+        ~TagGuard() { Thread().mask = m_savedMask; }
+
+    private:
+        unsigned m_savedMask;
+    };
+
+    // RAII 作用域：期间本线程的分配记到该作用域，析构时计一次操作并更新单次最大值。
+    // exclusive 时外层作用域暂停计数（首次建页不算进 ShowPage）
+    class ScopeGuard
+    {
+    public:
+        explicit ScopeGuard(Scope scope, bool exclusive = false)
+            : m_scope(scope)
+            , m_savedMask(Thread().mask)
+            , m_start(Thread().allocs[scope])
+        {
+            Thread().mask = (exclusive ? 0u : m_savedMask) | (1u << scope);
+        }
+
+        ~ScopeGuard()
+        {
+            ThreadState& state = Thread();
+            uint64_t allocs = state.allocs[m_scope] - m_start;
+            state.mask = m_savedMask;
+            Totals& totals = AllTotals()[m_scope];
+            ++totals.calls;
+            uint64_t prev = totals.maxAllocs.load();
+            while (allocs > prev && !totals.maxAllocs.compare_exchange_weak(prev, allocs)) {
+            }
+        }
+
+    private:
+        Scope m_scope;
+        unsigned m_savedMask;
+        uint64_t m_start;
+    };
+
+    // 格式化为 " alloc.<scope>=次数/操作,字节/操作,最大次数" 追加到 STATS 回复
+    inline std::string Format()
+    {
+        std::string text;
+        char item[128];
+        for (int i = 0; i < ScopeCount; ++i) {
+            const Totals& totals = AllTotals()[i];
+            uint64_t calls = totals.calls.load();
+            double allocsPerOp = calls ? double(totals.allocs.load()) / calls : 0;
+            double bytesPerOp = calls ? double(totals.bytes.load()) / calls : 0;
+            std::snprintf(item, sizeof(item), " alloc.%s=%.1f,%.0f,%llu", kScopeNames[i],
+                          allocsPerOp, bytesPerOp, (unsigned long long)totals.maxAllocs.load());
+            text += item;
+        }
+        return text;
+    }
+
+    // 最近一次 CheckBudgets 是否有作用域超出预算（决定进程退出码）
+    inline bool& BudgetExceeded()
+    {
+        static bool exceeded = false;
+        return exceeded;
+    }
+
+    // 检查各作用域每次操作的平均分配次数是否超出预算，把结果写到 out
+    inline bool CheckBudgets(FILE* out)
+    {
+        bool ok = true;
+        for (int i = 0; i < ScopeCount; ++i) {
+            const Totals& totals = AllTotals()[i];
+            uint64_t calls = totals.calls.load();
+            double allocsPerOp = calls ? double(totals.allocs.load()) / calls : 0.0;
+            double budget = Budgets()[i];
+            bool over = budget > 0 && allocsPerOp > budget;
+            std::fprintf(out, "alloc %-10s calls %-8llu allocs/op %-8.1f bytes/op %-10.0f max %-6llu budget %-6.0f %s\n",
+                         kScopeNames[i], (unsigned long long)calls, allocsPerOp,
+                         calls ? double(totals.bytes.load()) / calls : 0.0,
+                         (unsigned long long)totals.maxAllocs.load(), budget,
+                         budget <= 0 ? "-" : over ? "OVER" : "ok");
+            if (over) ok = false;
+        }
+        BudgetExceeded() = !ok;
+        return ok;
+    }
+}
+
+#ifdef TV_ALLOC_STATS
+
+#define ALLOC_SCOPE(scope) AllocStats::ScopeGuard allocScope_##scope(AllocStats::scope)
+#define ALLOC_SCOPE_EXCLUSIVE(scope) AllocStats::ScopeGuard allocScope_##scope(AllocStats::scope, true)
+#define ALLOC_TAG(scope) AllocStats::TagGuard allocTag_##scope(AllocStats::scope)
+
+inline void* AllocStatsNew(std::size_t size)
+{
+    AllocStats::Record(size);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) { return AllocStatsNew(size); }
+void* operator new[](std::size_t size) { return AllocStatsNew(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return AllocStatsNew(size); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return AllocStatsNew(size); } catch (...) { return nullptr; }
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+#ifdef __cpp_aligned_new
+// 对齐分配（alignas 超过默认对齐的类型）也要统计，否则会绕过上面的计数
+inline void* AllocStatsAlignedNew(std::size_t size, std::align_val_t align)
+{
+    AllocStats::Record(size);
+    std::size_t alignment = static_cast<std::size_t>(align);
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    size = (size + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+    void* p = _aligned_malloc(size ? size : alignment, alignment);
+#else
+    void* p = ::aligned_alloc(alignment, size ? size : alignment);
+#endif
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+inline void AllocStatsAlignedFree(void* p)
+{
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size, std::align_val_t align) { return AllocStatsAlignedNew(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return AllocStatsAlignedNew(size, align); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    try { return AllocStatsAlignedNew(size, align); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept
+{
+    try { return AllocStatsAlignedNew(size, align); } catch (...) { return nullptr; }
+}
+void operator delete(void* p, std::align_val_t) noexcept { AllocStatsAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { AllocStatsAlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { AllocStatsAlignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { AllocStatsAlignedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { AllocStatsAlignedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { AllocStatsAlignedFree(p); }
+#endif
+
+#else
+
+#define ALLOC_SCOPE(scope) ((void)0)
+#define ALLOC_SCOPE_EXCLUSIVE(scope) ((void)0)
+#define ALLOC_TAG(scope) ((void)0)
+
+#endif
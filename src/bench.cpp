@@ -0,0 +1,1529 @@
+// 性能基准工具 - 不依赖 wx，直接测试各个数据与处理模块
+//
+// 用法: bench <项目> [参数]
+//   channels [数量] [--keep 文件]   频道库写入、打开、按号查找、名称前缀搜索
+//   scan [--freqs N] [--packets N] [--dwell MS] [--threads N]
+//                                   模拟搜台在不同线程数下的耗时与加速比
+//   epg [--services N] [--days N] [--keep 文件]
+//                                   EIT 转储入库速度、增量更新、now/next 与网格查询延迟
+//   catalog [--keys N] [--languages N]
+//                                   翻译目录编译、打开、切换语言与查找延迟，对比全部语言常驻内存的 map
+//   yuv [--width N] [--height N] [--format i420|nv12] [--frames N]
+//                                   各 YUV->RGB 内核的单核转换吞吐，以及 60fps 下占用一个核的比例
+//   scale [--frames N] [--threads N] [--filter bilinear|area]
+//                                   4K->1080p、1080p->720p 视频缩放在各内核与线程数下的帧率
+//   picture [--width N] [--height N] [--frames N]
+//                                   各图像模式处理链在各内核下的单帧耗时
+//   analyze [--frames N] [--step N] [--threads N]
+//                                   1080p、4K 帧自适应对比度分析的耗时：播放线程的抽样复制，分析线程的直方图与曲线
+//   sound [--seconds N] [--channels N] [--rate N]
+//                                   各声音模式处理链在各内核下的实时倍数，切换预设的过渡幅度，无锁环形缓冲吞吐
+//   sources [--switches N] [--width N] [--height N] [--lock MS]
+//                                   模拟信号源切换到第一帧的延迟，以及全部停着时的 CPU 占用
+//   thumbs [--frames N] [--seconds N]
+//                                   1080p 缩小成图块缩略图在各内核下的耗时，以及不同 CPU 预算下缩略图线程的实际占用
+//   zap [--zaps N] [--interval MS] [--tune MS]
+//                                   频道加减换台到画面就绪的延迟：不缓存、只缓存看过的频道、预取相邻频道与历史
+//   timeshift [--streams N] [--seconds N] [--segment-mb N] [--segments N] [--dir 目录]
+//                                   多路时移缓冲同时全速写入的吞吐（折合 20 Mbit/s 高清流的路数），
+//                                   以及写入期间回看定位的延迟与读出数据的校验
+//   logos [--channels N] [--steps N] [--interval MS] [--decode MS] [--cache-kb N]
+//                                   频道列表逐项滚动时台标的缓存命中率与显示占位的比例：不预取、预取两侧
+#include "channel_store.h"
+#include "channel_scan.h"
+#include "picture_pipeline.h"
+#include "sound_engine.h"
+#include "epg_store.h"
+#include "frame_analyzer.h"
+#include "input_source.h"
+#include "logo_cache.h"
+#include "thumbnailer.h"
+#include "timeshift_ring.h"
+#include "zap_prefetch.h"
+#include "translation_catalog.h"
+#include "video_scaler.h"
+#include "yuv_convert.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double MicrosSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// 打印一组耗时样本（微秒）的均值与分位数
+static void PrintLatency(const char* label, std::vector<double>& samples)
+{
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double sample : samples) total += sample;
+    std::printf("%-24s n=%-8zu mean %9.3f us  p50 %9.3f us  p99 %9.3f us  max %9.3f us\n",
+                label, samples.size(), total / samples.size(), samples[samples.size() / 2],
+                samples[samples.size() * 99 / 100], samples.back());
+}
+
+// ---------------------------------------------------------------------------
+// channels
+// ---------------------------------------------------------------------------
+
+// 生成一份模拟频道表：频道号稀疏分布，名称带常见前缀便于测试前缀搜索
+static std::vector<ChannelInfo> MakeChannels(size_t count, unsigned seed)
+{
+    static const char* const kPrefixes[] = {
+        "CCTV-", "BBC ", "Discovery ", "HBO ", "News ", "Sport ", "Movie ", "Kids ", "Music ", "Radio "
+    };
+    std::mt19937 random(seed);
+    std::vector<ChannelInfo> channels;
+    channels.reserve(count);
+    uint32_t number = 0;
+    for (size_t i = 0; i < count; ++i) {
+        number += 1 + random() % 3;
+        ChannelInfo channel;
+        channel.number = number;
+        channel.frequencyKhz = 474000 + static_cast<uint32_t>(random() % 50) * 8000;
+        channel.flags = static_cast<uint16_t>(random() % 16);
+        channel.name = kPrefixes[random() % 10] + std::to_string(i + 1);
+        channels.push_back(channel);
+    }
+    std::shuffle(channels.begin(), channels.end(), random);
+    return channels;
+}
+
+static int BenchChannels(int argc, char** argv)
+{
+    size_t count = 20000;
+    std::string path = "bench_channels.tvch";
+    bool keep = false;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--keep") == 0 && i + 1 < argc) {
+            path = argv[++i];
+            keep = true;
+        } else {
+            count = static_cast<size_t>(std::strtoul(argv[i], nullptr, 10));
+        }
+    }
+
+    std::vector<ChannelInfo> channels = MakeChannels(count, 1);
+    std::vector<uint32_t> numbers;
+    for (const auto& channel : channels) numbers.push_back(channel.number);
+
+    Clock::time_point start = Clock::now();
+    if (!ChannelStore::Write(path, channels)) {
+        std::fprintf(stderr, "write %s failed\n", path.c_str());
+        return 1;
+    }
+    std::printf("write                    %zu channels %.1f ms\n", count, MicrosSince(start) / 1000);
+
+    // 打开：只映射与校验头部，应远低于 1ms
+    std::vector<double> samples;
+    for (int i = 0; i < 200; ++i) {
+        ChannelStore store;
+        start = Clock::now();
+        bool ok = store.Open(path);
+        samples.push_back(MicrosSince(start));
+        if (!ok || store.Count() != count) {
+            std::fprintf(stderr, "open %s failed\n", path.c_str());
+            return 1;
+        }
+    }
+    PrintLatency("open", samples);
+
+    ChannelStore store;
+    store.Open(path);
+
+    // 按号查找：一半命中、一半未命中
+    std::mt19937 random(2);
+    size_t hits = 0;
+    samples.clear();
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t number = (i & 1) ? numbers[random() % numbers.size()] : static_cast<uint32_t>(random() % 70000);
+        start = Clock::now();
+        long row = store.FindByNumber(number);
+        samples.push_back(MicrosSince(start));
+        if (row >= 0) {
+            ++hits;
+            if (store.Number(row) != number) {
+                std::fprintf(stderr, "lookup %u returned %u\n", number, store.Number(row));
+                return 1;
+            }
+        }
+    }
+    PrintLatency("find by number", samples);
+
+    // 名称前缀搜索：前缀越短命中越多，最多取 50 条
+    static const char* const kQueries[] = { "c", "cctv-1", "bbc 19", "DISCOVERY 2", "sport 12", "x" };
+    std::vector<size_t> rows;
+    samples.clear();
+    for (int round = 0; round < 2000; ++round) {
+        for (const char* query : kQueries) {
+            start = Clock::now();
+            store.FindByNamePrefix(query, rows, 50);
+            samples.push_back(MicrosSince(start));
+        }
+    }
+    PrintLatency("find by name prefix", samples);
+
+    // 数字键输入：每输入一位判断是否还需要等待下一位
+    samples.clear();
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t typed = numbers[random() % numbers.size()] / 10;
+        start = Clock::now();
+        volatile bool more = store.HasLongerNumber(typed);
+        (void)more;
+        samples.push_back(MicrosSince(start));
+    }
+    PrintLatency("digit entry check", samples);
+
+    std::printf("lookup hits %zu / 100000, file %s\n", hits, path.c_str());
+    store.Close();
+    if (!keep) std::remove(path.c_str());
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// scan
+// ---------------------------------------------------------------------------
+
+static int BenchScan(int argc, char** argv)
+{
+    size_t freqs = 400;
+    size_t packets = 8192;
+    int dwellMs = 0;
+    unsigned maxThreads = WorkStealingPool::DefaultThreads();
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--freqs") == 0) freqs = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--packets") == 0) packets = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--dwell") == 0) dwellMs = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--threads") == 0) maxThreads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    }
+
+    // 比真实频点表更密，让每个线程数下都有足够多的任务
+    std::vector<uint32_t> plan;
+    for (size_t i = 0; i < freqs; ++i) plan.push_back(static_cast<uint32_t>(474000 + i * 1000));
+
+    std::printf("scan %zu frequencies, %zu packets/mux, dwell %d ms\n", freqs, packets, dwellMs);
+    double baseline = 0;
+    size_t baselineFound = 0;
+    // 1, 2, 4 ... 直到硬件线程数（最后一档总是 maxThreads）
+    for (unsigned threads = 1; threads <= maxThreads;
+         threads = (threads < maxThreads && threads * 2 > maxThreads) ? maxThreads : threads * 2) {
+        std::string path = "bench_scan.tvch";
+        Clock::time_point start = Clock::now();
+        size_t found;
+        {
+            ChannelScanner scanner(std::unique_ptr<SignalSource>(new SimulatedSignalSource(1, packets, 60, dwellMs)),
+                                   plan, std::vector<ChannelInfo>(), path, threads, 200);
+            scanner.Start();
+            ChannelStore store;
+            while (!scanner.GetProgress().finished) {
+                scanner.CommitSnapshot(store);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            scanner.CommitSnapshot(store);
+            found = store.Count();
+        }
+        double ms = MicrosSince(start) / 1000;
+        if (threads == 1) {
+            baseline = ms;
+            baselineFound = found;
+        }
+        std::printf("threads %-3u %9.1f ms  %7.1f mux/s  speedup %5.2fx  channels %zu%s\n",
+                    threads, ms, freqs / (ms / 1000), baseline / ms, found,
+                    found == baselineFound ? "" : "  MISMATCH");
+        std::remove(path.c_str());
+        if (found != baselineFound) return 1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// epg
+// ---------------------------------------------------------------------------
+
+static const uint32_t kEpgBaseTime = 1767571200;   // 2026-01-05 00:00 UTC
+static const uint32_t kEpgSegmentSeconds = 3 * 3600;
+
+// 一个业务的节目：从 kEpgBaseTime 起首尾相接，时长 5-60 分钟
+static std::vector<Epg::Event> MakeServiceEvents(uint16_t serviceId, int days, unsigned seed)
+{
+    std::mt19937 random(seed * 7919u + serviceId);
+    std::vector<Epg::Event> events;
+    uint32_t end = kEpgBaseTime + static_cast<uint32_t>(days) * 86400;
+    uint16_t eventId = 1;
+    for (uint32_t start = kEpgBaseTime; start < end;) {
+        Epg::Event event;
+        event.originalNetworkId = 1;
+        event.transportStreamId = 1;
+        event.serviceId = serviceId;
+        event.eventId = eventId++;
+        event.start = start;
+        event.duration = (5 + random() % 56) * 60;
+        event.title = "Program " + std::to_string(serviceId) + "-" + std::to_string(event.eventId);
+        events.push_back(event);
+        start += event.duration;
+    }
+    return events;
+}
+
+// 按 EIT schedule 的分段方式（每 3 小时一段、每个 table_id 覆盖 4 天）打成段
+static void AppendEitSegment(std::vector<uint8_t>& stream, uint8_t& counter, uint16_t serviceId, size_t segment,
+                             uint8_t version, const std::vector<Epg::Event>& events, size_t first, size_t last)
+{
+    uint8_t tableId = static_cast<uint8_t>(std::min<size_t>(0x50 + segment / 32, 0x5F));
+    uint8_t sectionNumber = static_cast<uint8_t>((segment % 32) * 8);
+    uint16_t transportStreamId = events[first].transportStreamId;
+    uint16_t originalNetworkId = events[first].originalNetworkId;
+    std::vector<uint8_t> section = {
+        0x50, 0xF0, 0, static_cast<uint8_t>(serviceId >> 8), static_cast<uint8_t>(serviceId),
+        static_cast<uint8_t>(0xC1 | (version << 1)), sectionNumber, 0xF8,
+        static_cast<uint8_t>(transportStreamId >> 8), static_cast<uint8_t>(transportStreamId),
+        static_cast<uint8_t>(originalNetworkId >> 8), static_cast<uint8_t>(originalNetworkId), 0xF8, 0x5F
+    };
+    section[0] = tableId;
+    for (size_t i = first; i < last; ++i) {
+        const Epg::Event& event = events[i];
+        uint8_t header[Epg::kEventHeaderSize];
+        header[0] = static_cast<uint8_t>(event.eventId >> 8);
+        header[1] = static_cast<uint8_t>(event.eventId);
+        Epg::EncodeTime(event.start, header + 2);
+        Epg::EncodeDuration(event.duration, header + 7);
+        std::vector<uint8_t> descriptor = { Epg::kShortEventDescriptor, 0, 'c', 'h', 'i',
+                                            static_cast<uint8_t>(event.title.size()) };
+        descriptor.insert(descriptor.end(), event.title.begin(), event.title.end());
+        descriptor.push_back(0);   // 无简介
+        descriptor[1] = static_cast<uint8_t>(descriptor.size() - 2);
+        header[10] = static_cast<uint8_t>(0x80 | (descriptor.size() >> 8));
+        header[11] = static_cast<uint8_t>(descriptor.size());
+        section.insert(section.end(), header, header + Epg::kEventHeaderSize);
+        section.insert(section.end(), descriptor.begin(), descriptor.end());
+    }
+    TsScan::FinishSection(section);
+    TsScan::AppendSection(stream, section, Epg::kEitPid, counter);
+}
+
+// 写出 EIT 转储：按段轮流写各业务（与循环播发的顺序相同），repeat 次表示重复播发
+static size_t WriteEitDump(const std::string& path, const std::vector<std::vector<Epg::Event>>& services,
+                           uint8_t version, int repeat)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return 0;
+    size_t segments = 0;
+    for (const auto& events : services) {
+        if (!events.empty()) segments = std::max<size_t>(segments, (events.back().start - kEpgBaseTime) / kEpgSegmentSeconds + 1);
+    }
+    std::vector<size_t> cursor(services.size());
+    std::vector<uint8_t> stream;
+    uint8_t counter = 0;
+    size_t bytes = 0;
+    for (int round = 0; round < repeat; ++round) {
+        std::fill(cursor.begin(), cursor.end(), 0);
+        for (size_t segment = 0; segment < segments; ++segment) {
+            uint32_t segmentEnd = kEpgBaseTime + static_cast<uint32_t>(segment + 1) * kEpgSegmentSeconds;
+            stream.clear();
+            for (size_t s = 0; s < services.size(); ++s) {
+                const auto& events = services[s];
+                size_t first = cursor[s];
+                size_t last = first;
+                while (last < events.size() && events[last].start < segmentEnd) ++last;
+                if (last == first) continue;
+                AppendEitSegment(stream, counter, events[first].serviceId, segment, version, events, first, last);
+                cursor[s] = last;
+            }
+            bytes += std::fwrite(stream.data(), 1, stream.size(), file);
+        }
+    }
+    std::fclose(file);
+    return bytes;
+}
+
+static int BenchEpg(int argc, char** argv)
+{
+    size_t serviceCount = 500;
+    int days = 7;
+    std::string path = "bench_epg.ts";
+    bool keep = false;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--services") == 0) serviceCount = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--days") == 0) days = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--keep") == 0) {
+            path = argv[i + 1];
+            keep = true;
+        }
+    }
+
+    std::vector<std::vector<Epg::Event>> services;
+    size_t eventCount = 0;
+    for (size_t s = 0; s < serviceCount; ++s) {
+        services.push_back(MakeServiceEvents(static_cast<uint16_t>(s + 1), days, 1));
+        eventCount += services.back().size();
+    }
+    // 转储中每个段播发两次，第二次应按版本号整段跳过
+    size_t bytes = WriteEitDump(path, services, 1, 2);
+    if (bytes == 0) {
+        std::fprintf(stderr, "write %s failed\n", path.c_str());
+        return 1;
+    }
+    std::printf("epg %zu services, %d days, %zu events, dump %.1f MB\n", serviceCount, days, eventCount, bytes / 1e6);
+
+    EpgStore store;
+    Epg::EitParser parser;
+    Clock::time_point start = Clock::now();
+    if (!store.IngestFile(path, parser)) {
+        std::fprintf(stderr, "ingest %s failed\n", path.c_str());
+        return 1;
+    }
+    double ms = MicrosSince(start) / 1000;
+    std::printf("ingest                   %.1f ms  %.0f events/s  %.1f MB/s  sections %zu skipped %zu\n",
+                ms, eventCount / (ms / 1000), bytes / 1e6 / (ms / 1000), parser.SectionCount(), parser.SkippedCount());
+    if (store.EventCount() != eventCount || store.ServiceCount() != serviceCount) {
+        std::fprintf(stderr, "ingest stored %zu events in %zu services\n", store.EventCount(), store.ServiceCount());
+        return 1;
+    }
+
+    // 增量更新：十分之一的业务改了节目表（版本号 +1），同一个 parser 继续接收
+    std::vector<std::vector<Epg::Event>> changed;
+    size_t changedEvents = 0;
+    for (size_t s = 0; s < serviceCount; s += 10) {
+        changed.push_back(MakeServiceEvents(static_cast<uint16_t>(s + 1), days, 2));
+        changedEvents += changed.back().size();
+    }
+    std::string updatePath = path + ".update";
+    WriteEitDump(updatePath, changed, 2, 1);
+    size_t before = store.EventCount();
+    start = Clock::now();
+    store.IngestFile(updatePath, parser);
+    std::printf("incremental update       %.1f ms  %zu services, %zu events, store %zu -> %zu events\n",
+                MicrosSince(start) / 1000, changed.size(), changedEvents, before, store.EventCount());
+    std::remove(updatePath.c_str());
+
+    std::mt19937 random(3);
+    uint32_t span = static_cast<uint32_t>(days) * 86400;
+    std::vector<double> samples;
+    std::vector<EpgStore::NowNext> rows;
+    for (int i = 0; i < 2000; ++i) {
+        uint32_t time = kEpgBaseTime + random() % span;
+        start = Clock::now();
+        store.QueryNowNext(time, rows);
+        samples.push_back(MicrosSince(start));
+    }
+    PrintLatency("now/next all services", samples);
+
+    // 节目表网格：10 个业务 x 3 小时，逐页翻
+    std::vector<EpgStore::Entry> entries;
+    std::vector<size_t> rowStarts;
+    samples.clear();
+    for (int i = 0; i < 20000; ++i) {
+        uint32_t from = kEpgBaseTime + random() % span;
+        size_t first = random() % serviceCount;
+        start = Clock::now();
+        store.QueryGrid(from, from + 3 * 3600, first, 10, entries, rowStarts);
+        samples.push_back(MicrosSince(start));
+    }
+    PrintLatency("grid 10 x 3h", samples);
+
+    samples.clear();
+    EpgStore::Entry entry;
+    size_t hits = 0;
+    for (int i = 0; i < 100000; ++i) {
+        uint32_t time = kEpgBaseTime + random() % span;
+        size_t service = random() % serviceCount;
+        start = Clock::now();
+        hits += store.EventAt(service, time, entry);
+        samples.push_back(MicrosSince(start));
+    }
+    PrintLatency("event at", samples);
+    if (hits != 100000) {
+        std::fprintf(stderr, "event at missed %zu lookups\n", 100000 - hits);
+        return 1;
+    }
+
+    start = Clock::now();
+    store.DropBefore(kEpgBaseTime + 86400);
+    std::printf("drop first day           %.1f ms  %zu events left\n", MicrosSince(start) / 1000, store.EventCount());
+
+    if (!keep) std::remove(path.c_str());
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// catalog
+// ---------------------------------------------------------------------------
+
+static std::string CatalogKey(size_t index)
+{
+    static const char* const kPages[] = { "source", "picture", "sound", "channel", "common", "epg", "scan", "network" };
+    return std::string(kPages[index % 8]) + "_item_" + std::to_string(index);
+}
+
+static int BenchCatalog(int argc, char** argv)
+{
+    size_t keyCount = 2000;
+    size_t languageCount = 12;
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--keys") == 0) {
+            keyCount = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--languages") == 0) {
+            languageCount = static_cast<size_t>(std::strtoul(argv[++i], nullptr, 10));
+        }
+    }
+    if (keyCount == 0 || languageCount == 0 || languageCount > 99) {
+        std::fprintf(stderr, "need --keys > 0 and 1..99 languages\n");
+        return 2;
+    }
+
+    std::vector<CatalogFile::Messages> languages(languageCount);
+    for (size_t language = 0; language < languageCount; ++language) {
+        for (size_t i = 0; i < keyCount; ++i) {
+            languages[language].emplace_back(CatalogKey(i), "L" + std::to_string(language) + " text for item " +
+                                             std::to_string(i) + std::string(i % 24, '.'));
+        }
+    }
+
+    // 原做法：启动时把所有语言的文本都建进一个 map
+    Clock::time_point start = Clock::now();
+    std::map<std::string, std::vector<std::string>> resident;
+    size_t residentBytes = 0;
+    for (size_t i = 0; i < keyCount; ++i) {
+        std::vector<std::string>& texts = resident[languages[0][i].first];
+        for (size_t language = 0; language < languageCount; ++language) {
+            texts.push_back(languages[language][i].second);
+            residentBytes += languages[language][i].second.size() + sizeof(std::string);
+        }
+        residentBytes += languages[0][i].first.size() + sizeof(std::string) * 2 + 32;
+    }
+    std::printf("build map (all languages) %zu keys x %zu languages %.2f ms  ~%zu KB resident\n",
+                keyCount, languageCount, MicrosSince(start) / 1000, residentBytes / 1024);
+
+    std::vector<std::string> paths;
+    start = Clock::now();
+    size_t fileBytes = 0;
+    for (size_t language = 0; language < languageCount; ++language) {
+        std::string code = "l" + std::to_string(language);
+        paths.push_back("bench_catalog_" + code + ".tvtc");
+        if (!CatalogFile::Write(paths.back(), code, languages[language])) {
+            std::fprintf(stderr, "write %s failed\n", paths.back().c_str());
+            return 1;
+        }
+        MappedFile file;
+        if (file.Open(paths.back())) fileBytes += file.Size();
+    }
+    std::printf("compile catalogs          %.2f ms  %zu KB per language\n",
+                MicrosSince(start) / 1000, fileBytes / languageCount / 1024);
+
+    // 打开：只映射并检查头部，与条目数无关
+    std::vector<double> samples;
+    for (int i = 0; i < 200; ++i) {
+        TranslationCatalog catalog;
+        start = Clock::now();
+        bool ok = catalog.Open(paths[i % languageCount]);
+        samples.push_back(MicrosSince(start));
+        if (!ok || catalog.Count() != keyCount) {
+            std::fprintf(stderr, "open %s failed\n", paths[i % languageCount].c_str());
+            return 1;
+        }
+    }
+    PrintLatency("open", samples);
+
+    // 切换语言：打开新目录并取一屏（约 40 条）文本
+    samples.clear();
+    std::mt19937 random(3);
+    for (int i = 0; i < 200; ++i) {
+        start = Clock::now();
+        TranslationCatalog catalog;
+        catalog.Open(paths[i % languageCount]);
+        for (int item = 0; item < 40; ++item) {
+            std::string key = CatalogKey(random() % keyCount);
+            const char* value;
+            size_t length;
+            catalog.Find(key.data(), key.size(), value, length);
+        }
+        samples.push_back(MicrosSince(start));
+    }
+    PrintLatency("switch + 40 lookups", samples);
+
+    // 查找：一半命中、一半未命中，与 map 查找对比
+    TranslationCatalog catalog;
+    catalog.Open(paths[languageCount - 1]);
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100000; ++i) {
+        keys.push_back((i & 1) ? CatalogKey(random() % keyCount) : "missing_" + std::to_string(i));
+    }
+    size_t hits = 0;
+    samples.clear();
+    for (const std::string& key : keys) {
+        const char* value;
+        size_t length;
+        start = Clock::now();
+        bool found = catalog.Find(key.data(), key.size(), value, length);
+        samples.push_back(MicrosSince(start));
+        if (found) {
+            ++hits;
+            size_t index = static_cast<size_t>(std::strtoul(key.c_str() + key.rfind('_') + 1, nullptr, 10));
+            if (languages[languageCount - 1][index].second != std::string(value, length)) {
+                std::fprintf(stderr, "lookup %s returned wrong text\n", key.c_str());
+                return 1;
+            }
+        }
+    }
+    PrintLatency("catalog lookup", samples);
+
+    samples.clear();
+    for (const std::string& key : keys) {
+        start = Clock::now();
+        auto it = resident.find(key);
+        volatile bool found = it != resident.end();
+        (void)found;
+        samples.push_back(MicrosSince(start));
+    }
+    PrintLatency("map lookup", samples);
+
+    std::printf("lookup hits %zu / %zu\n", hits, keys.size());
+    catalog.Close();
+    for (const std::string& path : paths) std::remove(path.c_str());
+    return hits == keys.size() / 2 ? 0 : 1;
+}
+
+// ---------------------------------------------------------------------------
+// yuv
+// ---------------------------------------------------------------------------
+
+static int BenchYuv(int argc, char** argv)
+{
+    int width = 1920;
+    int height = 1080;
+    int frames = 200;
+    Yuv::Format format = Yuv::Format::I420;
+    for (int i = 0; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--width") == 0) {
+            width = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--height") == 0) {
+            height = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0) {
+            frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--format") == 0) {
+            format = std::strcmp(argv[++i], "nv12") == 0 ? Yuv::Format::NV12 : Yuv::Format::I420;
+        }
+    }
+    if (width <= 0 || height <= 0 || frames <= 0) {
+        std::fprintf(stderr, "need positive --width, --height and --frames\n");
+        return 2;
+    }
+
+    // 随机内容：不让分支预测或缓存命中率偏向某个内核
+    std::mt19937 random(4);
+    std::vector<uint8_t> yuv(Yuv::FrameSize(format, width, height));
+    for (uint8_t& byte : yuv) byte = static_cast<uint8_t>(random());
+    Yuv::Planes planes = Yuv::FromBuffer(yuv.data(), format, width, height);
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    std::vector<uint8_t> reference(rowBytes * height);
+    std::vector<uint8_t> output(rowBytes * height);
+    Yuv::Convert(planes, reference.data(), rowBytes, Yuv::PixelOrder::Bgra, Yuv::Kernel::Scalar);
+
+    std::printf("%dx%d %s, %d frames per kernel, single thread\n", width, height,
+                format == Yuv::Format::NV12 ? "nv12" : "i420", frames);
+    for (Yuv::Kernel kernel : { Yuv::Kernel::Scalar, Yuv::Kernel::Sse2, Yuv::Kernel::Avx2 }) {
+        if (!Yuv::IsSupported(kernel)) {
+            std::printf("%-8s not supported\n", Yuv::KernelName(kernel));
+            continue;
+        }
+        std::fill(output.begin(), output.end(), 0);
+        Yuv::Convert(planes, output.data(), rowBytes, Yuv::PixelOrder::Bgra, kernel);
+        if (output != reference) {
+            std::fprintf(stderr, "%s output differs from scalar\n", Yuv::KernelName(kernel));
+            return 1;
+        }
+        Clock::time_point start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            Yuv::Convert(planes, output.data(), rowBytes, Yuv::PixelOrder::Bgra, kernel);
+        }
+        double perFrame = MicrosSince(start) / frames;
+        std::printf("%-8s %8.3f ms/frame  %7.1f fps  %8.1f Mpix/s  60fps uses %5.1f%% of a core\n",
+                    Yuv::KernelName(kernel), perFrame / 1000, 1e6 / perFrame,
+                    static_cast<double>(width) * height / perFrame, perFrame * 60 / 1e4);
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// scale
+// ---------------------------------------------------------------------------
+
+static int BenchScale(int argc, char** argv)
+{
+    int frames = 30;
+    unsigned maxThreads = WorkStealingPool::DefaultThreads();
+    std::vector<Scaler::Filter> filters = { Scaler::Filter::Bilinear, Scaler::Filter::Area };
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--frames") == 0) frames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--threads") == 0) maxThreads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--filter") == 0) {
+            filters = { std::strcmp(argv[i + 1], "area") == 0 ? Scaler::Filter::Area : Scaler::Filter::Bilinear };
+        }
+    }
+    if (frames <= 0 || maxThreads == 0) {
+        std::fprintf(stderr, "need positive --frames and --threads\n");
+        return 2;
+    }
+
+    struct Case { int srcWidth, srcHeight, dstWidth, dstHeight; };
+    static const Case kCases[] = { { 3840, 2160, 1920, 1080 }, { 1920, 1080, 1280, 720 } };
+    std::mt19937 random(5);
+    for (const Case& item : kCases) {
+        std::vector<uint8_t> src(static_cast<size_t>(item.srcWidth) * item.srcHeight * 4);
+        for (uint8_t& byte : src) byte = static_cast<uint8_t>(random());
+        size_t dstBytes = static_cast<size_t>(item.dstWidth) * item.dstHeight * 4;
+        std::vector<uint8_t> reference(dstBytes);
+        std::vector<uint8_t> output(dstBytes);
+        for (Scaler::Filter filter : filters) {
+            std::printf("%dx%d -> %dx%d %s, %d frames\n", item.srcWidth, item.srcHeight,
+                        item.dstWidth, item.dstHeight, Scaler::FilterName(filter), frames);
+            VideoScaler(1, Yuv::Kernel::Scalar).Scale(src.data(), item.srcWidth * 4, item.srcWidth, item.srcHeight,
+                                                       reference.data(), item.dstWidth * 4,
+                                                       item.dstWidth, item.dstHeight, filter);
+            for (Yuv::Kernel kernel : { Yuv::Kernel::Scalar, Yuv::Kernel::Sse2, Yuv::Kernel::Avx2 }) {
+                if (!Yuv::IsSupported(kernel)) continue;
+                double baseline = 0;
+                // 1, 2, 4 ... 直到 maxThreads（最后一档总是 maxThreads）
+                for (unsigned threads = 1; threads <= maxThreads;
+                     threads = (threads < maxThreads && threads * 2 > maxThreads) ? maxThreads : threads * 2) {
+                    VideoScaler scaler(threads, kernel);
+                    std::fill(output.begin(), output.end(), 0);
+                    // 第一帧建系数表，不计时
+                    scaler.Scale(src.data(), item.srcWidth * 4, item.srcWidth, item.srcHeight,
+                                 output.data(), item.dstWidth * 4, item.dstWidth, item.dstHeight, filter);
+                    if (output != reference) {
+                        std::fprintf(stderr, "%s with %u threads differs from scalar\n", Yuv::KernelName(kernel), threads);
+                        return 1;
+                    }
+                    Clock::time_point start = Clock::now();
+                    for (int frame = 0; frame < frames; ++frame) {
+                        scaler.Scale(src.data(), item.srcWidth * 4, item.srcWidth, item.srcHeight,
+                                     output.data(), item.dstWidth * 4, item.dstWidth, item.dstHeight, filter);
+                    }
+                    double perFrame = MicrosSince(start) / frames;
+                    if (threads == 1) baseline = perFrame;
+                    std::printf("  %-8s threads %-3u %8.3f ms/frame  %7.1f fps  speedup %5.2fx\n",
+                                Yuv::KernelName(kernel), threads, perFrame / 1000, 1e6 / perFrame, baseline / perFrame);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// picture
+// ---------------------------------------------------------------------------
+
+static int BenchPicture(int argc, char** argv)
+{
+    int width = 1920;
+    int height = 1080;
+    int frames = 100;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--width") == 0) width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0) height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--frames") == 0) frames = std::atoi(argv[i + 1]);
+    }
+    if (width <= 0 || height <= 0 || frames <= 0) {
+        std::fprintf(stderr, "need positive --width, --height and --frames\n");
+        return 2;
+    }
+
+    std::mt19937 random(6);
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    std::vector<uint8_t> src(rowBytes * height);
+    for (uint8_t& byte : src) byte = static_cast<uint8_t>(random());
+    std::vector<uint8_t> reference(src.size());
+    std::vector<uint8_t> output(src.size());
+
+    std::printf("%dx%d, %d frames per chain, single thread\n", width, height, frames);
+    for (Picture::Mode mode : { Picture::Mode::Standard, Picture::Mode::Dynamic, Picture::Mode::Movie,
+                                Picture::Mode::Game }) {
+        Picture::Chain chain = Picture::Compile(mode, Yuv::PixelOrder::Bgra);
+        Picture::Process(chain, src.data(), rowBytes, reference.data(), rowBytes, width, height, Yuv::Kernel::Scalar);
+        for (Yuv::Kernel kernel : { Yuv::Kernel::Scalar, Yuv::Kernel::Sse2, Yuv::Kernel::Avx2 }) {
+            if (!Yuv::IsSupported(kernel)) continue;
+            Picture::Process(chain, src.data(), rowBytes, output.data(), rowBytes, width, height, kernel);
+            if (output != reference) {
+                std::fprintf(stderr, "%s %s differs from scalar\n", Picture::ModeName(mode), Yuv::KernelName(kernel));
+                return 1;
+            }
+            Clock::time_point start = Clock::now();
+            for (int frame = 0; frame < frames; ++frame) {
+                Picture::Process(chain, src.data(), rowBytes, output.data(), rowBytes, width, height, kernel);
+            }
+            double perFrame = MicrosSince(start) / frames;
+            std::printf("%-9s %-7s %8.3f ms/frame  %7.1f fps  (sharpen %d, matrix %d, lut %d)\n",
+                        Picture::ModeName(mode), Yuv::KernelName(kernel), perFrame / 1000, 1e6 / perFrame,
+                        chain.sharpen, chain.matrix, chain.lut);
+        }
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// analyze
+// ---------------------------------------------------------------------------
+
+static int BenchAnalyze(int argc, char** argv)
+{
+    int frames = 100;
+    int step = 4;
+    unsigned maxThreads = std::min(WorkStealingPool::DefaultThreads(), 4u);
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--frames") == 0) frames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--step") == 0) step = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--threads") == 0) maxThreads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    }
+    if (frames <= 0 || step <= 0 || maxThreads == 0) {
+        std::fprintf(stderr, "need positive --frames, --step and --threads\n");
+        return 2;
+    }
+
+    struct Case { int width, height; };
+    static const Case kCases[] = { { 1920, 1080 }, { 3840, 2160 } };
+    std::mt19937 random(7);
+    for (const Case& item : kCases) {
+        // 偏暗的随机画面，让均衡曲线有明显的形状
+        size_t rowBytes = static_cast<size_t>(item.width) * 4;
+        std::vector<uint8_t> frame(rowBytes * item.height);
+        for (uint8_t& byte : frame) byte = static_cast<uint8_t>(random() % 256 * (random() % 256) / 255);
+
+        std::vector<uint32_t> samples;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < frames; ++i) {
+            Analysis::Subsample(frame.data(), rowBytes, item.width, item.height, step, samples);
+        }
+        double subsample = MicrosSince(start) / frames;
+        std::printf("%dx%d, step %d (%zu samples), %d frames\n", item.width, item.height, step, samples.size(), frames);
+        std::printf("  subsample (player thread)        %8.1f us/frame\n", subsample);
+
+        Analysis::Histogram reference;
+        Analysis::CountLuma(samples.data(), samples.size(), Yuv::PixelOrder::Bgra, reference, Yuv::Kernel::Scalar);
+        for (Yuv::Kernel kernel : { Yuv::Kernel::Scalar, Yuv::Kernel::Sse2, Yuv::Kernel::Avx2 }) {
+            if (!Yuv::IsSupported(kernel)) continue;
+            // 1, 2, 4 ... 直到 maxThreads（最后一档总是 maxThreads）
+            for (unsigned threads = 1; threads <= maxThreads;
+                 threads = (threads < maxThreads && threads * 2 > maxThreads) ? maxThreads : threads * 2) {
+                FrameAnalyzer analyzer(threads, step, kernel);
+                Analysis::Histogram histogram;
+                analyzer.CountHistogram(samples.data(), samples.size(), Yuv::PixelOrder::Bgra, histogram);
+                if (std::memcmp(histogram, reference, sizeof(histogram)) != 0) {
+                    std::fprintf(stderr, "%s with %u threads differs from scalar\n", Yuv::KernelName(kernel), threads);
+                    return 1;
+                }
+                double histogramMicros = 0;
+                double curveMicros = 0;
+                double curve[256];
+                for (int i = 0; i < frames; ++i) {
+                    Clock::time_point begin = Clock::now();
+                    analyzer.CountHistogram(samples.data(), samples.size(), Yuv::PixelOrder::Bgra, histogram);
+                    Clock::time_point counted = Clock::now();
+                    Analysis::BuildCurve(histogram, FrameAnalyzer::kStrength, FrameAnalyzer::kClipLimit, curve);
+                    histogramMicros += std::chrono::duration<double, std::micro>(counted - begin).count();
+                    curveMicros += MicrosSince(counted);
+                }
+                std::printf("  %-7s threads %-3u histogram %8.1f us  curve %6.1f us  full-res equivalent %6.2f ms\n",
+                            Yuv::KernelName(kernel), threads, histogramMicros / frames, curveMicros / frames,
+                            histogramMicros / frames * step * step / 1000);
+            }
+        }
+
+        // 端到端：播放线程 Submit 到新曲线可取的延迟，以及 Submit 本身在播放线程上的耗时
+        FrameAnalyzer analyzer(0, step);
+        uint64_t version = 0;
+        uint8_t table[256];
+        double submitMicros = 0;
+        double latencyMicros = 0;
+        for (int i = 0; i < frames; ++i) {
+            Clock::time_point begin = Clock::now();
+            while (!analyzer.Submit(frame.data(), rowBytes, item.width, item.height, Yuv::PixelOrder::Bgra)) {
+                std::this_thread::yield();
+                begin = Clock::now();
+            }
+            submitMicros += MicrosSince(begin);
+            while (!analyzer.LatestCurve(version, table)) std::this_thread::yield();
+            latencyMicros += MicrosSince(begin);
+        }
+        std::printf("  end to end: submit %.1f us, curve ready after %.1f us\n",
+                    submitMicros / frames, latencyMicros / frames);
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// sound
+// ---------------------------------------------------------------------------
+
+static int BenchSound(int argc, char** argv)
+{
+    double seconds = 60;
+    int channels = 2;
+    int rate = 48000;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--seconds") == 0) seconds = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--channels") == 0) channels = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--rate") == 0) rate = std::atoi(argv[i + 1]);
+    }
+    if (seconds <= 0 || channels < 1 || channels > Sound::kMaxChannels || rate <= 0) {
+        std::fprintf(stderr, "need positive --seconds and --rate, --channels 1..%d\n", Sound::kMaxChannels);
+        return 2;
+    }
+    Sound::DisableDenormals();
+
+    // 几个正弦叠加噪声，幅度随时间起伏，让压缩器有事可做
+    size_t frames = static_cast<size_t>(seconds * rate);
+    int stride = Sound::PaddedChannels(channels);
+    std::vector<float> input(frames * stride, 0.0f);
+    std::mt19937 random(8);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+    for (size_t i = 0; i < frames; ++i) {
+        double t = static_cast<double>(i) / rate;
+        double level = 0.3 + 0.25 * std::sin(2 * 3.14159265 * 0.5 * t);
+        for (int ch = 0; ch < channels; ++ch) {
+            double tone = std::sin(2 * 3.14159265 * (60 + 20 * ch) * t) + 0.5 * std::sin(2 * 3.14159265 * 1000 * t) +
+                          0.25 * std::sin(2 * 3.14159265 * 7000 * t);
+            input[i * stride + ch] = static_cast<float>(level * tone / 1.75) + noise(random);
+        }
+    }
+
+    const size_t kBlock = 480;
+    std::vector<float> reference(input.size());
+    std::vector<float> output(input.size());
+    std::printf("%.0f s of %d ch %d Hz, %zu-frame blocks, single thread\n", seconds, channels, rate, kBlock);
+    for (Sound::Mode mode : { Sound::Mode::Standard, Sound::Mode::Music, Sound::Mode::Movie, Sound::Mode::Sports }) {
+        for (Yuv::Kernel kernel : { Yuv::Kernel::Scalar, Yuv::Kernel::Sse2 }) {
+            if (!Yuv::IsSupported(kernel)) continue;
+            // 先直接切到该模式并走完过渡，计时的部分只有稳态处理
+            SoundProcessor processor(channels, rate, kernel);
+            processor.SetMode(mode);
+            std::vector<float> warmup(static_cast<size_t>(rate) * stride / 10, 0.0f);
+            processor.Process(warmup.data(), warmup.size() / stride);
+
+            output = input;
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < frames; i += kBlock) {
+                processor.Process(output.data() + i * stride, std::min(kBlock, frames - i));
+            }
+            double micros = MicrosSince(start);
+            if (kernel == Yuv::Kernel::Scalar) reference = output;
+            else if (output != reference) {
+                std::fprintf(stderr, "%s %s differs from scalar\n", Sound::ModeName(mode), Yuv::KernelName(kernel));
+                return 1;
+            }
+            std::printf("%-9s %-7s %8.1f ms  %7.0fx realtime  %6.1f ns/frame\n", Sound::ModeName(mode),
+                        Yuv::KernelName(kernel), micros / 1000, seconds * 1e6 / micros, micros * 1000 / frames);
+        }
+    }
+
+    // 每 0.5 秒切换一次预设：过渡期间相邻样本的最大跳变与稳态比较，接近即没有爆音
+    {
+        SoundProcessor processor(channels, rate);
+        output = input;
+        Sound::Mode modes[] = { Sound::Mode::Standard, Sound::Mode::Music, Sound::Mode::Movie, Sound::Mode::Sports,
+                                Sound::Mode::Off };
+        size_t switchEvery = static_cast<size_t>(rate) / 2;
+        int switches = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < frames; i += kBlock) {
+            if (i % switchEvery < kBlock) processor.SetMode(modes[switches++ % 5]);
+            processor.Process(output.data() + i * stride, std::min(kBlock, frames - i));
+        }
+        double micros = MicrosSince(start);
+        size_t fade = static_cast<size_t>(rate * Sound::kFadeMilliseconds / 1000);
+        float fadeJump = 0;
+        float steadyJump = 0;
+        for (size_t i = 1; i < frames; ++i) {
+            size_t sinceSwitch = i % switchEvery;
+            float jump = 0;
+            for (int ch = 0; ch < channels; ++ch) {
+                jump = std::max(jump, std::fabs(output[i * stride + ch] - output[(i - 1) * stride + ch]));
+            }
+            if (sinceSwitch <= fade + kBlock) fadeJump = std::max(fadeJump, jump);
+            else steadyJump = std::max(steadyJump, jump);
+        }
+        std::printf("switching every 0.5 s (%d switches): %7.0fx realtime, max step %.4f during fades, %.4f steady\n",
+                    switches, seconds * 1e6 / micros, fadeJump, steadyJump);
+    }
+
+    // 环形缓冲：两个线程一写一读，每次一个 10ms 周期
+    {
+        AudioRing ring(static_cast<size_t>(rate) * channels / 5);
+        size_t period = static_cast<size_t>(rate / 100) * channels;
+        size_t total = frames * channels;
+        Clock::time_point start = Clock::now();
+        std::thread producer([&] {
+            std::vector<float> block(period, 1.0f);
+            size_t written = 0;
+            while (written < total) {
+                size_t n = ring.Write(block.data(), std::min(period, total - written));
+                if (!n) std::this_thread::yield();
+                written += n;
+            }
+        });
+        std::vector<float> block(period);
+        size_t read = 0;
+        while (read < total) {
+            size_t n = ring.Read(block.data(), period);
+            if (!n) std::this_thread::yield();
+            read += n;
+        }
+        producer.join();
+        double micros = MicrosSince(start);
+        std::printf("ring: %.0f M samples/s through a %zu-sample ring\n", total / micros, ring.Capacity());
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// sources
+// ---------------------------------------------------------------------------
+
+static int BenchSources(int argc, char** argv)
+{
+    int switches = 50;
+    int width = 1920;
+    int height = 1080;
+    unsigned lockMs = 0;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--switches") == 0) switches = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--width") == 0) width = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--height") == 0) height = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--lock") == 0) lockMs = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    }
+    if (switches <= 0 || width <= 0 || height <= 0) {
+        std::fprintf(stderr, "need positive --switches, --width and --height\n");
+        return 2;
+    }
+
+    // 生产线程出帧时唤醒这里的“UI 线程”
+    std::mutex lock;
+    std::condition_variable wake;
+    bool posted = false;
+    SourceSwitcher switcher([&] {
+        std::lock_guard<std::mutex> guard(lock);
+        posted = true;
+        wake.notify_one();
+    });
+    const Source::Pattern kPatterns[] = { Source::Pattern::Bars, Source::Pattern::Snow, Source::Pattern::Ramp,
+                                          Source::Pattern::Checker, Source::Pattern::Bars };
+    for (int i = 0; i < 5; ++i) {
+        InputSource::Options options;
+        options.name = "source" + std::to_string(i);
+        options.pattern = kPatterns[i];
+        options.width = width;
+        options.height = height;
+        options.lockMs = lockMs;
+        switcher.Add(options);
+    }
+
+    std::printf("%d switches between 5 pattern sources at %dx%d 60fps, lock %u ms\n", switches, width, height, lockMs);
+    std::vector<double> latencies;
+    uint64_t parkedFrames = 0;
+    for (int i = 0; i < switches; ++i) {
+        int index = i % switcher.Count();
+        switcher.Switch(index, Clock::now());
+        double millis = -1;
+        while (millis < 0) {
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return posted; });
+                posted = false;
+            }
+            switcher.Recycle(switcher.TakeLatest(millis));
+        }
+        latencies.push_back(millis);
+        // 再放几帧，确认其他源停着
+        std::vector<uint64_t> before;
+        for (int k = 0; k < switcher.Count(); ++k) before.push_back(switcher.At(k).FramesProduced());
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        switcher.Recycle(switcher.TakeLatest(millis));
+        for (int k = 0; k < switcher.Count(); ++k) {
+            if (k != index) parkedFrames += switcher.At(k).FramesProduced() - before[k];
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double total = 0;
+    for (double value : latencies) total += value;
+    std::printf("switch to first frame: min %.2f ms  avg %.2f ms  p95 %.2f ms  max %.2f ms\n", latencies.front(),
+                total / latencies.size(), latencies[latencies.size() * 95 / 100], latencies.back());
+    std::printf("frames produced by parked sources while another was active: %llu\n",
+                static_cast<unsigned long long>(parkedFrames));
+
+    // 全部停下后的 CPU 时间
+    switcher.Switch(-1, Clock::now());
+    std::clock_t cpuStart = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    double cpuMillis = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    std::printf("all sources parked: %.2f ms CPU over 500 ms\n", cpuMillis);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// thumbs
+// ---------------------------------------------------------------------------
+
+static int BenchThumbs(int argc, char** argv)
+{
+    int frames = 200;
+    double seconds = 2;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--frames") == 0) frames = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--seconds") == 0) seconds = std::atof(argv[i + 1]);
+    }
+    if (frames <= 0 || seconds <= 0) {
+        std::fprintf(stderr, "need positive --frames and --seconds\n");
+        return 2;
+    }
+
+    const int width = 1920;
+    const int height = 1080;
+    const int thumbWidth = 128;
+    const int thumbHeight = 68;
+    std::vector<uint8_t> source(static_cast<size_t>(width) * height * 4);
+    Source::Render(Source::Pattern::Snow, source.data(), width, height, 1, Yuv::PixelOrder::Bgra);
+    std::vector<uint8_t> expected(static_cast<size_t>(thumbWidth) * thumbHeight * 4);
+    std::vector<uint8_t> output(expected.size());
+    Thumbnail::Scratch scratch;
+    Thumbnail::BoxDownscale(source.data(), width * 4, width, height, expected.data(), thumbWidth * 4, thumbWidth,
+                            thumbHeight, scratch, Yuv::Kernel::Scalar);
+
+    std::printf("box downscale %dx%d -> %dx%d, %d frames\n", width, height, thumbWidth, thumbHeight, frames);
+    const Yuv::Kernel kKernels[] = { Yuv::Kernel::Scalar, Yuv::Kernel::Sse2, Yuv::Kernel::Avx2 };
+    for (Yuv::Kernel kernel : kKernels) {
+        if (!Yuv::IsSupported(kernel)) continue;
+        Thumbnail::BoxDownscale(source.data(), width * 4, width, height, output.data(), thumbWidth * 4, thumbWidth,
+                                thumbHeight, scratch, kernel);
+        if (output != expected) {
+            std::printf("  %-6s MISMATCH against scalar\n", Yuv::KernelName(kernel));
+            return 1;
+        }
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < frames; ++i) {
+            Thumbnail::BoxDownscale(source.data(), width * 4, width, height, output.data(), thumbWidth * 4, thumbWidth,
+                                    thumbHeight, scratch, kernel);
+        }
+        std::printf("  %-6s %8.1f us/thumbnail\n", Yuv::KernelName(kernel), MicrosSince(start) / frames);
+    }
+
+    // 5 个停着的 1080p 测试图源，每块最多 4fps：不同预算下缩略图线程与源线程合计的 CPU 占用
+    SourceSwitcher switcher(nullptr);
+    const Source::Pattern kPatterns[] = { Source::Pattern::Bars, Source::Pattern::Snow, Source::Pattern::Ramp,
+                                          Source::Pattern::Checker, Source::Pattern::Bars };
+    for (int i = 0; i < 5; ++i) {
+        InputSource::Options options;
+        options.name = "source" + std::to_string(i);
+        options.pattern = kPatterns[i];
+        switcher.Add(options);
+    }
+    std::printf("5 parked 1080p sources, 4 fps per tile cap, %.1f s per budget\n", seconds);
+    const double kBudgets[] = { 0.02, 0.05, 0.2, 1.0 };
+    for (double budget : kBudgets) {
+        SourceThumbnailer::Options options;
+        options.width = thumbWidth;
+        options.height = thumbHeight;
+        options.cpuBudget = budget;
+        SourceThumbnailer thumbnailer(switcher, options, nullptr);
+        std::clock_t cpuStart = std::clock();
+        thumbnailer.SetEnabled(true);
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        thumbnailer.SetEnabled(false);
+        double cpuShare = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC / seconds;
+        SourceThumbnailer::Stats stats = thumbnailer.GetStats();
+        std::printf("  budget %5.1f%%: %5.1f thumbnails/s (cap 20), accounted %5.1f%% cpu, process %5.1f%% cpu, "
+                    "last %.0f us source + %.0f us scale\n",
+                    budget * 100, stats.thumbnails / seconds, stats.cpuShare * 100, cpuShare * 100,
+                    stats.lastRenderMicros, stats.lastScaleMicros);
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// zap
+// ---------------------------------------------------------------------------
+
+static int BenchZap(int argc, char** argv)
+{
+    int zaps = 20;
+    unsigned intervalMs = 250;
+    unsigned tuneMs = 120;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--zaps") == 0) zaps = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--interval") == 0) intervalMs = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--tune") == 0) tuneMs = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    }
+    if (zaps <= 0) {
+        std::fprintf(stderr, "need positive --zaps\n");
+        return 2;
+    }
+
+    // 100 个频道上的一段换台：多数沿同一方向连按，偶尔反向或跳回上一个看过的频道；三种方式用同一序列
+    const uint32_t kChannels = 100;
+    std::mt19937 random(7);
+    std::vector<uint32_t> sequence;
+    uint32_t current = 1;
+    uint32_t previous = 1;
+    int direction = 1;
+    for (int i = 0; i < zaps; ++i) {
+        unsigned roll = random() % 10;
+        uint32_t next;
+        if (roll == 0 && previous != current) {
+            next = previous;
+        } else {
+            if (roll == 1) direction = -direction;
+            next = (current - 1 + kChannels + direction) % kChannels + 1;
+        }
+        previous = current;
+        current = next;
+        sequence.push_back(current);
+    }
+
+    struct Mode {
+        const char* name;
+        bool prefetch;
+        size_t cacheBytes;
+    };
+    const Mode kModes[] = {
+        { "no cache", false, 0 },
+        { "cache only", false, 48u << 20 },
+        { "prefetch", true, 48u << 20 },
+    };
+    std::printf("%d zaps every %u ms over %u channels, tune %u ms, 1080p test pattern -> 960x540\n", zaps, intervalMs,
+                kChannels, tuneMs);
+    for (const Mode& mode : kModes) {
+        ZapPrefetcher::Options options;
+        options.tuneMs = tuneMs;
+        options.prefetch = mode.prefetch;
+        options.cacheBytes = mode.cacheBytes;
+        std::mutex lock;
+        std::condition_variable wake;
+        bool ready = false;
+        ZapPrefetcher prefetcher(options, [&] {
+            std::lock_guard<std::mutex> guard(lock);
+            ready = true;
+            wake.notify_one();
+        });
+        prefetcher.SetOutputSize(960, 540);
+
+        std::vector<double> latencies;
+        size_t peakBytes = 0;
+        int lastDirection = 1;
+        uint32_t tuned = 1;
+        for (uint32_t number : sequence) {
+            int step = static_cast<int>(number) - static_cast<int>(tuned);
+            if (step == 1 || step == -1) lastDirection = step;
+            tuned = number;
+            // 预测：沿当前方向的下一个，然后反方向
+            std::vector<uint32_t> neighbours = {
+                (number - 1 + kChannels + lastDirection) % kChannels + 1,
+                (number - 1 + kChannels - lastDirection) % kChannels + 1,
+            };
+            Clock::time_point start = Clock::now();
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                ready = false;
+            }
+            ZapPrefetcher::FramePtr frame = prefetcher.Zap(number, neighbours, start);
+            double millis = 0;
+            if (!frame) {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return ready; });
+                guard.unlock();
+                frame = prefetcher.TakeZapFrame(millis);
+            }
+            latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            peakBytes = std::max(peakBytes, prefetcher.GetStats().cachedBytes);
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+        ZapPrefetcher::Stats stats = prefetcher.GetStats();
+        std::sort(latencies.begin(), latencies.end());
+        double total = 0;
+        for (double value : latencies) total += value;
+        std::printf("  %-10s avg %7.2f ms  p50 %7.2f ms  p95 %7.2f ms  max %7.2f ms  hits %llu/%llu  loads %llu  "
+                    "cancelled %llu  peak cache %.1f MB\n",
+                    mode.name, total / latencies.size(), latencies[latencies.size() / 2],
+                    latencies[latencies.size() * 95 / 100], latencies.back(), static_cast<unsigned long long>(stats.hits),
+                    static_cast<unsigned long long>(stats.zaps), static_cast<unsigned long long>(stats.loads),
+                    static_cast<unsigned long long>(stats.cancelled), peakBytes / 1048576.0);
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// timeshift
+// ---------------------------------------------------------------------------
+
+static int BenchTimeShift(int argc, char** argv)
+{
+    unsigned maxStreams = 4;
+    double seconds = 2;
+    size_t segmentMb = 16;
+    unsigned segments = 8;
+    std::string directory = ".";
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--streams") == 0) maxStreams = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--seconds") == 0) seconds = std::atof(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--segment-mb") == 0) segmentMb = static_cast<size_t>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--segments") == 0) segments = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--dir") == 0) directory = argv[i + 1];
+    }
+    if (maxStreams == 0 || seconds <= 0 || segmentMb == 0 || segments < 2) {
+        std::fprintf(stderr, "need positive --streams, --seconds, --segment-mb and --segments >= 2\n");
+        return 2;
+    }
+
+    // 流内时间按 20 Mbit/s 由包序号推算，全速写入时窗口也有对应的时间跨度
+    const double kHdMbps = 20;
+    const double kMicrosPerPacket = TimeShift::kPacketSize * 8 / kHdMbps;
+    const size_t kChunkPackets = 348;      // 每次写入约 64KB
+    std::printf("time-shift ring: %u x %zu MB segments per stream, %zu-packet writes, reader seeks while writing\n",
+                segments, segmentMb, kChunkPackets);
+    for (unsigned streams = 1; streams <= maxStreams; streams *= 2) {
+        std::vector<std::unique_ptr<TimeShiftBuffer>> buffers;
+        for (unsigned s = 0; s < streams; ++s) {
+            TimeShiftBuffer::Options options;
+            options.directory = directory;
+            options.name = "bench_timeshift" + std::to_string(s);
+            options.segmentBytes = segmentMb << 20;
+            options.segments = segments;
+            std::unique_ptr<TimeShiftBuffer> buffer(new TimeShiftBuffer());
+            if (!buffer->Open(options)) {
+                std::fprintf(stderr, "cannot create segment files in %s\n", directory.c_str());
+                return 1;
+            }
+            buffers.push_back(std::move(buffer));
+        }
+
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> threads;
+        std::vector<uint64_t> written(streams, 0);
+        std::vector<std::vector<double>> seekMicros(streams);
+        std::vector<uint64_t> reads(streams, 0);
+        std::vector<uint64_t> errors(streams, 0);
+        for (unsigned s = 0; s < streams; ++s) {
+            threads.emplace_back([&, s] {
+                std::vector<uint8_t> packets(kChunkPackets * TimeShift::kPacketSize, 0xA5);
+                uint64_t sequence = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    int64_t micros = static_cast<int64_t>(sequence * kMicrosPerPacket);
+                    TimeShift::FillPackets(packets.data(), kChunkPackets, sequence, 0x100);
+                    buffers[s]->Append(packets.data(), kChunkPackets, micros,
+                                       micros + static_cast<int64_t>(kChunkPackets * kMicrosPerPacket));
+                }
+                written[s] = sequence;
+            });
+            // 读者：随机定位到窗口内的某个时间，读 64 个包并核对序号连续
+            threads.emplace_back([&, s] {
+                std::mt19937 random(s + 1);
+                std::vector<uint8_t> out(64 * TimeShift::kPacketSize);
+                while (!stop.load(std::memory_order_relaxed)) {
+                    TimeShiftBuffer::Stats stats = buffers[s]->GetStats();
+                    if (stats.windowEndMicros <= stats.windowStartMicros) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    int64_t target = stats.windowStartMicros +
+                        static_cast<int64_t>(random() % static_cast<uint64_t>(stats.windowEndMicros - stats.windowStartMicros));
+                    Clock::time_point start = Clock::now();
+                    uint64_t packet = buffers[s]->Seek(target);
+                    seekMicros[s].push_back(MicrosSince(start));
+                    bool lost = false;
+                    size_t count = buffers[s]->Read(packet, out.data(), 64, &lost);
+                    for (size_t i = 0; i < count; ++i) {
+                        if (TimeShift::PacketSequence(out.data() + i * TimeShift::kPacketSize) != packet - count + i) {
+                            ++errors[s];
+                        }
+                    }
+                    ++reads[s];
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (std::thread& thread : threads) thread.join();
+
+        uint64_t totalPackets = 0;
+        uint64_t totalReads = 0;
+        uint64_t totalErrors = 0;
+        uint64_t recycled = 0;
+        std::vector<double> seeks;
+        for (unsigned s = 0; s < streams; ++s) {
+            totalPackets += written[s];
+            totalReads += reads[s];
+            totalErrors += errors[s];
+            recycled += buffers[s]->GetStats().recycled;
+            seeks.insert(seeks.end(), seekMicros[s].begin(), seekMicros[s].end());
+        }
+        double megabytes = totalPackets * TimeShift::kPacketSize / 1048576.0;
+        double mbps = totalPackets * TimeShift::kPacketSize * 8 / seconds / 1e6;
+        std::printf("  %u stream%s: %8.1f MB/s total, %7.1f MB/s per stream = %6.0f HD streams of %.0f Mbit/s, "
+                    "%llu segments recycled\n",
+                    streams, streams > 1 ? "s" : " ", megabytes / seconds, megabytes / seconds / streams, mbps / kHdMbps,
+                    kHdMbps, static_cast<unsigned long long>(recycled));
+        PrintLatency("  seek while writing", seeks);
+        std::printf("  %llu verified reads, %llu mismatched packets\n", static_cast<unsigned long long>(totalReads),
+                    static_cast<unsigned long long>(totalErrors));
+        if (totalErrors) return 1;
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// logos
+// ---------------------------------------------------------------------------
+
+static int BenchLogos(int argc, char** argv)
+{
+    uint32_t channels = 1000;
+    int steps = 120;
+    unsigned intervalMs = 40;
+    unsigned decodeMs = 4;
+    size_t cacheKb = 4096;
+    for (int i = 0; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--channels") == 0) channels = static_cast<uint32_t>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--steps") == 0) steps = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--interval") == 0) intervalMs = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--decode") == 0) decodeMs = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (std::strcmp(argv[i], "--cache-kb") == 0) cacheKb = static_cast<size_t>(std::atoi(argv[i + 1]));
+    }
+    if (channels < 32 || steps <= 0 || static_cast<uint32_t>(steps) >= channels) {
+        std::fprintf(stderr, "need --channels >= 32 and 0 < --steps < --channels\n");
+        return 2;
+    }
+
+    // 与频道列表页一致：一屏 8 块，条带两侧各多绑定 2 块
+    const size_t kVisible = 8;
+    const size_t kOverscan = 2;
+    // 模拟 PNG 解码：先等 decodeMs（解压的耗时），再生成 320x120 带透明边的台标
+    LogoCache::DecodeFunc decode = [decodeMs](uint32_t key, LogoCache::Image& image) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(decodeMs));
+        if (key % 50 == 0) return false;   // 少数频道没有台标
+        image.width = 320;
+        image.height = 120;
+        image.rgba.resize(static_cast<size_t>(image.width) * image.height * 4);
+        for (int y = 0; y < image.height; ++y) {
+            uint8_t* row = image.rgba.data() + static_cast<size_t>(y) * image.width * 4;
+            for (int x = 0; x < image.width; ++x) {
+                bool inside = x >= 16 && x < image.width - 16 && y >= 8 && y < image.height - 8;
+                row[x * 4 + 0] = static_cast<uint8_t>(key * 37 + x);
+                row[x * 4 + 1] = static_cast<uint8_t>(key * 11 + y);
+                row[x * 4 + 2] = static_cast<uint8_t>(x ^ y);
+                row[x * 4 + 3] = inside ? 255 : 0;
+            }
+        }
+        return true;
+    };
+
+    struct Mode {
+        const char* name;
+        size_t margin;                     // 绑定区间两侧再预取的项数
+    };
+    const Mode kModes[] = {
+        { "no prefetch", 0 },
+        { "prefetch 8", 8 },
+    };
+    std::printf("%u channels, scroll %d items forward then back every %u ms, %u ms simulated decode, %zu KB cache\n",
+                channels, steps, intervalMs, decodeMs, cacheKb);
+    for (const Mode& mode : kModes) {
+        LogoCache::Options options;
+        options.cacheBytes = cacheKb << 10;
+        LogoCache cache(options, decode, nullptr);
+        uint64_t visibleFrames = 0;
+        uint64_t placeholders = 0;
+        std::vector<double> getMicros;
+        // 先前进再后退：后退时看的是刚滚过的台标，检验 LRU 缓存
+        for (int step = 0; step <= 2 * steps; ++step) {
+            size_t first = static_cast<size_t>(step <= steps ? step : 2 * steps - step);
+            size_t begin = first > kOverscan ? first - kOverscan : 0;
+            size_t end = std::min<size_t>(first + kVisible + kOverscan, channels);
+            // 每一帧：可见与预留的图块各取一次台标（模拟绑定后逐块绘制前）
+            for (size_t item = begin; item < end; ++item) {
+                Clock::time_point start = Clock::now();
+                LogoCache::LogoPtr logo = cache.Get(static_cast<uint32_t>(item + 1));
+                getMicros.push_back(MicrosSince(start));
+                if (item >= first && item < first + kVisible) {
+                    ++visibleFrames;
+                    if (!logo) ++placeholders;
+                }
+            }
+            std::vector<uint32_t> wanted;
+            for (size_t item = begin; item < end; ++item) wanted.push_back(static_cast<uint32_t>(item + 1));
+            for (size_t distance = 1; distance <= mode.margin; ++distance) {
+                if (end + distance - 1 < channels) wanted.push_back(static_cast<uint32_t>(end + distance));
+                if (begin >= distance) wanted.push_back(static_cast<uint32_t>(begin - distance + 1));
+            }
+            cache.Prefetch(wanted);
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+        LogoCache::Stats stats = cache.GetStats();
+        std::printf("  %-12s hit rate %5.1f%% (%llu/%llu, %llu from prefetch), placeholders %5.1f%% of visible tiles, "
+                    "%llu decoded, %llu dropped, %llu evicted, cache %zu logos %.0f KB, %.0f us/logo on workers\n",
+                    mode.name, stats.hitRate * 100, static_cast<unsigned long long>(stats.hits),
+                    static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.prefetchHits),
+                    visibleFrames ? 100.0 * placeholders / visibleFrames : 0.0,
+                    static_cast<unsigned long long>(stats.decoded + stats.missing),
+                    static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(stats.evicted),
+                    stats.cachedLogos, stats.cachedBytes / 1024.0, stats.decodeMicros);
+        PrintLatency("    Get on UI thread", getMicros);
+    }
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+struct BenchEntry {
+    const char* name;
+    int (*run)(int argc, char** argv);
+    const char* usage;
+};
+
+static const BenchEntry kBenches[] = {
+    { "channels", BenchChannels, "channels [数量] [--keep 文件]" },
+    { "scan", BenchScan, "scan [--freqs N] [--packets N] [--dwell MS] [--threads N]" },
+    { "epg", BenchEpg, "epg [--services N] [--days N] [--keep 文件]" },
+    { "catalog", BenchCatalog, "catalog [--keys N] [--languages N]" },
+    { "yuv", BenchYuv, "yuv [--width N] [--height N] [--format i420|nv12] [--frames N]" },
+    { "scale", BenchScale, "scale [--frames N] [--threads N] [--filter bilinear|area]" },
+    { "picture", BenchPicture, "picture [--width N] [--height N] [--frames N]" },
+    { "analyze", BenchAnalyze, "analyze [--frames N] [--step N] [--threads N]" },
+    { "sound", BenchSound, "sound [--seconds N] [--channels N] [--rate N]" },
+    { "sources", BenchSources, "sources [--switches N] [--width N] [--height N] [--lock MS]" },
+    { "thumbs", BenchThumbs, "thumbs [--frames N] [--seconds N]" },
+    { "zap", BenchZap, "zap [--zaps N] [--interval MS] [--tune MS]" },
+    { "logos", BenchLogos, "logos [--channels N] [--steps N] [--interval MS] [--decode MS] [--cache-kb N]" },
+    { "timeshift", BenchTimeShift, "timeshift [--streams N] [--seconds N] [--segment-mb N] [--segments N] [--dir 目录]" },
+};
+
+int main(int argc, char** argv)
+{
+    if (argc >= 2) {
+        for (const auto& bench : kBenches) {
+            if (std::strcmp(argv[1], bench.name) == 0) {
+                return bench.run(argc - 2, argv + 2);
+            }
+        }
+    }
+    std::fprintf(stderr, "usage: bench <item> [args]\n");
+    for (const auto& bench : kBenches) {
+        std::fprintf(stderr, "  %s\n", bench.usage);
+    }
+    return 2;
+}
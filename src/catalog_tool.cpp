@@ -0,0 +1,111 @@
+// 翻译目录编译工具 - 把 gettext 风格的 .po 文本编译成菜单程序映射读取的 .tvtc 目录
+//
+// 用法: catalog_tool <输入.po> <输出.tvtc> [--language 代码]
+//       catalog_tool --dump <目录.tvtc>
+//       catalog_tool --embed <输入.po> <输出.h>   生成内置文本表（lang/en.po -> src/lang_builtin_en.h）
+// 语言代码默认取输入文件名（lang/zh.po -> zh），须与 main.cpp 中 kLanguageCodes 一致。
+#include "translation_catalog.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static int Dump(const std::string& path)
+{
+    TranslationCatalog catalog;
+    if (!catalog.Open(path)) {
+        std::fprintf(stderr, "invalid catalog: %s\n", path.c_str());
+        return 1;
+    }
+    std::printf("language %s, %zu entries\n", catalog.Language(), catalog.Count());
+    return 0;
+}
+
+// 把文本写成 C 字符串字面量，非 ASCII 字节用八进制转义，生成的头文件与源码编码无关
+static std::string Quote(const std::string& text)
+{
+    std::string out = "\"";
+    char escape[8];
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c < 0x20 || c >= 0x7F) {
+            std::snprintf(escape, sizeof(escape), "\\%03o", c);
+            out += escape;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+// 生成内置文本表：找不到目录文件时菜单程序用它兜底
+static int Embed(const std::string& input, const std::string& output)
+{
+    CatalogFile::Messages messages;
+    std::string error;
+    if (!CatalogFile::ParsePo(input, messages, error)) {
+        std::fprintf(stderr, "%s:%s\n", input.c_str(), error.c_str());
+        return 1;
+    }
+    FILE* file = std::fopen(output.c_str(), "wb");
+    if (!file) {
+        std::fprintf(stderr, "cannot write %s\n", output.c_str());
+        return 1;
+    }
+    size_t slash = input.find_last_of("/\\");
+    std::fprintf(file, "// 内置英文文本 - 由 catalog_tool --embed 从 lang/%s 生成，请勿手工修改\n"
+                       "//\n"
+                       "// 目录文件都打不开时 LanguageManager 用它兜底，菜单不会只显示文本键。\n"
+                       "#pragma once\n\n"
+                       "static const char* const kBuiltinEnglish[][2] = {\n",
+                 input.substr(slash == std::string::npos ? 0 : slash + 1).c_str());
+    for (const auto& message : messages) {
+        std::fprintf(file, "    { %s, %s },\n", Quote(message.first).c_str(), Quote(message.second).c_str());
+    }
+    std::fprintf(file, "};\n");
+    bool ok = FileUtil::SyncAndClose(file);
+    std::printf("%zu messages -> %s\n", messages.size(), output.c_str());
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && std::strcmp(argv[1], "--dump") == 0) {
+        return Dump(argv[2]);
+    }
+    if (argc == 4 && std::strcmp(argv[1], "--embed") == 0) {
+        return Embed(argv[2], argv[3]);
+    }
+    if (argc != 3 && !(argc == 5 && std::strcmp(argv[3], "--language") == 0)) {
+        std::fprintf(stderr, "usage: catalog_tool <input.po> <output.tvtc> [--language code]\n"
+                             "       catalog_tool --dump <catalog.tvtc>\n"
+                             "       catalog_tool --embed <input.po> <output.h>\n");
+        return 2;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+    std::string language;
+    if (argc == 5) {
+        language = argv[4];
+    } else {
+        size_t slash = input.find_last_of("/\\");
+        language = input.substr(slash == std::string::npos ? 0 : slash + 1);
+        language = language.substr(0, language.find('.'));
+    }
+
+    CatalogFile::Messages messages;
+    std::string error;
+    if (!CatalogFile::ParsePo(input, messages, error)) {
+        std::fprintf(stderr, "%s:%s\n", input.c_str(), error.c_str());
+        return 1;
+    }
+    if (!CatalogFile::Write(output, language, messages)) {
+        std::fprintf(stderr, "cannot write %s (language code '%s')\n", output.c_str(), language.c_str());
+        return 1;
+    }
+    std::printf("%s: %zu messages -> %s\n", language.c_str(), messages.size(), output.c_str());
+    return Dump(output);
+}
@@ -0,0 +1,550 @@
+// 自动搜台 - 在频点表上并行锁频、解析传输流中的 PAT/SDT，结果边搜边写入频道库
+//
+// 信号源可替换：SimulatedSignalSource 按频点生成合成传输流，TsFileSignalSource 读取
+// 录制的 "<频点kHz>.ts" 文件；两者走同一个 PSI 解析器，不需要调谐器硬件即可测试。
+// 每个频点是线程池中的一个任务；协调线程按固定间隔把已发现的频道写成暂存文件，
+// 由 UI 线程在合适的时机替换并重新映射频道库（Windows 上不能替换仍被映射的文件）。
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "channel_store.h"
+#include "ts_section.h"
+#include "work_pool.h"
+
+namespace TsScan {
+    const uint16_t kPatPid = 0x0000;
+    const uint16_t kSdtPid = 0x0011;
+    const uint8_t kPatTableId = 0x00;
+    const uint8_t kSdtActualTableId = 0x42;
+    const uint8_t kServiceDescriptor = 0x48;
+
+    struct Service {
+        uint16_t serviceId;
+        uint8_t serviceType;   // 0x01 电视，0x02 广播
+        bool scrambled;
+        std::string name;
+    };
+
+    // 从 TS 包流中拼装 PAT 与 SDT 段并解析出业务列表；Feed 可分块调用
+    class PsiParser
+    {
+    public:
+        PsiParser()
+            : m_patDone(false)
+            , m_sdtLastSection(-1)
+            , m_packets(0)
+        {
+            std::fill(m_sdtSeen, m_sdtSeen + 256, false);
+        }
+
+        // 喂入整数个 TS 包，遇到失步的包直接跳过
+        void Feed(const uint8_t* data, size_t size)
+        {
+            auto onSection = [this](const uint8_t* section, size_t length) { OnSection(section, length); };
+            for (size_t offset = 0; offset + kPacketSize <= size; offset += kPacketSize) {
+                ++m_packets;
+                uint16_t pid;
+                bool unitStart;
+                const uint8_t* payload;
+                size_t size;
+                if (!PacketPayload(data + offset, pid, unitStart, payload, size)) continue;   // 失步或传输错误
+                if (pid != kPatPid && pid != kSdtPid) continue;
+                (pid == kPatPid ? m_patSection : m_sdtSection).Push(unitStart, payload, size, onSection);
+            }
+        }
+
+        // PAT 与 SDT 的所有段都已收到
+        bool Complete() const
+        {
+            if (!m_patDone || m_sdtLastSection < 0) return false;
+            for (int i = 0; i <= m_sdtLastSection; ++i) {
+                if (!m_sdtSeen[i]) return false;
+            }
+            return true;
+        }
+
+        size_t PacketCount() const { return m_packets; }
+
+        // PAT 中存在的业务（PAT 未收到时返回 SDT 中的全部业务）
+        std::vector<Service> Services() const
+        {
+            std::vector<Service> services;
+            for (const auto& service : m_services) {
+                if (!m_patDone || std::binary_search(m_programs.begin(), m_programs.end(), service.serviceId)) {
+                    services.push_back(service);
+                }
+            }
+            return services;
+        }
+
+    private:
+        SectionAssembler m_patSection;
+        SectionAssembler m_sdtSection;
+        std::vector<uint16_t> m_programs;   // 升序
+        std::vector<Service> m_services;
+        bool m_patDone;
+        int m_sdtLastSection;
+        bool m_sdtSeen[256];
+        size_t m_packets;
+
+        // 完整且 CRC 正确的段
+        void OnSection(const uint8_t* data, size_t length)
+        {
+            if (data[0] == kPatTableId) ParsePat(data, length);
+            else if (data[0] == kSdtActualTableId) ParseSdt(data, length);
+        }
+
+        void ParsePat(const uint8_t* data, size_t length)
+        {
+            m_programs.clear();
+            for (size_t i = 8; i + 4 <= length - 4; i += 4) {
+                uint16_t program = static_cast<uint16_t>((data[i] << 8) | data[i + 1]);
+                if (program != 0) m_programs.push_back(program);   // 0 为 NIT
+            }
+            std::sort(m_programs.begin(), m_programs.end());
+            m_patDone = true;
+        }
+
+        void ParseSdt(const uint8_t* data, size_t length)
+        {
+            int sectionNumber = data[6];
+            if (m_sdtSeen[sectionNumber]) return;
+            m_sdtSeen[sectionNumber] = true;
+            m_sdtLastSection = data[7];
+
+            size_t end = length - 4;
+            size_t i = 11;
+            while (i + 5 <= end) {
+                Service service;
+                service.serviceId = static_cast<uint16_t>((data[i] << 8) | data[i + 1]);
+                service.scrambled = (data[i + 3] & 0x10) != 0;
+                service.serviceType = 0;
+                size_t loopEnd = i + 5 + (((data[i + 3] & 0x0F) << 8) | data[i + 4]);
+                if (loopEnd > end) break;
+                for (size_t d = i + 5; d + 2 <= loopEnd; d += 2 + data[d + 1]) {
+                    size_t descriptorEnd = d + 2 + data[d + 1];
+                    if (descriptorEnd > loopEnd) break;
+                    if (data[d] != kServiceDescriptor || data[d + 1] < 3) continue;
+                    service.serviceType = data[d + 2];
+                    size_t provider = data[d + 3];
+                    size_t nameAt = d + 4 + provider;
+                    if (nameAt < descriptorEnd && nameAt + 1 + data[nameAt] <= descriptorEnd) {
+                        service.name.assign(reinterpret_cast<const char*>(data + nameAt + 1), data[nameAt]);
+                    }
+                }
+                m_services.push_back(service);
+                i = loopEnd;
+            }
+        }
+    };
+
+    // 生成一个频点的合成传输流：PAT、SDT 放在随机位置，其余是视频 PID 与空包
+    inline std::vector<uint8_t> Synthesize(uint32_t frequencyKhz, uint32_t seed, size_t packets,
+                                           std::vector<Service>& services)
+    {
+        static const char* const kNames[] = {
+            "CCTV-", "BBC ", "Discovery ", "HBO ", "News ", "Sport ", "Movie ", "Kids ", "Music ", "Radio "
+        };
+        std::mt19937 random(seed ^ (frequencyKhz * 2654435761u));
+        services.clear();
+        int count = 2 + static_cast<int>(random() % 11);
+        uint16_t base = static_cast<uint16_t>((frequencyKhz / 1000) % 1000 * 16);
+        for (int k = 0; k < count; ++k) {
+            Service service;
+            service.serviceId = static_cast<uint16_t>(base + k + 1);
+            service.serviceType = (random() % 8 == 0) ? 0x02 : 0x01;
+            service.scrambled = random() % 5 == 0;
+            service.name = kNames[random() % 10] + std::to_string(frequencyKhz / 1000) + "." + std::to_string(k + 1);
+            services.push_back(service);
+        }
+
+        std::vector<uint8_t> pat = { kPatTableId, 0xB0, 0, 0x00, 0x01, 0xC1, 0, 0 };
+        for (const auto& service : services) {
+            uint16_t pmtPid = static_cast<uint16_t>(0x100 + (service.serviceId & 0xFF));
+            pat.insert(pat.end(), { static_cast<uint8_t>(service.serviceId >> 8), static_cast<uint8_t>(service.serviceId),
+                                    static_cast<uint8_t>(0xE0 | (pmtPid >> 8)), static_cast<uint8_t>(pmtPid) });
+        }
+        FinishSection(pat);
+
+        std::vector<uint8_t> sdt = { kSdtActualTableId, 0xB0, 0, 0x00, 0x01, 0xC1, 0, 0, 0x20, 0x85, 0xFF };
+        for (const auto& service : services) {
+            std::vector<uint8_t> descriptor = { kServiceDescriptor, 0, service.serviceType, 0,
+                                                static_cast<uint8_t>(service.name.size()) };
+            descriptor.insert(descriptor.end(), service.name.begin(), service.name.end());
+            descriptor[1] = static_cast<uint8_t>(descriptor.size() - 2);
+            uint16_t loop = static_cast<uint16_t>(descriptor.size());
+            sdt.insert(sdt.end(), { static_cast<uint8_t>(service.serviceId >> 8), static_cast<uint8_t>(service.serviceId),
+                                    0xFC, static_cast<uint8_t>(0x80 | (service.scrambled ? 0x10 : 0) | (loop >> 8)),
+                                    static_cast<uint8_t>(loop) });
+            sdt.insert(sdt.end(), descriptor.begin(), descriptor.end());
+        }
+        FinishSection(sdt);
+
+        if (packets < 64) packets = 64;
+        std::vector<uint8_t> stream(packets * kPacketSize);
+        size_t patAt = random() % (packets / 2);
+        size_t sdtAt = packets / 2 + random() % (packets / 2 - 8);
+        uint8_t counter = 0;
+        for (size_t p = 0; p < packets; ++p) {
+            uint8_t* packet = &stream[p * kPacketSize];
+            uint16_t pid = (p % 4 == 3) ? kNullPid : 0x100;
+            packet[0] = kSyncByte;
+            packet[1] = static_cast<uint8_t>(pid >> 8);
+            packet[2] = static_cast<uint8_t>(pid);
+            packet[3] = static_cast<uint8_t>(0x10 | (counter++ & 0x0F));
+            for (size_t i = 4; i < kPacketSize; i += 4) {
+                uint32_t value = random();
+                std::memcpy(packet + i, &value, 4);
+            }
+        }
+
+        // 把一个段切成若干包写到 at 开始的位置
+        auto place = [&](const std::vector<uint8_t>& section, uint16_t pid, size_t at) {
+            size_t written = 0;
+            for (size_t p = at; written < section.size() && p < packets; ++p) {
+                uint8_t* packet = &stream[p * kPacketSize];
+                bool first = written == 0;
+                packet[1] = static_cast<uint8_t>((first ? 0x40 : 0x00) | (pid >> 8));
+                packet[2] = static_cast<uint8_t>(pid);
+                size_t offset = 4;
+                if (first) packet[offset++] = 0;   // pointer_field
+                size_t chunk = std::min(kPacketSize - offset, section.size() - written);
+                std::copy(section.begin() + written, section.begin() + written + chunk, packet + offset);
+                std::fill(packet + offset + chunk, packet + kPacketSize, 0xFF);
+                written += chunk;
+            }
+        };
+        place(pat, kPatPid, patAt);
+        place(sdt, kSdtPid, sdtAt);
+        return stream;
+    }
+}
+
+// 信号源：锁定一个频点并返回其中的业务；会被多个工作线程同时调用，实现必须线程安全
+class SignalSource
+{
+public:
+    virtual ~SignalSource() {}
+
+    // 未锁定信号时返回 false；cancel 置位时应尽快返回
+    virtual bool Tune(uint32_t frequencyKhz, std::vector<TsScan::Service>& services,
+                      const std::atomic<bool>& cancel) = 0;
+};
+
+// 模拟信号源：按频点生成合成传输流并解析；lockPercent 的频点有信号，dwellMs 模拟锁频耗时
+class SimulatedSignalSource : public SignalSource
+{
+public:
+    SimulatedSignalSource(uint32_t seed = 1, size_t packetsPerMux = 4096, int lockPercent = 60, int dwellMs = 0)
+        : m_seed(seed)
+        , m_packets(packetsPerMux)
+        , m_lockPercent(lockPercent)
+        , m_dwellMs(dwellMs)
+    {
+    }
+
+    bool Tune(uint32_t frequencyKhz, std::vector<TsScan::Service>& services,
+              const std::atomic<bool>& cancel) override
+    {
+        services.clear();
+        if (m_dwellMs > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_dwellMs));
+        }
+        uint32_t hash = (frequencyKhz ^ m_seed) * 2654435761u;
+        if (cancel.load() || static_cast<int>((hash >> 16) % 100) >= m_lockPercent) return false;
+
+        std::vector<TsScan::Service> expected;
+        std::vector<uint8_t> stream = TsScan::Synthesize(frequencyKhz, m_seed, m_packets, expected);
+        TsScan::PsiParser parser;
+        const size_t chunk = 64 * TsScan::kPacketSize;
+        for (size_t offset = 0; offset < stream.size() && !parser.Complete() && !cancel.load(); offset += chunk) {
+            parser.Feed(stream.data() + offset, std::min(chunk, stream.size() - offset));
+        }
+        services = parser.Services();
+        return parser.Complete();
+    }
+
+private:
+    uint32_t m_seed;
+    size_t m_packets;
+    int m_lockPercent;
+    int m_dwellMs;
+};
+
+// 录制文件信号源：频点 f 对应 directory/<f>.ts，文件不存在视为无信号
+class TsFileSignalSource : public SignalSource
+{
+public:
+    explicit TsFileSignalSource(const std::string& directory)
+        : m_directory(directory)
+    {
+    }
+
+    bool Tune(uint32_t frequencyKhz, std::vector<TsScan::Service>& services,
+              const std::atomic<bool>& cancel) override
+    {
+        services.clear();
+        std::string path = m_directory + "/" + std::to_string(frequencyKhz) + ".ts";
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+
+        TsScan::PsiParser parser;
+        TsScan::ReadPackets(file, [&](const uint8_t* data, size_t size) {
+            parser.Feed(data, size);
+            return !parser.Complete() && !cancel.load();
+        });
+        std::fclose(file);
+        services = parser.Services();
+        return !services.empty();
+    }
+
+private:
+    std::string m_directory;
+};
+
+namespace ScanPlan {
+    // UHF 21-69 频道，8MHz 间隔
+    inline std::vector<uint32_t> Uhf()
+    {
+        std::vector<uint32_t> plan;
+        for (uint32_t khz = 474000; khz <= 858000; khz += 8000) plan.push_back(khz);
+        return plan;
+    }
+}
+
+class ChannelScanner
+{
+public:
+    struct Progress {
+        size_t done;        // 已扫描的频点数
+        size_t total;
+        size_t found;       // 已发现的业务数
+        bool finished;
+        bool cancelled;
+    };
+
+    // existing 中的频道保留原频道号；plan 中频点上的旧频道被本次结果替换，
+    // 重新找到的（同频点同名）沿用原频道号，频点扫完之前旧频道留在快照里。
+    // 新发现的业务按 (频点, service_id) 排序，编号接在所有已有频道之后。
+    ChannelScanner(std::unique_ptr<SignalSource> source, const std::vector<uint32_t>& plan,
+                   const std::vector<ChannelInfo>& existing, const std::string& storePath,
+                   unsigned threads = 0, int snapshotIntervalMs = 500)
+        : m_source(std::move(source))
+        , m_plan(plan)
+        , m_storePath(storePath)
+        , m_stagingPath(storePath + ".scan")
+        , m_threads(threads)
+        , m_snapshotIntervalMs(snapshotIntervalMs)
+        , m_cancel(false)
+        , m_done(0)
+        , m_found(0)
+        , m_finished(false)
+        , m_snapshotReady(false)
+    {
+        std::vector<uint32_t> sorted = plan;
+        std::sort(sorted.begin(), sorted.end());
+        for (const auto& channel : existing) {
+            if (!std::binary_search(sorted.begin(), sorted.end(), channel.frequencyKhz)) {
+                m_existing.push_back(channel);
+            } else {
+                m_rescanned.push_back(channel);
+            }
+        }
+    }
+
+    ~ChannelScanner()
+    {
+        Cancel();
+        if (m_coordinator.joinable()) m_coordinator.join();
+        std::remove(m_stagingPath.c_str());
+    }
+
+    void Start()
+    {
+        m_coordinator = std::thread(&ChannelScanner::Run, this);
+    }
+
+    void Cancel()
+    {
+        m_cancel = true;
+        m_changed.notify_all();
+    }
+
+    Progress GetProgress() const
+    {
+        Progress progress;
+        progress.done = m_done.load();
+        progress.total = m_plan.size();
+        progress.found = m_found.load();
+        progress.finished = m_finished.load();
+        progress.cancelled = m_cancel.load();
+        return progress;
+    }
+
+    // 在 UI 线程调用：有新的暂存快照时关闭 store、替换频道库文件并重新映射
+    bool CommitSnapshot(ChannelStore& store)
+    {
+        std::lock_guard<std::mutex> lock(m_snapshotLock);
+        if (!m_snapshotReady) return false;
+        m_snapshotReady = false;
+        store.Close();
+        bool replaced = FileUtil::AtomicReplace(m_stagingPath, m_storePath);
+        store.Open(m_storePath);
+        return replaced;
+    }
+
+private:
+    struct Found {
+        uint32_t frequencyKhz;
+        TsScan::Service service;
+    };
+
+    std::unique_ptr<SignalSource> m_source;
+    std::vector<uint32_t> m_plan;
+    std::vector<ChannelInfo> m_existing;
+    std::vector<ChannelInfo> m_rescanned;   // 在本次重扫频点上的旧频道
+    std::string m_storePath;
+    std::string m_stagingPath;
+    unsigned m_threads;
+    int m_snapshotIntervalMs;
+    std::thread m_coordinator;
+
+    std::atomic<bool> m_cancel;
+    std::atomic<size_t> m_done;
+    std::atomic<size_t> m_found;
+    std::atomic<bool> m_finished;
+
+    std::mutex m_resultsLock;
+    std::condition_variable m_changed;
+    std::vector<Found> m_results;
+    std::vector<uint32_t> m_scanned;       // 已扫完的频点
+
+    std::mutex m_snapshotLock;
+    bool m_snapshotReady;
+
+    void Run()
+    {
+        {
+            WorkStealingPool pool(m_threads);
+            for (uint32_t frequency : m_plan) {
+                pool.Submit([this, frequency] { ScanFrequency(frequency); });
+            }
+
+            // 等待期间按固定间隔输出快照，搜台过程中频道列表即可使用
+            size_t written = 0;
+            size_t scanned = 0;
+            auto deadline = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(m_resultsLock);
+            while (m_done.load() < m_plan.size() && !m_cancel.load()) {
+                deadline += std::chrono::milliseconds(m_snapshotIntervalMs);
+                m_changed.wait_until(lock, deadline, [this] {
+                    return m_done.load() >= m_plan.size() || m_cancel.load();
+                });
+                if (m_done.load() < m_plan.size() && !m_cancel.load() &&
+                    (m_results.size() != written || m_scanned.size() != scanned)) {
+                    std::vector<Found> results = m_results;
+                    std::vector<uint32_t> frequencies = m_scanned;
+                    lock.unlock();
+                    WriteSnapshot(results, frequencies);
+                    written = results.size();
+                    scanned = frequencies.size();
+                    lock.lock();
+                }
+            }
+        }   // 取消时线程池析构会等正在扫描的频点返回
+
+        std::vector<Found> results;
+        std::vector<uint32_t> frequencies;
+        {
+            std::lock_guard<std::mutex> lock(m_resultsLock);
+            results = m_results;
+            frequencies = m_scanned;
+        }
+        WriteSnapshot(results, frequencies);
+        m_finished = true;
+    }
+
+    void ScanFrequency(uint32_t frequency)
+    {
+        if (m_cancel.load()) return;
+        std::vector<TsScan::Service> services;
+        m_source->Tune(frequency, services, m_cancel);
+        // 锁频中途取消的结果可能不全，整个频点按没扫处理（旧频道保留）
+        if (m_cancel.load()) return;
+        {
+            std::lock_guard<std::mutex> lock(m_resultsLock);
+            for (const auto& service : services) {
+                Found found = { frequency, service };
+                m_results.push_back(found);
+            }
+            m_scanned.push_back(frequency);
+        }
+        m_found += services.size();
+        ++m_done;
+        m_changed.notify_all();
+    }
+
+    std::vector<ChannelInfo> BuildLineup(std::vector<Found> results, std::vector<uint32_t> scanned) const
+    {
+        std::sort(results.begin(), results.end(), [](const Found& a, const Found& b) {
+            return a.frequencyKhz != b.frequencyKhz ? a.frequencyKhz < b.frequencyKhz
+                                                    : a.service.serviceId < b.service.serviceId;
+        });
+        std::sort(scanned.begin(), scanned.end());
+        std::vector<ChannelInfo> lineup = m_existing;
+        uint32_t next = 1;
+        for (const auto& channel : lineup) next = std::max(next, channel.number + 1);
+        for (const auto& channel : m_rescanned) next = std::max(next, channel.number + 1);
+        // 还没扫完的频点保留旧频道；扫完的频点上同名业务沿用旧频道号（每个旧频道只用一次）
+        std::vector<bool> reused(m_rescanned.size(), false);
+        for (size_t i = 0; i < m_rescanned.size(); ++i) {
+            if (!std::binary_search(scanned.begin(), scanned.end(), m_rescanned[i].frequencyKhz)) {
+                lineup.push_back(m_rescanned[i]);
+                reused[i] = true;
+            }
+        }
+        for (const auto& found : results) {
+            ChannelInfo channel;
+            channel.number = 0;
+            for (size_t i = 0; i < m_rescanned.size() && !channel.number; ++i) {
+                if (!reused[i] && m_rescanned[i].frequencyKhz == found.frequencyKhz &&
+                    m_rescanned[i].name == found.service.name) {
+                    channel.number = m_rescanned[i].number;
+                    reused[i] = true;
+                }
+            }
+            if (!channel.number) channel.number = next++;
+            channel.frequencyKhz = found.frequencyKhz;
+            channel.flags = static_cast<uint16_t>((found.service.serviceType == 0x02 ? kChannelRadio : 0) |
+                                                  (found.service.scrambled ? kChannelScrambled : 0));
+            channel.name = found.service.name;
+            lineup.push_back(channel);
+        }
+        return lineup;
+    }
+
+    void WriteSnapshot(const std::vector<Found>& results, const std::vector<uint32_t>& scanned)
+    {
+        {
+            // 先撤回尚未被 UI 取走的旧快照，写文件期间 UI 不会碰暂存文件
+            std::lock_guard<std::mutex> lock(m_snapshotLock);
+            m_snapshotReady = false;
+        }
+        if (ChannelStore::WriteTo(m_stagingPath, BuildLineup(results, scanned))) {
+            std::lock_guard<std::mutex> lock(m_snapshotLock);
+            m_snapshotReady = true;
+        }
+    }
+};
@@ -0,0 +1,302 @@
+// 频道库 - 按列存放的内存映射文件，打开时校验文件头和会被用作下标的列（名称偏移、名称索引）
+//
+// 文件格式（小端，各列 4 字节对齐）：
+//   头部 FileHeader
+//   numbers[count]        uint32  频道号，升序（按频道号二分查找）
+//   frequencies[count]    uint32  频点 kHz
+//   flags[count]          uint16  ChannelFlags
+//   nameOffsets[count+1]  uint32  名称在名称区中的起止位置
+//   names                 UTF-8 名称区（不含结尾 0）
+//   nameIndex[count]      uint32  按名称（ASCII 不区分大小写）排序的行号，用于前缀搜索
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+enum ChannelFlags : uint16_t {
+    kChannelRadio = 1 << 0,
+    kChannelScrambled = 1 << 1,
+    kChannelHidden = 1 << 2,
+    kChannelFavourite = 1 << 3,
+};
+
+struct ChannelInfo {
+    uint32_t number;
+    uint32_t frequencyKhz;
+    uint16_t flags;
+    std::string name;
+};
+
+class ChannelStore
+{
+public:
+    static const uint32_t kVersion = 1;
+    static const uint32_t kMaxNumber = 99999;   // 遥控器数字键最多输入 5 位
+
+    ChannelStore()
+        : m_count(0)
+        , m_numbers(nullptr)
+        , m_frequencies(nullptr)
+        , m_flags(nullptr)
+        , m_nameOffsets(nullptr)
+        , m_names(nullptr)
+        , m_nameIndex(nullptr)
+    {
+    }
+
+    // 写出频道库：先写临时文件再替换，正在映射旧文件的读者不受影响
+    static bool Write(const std::string& path, const std::vector<ChannelInfo>& channels)
+    {
+        std::string tempPath = path + ".tmp";
+        return WriteTo(tempPath, channels) && FileUtil::AtomicReplace(tempPath, path);
+    }
+
+    // 直接写到 path（调用方负责替换时机）
+    static bool WriteTo(const std::string& path, std::vector<ChannelInfo> channels)
+    {
+        std::stable_sort(channels.begin(), channels.end(), [](const ChannelInfo& a, const ChannelInfo& b) {
+            return a.number < b.number;
+        });
+        // 同一频道号只保留最后一个
+        std::vector<ChannelInfo> unique;
+        unique.reserve(channels.size());
+        for (auto& channel : channels) {
+            if (channel.number > kMaxNumber) continue;
+            if (!unique.empty() && unique.back().number == channel.number) {
+                unique.back() = std::move(channel);
+            } else {
+                unique.push_back(std::move(channel));
+            }
+        }
+
+        uint32_t count = static_cast<uint32_t>(unique.size());
+        std::vector<uint32_t> numbers(count), frequencies(count), nameOffsets(count + 1), nameIndex(count);
+        std::vector<uint16_t> flags(count);
+        std::string names;
+        for (uint32_t i = 0; i < count; ++i) {
+            numbers[i] = unique[i].number;
+            frequencies[i] = unique[i].frequencyKhz;
+            flags[i] = unique[i].flags;
+            nameOffsets[i] = static_cast<uint32_t>(names.size());
+            names += unique[i].name;
+            nameIndex[i] = i;
+        }
+        nameOffsets[count] = static_cast<uint32_t>(names.size());
+        std::sort(nameIndex.begin(), nameIndex.end(), [&](uint32_t a, uint32_t b) {
+            int c = CompareFolded(unique[a].name.data(), unique[a].name.size(),
+                                  unique[b].name.data(), unique[b].name.size());
+            return c < 0 || (c == 0 && a < b);
+        });
+
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "TVCH", 4);
+        header.version = kVersion;
+        header.count = count;
+        uint32_t offset = sizeof(FileHeader);
+        header.numbersOffset = offset;      offset += Align4(count * 4);
+        header.frequenciesOffset = offset;  offset += Align4(count * 4);
+        header.flagsOffset = offset;        offset += Align4(count * 2);
+        header.nameOffsetsOffset = offset;  offset += Align4((count + 1) * 4);
+        header.namesOffset = offset;        offset += Align4(static_cast<uint32_t>(names.size()));
+        header.nameIndexOffset = offset;    offset += Align4(count * 4);
+        header.fileSize = offset;
+
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && WriteColumn(file, numbers.data(), count * 4);
+        ok = ok && WriteColumn(file, frequencies.data(), count * 4);
+        ok = ok && WriteColumn(file, flags.data(), count * 2);
+        ok = ok && WriteColumn(file, nameOffsets.data(), (count + 1) * 4);
+        ok = ok && WriteColumn(file, names.data(), static_cast<uint32_t>(names.size()));
+        ok = ok && WriteColumn(file, nameIndex.data(), count * 4);
+        ok = FileUtil::SyncAndClose(file) && ok;
+        if (!ok) {
+            std::remove(path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // 映射频道库文件，只校验头部与各列边界，不解析内容
+    bool Open(const std::string& path)
+    {
+        Close();
+        if (!m_file.Open(path)) return false;
+        const uint8_t* base = m_file.Data();
+        size_t size = m_file.Size();
+        if (size < sizeof(FileHeader)) {
+            Close();
+            return false;
+        }
+        FileHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        uint64_t count = header.count;
+        if (std::memcmp(header.magic, "TVCH", 4) != 0 || header.version != kVersion ||
+            header.fileSize != size ||
+            !ColumnFits(header.numbersOffset, count * 4, size) ||
+            !ColumnFits(header.frequenciesOffset, count * 4, size) ||
+            !ColumnFits(header.flagsOffset, count * 2, size) ||
+            !ColumnFits(header.nameOffsetsOffset, (count + 1) * 4, size) ||
+            !ColumnFits(header.nameIndexOffset, count * 4, size) ||
+            header.namesOffset > size) {
+            Close();
+            return false;
+        }
+        m_count = header.count;
+        m_numbers = reinterpret_cast<const uint32_t*>(base + header.numbersOffset);
+        m_frequencies = reinterpret_cast<const uint32_t*>(base + header.frequenciesOffset);
+        m_flags = reinterpret_cast<const uint16_t*>(base + header.flagsOffset);
+        m_nameOffsets = reinterpret_cast<const uint32_t*>(base + header.nameOffsetsOffset);
+        m_names = reinterpret_cast<const char*>(base + header.namesOffset);
+        m_nameIndex = reinterpret_cast<const uint32_t*>(base + header.nameIndexOffset);
+        if (!ColumnsValid(size - header.namesOffset)) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        m_file.Close();
+        m_count = 0;
+        m_numbers = m_frequencies = m_nameOffsets = m_nameIndex = nullptr;
+        m_flags = nullptr;
+        m_names = nullptr;
+    }
+
+    bool IsOpen() const { return m_file.IsOpen(); }
+    size_t Count() const { return m_count; }
+
+    uint32_t Number(size_t row) const { return m_numbers[row]; }
+    uint32_t FrequencyKhz(size_t row) const { return m_frequencies[row]; }
+    uint16_t Flags(size_t row) const { return m_flags[row]; }
+
+    // 名称指向映射内存，不含结尾 0
+    const char* Name(size_t row, size_t& length) const
+    {
+        length = m_nameOffsets[row + 1] - m_nameOffsets[row];
+        return m_names + m_nameOffsets[row];
+    }
+
+    std::string Name(size_t row) const
+    {
+        size_t length;
+        const char* name = Name(row, length);
+        return std::string(name, length);
+    }
+
+    // 按频道号二分查找，返回行号，找不到返回 -1
+    long FindByNumber(uint32_t number) const
+    {
+        const uint32_t* end = m_numbers + m_count;
+        const uint32_t* it = std::lower_bound(m_numbers, end, number);
+        return (it != end && *it == number) ? static_cast<long>(it - m_numbers) : -1;
+    }
+
+    // 数字键输入：是否存在以 typed 开头且更长的频道号（决定是否还要等下一位）
+    bool HasLongerNumber(uint32_t typed) const
+    {
+        uint64_t low = typed, high = typed;
+        for (int digits = 1; digits < 5; ++digits) {
+            low = low * 10;
+            high = high * 10 + 9;
+            if (low > kMaxNumber) break;
+            if (low == 0) continue;   // 前导 0 不构成更长的频道号
+            const uint32_t* end = m_numbers + m_count;
+            const uint32_t* it = std::lower_bound(m_numbers, end, static_cast<uint32_t>(low));
+            if (it != end && *it <= high) return true;
+        }
+        return false;
+    }
+
+    // 名称前缀搜索（ASCII 不区分大小写），按名称顺序输出最多 limit 个行号
+    void FindByNamePrefix(const std::string& prefix, std::vector<size_t>& rows, size_t limit) const
+    {
+        rows.clear();
+        const uint32_t* end = m_nameIndex + m_count;
+        const uint32_t* it = std::lower_bound(m_nameIndex, end, prefix, [this](uint32_t row, const std::string& key) {
+            size_t length;
+            const char* name = Name(row, length);
+            return CompareFolded(name, length, key.data(), key.size()) < 0;
+        });
+        for (; it != end && rows.size() < limit; ++it) {
+            size_t length;
+            const char* name = Name(*it, length);
+            if (length < prefix.size() || CompareFolded(name, prefix.size(), prefix.data(), prefix.size()) != 0)
+                break;
+            rows.push_back(*it);
+        }
+    }
+
+private:
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t count;
+        uint32_t numbersOffset;
+        uint32_t frequenciesOffset;
+        uint32_t flagsOffset;
+        uint32_t nameOffsetsOffset;
+        uint32_t namesOffset;
+        uint32_t nameIndexOffset;
+        uint32_t fileSize;
+    };
+
+    MappedFile m_file;
+    size_t m_count;
+    const uint32_t* m_numbers;
+    const uint32_t* m_frequencies;
+    const uint16_t* m_flags;
+    const uint32_t* m_nameOffsets;
+    const char* m_names;
+    const uint32_t* m_nameIndex;
+
+    static uint32_t Align4(uint32_t size) { return (size + 3) & ~3u; }
+
+    // 名称偏移单调且不超出名称区、名称索引都是有效行号、频道号升序，
+    // 否则损坏的文件会让 Name/前缀搜索越界读
+    bool ColumnsValid(size_t namesSize) const
+    {
+        if (m_nameOffsets[0] != 0) return false;
+        for (size_t row = 0; row < m_count; ++row) {
+            if (m_nameOffsets[row + 1] < m_nameOffsets[row]) return false;
+            if (m_nameIndex[row] >= m_count) return false;
+            if (row > 0 && m_numbers[row] <= m_numbers[row - 1]) return false;
+        }
+        return m_nameOffsets[m_count] <= namesSize;
+    }
+
+    static bool ColumnFits(uint32_t offset, uint64_t bytes, size_t size)
+    {
+        return offset % 4 == 0 && offset <= size && bytes <= size - offset;
+    }
+
+    static bool WriteColumn(FILE* file, const void* data, uint32_t bytes)
+    {
+        static const char kPadding[4] = {0, 0, 0, 0};
+        if (bytes && std::fwrite(data, 1, bytes, file) != bytes) return false;
+        uint32_t pad = Align4(bytes) - bytes;
+        return pad == 0 || std::fwrite(kPadding, 1, pad, file) == pad;
+    }
+
+    static int CompareFolded(const char* a, size_t aLength, const char* b, size_t bLength)
+    {
+        size_t n = aLength < bLength ? aLength : bLength;
+        for (size_t i = 0; i < n; ++i) {
+            unsigned char ca = static_cast<unsigned char>(a[i]);
+            unsigned char cb = static_cast<unsigned char>(b[i]);
+            if (ca >= 'A' && ca <= 'Z') ca = static_cast<unsigned char>(ca + 32);
+            if (cb >= 'A' && cb <= 'Z') cb = static_cast<unsigned char>(cb + 32);
+            if (ca != cb) return ca < cb ? -1 : 1;
+        }
+        return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+    }
+};
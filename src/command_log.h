@@ -0,0 +1,192 @@
+// 遥控器命令录制文件 - 只追加的紧凑二进制日志
+//
+// 文件格式：
+//   头部 8 字节: "TVCL" + 版本(1 字节) + 保留(3 字节)
+//   记录: varint(距上一条的微秒数) + 按键编号(1 字节)
+//         按键编号为 0xFF 时后跟 varint(长度) + 原始命令字节
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace CommandLog {
+    const char kMagic[4] = {'T', 'V', 'C', 'L'};
+    const uint8_t kVersion = 1;
+    const uint8_t kRawKey = 0xFF;
+
+    // 常用按键编号，未知命令按原始字符串保存
+    const char* const kKeys[] = {
+        "KEY_MENU", "KEY_UP", "KEY_DOWN", "KEY_LEFT",
+        "KEY_RIGHT", "KEY_OK", "KEY_RETURN", "KEY_BACK"
+    };
+    const size_t kKeyCount = sizeof(kKeys) / sizeof(kKeys[0]);
+
+    inline uint64_t NowMicros()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    struct Record {
+        uint64_t time;     // 距录制开始的微秒数
+        std::string key;
+    };
+}
+
+class CommandLogWriter
+{
+public:
+    CommandLogWriter() : m_file(nullptr), m_lastTime(0), m_count(0) {}
+    ~CommandLogWriter() { Close(); }
+
+    bool Open(const std::string& path)
+    {
+        Close();
+        m_file = std::fopen(path.c_str(), "wb");
+        if (!m_file) return false;
+        uint8_t header[8] = {0};
+        std::memcpy(header, CommandLog::kMagic, 4);
+        header[4] = CommandLog::kVersion;
+        std::fwrite(header, 1, sizeof(header), m_file);
+        m_lastTime = CommandLog::NowMicros();
+        m_count = 0;
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+    bool IsOpen() const { return m_file != nullptr; }
+    uint64_t GetCount() const { return m_count; }
+
+    // 以当前时间记录一条命令
+    void Append(const std::string& key)
+    {
+        Append(key, CommandLog::NowMicros());
+    }
+
+    void Append(const std::string& key, uint64_t nowMicros)
+    {
+        if (!m_file) return;
+        uint8_t record[32];
+        size_t len = PutVarint(record, nowMicros > m_lastTime ? nowMicros - m_lastTime : 0);
+        m_lastTime = nowMicros;
+
+        uint8_t index = CommandLog::kRawKey;
+        for (size_t i = 0; i < CommandLog::kKeyCount; ++i) {
+            if (key == CommandLog::kKeys[i]) {
+                index = static_cast<uint8_t>(i);
+                break;
+            }
+        }
+        record[len++] = index;
+        if (index == CommandLog::kRawKey) {
+            len += PutVarint(record + len, key.size());
+            std::fwrite(record, 1, len, m_file);
+            std::fwrite(key.data(), 1, key.size(), m_file);
+        } else {
+            std::fwrite(record, 1, len, m_file);
+        }
+        ++m_count;
+    }
+
+    // 每批命令处理完调用一次，崩溃时最多丢失最后一批
+    void Flush()
+    {
+        if (m_file) std::fflush(m_file);
+    }
+
+private:
+    FILE* m_file;
+    uint64_t m_lastTime;
+    uint64_t m_count;
+
+    static size_t PutVarint(uint8_t* out, uint64_t value)
+    {
+        size_t len = 0;
+        while (value >= 0x80) {
+            out[len++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        out[len++] = static_cast<uint8_t>(value);
+        return len;
+    }
+};
+
+class CommandLogReader
+{
+public:
+    CommandLogReader() : m_file(nullptr), m_time(0) {}
+    ~CommandLogReader() { Close(); }
+
+    bool Open(const std::string& path)
+    {
+        Close();
+        m_file = std::fopen(path.c_str(), "rb");
+        if (!m_file) return false;
+        uint8_t header[8];
+        if (std::fread(header, 1, sizeof(header), m_file) != sizeof(header) ||
+            std::memcmp(header, CommandLog::kMagic, 4) != 0 ||
+            header[4] != CommandLog::kVersion) {
+            Close();
+            return false;
+        }
+        m_time = 0;
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_file) {
+            std::fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+    // 读取下一条记录，文件结束或数据截断时返回 false
+    bool Next(CommandLog::Record& record)
+    {
+        if (!m_file) return false;
+        uint64_t delta, size;
+        if (!GetVarint(delta)) return false;
+        int index = std::fgetc(m_file);
+        if (index == EOF) return false;
+
+        m_time += delta;
+        record.time = m_time;
+        if (index == CommandLog::kRawKey) {
+            if (!GetVarint(size) || size > 4096) return false;
+            record.key.resize(static_cast<size_t>(size));
+            if (size > 0 && std::fread(&record.key[0], 1, static_cast<size_t>(size), m_file) != size) return false;
+        } else if (static_cast<size_t>(index) < CommandLog::kKeyCount) {
+            record.key = CommandLog::kKeys[index];
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+private:
+    FILE* m_file;
+    uint64_t m_time;
+
+    bool GetVarint(uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int c = std::fgetc(m_file);
+            if (c == EOF) return false;
+            value |= static_cast<uint64_t>(c & 0x7F) << shift;
+            if (!(c & 0x80)) return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,457 @@
+// 电子节目指南 - 流式解析 EIT 段，按业务存放按时间排序的节目数组并提供时间查询
+//
+// EitParser 从 TS 包流（PID 0x12）拼装 EIT 段；(original_network_id, transport_stream_id, 业务,
+// table_id, 段号) 的版本没变时整段跳过，循环播发的节目表不会重复入库。EpgStore 为每个业务保存一组按开始时间排序、互不重叠的列
+// （开始、结束、event_id、标题），并按小时分桶建区间索引：桶 b 记录第一个结束时间晚于桶起点
+// 的节目，"正在播出"只需定位桶再在桶内二分。新数据按业务合并，与新节目重叠的旧节目被替换。
+//
+// EpgStore 按 service_id 分业务，适用于一个网络内的节目表。目前只有 bench epg 使用，还没有接入菜单：
+// 频道库的行不记录 service_id，接入前需要先让搜台把它写进频道库。
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ts_section.h"
+
+namespace Epg {
+    const uint16_t kEitPid = 0x0012;
+    const uint8_t kFirstTableId = 0x4E;   // 本流 present/following
+    const uint8_t kLastTableId = 0x6F;    // 他流 schedule
+    const uint8_t kShortEventDescriptor = 0x4D;
+    const size_t kEventHeaderSize = 12;
+    const size_t kSectionHeaderSize = 14;
+
+    struct Event {
+        uint16_t originalNetworkId;
+        uint16_t transportStreamId;
+        uint16_t serviceId;
+        uint16_t eventId;
+        uint32_t start;       // UTC 秒（Unix 时间）
+        uint32_t duration;    // 秒
+        std::string title;
+    };
+
+    inline int FromBcd(uint8_t value) { return (value >> 4) * 10 + (value & 0x0F); }
+    inline uint8_t ToBcd(int value) { return static_cast<uint8_t>(((value / 10) << 4) | (value % 10)); }
+
+    // start_time：16 位 MJD + BCD 时分秒；全 1 表示未定义，返回 0
+    inline uint32_t DecodeTime(const uint8_t* p)
+    {
+        uint32_t mjd = static_cast<uint32_t>((p[0] << 8) | p[1]);
+        if (mjd == 0xFFFF || mjd < 40587) return 0;
+        return (mjd - 40587) * 86400u + FromBcd(p[2]) * 3600u + FromBcd(p[3]) * 60u + FromBcd(p[4]);
+    }
+
+    inline void EncodeTime(uint32_t time, uint8_t* p)
+    {
+        uint32_t mjd = time / 86400 + 40587;
+        uint32_t seconds = time % 86400;
+        p[0] = static_cast<uint8_t>(mjd >> 8);
+        p[1] = static_cast<uint8_t>(mjd);
+        p[2] = ToBcd(static_cast<int>(seconds / 3600));
+        p[3] = ToBcd(static_cast<int>(seconds / 60 % 60));
+        p[4] = ToBcd(static_cast<int>(seconds % 60));
+    }
+
+    inline uint32_t DecodeDuration(const uint8_t* p)
+    {
+        return FromBcd(p[0]) * 3600u + FromBcd(p[1]) * 60u + FromBcd(p[2]);
+    }
+
+    inline void EncodeDuration(uint32_t seconds, uint8_t* p)
+    {
+        p[0] = ToBcd(static_cast<int>(seconds / 3600 % 100));
+        p[1] = ToBcd(static_cast<int>(seconds / 60 % 60));
+        p[2] = ToBcd(static_cast<int>(seconds % 60));
+    }
+
+    // 从 TS 包流中解析 EIT；Feed 可分块调用，解析出的节目由 TakeEvents 取走
+    class EitParser
+    {
+    public:
+        EitParser()
+            : m_sections(0)
+            , m_skipped(0)
+        {
+        }
+
+        // 喂入整数个 TS 包
+        void Feed(const uint8_t* data, size_t size)
+        {
+            auto onSection = [this](const uint8_t* section, size_t length) { OnSection(section, length); };
+            for (size_t offset = 0; offset + TsScan::kPacketSize <= size; offset += TsScan::kPacketSize) {
+                uint16_t pid;
+                bool unitStart;
+                const uint8_t* payload;
+                size_t payloadSize;
+                if (!TsScan::PacketPayload(data + offset, pid, unitStart, payload, payloadSize) || pid != kEitPid)
+                    continue;
+                m_assembler.Push(unitStart, payload, payloadSize, onSection);
+            }
+        }
+
+        // 把已解析的节目追加到 events 末尾
+        void TakeEvents(std::vector<Event>& events)
+        {
+            if (events.empty()) {
+                events.swap(m_events);
+            } else {
+                std::move(m_events.begin(), m_events.end(), std::back_inserter(events));
+            }
+            m_events.clear();
+        }
+
+        size_t PendingCount() const { return m_events.size(); }
+        size_t SectionCount() const { return m_sections; }   // 解析过的段
+        size_t SkippedCount() const { return m_skipped; }    // 版本未变而跳过的段
+
+    private:
+        TsScan::SectionAssembler m_assembler;
+        // (original_network_id, transport_stream_id, service_id, table_id, 段号) -> version；
+        // 他流表（0x4F、0x60-0x6F）中不同 TS 的业务可能 service_id 相同，必须带上前两项区分
+        std::unordered_map<uint64_t, uint8_t> m_versions;
+        std::vector<Event> m_events;
+        size_t m_sections;
+        size_t m_skipped;
+
+        void OnSection(const uint8_t* data, size_t length)
+        {
+            uint8_t tableId = data[0];
+            if (tableId < kFirstTableId || tableId > kLastTableId || length < kSectionHeaderSize + 4) return;
+            if (!(data[5] & 0x01)) return;   // current_next_indicator = 0：尚未生效
+            uint16_t serviceId = static_cast<uint16_t>((data[3] << 8) | data[4]);
+            uint16_t transportStreamId = static_cast<uint16_t>((data[8] << 8) | data[9]);
+            uint16_t originalNetworkId = static_cast<uint16_t>((data[10] << 8) | data[11]);
+            uint8_t version = static_cast<uint8_t>((data[5] >> 1) & 0x1F);
+            uint64_t key = (static_cast<uint64_t>(originalNetworkId) << 48) | (static_cast<uint64_t>(transportStreamId) << 32) |
+                           (static_cast<uint64_t>(serviceId) << 16) | (static_cast<uint64_t>(tableId) << 8) | data[6];
+            auto it = m_versions.find(key);
+            if (it != m_versions.end() && it->second == version) {
+                ++m_skipped;
+                return;
+            }
+            m_versions[key] = version;
+            ++m_sections;
+
+            size_t end = length - 4;
+            size_t i = kSectionHeaderSize;
+            while (i + kEventHeaderSize <= end) {
+                Event event;
+                event.originalNetworkId = originalNetworkId;
+                event.transportStreamId = transportStreamId;
+                event.serviceId = serviceId;
+                event.eventId = static_cast<uint16_t>((data[i] << 8) | data[i + 1]);
+                event.start = DecodeTime(data + i + 2);
+                event.duration = DecodeDuration(data + i + 7);
+                size_t loopEnd = i + kEventHeaderSize + (((data[i + 10] & 0x0F) << 8) | data[i + 11]);
+                if (loopEnd > end) break;
+                for (size_t d = i + kEventHeaderSize; d + 2 <= loopEnd; d += 2 + data[d + 1]) {
+                    size_t descriptorEnd = d + 2 + data[d + 1];
+                    if (descriptorEnd > loopEnd) break;
+                    // 短节目描述符：3 字节语言码 + 节目名 + 简介，只取节目名
+                    if (data[d] != kShortEventDescriptor || data[d + 1] < 5) continue;
+                    size_t nameLength = data[d + 5];
+                    if (d + 6 + nameLength > descriptorEnd) continue;
+                    const char* name = reinterpret_cast<const char*>(data + d + 6);
+                    // 跳过 DVB 字符集选择字节（0x10 后跟 2 字节，其余 1 字节）
+                    size_t skip = 0;
+                    if (nameLength > 0 && data[d + 6] < 0x20) skip = data[d + 6] == 0x10 ? 3 : 1;
+                    if (skip <= nameLength) event.title.assign(name + skip, nameLength - skip);
+                }
+                if (event.start != 0 && event.duration != 0) m_events.push_back(std::move(event));
+                i = loopEnd;
+            }
+        }
+    };
+}
+
+class EpgStore
+{
+public:
+    static const uint32_t kBucketSeconds = 3600;
+    static const size_t kMaxBuckets = 24 * 62;   // 时间跨度异常大时不建桶，只用二分查找
+
+    // 查询结果；title 指向库内存储，在下一次 Apply / DropBefore 之前有效
+    struct Entry {
+        uint16_t eventId;
+        uint32_t start;
+        uint32_t end;
+        const char* title;
+        size_t titleLength;
+    };
+
+    struct NowNext {
+        uint16_t serviceId;
+        bool hasNow;
+        bool hasNext;
+        Entry now;
+        Entry next;
+    };
+
+    EpgStore()
+        : m_eventCount(0)
+    {
+    }
+
+    // 合并一批节目（可混有多个业务），返回受影响的业务数
+    size_t Apply(std::vector<Epg::Event> events)
+    {
+        std::stable_sort(events.begin(), events.end(), [](const Epg::Event& a, const Epg::Event& b) {
+            return a.serviceId != b.serviceId ? a.serviceId < b.serviceId : a.start < b.start;
+        });
+        size_t touched = 0;
+        for (size_t first = 0; first < events.size();) {
+            size_t last = first;
+            while (last < events.size() && events[last].serviceId == events[first].serviceId) ++last;
+            Merge(ServiceFor(events[first].serviceId), events, first, last);
+            ++touched;
+            first = last;
+        }
+        return touched;
+    }
+
+    // 流式读取 EIT 转储文件（TS 格式），每攒够 batchEvents 个节目合并一次
+    bool IngestFile(const std::string& path, Epg::EitParser& parser, size_t batchEvents = 16384)
+    {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        std::vector<Epg::Event> batch;
+        TsScan::ReadPackets(file, [&](const uint8_t* data, size_t size) {
+            parser.Feed(data, size);
+            if (parser.PendingCount() >= batchEvents) {
+                batch.clear();
+                parser.TakeEvents(batch);
+                Apply(std::move(batch));
+            }
+            return true;
+        });
+        std::fclose(file);
+        batch.clear();
+        parser.TakeEvents(batch);
+        Apply(std::move(batch));
+        return true;
+    }
+
+    size_t ServiceCount() const { return m_services.size(); }
+    size_t EventCount() const { return m_eventCount; }
+    uint16_t ServiceId(size_t service) const { return m_services[service].serviceId; }
+    size_t ServiceEventCount(size_t service) const { return m_services[service].starts.size(); }
+
+    // 按 service_id 查业务序号，找不到返回 -1
+    long FindService(uint16_t serviceId) const
+    {
+        auto it = LowerBound(serviceId);
+        return (it != m_services.end() && it->serviceId == serviceId) ? static_cast<long>(it - m_services.begin()) : -1;
+    }
+
+    // time 时刻正在播出的节目
+    bool EventAt(size_t service, uint32_t time, Entry& entry) const
+    {
+        const ServiceEvents& events = m_services[service];
+        size_t i = FirstEndingAfter(events, time);
+        if (i >= events.starts.size() || events.starts[i] > time) return false;
+        entry = MakeEntry(events, i);
+        return true;
+    }
+
+    // 所有业务的当前与下一个节目，按 service_id 顺序；rows 可复用以免重复分配
+    void QueryNowNext(uint32_t time, std::vector<NowNext>& rows) const
+    {
+        rows.resize(m_services.size());
+        for (size_t s = 0; s < m_services.size(); ++s) {
+            const ServiceEvents& events = m_services[s];
+            NowNext& row = rows[s];
+            row.serviceId = events.serviceId;
+            size_t i = FirstEndingAfter(events, time);
+            row.hasNow = i < events.starts.size() && events.starts[i] <= time;
+            if (row.hasNow) row.now = MakeEntry(events, i++);
+            row.hasNext = i < events.starts.size();
+            if (row.hasNext) row.next = MakeEntry(events, i);
+        }
+    }
+
+    // 节目表网格：从第 firstService 个业务起最多 serviceCount 个业务在 [from, to) 内的节目。
+    // 第 k 行为 entries[rowStarts[k], rowStarts[k + 1])
+    void QueryGrid(uint32_t from, uint32_t to, size_t firstService, size_t serviceCount,
+                   std::vector<Entry>& entries, std::vector<size_t>& rowStarts) const
+    {
+        entries.clear();
+        rowStarts.clear();
+        size_t last = std::min(m_services.size(), firstService + serviceCount);
+        for (size_t s = firstService; s < last; ++s) {
+            const ServiceEvents& events = m_services[s];
+            rowStarts.push_back(entries.size());
+            for (size_t i = FirstEndingAfter(events, from); i < events.starts.size() && events.starts[i] < to; ++i) {
+                entries.push_back(MakeEntry(events, i));
+            }
+        }
+        rowStarts.push_back(entries.size());
+    }
+
+    // 丢弃 time 之前已经结束的节目
+    void DropBefore(uint32_t time)
+    {
+        for (auto& events : m_services) {
+            size_t n = FirstEndingAfter(events, time);
+            if (n == 0) continue;
+            uint32_t titleBytes = events.titleOffsets[n];
+            events.starts.erase(events.starts.begin(), events.starts.begin() + n);
+            events.ends.erase(events.ends.begin(), events.ends.begin() + n);
+            events.eventIds.erase(events.eventIds.begin(), events.eventIds.begin() + n);
+            events.titleOffsets.erase(events.titleOffsets.begin(), events.titleOffsets.begin() + n);
+            for (auto& offset : events.titleOffsets) offset -= titleBytes;
+            events.titles.erase(0, titleBytes);
+            m_eventCount -= n;
+            BuildIndex(events);
+        }
+    }
+
+private:
+    // 一个业务的节目：按开始时间排序且互不重叠，因此结束时间也有序
+    struct ServiceEvents {
+        uint16_t serviceId;
+        std::vector<uint32_t> starts;
+        std::vector<uint32_t> ends;
+        std::vector<uint16_t> eventIds;
+        std::vector<uint32_t> titleOffsets;   // size() + 1 项
+        std::string titles;
+        uint32_t indexBase;                   // 第 0 个桶的起点
+        std::vector<uint32_t> buckets;        // 桶 b：第一个 end > indexBase + b * kBucketSeconds 的节目
+    };
+
+    std::vector<ServiceEvents> m_services;    // 按 service_id 升序
+    size_t m_eventCount;
+
+    std::vector<ServiceEvents>::const_iterator LowerBound(uint16_t serviceId) const
+    {
+        return std::lower_bound(m_services.begin(), m_services.end(), serviceId,
+                                [](const ServiceEvents& events, uint16_t id) { return events.serviceId < id; });
+    }
+
+    ServiceEvents& ServiceFor(uint16_t serviceId)
+    {
+        size_t index = static_cast<size_t>(LowerBound(serviceId) - m_services.begin());
+        if (index == m_services.size() || m_services[index].serviceId != serviceId) {
+            ServiceEvents events;
+            events.serviceId = serviceId;
+            events.titleOffsets.push_back(0);
+            events.indexBase = 0;
+            m_services.insert(m_services.begin() + index, std::move(events));
+        }
+        return m_services[index];
+    }
+
+    static Entry MakeEntry(const ServiceEvents& events, size_t i)
+    {
+        Entry entry;
+        entry.eventId = events.eventIds[i];
+        entry.start = events.starts[i];
+        entry.end = events.ends[i];
+        entry.title = events.titles.data() + events.titleOffsets[i];
+        entry.titleLength = events.titleOffsets[i + 1] - events.titleOffsets[i];
+        return entry;
+    }
+
+    // 第一个结束时间晚于 time 的节目；先用桶缩小范围再二分
+    static size_t FirstEndingAfter(const ServiceEvents& events, uint32_t time)
+    {
+        size_t low = 0, high = events.ends.size();
+        if (!events.buckets.empty() && time >= events.indexBase) {
+            size_t bucket = (time - events.indexBase) / kBucketSeconds;
+            if (bucket >= events.buckets.size()) return high;
+            low = events.buckets[bucket];
+            if (bucket + 1 < events.buckets.size()) high = std::min(high, static_cast<size_t>(events.buckets[bucket + 1]) + 1);
+        }
+        return static_cast<size_t>(std::upper_bound(events.ends.begin() + low, events.ends.begin() + high, time) -
+                                   events.ends.begin());
+    }
+
+    static void BuildIndex(ServiceEvents& events)
+    {
+        events.buckets.clear();
+        if (events.starts.empty()) return;
+        events.indexBase = events.starts.front() / kBucketSeconds * kBucketSeconds;
+        size_t count = (events.ends.back() - events.indexBase) / kBucketSeconds + 1;
+        if (count > kMaxBuckets) return;
+        events.buckets.resize(count);
+        size_t i = 0;
+        for (size_t b = 0; b < count; ++b) {
+            uint32_t bucketStart = events.indexBase + static_cast<uint32_t>(b) * kBucketSeconds;
+            while (i < events.ends.size() && events.ends[i] <= bucketStart) ++i;
+            events.buckets[b] = static_cast<uint32_t>(i);
+        }
+    }
+
+    static void Append(ServiceEvents& events, uint32_t start, uint32_t end, uint16_t eventId,
+                       const char* title, size_t titleLength)
+    {
+        events.starts.push_back(start);
+        events.ends.push_back(end);
+        events.eventIds.push_back(eventId);
+        events.titles.append(title, titleLength);
+        events.titleOffsets.push_back(static_cast<uint32_t>(events.titles.size()));
+    }
+
+    static uint32_t EndOf(const Epg::Event& event)
+    {
+        uint64_t end = static_cast<uint64_t>(event.start) + event.duration;
+        return end > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(end);
+    }
+
+    // events[first, last) 属于同一业务且已按开始时间排序
+    void Merge(ServiceEvents& current, const std::vector<Epg::Event>& events, size_t first, size_t last)
+    {
+        // 新数据内部先去重叠：与前一个重叠时以后来者为准
+        std::vector<const Epg::Event*> incoming;
+        incoming.reserve(last - first);
+        for (size_t k = first; k < last; ++k) {
+            while (!incoming.empty() && EndOf(*incoming.back()) > events[k].start) incoming.pop_back();
+            incoming.push_back(&events[k]);
+        }
+
+        size_t oldCount = current.starts.size();
+        if (oldCount == 0 || incoming.front()->start >= current.ends.back()) {
+            // 常见情况：新节目都在已有节目之后，直接追加
+            for (const Epg::Event* event : incoming) {
+                Append(current, event->start, EndOf(*event), event->eventId, event->title.data(), event->title.size());
+            }
+            m_eventCount += incoming.size();
+            BuildIndex(current);
+            return;
+        }
+
+        // 两路归并：旧节目与任何新节目重叠则丢弃
+        ServiceEvents merged;
+        merged.serviceId = current.serviceId;
+        merged.indexBase = 0;
+        merged.titleOffsets.push_back(0);
+        merged.starts.reserve(oldCount + incoming.size());
+        merged.ends.reserve(oldCount + incoming.size());
+        merged.eventIds.reserve(oldCount + incoming.size());
+        merged.titleOffsets.reserve(oldCount + incoming.size() + 1);
+        size_t overlap = 0, emit = 0;
+        for (size_t i = 0; i < oldCount; ++i) {
+            uint32_t start = current.starts[i], end = current.ends[i];
+            while (overlap < incoming.size() && EndOf(*incoming[overlap]) <= start) ++overlap;
+            if (overlap < incoming.size() && incoming[overlap]->start < end) continue;
+            for (; emit < incoming.size() && incoming[emit]->start < start; ++emit) {
+                const Epg::Event* event = incoming[emit];
+                Append(merged, event->start, EndOf(*event), event->eventId, event->title.data(), event->title.size());
+            }
+            Append(merged, start, end, current.eventIds[i], current.titles.data() + current.titleOffsets[i],
+                   current.titleOffsets[i + 1] - current.titleOffsets[i]);
+        }
+        for (; emit < incoming.size(); ++emit) {
+            const Epg::Event* event = incoming[emit];
+            Append(merged, event->start, EndOf(*event), event->eventId, event->title.data(), event->title.size());
+        }
+        m_eventCount = m_eventCount - oldCount + merged.starts.size();
+        current = std::move(merged);
+        BuildIndex(current);
+    }
+};
@@ -0,0 +1,404 @@
+// 帧分析 - 动态图像模式的自适应对比度
+//
+// 播放线程把缩放后的帧按 step 抽样复制一份交给分析线程（分析线程忙时直接跳过，不等待），
+// 分析线程计算亮度直方图，推出一条限制对比度的均衡曲线，再与上一条曲线做指数平滑，防止画面闪烁；
+// 场景切换（直方图变化很大）时平滑系数加大，几帧内跟上新画面。曲线以 256 项查找表发布，
+// 图像处理链把它与预设的色调表合成（Picture::ApplyToneCurve）。
+//
+// 亮度按 BT.709 的 8 位整数权重计算：Y = (54 R + 183 G + 19 B + 128) >> 8。
+// 直方图按行分段由线程池统计，每段一份子直方图，最后合并；段内再按像素位置分 4 份子直方图，
+// 避免相邻像素落在同一格时的写后读依赖。标量、SSE2、AVX2 内核的结果完全一致。
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "work_pool.h"
+#include "yuv_convert.h"
+
+namespace Analysis {
+    const int kLumaR = 54;
+    const int kLumaG = 183;
+    const int kLumaB = 19;
+
+    // 一帧统计量：256 格亮度计数
+    typedef uint32_t Histogram[256];
+
+    // 按 step 抽取行和列，复制成紧密排列的 32 位像素
+    inline void Subsample(const uint8_t* pixels, ptrdiff_t stride, int width, int height, int step,
+                          std::vector<uint32_t>& out)
+    {
+        if (width <= 0 || height <= 0 || step <= 0) {
+            out.clear();
+            return;
+        }
+        int columns = (width + step - 1) / step;
+        out.resize(static_cast<size_t>(columns) * ((height + step - 1) / step));
+        uint32_t* dst = out.data();
+        for (int y = 0; y < height; y += step) {
+            const uint8_t* row = pixels + y * stride;
+            for (int x = 0; x < columns; ++x) std::memcpy(dst + x, row + static_cast<size_t>(x) * step * 4, 4);
+            dst += columns;
+        }
+    }
+
+    // 内存中 4 个字节对应的亮度权重（Alpha 为 0）
+    inline void LumaWeights(Yuv::PixelOrder order, int16_t weights[4])
+    {
+        weights[0] = static_cast<int16_t>(order == Yuv::PixelOrder::Bgra ? kLumaB : kLumaR);
+        weights[1] = static_cast<int16_t>(kLumaG);
+        weights[2] = static_cast<int16_t>(order == Yuv::PixelOrder::Bgra ? kLumaR : kLumaB);
+        weights[3] = 0;
+    }
+
+    // 把 [begin, count) 个像素计入 4 份子直方图，第 i 个像素计入 sub[i & 3]
+    inline void CountScalar(const uint32_t* pixels, size_t begin, size_t count, Yuv::PixelOrder order,
+                            uint32_t (*sub)[256])
+    {
+        int16_t weights[4];
+        LumaWeights(order, weights);
+        for (size_t i = begin; i < count; ++i) {
+            uint32_t pixel = pixels[i];
+            int luma = (static_cast<int>(pixel & 0xFF) * weights[0] + static_cast<int>((pixel >> 8) & 0xFF) * weights[1] +
+                        static_cast<int>((pixel >> 16) & 0xFF) * weights[2] + 128) >> 8;
+            ++sub[i & 3][luma];
+        }
+    }
+
+#if YUV_HAVE_X86
+    // 每次 4 个像素：madd 得到每像素两个部分和，整理成 [a0 a1 a2 a3] + [b0 b1 b2 b3] 相加
+    __attribute__((target("sse2")))
+    inline size_t CountSse2(const uint32_t* pixels, size_t count, Yuv::PixelOrder order, uint32_t (*sub)[256])
+    {
+        int16_t w[4];
+        LumaWeights(order, w);
+        const __m128i weights = _mm_set_epi16(w[3], w[2], w[1], w[0], w[3], w[2], w[1], w[0]);
+        const __m128i round = _mm_set1_epi32(128);
+        const __m128i zero = _mm_setzero_si128();
+        // 亮度压成 16 位再存：与 uint32_t 的直方图不会别名，编译器不必每次加一后重新读取
+        alignas(16) uint16_t luma[8];
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+            __m128i low = _mm_shuffle_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights), _MM_SHUFFLE(3, 1, 2, 0));
+            __m128i high = _mm_shuffle_epi32(_mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights), _MM_SHUFFLE(3, 1, 2, 0));
+            __m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+            __m128i values = _mm_srli_epi32(_mm_add_epi32(sum, round), 8);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(luma), _mm_packs_epi32(values, values));
+            ++sub[0][luma[0]];
+            ++sub[1][luma[1]];
+            ++sub[2][luma[2]];
+            ++sub[3][luma[3]];
+        }
+        return i;
+    }
+#endif
+
+#if YUV_HAVE_AVX2
+    // 与 SSE2 相同，一次 8 个像素；各步都在 128 位通道内，结果顺序不变
+    __attribute__((target("avx2")))
+    inline size_t CountAvx2(const uint32_t* pixels, size_t count, Yuv::PixelOrder order, uint32_t (*sub)[256])
+    {
+        int16_t w[4];
+        LumaWeights(order, w);
+        const __m256i weights = _mm256_set1_epi64x(static_cast<int64_t>(
+            static_cast<uint64_t>(static_cast<uint16_t>(w[0])) | static_cast<uint64_t>(static_cast<uint16_t>(w[1])) << 16 |
+            static_cast<uint64_t>(static_cast<uint16_t>(w[2])) << 32));
+        const __m256i round = _mm256_set1_epi32(128);
+        const __m256i zero = _mm256_setzero_si256();
+        alignas(16) uint16_t luma[8];
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+            __m256i low = _mm256_shuffle_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi8(v, zero), weights),
+                                               _MM_SHUFFLE(3, 1, 2, 0));
+            __m256i high = _mm256_shuffle_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi8(v, zero), weights),
+                                                _MM_SHUFFLE(3, 1, 2, 0));
+            __m256i sum = _mm256_add_epi32(_mm256_unpacklo_epi64(low, high), _mm256_unpackhi_epi64(low, high));
+            __m256i values = _mm256_srli_epi32(_mm256_add_epi32(sum, round), 8);
+            values = _mm256_permute4x64_epi64(_mm256_packs_epi32(values, values), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_store_si128(reinterpret_cast<__m128i*>(luma), _mm256_castsi256_si128(values));
+            ++sub[0][luma[0]];
+            ++sub[1][luma[1]];
+            ++sub[2][luma[2]];
+            ++sub[3][luma[3]];
+            ++sub[0][luma[4]];
+            ++sub[1][luma[5]];
+            ++sub[2][luma[6]];
+            ++sub[3][luma[7]];
+        }
+        return i;
+    }
+#endif
+
+    // 统计 count 个像素的亮度直方图（覆盖 histogram 原有内容）
+    inline void CountLuma(const uint32_t* pixels, size_t count, Yuv::PixelOrder order, Histogram histogram,
+                          Yuv::Kernel kernel = Yuv::BestKernel())
+    {
+        uint32_t sub[4][256];
+        std::memset(sub, 0, sizeof(sub));
+        size_t done = 0;
+#if YUV_HAVE_AVX2
+        if (kernel == Yuv::Kernel::Avx2) done = CountAvx2(pixels, count, order, sub);
+#endif
+#if YUV_HAVE_X86
+        if (kernel != Yuv::Kernel::Scalar) done += CountSse2(pixels + done, count - done, order, sub);
+#endif
+        // SIMD 内核从 0 开始给子直方图编号，标量接着处理时编号错开不影响合并后的结果
+        CountScalar(pixels, done, count, order, sub);
+        for (int bin = 0; bin < 256; ++bin) histogram[bin] = sub[0][bin] + sub[1][bin] + sub[2][bin] + sub[3][bin];
+    }
+
+    // 限制对比度的直方图均衡：每格计数超过平均值 clipLimit 倍的部分平均分给所有格，
+    // 由累积分布得到均衡曲线，再按 strength 与恒等曲线混合。结果单调不减
+    inline void BuildCurve(const Histogram histogram, double strength, double clipLimit, double curve[256])
+    {
+        double total = 0;
+        for (int bin = 0; bin < 256; ++bin) total += histogram[bin];
+        if (total == 0) {
+            for (int bin = 0; bin < 256; ++bin) curve[bin] = bin;
+            return;
+        }
+        double limit = clipLimit * total / 256;
+        double excess = 0;
+        for (int bin = 0; bin < 256; ++bin) excess += std::max(0.0, histogram[bin] - limit);
+        double share = excess / 256;
+        double cumulative = 0;
+        for (int bin = 0; bin < 256; ++bin) {
+            double count = std::min(static_cast<double>(histogram[bin]), limit) + share;
+            // 取本格的中点，全黑或全白的画面不会被整体推向一端
+            double equalized = 255 * (cumulative + count / 2) / total;
+            cumulative += count;
+            curve[bin] = bin + strength * (equalized - bin);
+        }
+    }
+}
+
+// 分析线程：Submit 只能由一个线程（播放线程）调用
+class FrameAnalyzer
+{
+public:
+    struct Stats {
+        uint64_t analyses;
+        uint64_t skipped;          // 分析线程忙而跳过的帧
+        double analysisMicros;     // 最近一次分析（直方图 + 曲线）的耗时
+    };
+
+    // 均衡曲线与恒等曲线的混合比例、限制倍数，以及两种情况下的平滑系数（每次分析向新曲线靠近的比例）
+    static constexpr double kStrength = 0.5;
+    static constexpr double kClipLimit = 3.0;
+    static constexpr double kSmoothing = 0.15;
+    static constexpr double kSceneCutSmoothing = 0.6;
+    static constexpr double kSceneCutDistance = 0.5;    // 归一化直方图的 L1 距离，范围 0..2
+
+    // threads 为 0 时使用硬件线程数（最多 4 个，抽样后的帧很小，更多线程得不偿失）
+    explicit FrameAnalyzer(unsigned threads = 0, int step = 4, Yuv::Kernel kernel = Yuv::BestKernel())
+        : m_threads(threads ? threads : std::min(WorkStealingPool::DefaultThreads(), 4u))
+        , m_step(step)
+        , m_kernel(kernel)
+        , m_order(Yuv::PixelOrder::Bgra)
+        , m_busy(false)
+        , m_pending(false)
+        , m_stop(false)
+        , m_generation(0)
+        , m_resetPending(false)
+        , m_curveVersion(0)
+        , m_analyses(0)
+        , m_skipped(0)
+        , m_analysisMicros(0)
+        , m_hasHistory(false)
+    {
+        for (int bin = 0; bin < 256; ++bin) {
+            m_curve[bin] = static_cast<uint8_t>(bin);
+            m_smoothed[bin] = bin;
+            m_previous[bin] = 0;
+        }
+        if (m_threads > 1) m_pool.reset(new WorkStealingPool(m_threads));
+        m_thread = std::thread(&FrameAnalyzer::Run, this);
+    }
+
+    ~FrameAnalyzer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    FrameAnalyzer(const FrameAnalyzer&) = delete;
+    FrameAnalyzer& operator=(const FrameAnalyzer&) = delete;
+
+    // 分析线程空闲时抽样复制这一帧并唤醒它，返回 true；忙时立即返回 false，调用方不会被阻塞
+    bool Submit(const uint8_t* pixels, ptrdiff_t stride, int width, int height, Yuv::PixelOrder order)
+    {
+        if (m_busy.load()) {
+            std::lock_guard<std::mutex> lock(m_lock);
+            ++m_skipped;
+            return false;
+        }
+        // 空闲时分析线程不访问 m_input
+        Analysis::Subsample(pixels, stride, width, height, m_step, m_input);
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_order = order;
+            m_pending = true;
+            m_busy = true;
+        }
+        m_wake.notify_all();
+        return true;
+    }
+
+    // 曲线比 version 新时复制出来并更新 version
+    bool LatestCurve(uint64_t& version, uint8_t curve[256]) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_curveVersion == version) return false;
+        std::memcpy(curve, m_curve, 256);
+        version = m_curveVersion;
+        return true;
+    }
+
+    // 丢掉平滑历史，曲线回到恒等；正在进行的分析结果作废，下一次分析从头开始
+    void Reset()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        ++m_generation;
+        m_resetPending = true;
+        for (int bin = 0; bin < 256; ++bin) m_curve[bin] = static_cast<uint8_t>(bin);
+        ++m_curveVersion;
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        Stats stats;
+        stats.analyses = m_analyses;
+        stats.skipped = m_skipped;
+        stats.analysisMicros = m_analysisMicros;
+        return stats;
+    }
+
+    // 按行分段统计，每段一份子直方图，最后合并。只在分析线程（或没有启动分析的调用方）中使用
+    void CountHistogram(const uint32_t* pixels, size_t count, Yuv::PixelOrder order, Analysis::Histogram histogram)
+    {
+        size_t bands = m_pool ? std::min<size_t>(m_threads, std::max<size_t>(count / 1024, 1)) : 1;
+        m_bandHistograms.resize(bands * 256);
+        if (bands == 1) {
+            Analysis::CountLuma(pixels, count, order, &m_bandHistograms[0], m_kernel);
+        } else {
+            for (size_t band = 0; band < bands; ++band) {
+                size_t begin = count * band / bands;
+                size_t end = count * (band + 1) / bands;
+                uint32_t* out = &m_bandHistograms[band * 256];
+                Yuv::Kernel kernel = m_kernel;
+                m_pool->Submit([=] { Analysis::CountLuma(pixels + begin, end - begin, order, out, kernel); });
+            }
+            m_pool->WaitIdle();
+        }
+        for (int bin = 0; bin < 256; ++bin) {
+            uint32_t sum = 0;
+            for (size_t band = 0; band < bands; ++band) sum += m_bandHistograms[band * 256 + bin];
+            histogram[bin] = sum;
+        }
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    unsigned m_threads;
+    int m_step;
+    Yuv::Kernel m_kernel;
+    std::unique_ptr<WorkStealingPool> m_pool;
+    std::thread m_thread;
+    mutable std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::vector<uint32_t> m_input;
+    Yuv::PixelOrder m_order;
+    std::atomic<bool> m_busy;
+    bool m_pending;
+    bool m_stop;
+    uint64_t m_generation;
+    bool m_resetPending;             // Reset 后尚未被分析线程处理：下一次分析先清掉历史
+    uint8_t m_curve[256];
+    uint64_t m_curveVersion;
+    uint64_t m_analyses;
+    uint64_t m_skipped;
+    double m_analysisMicros;
+
+    // 以下只在分析线程中访问
+    std::vector<uint32_t> m_bandHistograms;
+    double m_smoothed[256];
+    double m_previous[256];          // 上一帧的归一化直方图，用于判断场景切换
+    bool m_hasHistory;
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_pending || m_stop; });
+            if (m_stop) return;
+            m_pending = false;
+            uint64_t generation = m_generation;
+            Yuv::PixelOrder order = m_order;
+            bool reset = m_resetPending;
+            m_resetPending = false;
+            lock.unlock();
+
+            Clock::time_point start = Clock::now();
+            uint8_t curve[256];
+            Analyze(order, reset, curve);
+            double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            lock.lock();
+            // 分析期间被 Reset 过：这次的结果作废，历史在下一次分析开始时清掉
+            if (generation == m_generation) {
+                std::memcpy(m_curve, curve, 256);
+                ++m_curveVersion;
+            }
+            ++m_analyses;
+            m_analysisMicros = micros;
+            m_busy = false;
+        }
+    }
+
+    void Analyze(Yuv::PixelOrder order, bool reset, uint8_t curve[256])
+    {
+        if (reset) {
+            m_hasHistory = false;
+            for (int bin = 0; bin < 256; ++bin) {
+                m_smoothed[bin] = bin;
+                m_previous[bin] = 0;
+            }
+        }
+        Analysis::Histogram histogram;
+        CountHistogram(m_input.data(), m_input.size(), order, histogram);
+        double target[256];
+        Analysis::BuildCurve(histogram, kStrength, kClipLimit, target);
+
+        double total = std::max<size_t>(m_input.size(), 1);
+        double distance = 0;
+        for (int bin = 0; bin < 256; ++bin) {
+            double normalized = histogram[bin] / total;
+            distance += std::fabs(normalized - m_previous[bin]);
+            m_previous[bin] = normalized;
+        }
+        double alpha = distance > kSceneCutDistance ? kSceneCutSmoothing : kSmoothing;
+        for (int bin = 0; bin < 256; ++bin) {
+            if (m_hasHistory) m_smoothed[bin] += alpha * (target[bin] - m_smoothed[bin]);
+            else m_smoothed[bin] = target[bin];
+            curve[bin] = static_cast<uint8_t>(std::lround(std::min(std::max(m_smoothed[bin], 0.0), 255.0)));
+        }
+        m_hasHistory = true;
+    }
+};
@@ -0,0 +1,556 @@
+// 输入源模拟 - Source 页的每个信号源由一个生产线程出画面（测试图或录制的 YUV 文件），送进共享的帧队列，
+// 背景视频层从队列取最新一帧显示。
+//
+// 同一时刻只有一个源在工作。切换时旧源停下：线程阻塞在条件变量上，不占 CPU；新源先等过模拟的锁定时间
+// （调谐器锁定、HDMI 握手），再按帧率出帧。每次切换递增代号，队列里旧代号的帧取出时直接丢弃；
+// 新代号的第一帧被取走时，记下从切换请求（KEY_OK）到这一帧的延迟。
+// 帧缓冲在队列中循环使用，稳定后出帧不再分配内存。
+//
+// Snapshot 供 Source 页的缩略图使用：出帧中的源把下一帧复制一份，停着的源醒来按原始尺寸画一帧后继续停着。
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "picture_pipeline.h"
+#include "video_player.h"
+#include "video_scaler.h"
+#include "yuv_convert.h"
+
+namespace Source {
+    enum class Pattern : uint8_t { Bars, Ramp, Checker, Snow };
+
+    inline uint32_t PackPixel(uint8_t r, uint8_t g, uint8_t b, Yuv::PixelOrder order)
+    {
+        return order == Yuv::PixelOrder::Bgra ? (b | g << 8 | r << 16 | 0xFF000000u) : (r | g << 8 | b << 16 | 0xFF000000u);
+    }
+
+    // 画一帧测试图。frame 让画面逐帧变化（移动的竖条、滚动的棋盘、雪花），看得出源是否在出帧
+    inline void Render(Pattern pattern, uint8_t* pixels, int width, int height, uint64_t frame, Yuv::PixelOrder order)
+    {
+        static const uint8_t kBars[8][3] = {
+            { 235, 235, 235 }, { 235, 235, 16 }, { 16, 235, 235 }, { 16, 235, 16 },
+            { 235, 16, 235 }, { 235, 16, 16 }, { 16, 16, 235 }, { 16, 16, 16 },
+        };
+        uint32_t* out = reinterpret_cast<uint32_t*>(pixels);
+        switch (pattern) {
+            case Pattern::Bars: {
+                // 第一行画好后复制到其余各行
+                for (int x = 0; x < width; ++x) {
+                    const uint8_t* bar = kBars[x * 8 / width];
+                    out[x] = PackPixel(bar[0], bar[1], bar[2], order);
+                }
+                for (int y = 1; y < height; ++y) std::memcpy(out + static_cast<size_t>(y) * width, out, width * 4);
+                break;
+            }
+            case Pattern::Ramp: {
+                for (int x = 0; x < width; ++x) {
+                    uint8_t level = static_cast<uint8_t>(x * 255 / std::max(width - 1, 1));
+                    out[x] = PackPixel(level, level, level, order);
+                }
+                for (int y = 1; y < height; ++y) std::memcpy(out + static_cast<size_t>(y) * width, out, width * 4);
+                break;
+            }
+            case Pattern::Checker: {
+                int cell = std::max(height / 9, 1);
+                int shift = static_cast<int>(frame % (2 * cell));
+                uint32_t light = PackPixel(200, 200, 200, order);
+                uint32_t dark = PackPixel(40, 40, 40, order);
+                for (int y = 0; y < height; ++y) {
+                    uint32_t* row = out + static_cast<size_t>(y) * width;
+                    // 同一格行内的各行相同
+                    if (y % cell != 0) {
+                        std::memcpy(row, row - width, width * 4);
+                        continue;
+                    }
+                    for (int x = 0; x < width; ++x) row[x] = (((x + shift) / cell + y / cell) & 1) ? light : dark;
+                }
+                break;
+            }
+            case Pattern::Snow: {
+                uint32_t state = static_cast<uint32_t>(frame * 2654435761u) | 1;
+                size_t count = static_cast<size_t>(width) * height;
+                for (size_t i = 0; i < count; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+                    uint8_t level = static_cast<uint8_t>(state);
+                    out[i] = PackPixel(level, level, level, order);
+                }
+                return;
+            }
+        }
+        // 移动的白色竖条
+        if (width >= 8) {
+            int barX = static_cast<int>(frame * 8 % (width - 7));
+            uint32_t white = PackPixel(255, 255, 255, order);
+            for (int y = 0; y < height; ++y) {
+                std::fill(out + static_cast<size_t>(y) * width + barX, out + static_cast<size_t>(y) * width + barX + 8, white);
+            }
+        }
+    }
+}
+
+// 一帧 32 位像素，行紧密排列
+struct SourceFrame {
+    int source;
+    uint64_t generation;
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+};
+
+// 生产线程放入、UI 线程取出的有界帧队列。满时丢掉最旧的帧：显示只要最新一帧，生产线程从不等待
+class FrameQueue
+{
+public:
+    explicit FrameQueue(size_t capacity = 3)
+        : m_capacity(std::max<size_t>(capacity, 1))
+        , m_dropped(0)
+    {
+    }
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    // 取一块空闲帧缓冲，没有时新建
+    std::unique_ptr<SourceFrame> Acquire()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_free.empty()) return std::unique_ptr<SourceFrame>(new SourceFrame());
+        std::unique_ptr<SourceFrame> frame = std::move(m_free.back());
+        m_free.pop_back();
+        return frame;
+    }
+
+    void Recycle(std::unique_ptr<SourceFrame> frame)
+    {
+        if (!frame) return;
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_free.push_back(std::move(frame));
+    }
+
+    void Push(std::unique_ptr<SourceFrame> frame)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_frames.size() >= m_capacity) {
+            m_free.push_back(std::move(m_frames.front()));
+            m_frames.pop_front();
+            ++m_dropped;
+        }
+        m_frames.push_back(std::move(frame));
+    }
+
+    // 取出 generation 代最新的一帧，其余的帧回收；没有时返回空
+    std::unique_ptr<SourceFrame> PopLatest(uint64_t generation)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        std::unique_ptr<SourceFrame> latest;
+        while (!m_frames.empty()) {
+            std::unique_ptr<SourceFrame> frame = std::move(m_frames.front());
+            m_frames.pop_front();
+            if (frame->generation == generation) {
+                if (latest) m_free.push_back(std::move(latest));
+                latest = std::move(frame);
+            } else {
+                m_free.push_back(std::move(frame));
+            }
+        }
+        return latest;
+    }
+
+    uint64_t Dropped() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_dropped;
+    }
+
+private:
+    size_t m_capacity;
+    mutable std::mutex m_lock;
+    std::deque<std::unique_ptr<SourceFrame>> m_frames;
+    std::vector<std::unique_ptr<SourceFrame>> m_free;
+    uint64_t m_dropped;
+};
+
+// 一个模拟信号源：构造时即启动生产线程并停在条件变量上，Activate 后才出帧
+class InputSource
+{
+public:
+    struct Options {
+        std::string name;
+        Source::Pattern pattern;
+        std::string path;              // 录制的原始 YUV 文件；为空或打不开时画测试图
+        Yuv::Format format;
+        int width;                     // 源的原始尺寸
+        int height;
+        double fps;
+        unsigned lockMs;               // 激活后到第一帧的模拟锁定时间
+        Yuv::PixelOrder order;
+
+        Options()
+            : pattern(Source::Pattern::Bars)
+            , format(Yuv::Format::I420)
+            , width(1920)
+            , height(1080)
+            , fps(60)
+            , lockMs(0)
+            , order(Yuv::PixelOrder::Bgra)
+        {
+        }
+    };
+
+    InputSource(int index, const Options& options, FrameQueue& queue, const std::function<void()>& onFrame)
+        : m_index(index)
+        , m_options(options)
+        , m_queue(queue)
+        , m_onFrame(onFrame)
+        , m_active(false)
+        , m_stop(false)
+        , m_generation(0)
+        , m_outputWidth(0)
+        , m_outputHeight(0)
+        , m_pictureMode(Picture::Mode::Off)
+        , m_frames(0)
+        , m_snapshotRequested(0)
+        , m_snapshotServed(0)
+        , m_snapshotMicros(0)
+    {
+        if (!m_options.path.empty() &&
+            !m_reader.Open(m_options.path, m_options.format, m_options.width, m_options.height)) {
+            m_options.path.clear();
+        }
+        if (m_options.fps <= 0) m_options.fps = 60;
+        m_thread = std::thread(&InputSource::Run, this);
+    }
+
+    ~InputSource()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    InputSource(const InputSource&) = delete;
+    InputSource& operator=(const InputSource&) = delete;
+
+    const Options& GetOptions() const { return m_options; }
+    bool StreamsFile() const { return !m_options.path.empty(); }
+
+    // 以新的代号开始（或重新开始）出帧，先经过锁定时间
+    void Activate(uint64_t generation)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_active = true;
+            m_generation = generation;
+        }
+        m_wake.notify_all();
+    }
+
+    void Park()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_active = false;
+        }
+        m_wake.notify_all();
+    }
+
+    // 0 为源的原始尺寸；从下一帧起生效
+    void SetOutputSize(int width, int height)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_outputWidth = width;
+        m_outputHeight = height;
+    }
+
+    void SetPictureMode(Picture::Mode mode)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_pictureMode = mode;
+    }
+
+    // 已开始生产的帧数；停下后不再增加
+    uint64_t FramesProduced() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_frames;
+    }
+
+    // 取一帧当前画面，最多等 timeout；只供一个线程调用。出帧中的源给出下一帧的副本（输出尺寸，已经过画质处理），
+    // 停着的源给出临时画的一帧（原始尺寸，不经画质处理）。renderMicros 为源线程为此多花的时间。
+    // 超时（例如正在锁定）时返回 false，源仍会在稍后交出这一帧，下次调用时不会读到写了一半的画面
+    bool Snapshot(std::vector<uint8_t>& pixels, int& width, int& height, double& renderMicros,
+                  std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        uint64_t request = ++m_snapshotRequested;
+        m_wake.notify_all();
+        if (!m_wake.wait_for(lock, timeout, [this, request] { return m_stop || m_snapshotServed >= request; }) ||
+            m_snapshotServed < request) {
+            return false;
+        }
+        pixels.swap(m_snapshot.pixels);
+        width = m_snapshot.width;
+        height = m_snapshot.height;
+        renderMicros = m_snapshotMicros;
+        return true;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    int m_index;
+    Options m_options;
+    FrameQueue& m_queue;
+    std::function<void()> m_onFrame;
+    std::thread m_thread;
+    mutable std::mutex m_lock;
+    std::condition_variable m_wake;
+    bool m_active;
+    bool m_stop;
+    uint64_t m_generation;
+    int m_outputWidth;
+    int m_outputHeight;
+    Picture::Mode m_pictureMode;
+    uint64_t m_frames;
+    uint64_t m_snapshotRequested;
+    uint64_t m_snapshotServed;
+    double m_snapshotMicros;
+    SourceFrame m_snapshot;            // 生产线程在 m_snapshotServed < m_snapshotRequested 期间写入
+    // 以下只在生产线程中访问
+    YuvFileReader m_reader;
+    std::unique_ptr<VideoScaler> m_scaler;
+    std::vector<uint8_t> m_yuv;
+    std::vector<uint8_t> m_converted;
+    std::vector<uint8_t> m_processed;
+    Picture::Chain m_chain;
+
+    void Run()
+    {
+        m_chain = Picture::Compile(Picture::Mode::Off, m_options.order);
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / m_options.fps));
+        uint64_t sequence = 0;
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || m_active || m_snapshotServed < m_snapshotRequested; });
+            if (m_stop) return;
+            if (!m_active) {
+                uint64_t request = m_snapshotRequested;
+                lock.unlock();
+                Clock::time_point start = Clock::now();
+                Produce(m_snapshot, m_options.width, m_options.height, Picture::Mode::Off, sequence++);
+                double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                lock.lock();
+                FinishSnapshot(request, micros);
+                continue;
+            }
+            uint64_t generation = m_generation;
+            auto interrupted = [this, generation] { return m_stop || !m_active || m_generation != generation; };
+            if (m_wake.wait_for(lock, std::chrono::milliseconds(m_options.lockMs), interrupted)) continue;
+
+            Clock::time_point deadline = Clock::now();
+            while (!interrupted()) {
+                int width = m_outputWidth > 0 ? m_outputWidth : m_options.width;
+                int height = m_outputHeight > 0 ? m_outputHeight : m_options.height;
+                Picture::Mode pictureMode = m_pictureMode;
+                uint64_t snapshotRequest = m_snapshotServed < m_snapshotRequested ? m_snapshotRequested : 0;
+                ++m_frames;
+                lock.unlock();
+
+                std::unique_ptr<SourceFrame> frame = m_queue.Acquire();
+                frame->source = m_index;
+                frame->generation = generation;
+                Produce(*frame, width, height, pictureMode, sequence++);
+                double snapshotMicros = 0;
+                if (snapshotRequest) {
+                    Clock::time_point start = Clock::now();
+                    m_snapshot.width = width;
+                    m_snapshot.height = height;
+                    m_snapshot.pixels.assign(frame->pixels.begin(), frame->pixels.end());
+                    snapshotMicros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                }
+                m_queue.Push(std::move(frame));
+                if (m_onFrame) m_onFrame();
+
+                lock.lock();
+                if (snapshotRequest) FinishSnapshot(snapshotRequest, snapshotMicros);
+                // 落后超过一帧时从现在重新计时
+                deadline += period;
+                if (Clock::now() > deadline + period) deadline = Clock::now();
+                m_wake.wait_until(lock, deadline, interrupted);
+            }
+        }
+    }
+
+    // 持有 m_lock 时调用
+    void FinishSnapshot(uint64_t request, double micros)
+    {
+        m_snapshotServed = request;
+        m_snapshotMicros = micros;
+        m_wake.notify_all();
+    }
+
+    void Produce(SourceFrame& frame, int width, int height, Picture::Mode pictureMode, uint64_t sequence)
+    {
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.resize(static_cast<size_t>(width) * height * 4);
+        ptrdiff_t stride = static_cast<ptrdiff_t>(width) * 4;
+        if (StreamsFile()) {
+            m_yuv.resize(m_reader.FrameSize());
+            m_reader.ReadFrame(m_yuv.data());
+            Yuv::Planes planes = Yuv::FromBuffer(m_yuv.data(), m_options.format, m_options.width, m_options.height);
+            if (width == m_options.width && height == m_options.height) {
+                Yuv::Convert(planes, frame.pixels.data(), stride, m_options.order);
+            } else {
+                m_converted.resize(static_cast<size_t>(m_options.width) * m_options.height * 4);
+                Yuv::Convert(planes, m_converted.data(), static_cast<ptrdiff_t>(m_options.width) * 4, m_options.order);
+                if (!m_scaler) m_scaler.reset(new VideoScaler(1));
+                m_scaler->Scale(m_converted.data(), static_cast<ptrdiff_t>(m_options.width) * 4,
+                                m_options.width, m_options.height, frame.pixels.data(), stride, width, height,
+                                Scaler::ChooseFilter(m_options.width, m_options.height, width, height));
+            }
+        } else {
+            Source::Render(m_options.pattern, frame.pixels.data(), width, height, sequence, m_options.order);
+        }
+
+        if (pictureMode != m_chain.mode) m_chain = Picture::Compile(pictureMode, m_options.order);
+        if (m_chain.Empty()) return;
+        if (m_chain.InPlace()) {
+            Picture::Process(m_chain, frame.pixels.data(), stride, frame.pixels.data(), stride, width, height);
+        } else {
+            m_processed.resize(frame.pixels.size());
+            Picture::Process(m_chain, frame.pixels.data(), stride, m_processed.data(), stride, width, height);
+            frame.pixels.swap(m_processed);
+        }
+    }
+};
+
+// 管理全部信号源与帧队列，除 onFrame（在生产线程中调用）和缩略图线程对 At(i).Snapshot 的调用外都只在 UI 线程中使用
+class SourceSwitcher
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Stats {
+        int active;                    // -1 为没有选择信号源
+        uint64_t switches;
+        uint64_t measured;             // 已收到第一帧的切换
+        double lastMillis;             // 最近一次切换到第一帧的延迟
+        double averageMillis;
+        double maxMillis;
+        uint64_t dropped;              // 队列满时丢掉的帧
+    };
+
+    explicit SourceSwitcher(const std::function<void()>& onFrame, size_t queueCapacity = 3)
+        : m_onFrame(onFrame)
+        , m_queue(queueCapacity)
+        , m_active(-1)
+        , m_generation(0)
+        , m_waitingFirstFrame(false)
+        , m_switches(0)
+        , m_measured(0)
+        , m_lastMillis(0)
+        , m_totalMillis(0)
+        , m_maxMillis(0)
+    {
+    }
+
+    SourceSwitcher(const SourceSwitcher&) = delete;
+    SourceSwitcher& operator=(const SourceSwitcher&) = delete;
+
+    // 在第一次 Switch 之前添加全部信号源
+    void Add(const InputSource::Options& options)
+    {
+        int index = static_cast<int>(m_sources.size());
+        m_sources.push_back(std::unique_ptr<InputSource>(new InputSource(index, options, m_queue, m_onFrame)));
+    }
+
+    int Count() const { return static_cast<int>(m_sources.size()); }
+    const InputSource& At(int index) const { return *m_sources[index]; }
+    InputSource& At(int index) { return *m_sources[index]; }
+    int Active() const { return m_active; }
+
+    // 切到 index（-1 为不选）；requested 为用户按下确认键的时间，作为延迟的起点
+    void Switch(int index, Clock::time_point requested)
+    {
+        if (index >= Count()) index = -1;
+        if (m_active >= 0) m_sources[m_active]->Park();
+        m_active = index;
+        ++m_generation;
+        ++m_switches;
+        m_requested = requested;
+        m_waitingFirstFrame = index >= 0;
+        if (index >= 0) m_sources[index]->Activate(m_generation);
+    }
+
+    // 取走当前源最新的一帧（用完交给 Recycle）。是切换后的第一帧时 switchMillis 为切换延迟，否则为负
+    std::unique_ptr<SourceFrame> TakeLatest(double& switchMillis)
+    {
+        switchMillis = -1;
+        std::unique_ptr<SourceFrame> frame = m_queue.PopLatest(m_generation);
+        if (frame && m_waitingFirstFrame) {
+            switchMillis = std::chrono::duration<double, std::milli>(Clock::now() - m_requested).count();
+            m_waitingFirstFrame = false;
+            ++m_measured;
+            m_lastMillis = switchMillis;
+            m_totalMillis += switchMillis;
+            m_maxMillis = std::max(m_maxMillis, switchMillis);
+        }
+        return frame;
+    }
+
+    void Recycle(std::unique_ptr<SourceFrame> frame) { m_queue.Recycle(std::move(frame)); }
+
+    void SetOutputSize(int width, int height)
+    {
+        for (auto& source : m_sources) source->SetOutputSize(width, height);
+    }
+
+    void SetPictureMode(Picture::Mode mode)
+    {
+        for (auto& source : m_sources) source->SetPictureMode(mode);
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.active = m_active;
+        stats.switches = m_switches;
+        stats.measured = m_measured;
+        stats.lastMillis = m_lastMillis;
+        stats.averageMillis = m_measured ? m_totalMillis / m_measured : 0;
+        stats.maxMillis = m_maxMillis;
+        stats.dropped = m_queue.Dropped();
+        return stats;
+    }
+
+private:
+    std::function<void()> m_onFrame;
+    FrameQueue m_queue;
+    std::vector<std::unique_ptr<InputSource>> m_sources;
+    int m_active;
+    uint64_t m_generation;
+    Clock::time_point m_requested;
+    bool m_waitingFirstFrame;
+    uint64_t m_switches;
+    uint64_t m_measured;
+    double m_lastMillis;
+    double m_totalMillis;
+    double m_maxMillis;
+};
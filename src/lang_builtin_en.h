@@ -0,0 +1,37 @@
+// 内置英文文本 - 由 catalog_tool --embed 从 lang/en.po 生成，请勿手工修改
+//
+// 目录文件都打不开时 LanguageManager 用它兜底，菜单不会只显示文本键。
+#pragma once
+
+static const char* const kBuiltinEnglish[][2] = {
+    { "tab_source", "Source" },
+    { "tab_picture", "Picture" },
+    { "tab_sound", "Sound" },
+    { "tab_channel", "Channel" },
+    { "tab_common", "Common" },
+    { "source_dtv", "DTV" },
+    { "source_atv", "ATV" },
+    { "source_av", "AV" },
+    { "source_hdmi1", "HDMI1" },
+    { "source_hdmi2", "HDMI2" },
+    { "picture_standard", "Standard" },
+    { "picture_dynamic", "Dynamic" },
+    { "picture_movie", "Movie" },
+    { "picture_game", "Game" },
+    { "sound_standard", "Standard" },
+    { "sound_music", "Music" },
+    { "sound_movie", "Movie" },
+    { "sound_sports", "Sports" },
+    { "channel_auto", "Auto Scan" },
+    { "channel_manual", "Manual Scan" },
+    { "channel_list", "Channel List" },
+    { "channel_list_empty", "No channels. Please run a scan first." },
+    { "channel_not_found", "Channel %s not found." },
+    { "scan_progress", "Scanning... %d%% (%d channels)" },
+    { "scan_done", "Scan complete: %d channels." },
+    { "scan_cancelled", "Scan cancelled: %d channels kept." },
+    { "common_language_english", "English" },
+    { "common_language_chinese", "Chinese" },
+    { "window_title", "TV Menu Demo" },
+    { "popup_switch_success", "Switched to %s page." },
+};
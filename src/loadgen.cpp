@@ -0,0 +1,330 @@
+// 遥控器命令压测工具 - 模拟多个遥控器向 TV Menu 发送命令
+// 测量 RemoteServerThread -> wxQueueEvent -> OnSocketCommand 整条管线的吞吐与往返延迟
+//
+// 用法: loadgen [选项]
+//   -c N             并发连接数（默认 1）
+//   -n N             每个连接发送的命令数（默认 10000，与 -d 互斥）
+//   -d SEC           按时长发送，单位秒
+//   -r RATE          每个连接每秒发送的命令数，0 表示尽可能快（默认 0）
+//   -w N             每个连接最多未确认的命令数（默认 64）
+//   --mix SPEC       命令配比，如 KEY_LEFT:4,KEY_RIGHT:4,KEY_OK:1（默认 KEY_LEFT:1,KEY_RIGHT:1）
+//   --host ADDR      目标地址（默认 127.0.0.1）
+//   --port PORT      目标端口（默认 5050）
+//   --timeout MS     超过该时间未收到 ACK 计为丢失（默认 2000）
+//   --min-rate R     总吞吐低于 R 条/秒时返回非零
+//   --max-p99 MS     p99 往返延迟超过 MS 毫秒时返回非零
+//   --max-drops N    丢失超过 N 条时返回非零（默认 0）
+#include "remote_link.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options {
+    int connections = 1;
+    long long count = 10000;
+    double duration = 0;
+    double rate = 0;
+    size_t window = 64;
+    std::string host = RemoteLink::kHost;
+    unsigned short port = RemoteLink::kPort;
+    int timeoutMs = 2000;
+    double minRate = 0;
+    double maxP99 = 0;
+    long long maxDrops = 0;
+    std::vector<std::pair<std::string, int>> mix;
+};
+
+// 单个连接：发送线程按节奏发命令，接收线程匹配 ACK 计算往返延迟
+class LoadConnection
+{
+public:
+    LoadConnection(const Options& options, int index)
+        : m_options(options)
+        , m_socket(INVALID_SOCKET)
+        , m_random(static_cast<unsigned>(index) * 7919u + 1u)
+        , m_sent(0)
+        , m_dropped(0)
+        , m_done(false)
+    {
+    }
+
+    ~LoadConnection()
+    {
+        if (m_socket != INVALID_SOCKET) closesocket(m_socket);
+    }
+
+    bool Open()
+    {
+        return RemoteLink::Connect(m_socket, m_options.host.c_str(), m_options.port) == RemoteLink::ConnectResult::Ok;
+    }
+
+    void Run(Clock::time_point start)
+    {
+        std::thread receiver(&LoadConnection::ReceiveLoop, this);
+        SendLoop(start);
+
+        // 等待最后一批 ACK，超时的计为丢失
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_changed.wait_for(lock, std::chrono::milliseconds(m_options.timeoutMs),
+                               [this] { return m_inFlight.empty(); });
+            m_dropped += m_inFlight.size();
+            m_inFlight.clear();
+            m_done = true;
+        }
+        shutdown(m_socket, 2);
+        receiver.join();
+    }
+
+    long long Sent() const { return m_sent; }
+    long long Dropped() const { return m_dropped; }
+    const std::vector<double>& Latencies() const { return m_latencies; }
+
+private:
+    const Options& m_options;
+    SOCKET m_socket;
+    std::mt19937 m_random;
+    long long m_sent;
+    long long m_dropped;
+    bool m_done;
+
+    std::mutex m_lock;
+    std::condition_variable m_changed;
+    std::unordered_map<long long, Clock::time_point> m_inFlight;
+    std::vector<double> m_latencies;  // 毫秒
+
+    const std::string& PickCommand()
+    {
+        int total = 0;
+        for (const auto& entry : m_options.mix) total += entry.second;
+        int pick = static_cast<int>(m_random() % static_cast<unsigned>(total));
+        for (const auto& entry : m_options.mix) {
+            if (pick < entry.second) return entry.first;
+            pick -= entry.second;
+        }
+        return m_options.mix.back().first;
+    }
+
+    // 窗口满时把超时未确认的命令计为丢失，腾出位置
+    void ExpireLocked(Clock::time_point now)
+    {
+        const auto limit = std::chrono::milliseconds(m_options.timeoutMs);
+        for (auto it = m_inFlight.begin(); it != m_inFlight.end(); ) {
+            if (now - it->second > limit) {
+                it = m_inFlight.erase(it);
+                ++m_dropped;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void SendLoop(Clock::time_point start)
+    {
+        const bool timed = m_options.duration > 0;
+        const auto end = start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(m_options.duration));
+
+        for (long long seq = 0; ; ++seq) {
+            if (timed ? Clock::now() >= end : seq >= m_options.count) break;
+
+            // 固定速率：按计划时间发送，落后时不补发突发
+            if (m_options.rate > 0) {
+                auto due = start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(seq / m_options.rate));
+                std::this_thread::sleep_until(due);
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                while (m_inFlight.size() >= m_options.window) {
+                    if (!m_changed.wait_for(lock, std::chrono::milliseconds(m_options.timeoutMs),
+                                            [this] { return m_inFlight.size() < m_options.window; })) {
+                        ExpireLocked(Clock::now());
+                    }
+                }
+                m_inFlight[seq] = Clock::now();
+            }
+
+            if (!RemoteLink::SendAll(m_socket, RemoteLink::FormatCommand(PickCommand(), seq))) {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_inFlight.erase(seq);
+                break;
+            }
+            ++m_sent;
+        }
+    }
+
+    void ReceiveLoop()
+    {
+        std::string pending, line;
+        char buffer[4096];
+        while (true) {
+            int n = recv(m_socket, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            pending.append(buffer, n);
+            Clock::time_point now = Clock::now();
+            while (RemoteLink::TakeLine(pending, line)) {
+                if (line.compare(0, 4, "ACK ") != 0) continue;
+                long long seq = std::atoll(line.c_str() + 4);
+
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (m_done) return;
+                auto it = m_inFlight.find(seq);
+                if (it == m_inFlight.end()) continue;  // 已按超时计为丢失
+                m_latencies.push_back(std::chrono::duration<double, std::milli>(now - it->second).count());
+                m_inFlight.erase(it);
+                m_changed.notify_all();
+            }
+        }
+    }
+};
+
+static bool ParseMix(const std::string& spec, std::vector<std::pair<std::string, int>>& mix)
+{
+    mix.clear();
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t comma = spec.find(',', pos);
+        if (comma == std::string::npos) comma = spec.size();
+        std::string item = spec.substr(pos, comma - pos);
+        size_t colon = item.find(':');
+        int weight = colon == std::string::npos ? 1 : std::atoi(item.c_str() + colon + 1);
+        std::string key = item.substr(0, colon);
+        if (key.empty() || weight <= 0) return false;
+        mix.push_back(std::make_pair(key, weight));
+        pos = comma + 1;
+    }
+    return !mix.empty();
+}
+
+static bool ParseOptions(int argc, char** argv, Options& options)
+{
+    ParseMix("KEY_LEFT:1,KEY_RIGHT:1", options.mix);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (arg == "-c") options.connections = std::atoi(value);
+        else if (arg == "-n") options.count = std::atoll(value);
+        else if (arg == "-d") options.duration = std::atof(value);
+        else if (arg == "-r") options.rate = std::atof(value);
+        else if (arg == "-w") options.window = static_cast<size_t>(std::max(1, std::atoi(value)));
+        else if (arg == "--mix") { if (!ParseMix(value, options.mix)) return false; }
+        else if (arg == "--host") options.host = value;
+        else if (arg == "--port") options.port = static_cast<unsigned short>(std::atoi(value));
+        else if (arg == "--timeout") options.timeoutMs = std::atoi(value);
+        else if (arg == "--min-rate") options.minRate = std::atof(value);
+        else if (arg == "--max-p99") options.maxP99 = std::atof(value);
+        else if (arg == "--max-drops") options.maxDrops = std::atoll(value);
+        else return false;
+    }
+    return options.connections > 0 && (options.count > 0 || options.duration > 0);
+}
+
+static double Percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// 单独连一次查询 menu 侧的管线统计
+static std::string QueryServerStats(const Options& options)
+{
+    SOCKET sock;
+    if (RemoteLink::Connect(sock, options.host.c_str(), options.port) != RemoteLink::ConnectResult::Ok) {
+        return std::string();
+    }
+    std::string pending, line;
+    if (RemoteLink::SendAll(sock, RemoteLink::FormatCommand("STATS"))) {
+        char buffer[512];
+        int n;
+        while (!RemoteLink::TakeLine(pending, line) && (n = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+            pending.append(buffer, n);
+        }
+    }
+    closesocket(sock);
+    return line;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: loadgen [-c conns] [-n count | -d seconds] [-r rate] [-w window]\n"
+                             "               [--mix KEY:weight,...] [--host addr] [--port port] [--timeout ms]\n"
+                             "               [--min-rate r] [--max-p99 ms] [--max-drops n]\n");
+        return 2;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    std::vector<std::unique_ptr<LoadConnection>> connections;
+    for (int i = 0; i < options.connections; ++i) {
+        connections.emplace_back(new LoadConnection(options, i));
+        if (!connections.back()->Open()) {
+            std::fprintf(stderr, "connect %s:%u failed (connection %d)\n", options.host.c_str(), options.port, i);
+#ifdef _WIN32
+            WSACleanup();
+#endif
+            return 2;
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    for (auto& connection : connections) {
+        threads.emplace_back(&LoadConnection::Run, connection.get(), start);
+    }
+    for (auto& thread : threads) thread.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    long long sent = 0, dropped = 0;
+    std::vector<double> latencies;
+    for (const auto& connection : connections) {
+        sent += connection->Sent();
+        dropped += connection->Dropped();
+        latencies.insert(latencies.end(), connection->Latencies().begin(), connection->Latencies().end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    double throughput = elapsed > 0 ? latencies.size() / elapsed : 0;
+    double p99 = Percentile(latencies, 99);
+
+    std::printf("connections   %d\n", options.connections);
+    std::printf("elapsed       %.3f s\n", elapsed);
+    std::printf("sent          %lld\n", sent);
+    std::printf("acked         %zu\n", latencies.size());
+    std::printf("dropped       %lld\n", dropped);
+    std::printf("throughput    %.0f cmd/s\n", throughput);
+    std::printf("rtt ms        min %.3f  p50 %.3f  p90 %.3f  p99 %.3f  p99.9 %.3f  max %.3f\n",
+                latencies.empty() ? 0 : latencies.front(), Percentile(latencies, 50), Percentile(latencies, 90),
+                p99, Percentile(latencies, 99.9), latencies.empty() ? 0 : latencies.back());
+
+    std::string stats = QueryServerStats(options);
+    if (!stats.empty()) std::printf("server        %s\n", stats.c_str());
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    bool ok = dropped <= options.maxDrops;
+    if (options.minRate > 0 && throughput < options.minRate) ok = false;
+    if (options.maxP99 > 0 && p99 > options.maxP99) ok = false;
+    if (!ok) std::printf("FAILED: thresholds not met\n");
+    return ok ? 0 : 1;
+}
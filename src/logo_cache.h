@@ -0,0 +1,326 @@
+// 台标缓存 - 频道列表的台标在工作线程上解码缩小，UI 线程只取现成的小图
+//
+// 解码由调用方提供（如用 wxImage 读 PNG），得到原尺寸的 RGBA；工作线程预乘 alpha、换成位图的字节序，
+// 再按区域平均等比缩小到台标框内，放进按字节数限制的 LRU 缓存。Get 命中时直接返回；未命中时该台标
+// 排到队首并返回空（图块先显示文字占位），解码好后回调 onReady，UI 再取一次。
+//
+// Prefetch 给出当前需要的全部台标（可见项加两侧即将滚入的），可见项之外的排在后面解码；列表每次整体替换，
+// 已滚远、还没开始解码的不再解码。列表只取缓存放得下的前面一段，缓存满时先淘汰不在列表中的最久未用的台标，
+// 预取不会挤掉正在显示的台标而反复解码。没有台标（解码失败）也缓存一个空项，不反复尝试。
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "thumbnailer.h"
+#include "yuv_convert.h"
+
+class LogoCache
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // 解码结果：原尺寸、未预乘的 RGBA，每行 width * 4 字节
+    struct Image {
+        int width;
+        int height;
+        std::vector<uint8_t> rgba;
+
+        Image() : width(0), height(0) {}
+    };
+
+    // 返回 false 表示 key 没有台标；在工作线程中调用，可能同时有多个
+    typedef std::function<bool(uint32_t key, Image& image)> DecodeFunc;
+
+    // 缩小后的台标：字节序为 Options::order，alpha 已预乘；没有台标时 width 为 0
+    struct Logo {
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+
+        Logo() : width(0), height(0) {}
+    };
+    typedef std::shared_ptr<const Logo> LogoPtr;
+
+    struct Options {
+        int width;                     // 台标框，等比缩小到框内（不放大）
+        int height;
+        Yuv::PixelOrder order;
+        size_t cacheBytes;             // 缓存台标的内存上限
+        unsigned threads;
+        Yuv::Kernel kernel;
+
+        Options()
+            : width(112)
+            , height(34)
+            , order(Yuv::PixelOrder::Bgra)
+            , cacheBytes(4u << 20)
+            , threads(2)
+            , kernel(Yuv::BestKernel())
+        {
+        }
+    };
+
+    struct Stats {
+        uint64_t requests;             // Get 次数
+        uint64_t hits;
+        uint64_t prefetchHits;         // 命中的台标中由预取解码的（每个台标只计第一次）
+        uint64_t decoded;
+        uint64_t missing;              // 没有台标
+        uint64_t dropped;              // 预取列表变化后不再解码的
+        uint64_t evicted;
+        size_t cachedLogos;
+        size_t cachedBytes;
+        double hitRate;
+        double decodeMicros;           // 平均每个台标解码加缩小的耗时
+    };
+
+    LogoCache(const Options& options, const DecodeFunc& decode, const std::function<void()>& onReady)
+        : m_options(options)
+        , m_decode(decode)
+        , m_onReady(onReady)
+        , m_stop(false)
+        , m_cachedBytes(0)
+        , m_requests(0)
+        , m_hits(0)
+        , m_prefetchHits(0)
+        , m_decoded(0)
+        , m_missing(0)
+        , m_dropped(0)
+        , m_evicted(0)
+        , m_decodeMicros(0)
+    {
+        m_options.width = std::max(m_options.width, 1);
+        m_options.height = std::max(m_options.height, 1);
+        unsigned threads = std::max(m_options.threads, 1u);
+        for (unsigned i = 0; i < threads; ++i) m_threads.emplace_back(&LogoCache::Run, this);
+    }
+
+    ~LogoCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    LogoCache(const LogoCache&) = delete;
+    LogoCache& operator=(const LogoCache&) = delete;
+
+    // 命中时返回台标（可能是没有台标的空项）；未命中时排到队首，解码好后回调 onReady
+    LogoPtr Get(uint32_t key)
+    {
+        LogoPtr logo;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            ++m_requests;
+            auto cached = m_cache.find(key);
+            if (cached != m_cache.end()) {
+                m_recent.splice(m_recent.begin(), m_recent, cached->second.recent);
+                ++m_hits;
+                if (cached->second.prefetched) {
+                    cached->second.prefetched = false;
+                    ++m_prefetchHits;
+                }
+                return cached->second.logo;
+            }
+            m_waiting.insert(key);
+            if (m_loading.count(key)) return logo;
+            m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), key), m_pending.end());
+            m_pending.push_front(key);
+        }
+        m_wake.notify_one();
+        return logo;
+    }
+
+    // 替换需要的台标列表（按优先顺序，可见项在前）：Get 未命中的仍在最前，其余依次排在后面；
+    // 队列中不在列表里的不再解码
+    void Prefetch(const std::vector<uint32_t>& keys)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            size_t logoBytes = static_cast<size_t>(m_options.width) * m_options.height * 4 + sizeof(Logo);
+            size_t count = std::min(keys.size(), std::max<size_t>(m_options.cacheBytes / logoBytes, 1));
+            m_wanted.assign(keys.begin(), keys.begin() + count);
+            std::set<uint32_t> wanted(m_wanted.begin(), m_wanted.end());
+            std::deque<uint32_t> pending;
+            for (uint32_t key : m_pending) {
+                if (!wanted.count(key)) {
+                    m_waiting.erase(key);
+                    ++m_dropped;
+                } else if (m_waiting.count(key)) {
+                    pending.push_back(key);
+                    wanted.erase(key);
+                }
+            }
+            for (uint32_t key : m_wanted) {
+                if (!wanted.erase(key) || m_cache.count(key) || m_loading.count(key)) continue;
+                pending.push_back(key);
+            }
+            m_pending.swap(pending);
+        }
+        m_wake.notify_all();
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        Stats stats;
+        stats.requests = m_requests;
+        stats.hits = m_hits;
+        stats.prefetchHits = m_prefetchHits;
+        stats.decoded = m_decoded;
+        stats.missing = m_missing;
+        stats.dropped = m_dropped;
+        stats.evicted = m_evicted;
+        stats.cachedLogos = m_cache.size();
+        stats.cachedBytes = m_cachedBytes;
+        stats.hitRate = m_requests ? static_cast<double>(m_hits) / m_requests : 0;
+        stats.decodeMicros = m_decoded + m_missing ? m_decodeMicros / (m_decoded + m_missing) : 0;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        LogoPtr logo;
+        size_t bytes;
+        bool prefetched;               // 由预取解码且还没被 Get 用过
+        std::list<uint32_t>::iterator recent;
+    };
+
+    // 每个工作线程自己的解码与缩小缓冲
+    struct Worker {
+        Image image;
+        std::vector<uint8_t> premultiplied;
+        Thumbnail::Scratch scratch;
+    };
+
+    Options m_options;
+    DecodeFunc m_decode;
+    std::function<void()> m_onReady;
+    std::vector<std::thread> m_threads;
+    mutable std::mutex m_lock;
+    std::condition_variable m_wake;
+    bool m_stop;
+    std::deque<uint32_t> m_pending;
+    std::set<uint32_t> m_loading;
+    std::set<uint32_t> m_waiting;      // Get 未命中、还在等解码的
+    std::vector<uint32_t> m_wanted;    // 最近一次 Prefetch 的列表（截到缓存放得下的数量）
+    // 缓存：m_recent 最近用过的在前
+    std::map<uint32_t, Entry> m_cache;
+    std::list<uint32_t> m_recent;
+    size_t m_cachedBytes;
+    uint64_t m_requests;
+    uint64_t m_hits;
+    uint64_t m_prefetchHits;
+    uint64_t m_decoded;
+    uint64_t m_missing;
+    uint64_t m_dropped;
+    uint64_t m_evicted;
+    double m_decodeMicros;
+
+    // 持有 m_lock 时调用：放进缓存，超出上限时从最久未用的一端先淘汰不在需要列表中的台标；
+    // 还放不下时，Get 在等的台标再淘汰列表中的，预取的则放弃
+    void Insert(uint32_t key, const LogoPtr& logo, bool prefetched)
+    {
+        size_t bytes = logo->pixels.size() + sizeof(Logo);
+        for (int pass = 0; pass < (prefetched ? 1 : 2); ++pass) {
+            for (auto it = m_recent.end(); m_cachedBytes + bytes > m_options.cacheBytes && it != m_recent.begin();) {
+                --it;
+                if (pass == 0 && std::find(m_wanted.begin(), m_wanted.end(), *it) != m_wanted.end()) continue;
+                auto entry = m_cache.find(*it);
+                m_cachedBytes -= entry->second.bytes;
+                m_cache.erase(entry);
+                it = m_recent.erase(it);
+                ++m_evicted;
+            }
+        }
+        if (m_cachedBytes + bytes > m_options.cacheBytes) return;
+        m_recent.push_front(key);
+        Entry entry;
+        entry.logo = logo;
+        entry.bytes = bytes;
+        entry.prefetched = prefetched;
+        entry.recent = m_recent.begin();
+        m_cache[key] = entry;
+        m_cachedBytes += bytes;
+    }
+
+    void Run()
+    {
+        Worker worker;
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+            if (m_stop) return;
+            uint32_t key = m_pending.front();
+            m_pending.pop_front();
+            m_loading.insert(key);
+            lock.unlock();
+
+            Clock::time_point start = Clock::now();
+            std::shared_ptr<Logo> logo(new Logo());
+            if (m_decode && m_decode(key, worker.image)) Shrink(worker, *logo);
+            double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            lock.lock();
+            m_loading.erase(key);
+            m_decodeMicros += micros;
+            if (logo->width > 0) {
+                ++m_decoded;
+            } else {
+                ++m_missing;
+            }
+            bool waited = m_waiting.erase(key) > 0;
+            Insert(key, logo, !waited);
+            if (waited && m_onReady) {
+                lock.unlock();
+                m_onReady();
+                lock.lock();
+            }
+        }
+    }
+
+    // 预乘 alpha 并换成位图字节序，再等比缩小到台标框内
+    void Shrink(Worker& worker, Logo& logo)
+    {
+        const Image& image = worker.image;
+        if (image.width <= 0 || image.height <= 0 ||
+            image.rgba.size() < static_cast<size_t>(image.width) * image.height * 4) {
+            return;
+        }
+        size_t count = static_cast<size_t>(image.width) * image.height;
+        worker.premultiplied.resize(count * 4);
+        int red = m_options.order == Yuv::PixelOrder::Bgra ? 2 : 0;
+        const uint8_t* in = image.rgba.data();
+        uint8_t* out = worker.premultiplied.data();
+        for (size_t i = 0; i < count; ++i, in += 4, out += 4) {
+            unsigned alpha = in[3];
+            out[red] = static_cast<uint8_t>((in[0] * alpha + 127) / 255);
+            out[1] = static_cast<uint8_t>((in[1] * alpha + 127) / 255);
+            out[2 - red] = static_cast<uint8_t>((in[2] * alpha + 127) / 255);
+            out[3] = static_cast<uint8_t>(alpha);
+        }
+
+        double scale = std::min(1.0, std::min(static_cast<double>(m_options.width) / image.width,
+                                              static_cast<double>(m_options.height) / image.height));
+        logo.width = std::max(static_cast<int>(image.width * scale + 0.5), 1);
+        logo.height = std::max(static_cast<int>(image.height * scale + 0.5), 1);
+        logo.pixels.resize(static_cast<size_t>(logo.width) * logo.height * 4);
+        Thumbnail::BoxDownscale(worker.premultiplied.data(), static_cast<ptrdiff_t>(image.width) * 4, image.width,
+                                image.height, logo.pixels.data(), static_cast<ptrdiff_t>(logo.width) * 4, logo.width,
+                                logo.height, worker.scratch, m_options.kernel);
+    }
+};
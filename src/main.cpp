@@ -7,11 +7,37 @@
 #include <wx/timer.h>
 #include <vector>
 #include <map>
-#include <winsock2.h>
-#include <ws2tcpip.h>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <tuple>
+#include <mutex>
 #include <wx/dcbuffer.h>
 #include <wx/image.h>
-typedef int socklen_t;
+#include <wx/imagpng.h>
+#include <wx/rawbmp.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include "remote_link.h"
+#include "command_log.h"
+#include "alloc_stats.h"
+#include "timer_wheel.h"
+#include "virtual_strip.h"
+#include "channel_store.h"
+#include "channel_scan.h"
+#include "settings_store.h"
+#include "startup_trace.h"
+#include "translation_catalog.h"
+#include "lang_builtin_en.h"
+#include "video_player.h"
+#include "sound_engine.h"
+#include "input_source.h"
+#include "thumbnailer.h"
+#include "zap_prefetch.h"
+#include "timeshift_ring.h"
+#include "logo_cache.h"
 
 namespace Theme {
     const wxColour Background = wxColour(3, 54, 75);       
@@ -24,23 +50,77 @@ namespace Theme {
     const wxColour CheckMark = wxColour(0, 200, 100);        
 }
 
-enum class Language {
+// 语言编号与 kLanguageCodes 一一对应，也写在设置快照里，只能在末尾追加
+enum class Language : uint8_t {
     English,
     Chinese,
-    // Spanish,
-    // Japanese,
-    // etc.
+    // 新增语言：在此追加枚举值，在 kLanguageCodes 追加语言代码，并提供 lang/<代码>.po；
+    // 改了 lang/en.po 后用 catalog_tool --embed 重新生成 src/lang_builtin_en.h
 };
 
+const char* const kLanguageCodes[] = {"en", "zh"};
+const size_t kLanguageCount = sizeof(kLanguageCodes) / sizeof(kLanguageCodes[0]);
+
+// 翻译来自 <目录>/<语言代码>.tvtc 二进制目录（见 translation_catalog.h）。
+// 只在切换到某种语言或需要英文兜底时才映射对应的目录；当前语言缺少的 key 用英文，英文也没有时显示 key 本身
 class LanguageManager {
 public:
+    typedef std::map<wxString, wxString> TextTable;
+    
     static LanguageManager& Instance() {
         static LanguageManager instance;
         return instance;
     }
     
+    // 需在第一次取文本之前设置；已打开的目录会在下次使用时按新目录重新打开
+    void SetCatalogDirectory(const wxString& directory) {
+        m_catalogDirectory = directory;
+        for (auto& catalog : m_catalogs) catalog.reset();
+        for (auto& texts : m_prepared) texts.clear();
+        m_texts.clear();
+    }
+    
     void SetLanguage(Language lang) {
+        // 离开的语言已取过的文本留着，切换回来时不必再查目录
+        TextTable& leaving = m_prepared[LanguageIndex(m_currentLanguage)];
+        leaving.insert(m_texts.begin(), m_texts.end());
         m_currentLanguage = lang;
+        m_texts.clear();
+        m_texts.swap(m_prepared[LanguageIndex(lang)]);
+        GetCatalog(lang);
+    }
+    
+    wxString GetCatalogPath(Language lang) const {
+        wxString directory = m_catalogDirectory.empty() ? DefaultCatalogDirectory() : m_catalogDirectory;
+        return directory + "/" + kLanguageCodes[LanguageIndex(lang)] + ".tvtc";
+    }
+    
+    // 一次取好 keys 在某种语言下的全部文本（缺的用英文兜底）。自行映射目录、不访问任何成员，
+    // 可在后台线程调用
+    static TextTable LoadTexts(const std::string& path, const std::string& fallbackPath, const std::vector<wxString>& keys) {
+        TranslationCatalog catalog, fallback;
+        catalog.Open(path);
+        fallback.Open(fallbackPath);
+        TextTable texts;
+        for (const wxString& key : keys) {
+            const wxScopedCharBuffer utf8 = key.utf8_str();
+            const char* value;
+            size_t length;
+            if (catalog.Find(utf8.data(), utf8.length(), value, length) ||
+                fallback.Find(utf8.data(), utf8.length(), value, length) ||
+                FindBuiltin(utf8.data(), utf8.length(), value, length)) {
+                texts[key] = wxString::FromUTF8(value, length);
+            } else {
+                texts[key] = key;
+            }
+        }
+        return texts;
+    }
+    
+    // 登记后台预取的文本，切换到该语言时直接作为文本缓存使用
+    void AddPreparedTexts(Language lang, const TextTable& texts) {
+        TextTable& target = lang == m_currentLanguage ? m_texts : m_prepared[LanguageIndex(lang)];
+        target.insert(texts.begin(), texts.end());
     }
     
     Language GetLanguage() const {
@@ -48,94 +128,153 @@ public:
     }
     
     wxString GetText(const wxString& key) const {
-        auto it = m_translations.find(key);
-        if (it != m_translations.end()) {
-            switch (m_currentLanguage) {
-                case Language::Chinese:
-                    return it->second.chinese;
-                case Language::English:
-                default:
-                    return it->second.english;
-            }
+        auto it = m_texts.find(key);
+        if (it != m_texts.end()) {
+            return it->second;
         }
-        return key;
+        wxString text = key;
+        const wxScopedCharBuffer utf8 = key.utf8_str();
+        const char* value;
+        size_t length;
+        if (GetCatalog(m_currentLanguage).Find(utf8.data(), utf8.length(), value, length) ||
+            GetCatalog(Language::English).Find(utf8.data(), utf8.length(), value, length) ||
+            FindBuiltin(utf8.data(), utf8.length(), value, length)) {
+            text = wxString::FromUTF8(value, length);
+        }
+        m_texts[key] = text;
+        return text;
     }
     
 private:
     LanguageManager() : m_currentLanguage(Language::English) {
-        InitializeTranslations();
     }
     
-    struct Translation {
-        wxString english;
-        wxString chinese;
-        // wxString spanish;
-        // wxString japanese;
-    };
+    // 默认目录：程序所在目录下的 lang，与从哪个工作目录启动无关
+    static wxString DefaultCatalogDirectory() {
+        static const wxString directory = wxFileName(wxStandardPaths::Get().GetExecutablePath()).GetPath() + "/lang";
+        return directory;
+    }
+    
+    // 目录文件都打不开（如未部署 lang 目录）时的最后兜底：编译进程序的英文文本
+    static bool FindBuiltin(const char* key, size_t keyLength, const char*& value, size_t& length) {
+        for (const auto& entry : kBuiltinEnglish) {
+            if (std::strlen(entry[0]) == keyLength && std::memcmp(entry[0], key, keyLength) == 0) {
+                value = entry[1];
+                length = std::strlen(entry[1]);
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    static size_t LanguageIndex(Language lang) {
+        return static_cast<size_t>(lang) < kLanguageCount ? static_cast<size_t>(lang) : 0;
+    }
     
-    void InitializeTranslations() {
-        // Tab 标签
-        m_translations["tab_source"] = {"Source", wxString::FromUTF8("信号源")};
-        m_translations["tab_picture"] = {"Picture", wxString::FromUTF8("图像")};
-        m_translations["tab_sound"] = {"Sound", wxString::FromUTF8("声音")};
-        m_translations["tab_channel"] = {"Channel", wxString::FromUTF8("频道")};
-        m_translations["tab_common"] = {"Common", wxString::FromUTF8("通用")};
-        
-        // Source 页面
-        m_translations["source_dtv"] = {"DTV", wxString::FromUTF8("数字电视")};
-        m_translations["source_atv"] = {"ATV", wxString::FromUTF8("模拟电视")};
-        m_translations["source_av"] = {"AV", wxString::FromUTF8("AV输入")};
-        m_translations["source_hdmi1"] = {"HDMI1", "HDMI1"};
-        m_translations["source_hdmi2"] = {"HDMI2", "HDMI2"};
-        
-        // Picture 页面
-        m_translations["picture_standard"] = {"Standard", wxString::FromUTF8("标准")};
-        m_translations["picture_dynamic"] = {"Dynamic", wxString::FromUTF8("动态")};
-        m_translations["picture_movie"] = {"Movie", wxString::FromUTF8("电影")};
-        m_translations["picture_game"] = {"Game", wxString::FromUTF8("游戏")};
-        
-        // Sound 页面
-        m_translations["sound_standard"] = {"Standard", wxString::FromUTF8("标准")};
-        m_translations["sound_music"] = {"Music", wxString::FromUTF8("音乐")};
-        m_translations["sound_movie"] = {"Movie", wxString::FromUTF8("电影")};
-        m_translations["sound_sports"] = {"Sports", wxString::FromUTF8("体育")};
-        
-        // Channel 页面
-        m_translations["channel_auto"] = {"Auto Scan", wxString::FromUTF8("自动搜台")};
-        m_translations["channel_manual"] = {"Manual Scan", wxString::FromUTF8("手动搜台")};
-        m_translations["channel_list"] = {"Channel List", wxString::FromUTF8("频道列表")};
-        
-        // Common 页面
-        m_translations["common_language_english"] = {"English", wxString::FromUTF8("英语")};
-        m_translations["common_language_chinese"] = {"Chinese", wxString::FromUTF8("中文")};
-        
-        // 窗口标题
-        m_translations["window_title"] = {"TV Menu Demo", wxString::FromUTF8("电视菜单演示")};
-        m_translations["popup_switch_success"] = {"Switched to %s page.", wxString::FromUTF8("已切换到%s页面。")};
+    // 第一次用到时打开；打开失败也不再重试，查找一律落空
+    const TranslationCatalog& GetCatalog(Language lang) const {
+        std::unique_ptr<TranslationCatalog>& catalog = m_catalogs[LanguageIndex(lang)];
+        if (!catalog) {
+            StartupPhase phase("LoadCatalog");
+            catalog.reset(new TranslationCatalog());
+            catalog->Open(std::string(GetCatalogPath(lang).utf8_str()));
+        }
+        return *catalog;
     }
     
     Language m_currentLanguage;
-    std::map<wxString, Translation> m_translations;
+    wxString m_catalogDirectory;    // 为空时用 DefaultCatalogDirectory
+    mutable std::unique_ptr<TranslationCatalog> m_catalogs[kLanguageCount];
+    // 当前语言已取过的文本，绘制时反复取同一个 key 不必每次转码
+    mutable TextTable m_texts;
+    // 其他语言预取或曾经取过的文本
+    TextTable m_prepared[kLanguageCount];
 };
 
 #define TR(key) LanguageManager::Instance().GetText(key)
 
+// Tile 文本尺寸缓存，按 (语言, 文本键, 基础字号, 缩放) 记录。切换语言前在后台为目标语言预先量好，
+// 切换后首次绘制不必再测量文本。只在 UI 线程使用
+class TextMetrics {
+public:
+    static TextMetrics& Instance() {
+        static TextMetrics instance;
+        return instance;
+    }
+    
+    bool Find(Language lang, const wxString& key, const wxFont& baseFont, double scale, double& width, double& height) const {
+        auto it = m_sizes.find(MakeKey(lang, key, baseFont, scale));
+        if (it == m_sizes.end())
+            return false;
+        width = it->second.first;
+        height = it->second.second;
+        return true;
+    }
+    
+    void Store(Language lang, const wxString& key, const wxFont& baseFont, double scale, double width, double height) {
+        m_sizes[MakeKey(lang, key, baseFont, scale)] = std::make_pair(width, height);
+    }
+    
+    // 用与 Tile 绘制相同的字体测量一组文本，scales 为 Tile 可能使用的字号缩放
+    void Measure(Language lang, const LanguageManager::TextTable& texts, const wxFont& baseFont, const std::vector<double>& scales) {
+        std::unique_ptr<wxGraphicsContext> gc(wxGraphicsContext::Create());
+        if (!gc)
+            return;
+        for (double scale : scales) {
+            gc->SetFont(baseFont.Bold().Scale(scale), *wxWHITE);
+            for (const auto& text : texts) {
+                double width, height;
+                gc->GetTextExtent(text.second, &width, &height);
+                Store(lang, text.first, baseFont, scale, width, height);
+            }
+        }
+    }
+    
+private:
+    typedef std::tuple<int, wxString, int, int> Key;
+    std::map<Key, std::pair<double, double>> m_sizes;
+    
+    static Key MakeKey(Language lang, const wxString& key, const wxFont& baseFont, double scale) {
+        return Key(static_cast<int>(lang), key, baseFont.GetPointSize(), static_cast<int>(scale * 100 + 0.5));
+    }
+};
+
 wxDECLARE_EVENT(wxEVT_TILE_CLICKED, wxCommandEvent);
 wxDEFINE_EVENT(wxEVT_TILE_CLICKED, wxCommandEvent);
 
 wxDECLARE_EVENT(wxEVT_TAB_CHANGED, wxCommandEvent);
 wxDEFINE_EVENT(wxEVT_TAB_CHANGED, wxCommandEvent);
 
-wxDECLARE_EVENT(wxEVT_SOCKET_CMD, wxCommandEvent);
-wxDEFINE_EVENT(wxEVT_SOCKET_CMD, wxCommandEvent);
+// 遥控命令：String 为命令，Int 为客户端 id，Payload<long long> 为序号（无序号时为 -1）
+wxDECLARE_EVENT(wxEVT_SOCKET_CMD, wxThreadEvent);
+wxDEFINE_EVENT(wxEVT_SOCKET_CMD, wxThreadEvent);
+
+wxDECLARE_EVENT(wxEVT_REPLAY_DONE, wxCommandEvent);
+wxDEFINE_EVENT(wxEVT_REPLAY_DONE, wxCommandEvent);
+
+wxDECLARE_EVENT(wxEVT_VIDEO_FRAME, wxCommandEvent);
+wxDEFINE_EVENT(wxEVT_VIDEO_FRAME, wxCommandEvent);
+
+wxDECLARE_EVENT(wxEVT_SOURCE_THUMBNAIL, wxCommandEvent);
+wxDEFINE_EVENT(wxEVT_SOURCE_THUMBNAIL, wxCommandEvent);
+
+wxDECLARE_EVENT(wxEVT_CHANNEL_LOGO, wxCommandEvent);
+wxDEFINE_EVENT(wxEVT_CHANNEL_LOGO, wxCommandEvent);
 
 
+// Tile 文本字号相对窗口字体的缩放：有图标时文本较小
+const double kTileIconTextScale = 1.0;
+const double kTileTextScale = 1.3;
+// 缩略图四周露出的卡片宽度：选中时的渐变色作为边框
+const int kTileThumbnailInset = 3;
+
 class TileButton : public wxPanel
 {
 public:
     TileButton(wxWindow* parent, wxWindowID id, const wxString& textKey)
         : wxPanel(parent, id, wxDefaultPosition, wxDefaultSize, wxBORDER_NONE)
         , m_textKey(textKey)
+        , m_literal(false)
         , m_highlighted(false)
         , m_checked(false)
         , m_hover(false)
@@ -156,6 +295,28 @@ public:
         Refresh();
     }
 
+    // 显示缩略图代替图标（传入空位图恢复图标）。位图应不大于 ThumbnailSize，绘制时不再缩放、居中贴出
+    void SetThumbnail(const wxBitmap& bitmap)
+    {
+        m_thumbnail = bitmap;
+        Refresh(false);
+    }
+
+    // 在图标位置显示台标；台标还没有时（空位图）显示 placeholder 文本占位，两者都空时按无图标布局
+    void SetLogo(const wxBitmap& logo, const wxString& placeholder)
+    {
+        m_logo = logo;
+        m_logoPlaceholder = placeholder;
+        Refresh(false);
+    }
+
+    // 缩略图框：图块去掉边距后的区域。SourceThumbnailer 按各信号源的宽高比把画面缩放到框内
+    wxSize ThumbnailSize() const
+    {
+        wxSize size = GetClientSize();
+        return wxSize(wxMax(size.x - 16 - 2 * kTileThumbnailInset, 1), wxMax(size.y - 16 - 2 * kTileThumbnailInset, 1));
+    }
+
     void SetHighlighted(bool highlighted) 
     { 
         if (m_highlighted != highlighted) {
@@ -176,20 +337,45 @@ public:
         Refresh();  // 重绘以显示新语言
     }
     
+    // 虚拟条带复用 Tile 时更换显示的文本
+    void SetTextKey(const wxString& textKey)
+    {
+        if (m_textKey != textKey) {
+            m_textKey = textKey;
+            Refresh();
+        }
+    }
+    
+    // 文本键本身就是要显示的文本（如频道名这类数据驱动的标签）：不查翻译，也不进文本尺寸缓存，
+    // 否则滚过的每个频道都会在两个缓存里各留一项
+    void SetLiteral(bool literal)
+    {
+        if (m_literal != literal) {
+            m_literal = literal;
+            Refresh();
+        }
+    }
+
     bool IsHighlighted() const { return m_highlighted; }
     bool IsChecked() const { return m_checked; }
     wxString GetTextKey() const { return m_textKey; }
 
 private:
     wxString m_textKey;  // 存储文本键而不是直接文本
+    bool m_literal;      // m_textKey 按原文显示
     wxString m_icon;
     wxBitmapBundle m_iconSvg;
+    wxBitmap m_thumbnail;
+    wxBitmap m_logo;
+    wxString m_logoPlaceholder;
     bool m_highlighted;
     bool m_checked;
     bool m_hover;
     
     void OnPaint(wxPaintEvent& evt)
     {
+        StartupPaintScope startupPaint(this, "paint TileButton");
+        ALLOC_SCOPE(Paint);
         wxAutoBufferedPaintDC dc(this);
         wxGraphicsContext* gc = wxGraphicsContext::Create(dc);
         if (!gc) return;
@@ -220,6 +406,13 @@ private:
         
         gc->SetPen(*wxTRANSPARENT_PEN);
         gc->DrawRoundedRectangle(x, y, w, h, radius);
+
+        const bool hasThumbnail = m_thumbnail.IsOk();
+        if (hasThumbnail) {
+            // 缩略图居中贴在卡片内
+            gc->DrawBitmap(m_thumbnail, x + (w - m_thumbnail.GetWidth()) / 2, y + (h - m_thumbnail.GetHeight()) / 2,
+                           m_thumbnail.GetWidth(), m_thumbnail.GetHeight());
+        }
         
         if (m_checked) {
             double checkSize = 20;
@@ -237,13 +430,20 @@ private:
             gc->StrokePath(path);
         }
 
-        const bool hasIcon = m_iconSvg.IsOk() || !m_icon.IsEmpty();
-        double textScale = hasIcon ? 1.0 : 1.3;
+        const bool hasLogo = !hasThumbnail && (m_logo.IsOk() || !m_logoPlaceholder.IsEmpty());
+        const bool hasIcon = hasLogo || (!hasThumbnail && (m_iconSvg.IsOk() || !m_icon.IsEmpty()));
+        double textScale = hasIcon ? kTileIconTextScale : kTileTextScale;
         wxFont textFont = GetFont().Bold().Scale(textScale);
-        wxString displayText = TR(m_textKey);
+        wxString displayText = m_literal ? m_textKey : TR(m_textKey);
         gc->SetFont(textFont, m_highlighted ? Theme::TextSelected : Theme::TextNormal);
         double tw, th;
-        gc->GetTextExtent(displayText, &tw, &th);
+        Language language = LanguageManager::Instance().GetLanguage();
+        if (m_literal) {
+            gc->GetTextExtent(displayText, &tw, &th);
+        } else if (!TextMetrics::Instance().Find(language, m_textKey, GetFont(), textScale, tw, th)) {
+            gc->GetTextExtent(displayText, &tw, &th);
+            TextMetrics::Instance().Store(language, m_textKey, GetFont(), textScale, tw, th);
+        }
 
         int topPad     = hasIcon ? 8  : 12;
         int bottomPad  = hasIcon ? 10 : 15;
@@ -263,8 +463,23 @@ private:
         int iconW = iconH;
         int iconX = static_cast<int>(x + (w - iconW) / 2);
         
-        // 5. 绘制图标（如果有足够空间）
-        if (hasIcon && iconH > 0) {
+        // 5. 绘制图标（如果有足够空间）；台标可以比图标宽，超出可用空间时等比缩小
+        if (hasLogo && iconH > 0) {
+            if (m_logo.IsOk()) {
+                double fit = wxMin(1.0, wxMin((w - 16) / m_logo.GetWidth(), static_cast<double>(iconH) / m_logo.GetHeight()));
+                double lw = m_logo.GetWidth() * fit;
+                double lh = m_logo.GetHeight() * fit;
+                gc->DrawBitmap(m_logo, x + (w - lw) / 2, iconTopY + (iconH - lh) / 2, lw, lh);
+            } else {
+                wxFont placeholderFont = GetFont().Bold().Scale(1.4);
+                gc->SetFont(placeholderFont, m_highlighted ? Theme::TextSelected : Theme::TextNormal);
+                double ptw, pth;
+                gc->GetTextExtent(m_logoPlaceholder, &ptw, &pth);
+                gc->Clip(x + 8, iconTopY, w - 16, iconH);
+                gc->DrawText(m_logoPlaceholder, x + wxMax((w - ptw) / 2, 8.0), iconTopY + (iconH - pth) / 2);
+                gc->ResetClip();
+            }
+        } else if (hasIcon && iconH > 0) {
             if (m_iconSvg.IsOk()) {
                 wxBitmap bmp = m_iconSvg.GetBitmap(wxSize(iconW, iconH));
                 if (bmp.IsOk()) gc->DrawBitmap(bmp, iconX, iconTopY, iconW, iconH);
@@ -277,8 +492,14 @@ private:
             }
         }
         
-        // 6. 绘制文本
-        gc->SetFont(textFont, m_highlighted ? Theme::TextSelected : Theme::TextNormal);
+        // 6. 绘制文本（在缩略图上时先垫一条半透明底）
+        if (hasThumbnail) {
+            gc->SetPen(*wxTRANSPARENT_PEN);
+            gc->SetBrush(wxBrush(wxColour(0, 0, 0, 140)));
+            gc->DrawRectangle(x + kTileThumbnailInset, textY - 4, w - 2 * kTileThumbnailInset,
+                              y + h - kTileThumbnailInset - (textY - 4));
+        }
+        gc->SetFont(textFont, m_highlighted || hasThumbnail ? Theme::TextSelected : Theme::TextNormal);
         gc->DrawText(displayText, x + (w - tw) / 2, textY);
     }
     
@@ -356,11 +577,18 @@ public:
     }
     
     void UpdateLanguage() {
-        // 更新所有标签的文本
+        // 只改动文本变了的标签，都没变时不重新布局
+        bool changed = false;
         for (size_t i = 0; i < m_tabs.size(); i++) {
-            m_tabs[i]->SetLabel(TR(m_tabKeys[i]));
+            wxString label = TR(m_tabKeys[i]);
+            if (m_tabs[i]->GetLabel() != label) {
+                m_tabs[i]->SetLabel(label);
+                changed = true;
+            }
+        }
+        if (changed) {
+            Layout();
         }
-        Layout();
     }
     
     int GetSelectedIndex() const { return m_selectedIndex; }
@@ -396,14 +624,254 @@ private:
 };
 
 
+// 虚拟化 Tile 条带：只为可见项（加少量预留）创建 TileButton，滚动时复用，
+// 项数再多 Tile 数量与绘制开销也不变
+class VirtualTileStrip : public wxPanel
+{
+public:
+    // 第 i 项显示的文本键；literal 条带中为直接显示的文本
+    typedef std::function<wxString(size_t)> ItemLabelFunc;
+    // 取第 i 项的台标，没有台标时 logo 为空位图、placeholder 为占位文本；返回 false 表示台标还在解码
+    typedef std::function<bool(size_t, wxBitmap&, wxString&)> ItemLogoFunc;
+    // 绑定的项区间 [first, last) 变化后调用，用于预取区间两侧的台标
+    typedef std::function<void(size_t, size_t)> ItemRangeFunc;
+    
+    VirtualTileStrip(wxWindow* parent, size_t itemCount, const ItemLabelFunc& itemLabel, const wxSize& tileSize,
+                     bool literal)
+        : wxPanel(parent, wxID_ANY)
+        , m_itemLabel(itemLabel)
+        , m_literal(literal)
+        , m_tileSize(tileSize)
+        , m_strip(itemCount, tileSize.x + kGap, kOverscan)
+        , m_selected(-1)
+        , m_checked(-1)
+        , m_placedOffset(-1)
+    {
+        SetBackgroundColour(Theme::Background);
+        SetMinSize(wxSize(-1, tileSize.y + 2 * kMargin));
+        
+        Bind(wxEVT_SIZE, &VirtualTileStrip::OnSize, this);
+        Bind(wxEVT_MOUSEWHEEL, &VirtualTileStrip::OnMouseWheel, this);
+    }
+    
+    size_t GetItemCount() const { return m_strip.GetItemCount(); }
+    const std::vector<TileButton*>& GetTiles() const { return m_pool; }
+    
+    // 各项显示台标：绑定 Tile 时取台标，区间变化时通知 onRange
+    void SetItemLogos(const ItemLogoFunc& itemLogo, const ItemRangeFunc& onRange)
+    {
+        m_itemLogo = itemLogo;
+        m_onRange = onRange;
+        for (size_t slot = 0; slot < m_pool.size(); ++slot) {
+            size_t item = m_strip.SlotItem(slot);
+            if (item != VirtualStrip::kNone) BindLogo(slot, item);
+        }
+        NotifyRange();
+    }
+    
+    // 有台标解码好了：还在等台标的 Tile 再取一次
+    void RefreshLogos()
+    {
+        if (!m_itemLogo)
+            return;
+        for (size_t slot = 0; slot < m_pool.size(); ++slot) {
+            size_t item = m_strip.SlotItem(slot);
+            if (item != VirtualStrip::kNone && slot < m_logoPending.size() && m_logoPending[slot]) BindLogo(slot, item);
+        }
+    }
+    
+    // 数据被替换：按新的项数重新绑定所有 Tile（文字、台标重新取），滚动位置尽量保持
+    void SetItemCount(size_t count)
+    {
+        m_strip.SetItemCount(count);
+        while (m_pool.size() < m_strip.GetPoolSize()) {
+            CreateTile();
+        }
+        for (size_t slot = m_strip.GetPoolSize(); slot < m_pool.size(); ++slot) {
+            m_pool[slot]->Hide();
+        }
+        if (m_selected >= static_cast<int>(count)) m_selected = -1;
+        if (m_checked >= static_cast<int>(count)) m_checked = -1;
+        m_placedOffset = -1;
+        Sync();
+    }
+    
+    // 高亮 index 并滚动到可见，-1 清除高亮
+    void SetSelection(int index)
+    {
+        m_selected = index;
+        if (index >= 0) {
+            m_strip.EnsureVisible(index);
+        }
+        Sync();
+    }
+    
+    // 与普通页面一致的单选勾选：再次勾选同一项则取消
+    bool ToggleChecked(int index)
+    {
+        m_checked = (m_checked == index) ? -1 : index;
+        Sync();
+        return m_checked == index;
+    }
+    
+    void SetChecked(int index)
+    {
+        m_checked = index;
+        Sync();
+    }
+    
+    // 确保 index 已绑定到某个 Tile 并返回该 Tile
+    TileButton* BringIntoView(int index)
+    {
+        if (index < 0 || index >= static_cast<int>(GetItemCount()))
+            return nullptr;
+        m_strip.EnsureVisible(index);
+        Sync();
+        size_t slot = m_strip.SlotOf(index);
+        return slot < m_pool.size() ? m_pool[slot] : nullptr;
+    }
+    
+    int FindItem(TileButton* tile) const
+    {
+        for (size_t slot = 0; slot < m_pool.size(); ++slot) {
+            if (m_pool[slot] == tile) {
+                size_t item = m_strip.SlotItem(slot);
+                return item == VirtualStrip::kNone ? -1 : static_cast<int>(item);
+            }
+        }
+        return -1;
+    }
+    
+private:
+    static const int kMargin = 5;
+    static const int kGap = 10;
+    static const int kOverscan = 2;
+    
+    ItemLabelFunc m_itemLabel;
+    bool m_literal;                     // 标签是数据而不是文本键
+    ItemLogoFunc m_itemLogo;
+    ItemRangeFunc m_onRange;
+    std::vector<bool> m_logoPending;    // 各槽的 Tile 是否还在等台标
+    wxSize m_tileSize;
+    VirtualStrip m_strip;
+    std::vector<TileButton*> m_pool;
+    std::vector<VirtualStrip::Binding> m_rebinds;
+    int m_selected;
+    int m_checked;
+    int m_placedOffset;     // 上次摆放 Tile 时的滚动位置
+    
+    void OnSize(wxSizeEvent& evt)
+    {
+        evt.Skip();
+        // 末尾 Tile 后的间隔可以超出视口
+        m_strip.SetViewport(GetClientSize().x - 2 * kMargin + kGap);
+        while (m_pool.size() < m_strip.GetPoolSize()) {
+            CreateTile();
+        }
+        m_placedOffset = -1;
+        Sync();
+    }
+    
+    void OnMouseWheel(wxMouseEvent& evt)
+    {
+        int steps = evt.GetWheelRotation() / wxMax(1, evt.GetWheelDelta());
+        m_strip.ScrollBy(-steps * m_strip.GetPitch());
+        Sync();
+    }
+    
+    void CreateTile()
+    {
+        TileButton* tile = new TileButton(this, 2000 + static_cast<int>(m_pool.size()), wxEmptyString);
+        tile->SetLiteral(m_literal);
+        tile->SetMinSize(m_tileSize);
+        tile->SetMaxSize(m_tileSize);
+        tile->SetSize(m_tileSize);
+        tile->Hide();
+        
+        tile->Bind(wxEVT_TILE_CLICKED, [this, tile](wxCommandEvent& evt) {
+            int item = FindItem(tile);
+            if (item >= 0) {
+                SetSelection(item);
+            }
+            evt.Skip();  // 让事件继续传播到 MyFrame
+        });
+        m_pool.push_back(tile);
+    }
+    
+    // 按滚动位置重新绑定移出窗口的槽，并同步所有可见 Tile 的位置与状态
+    void Sync()
+    {
+        bool moved = m_strip.GetOffset() != m_placedOffset;
+        m_placedOffset = m_strip.GetOffset();
+        
+        m_strip.Update(m_rebinds);
+        for (const auto& binding : m_rebinds) {
+            TileButton* tile = m_pool[binding.slot];
+            if (binding.item == VirtualStrip::kNone) {
+                tile->Hide();
+                continue;
+            }
+            tile->SetTextKey(m_itemLabel(binding.item));
+            if (m_itemLogo) BindLogo(binding.slot, binding.item);
+            if (!moved) {
+                tile->Move(kMargin + m_strip.ItemPosition(binding.item), kMargin);
+            }
+            tile->Show();
+        }
+        
+        for (size_t slot = 0; slot < m_pool.size(); ++slot) {
+            size_t item = m_strip.SlotItem(slot);
+            if (item == VirtualStrip::kNone)
+                continue;
+            TileButton* tile = m_pool[slot];
+            tile->SetHighlighted(static_cast<int>(item) == m_selected);
+            tile->SetChecked(static_cast<int>(item) == m_checked);
+            if (moved) {
+                tile->Move(kMargin + m_strip.ItemPosition(item), kMargin);
+            }
+        }
+        if (!m_rebinds.empty()) NotifyRange();
+    }
+    
+    void BindLogo(size_t slot, size_t item)
+    {
+        wxBitmap logo;
+        wxString placeholder;
+        if (m_logoPending.size() < m_pool.size()) m_logoPending.resize(m_pool.size(), false);
+        m_logoPending[slot] = !m_itemLogo(item, logo, placeholder);
+        m_pool[slot]->SetLogo(logo, placeholder);
+    }
+    
+    void NotifyRange()
+    {
+        if (!m_onRange || m_strip.GetPoolSize() == 0)
+            return;
+        size_t first, last;
+        m_strip.GetRange(first, last);
+        m_onRange(first, last);
+    }
+};
+
+
 class ContentPage : public wxPanel
 {
 public:
     ContentPage(wxWindow* parent, const std::vector<wxString>& itemKeys, const std::vector<wxString>& iconSvgPaths = {}, const wxSize& tileSize = wxSize(150, 60))
         : wxPanel(parent, wxID_ANY)
+        , m_strip(nullptr)
+        , m_textLanguage(LanguageManager::Instance().GetLanguage())
+        , m_layoutLanguage(Language::English)
+        , m_layoutValid(false)
     {
         SetBackgroundColour(Theme::Background);
         
+        // 项数很多时改用虚拟条带，只创建可见的 Tile
+        if (itemKeys.size() > kVirtualizeThreshold) {
+            std::vector<wxString> keys = itemKeys;
+            CreateStrip(keys.size(), [keys](size_t i) { return keys[i]; }, tileSize, false);
+            return;
+        }
+        
         // 使用 GridSizer，1行N列，和 TabBar 一样的对齐方式
         int numItems = itemKeys.size();
         wxGridSizer* sizer = new wxGridSizer(1, numItems, 0, 10);
@@ -418,6 +886,7 @@ public:
             if(!iconSvgPaths.empty() && i < iconSvgPaths.size()) {
                 const wxString& svg = iconSvgPaths[i];
                 if(!svg.IsEmpty()) {
+                    StartupPhase phase("LoadSvg");
                     tile->SetIconSvg(wxBitmapBundle::FromSVGFile(svg, wxSize(1024, 1024)));
                 }
             }
@@ -435,17 +904,155 @@ public:
         
     }
     
+    // 数据驱动的页面（如频道列表）：总是使用虚拟条带，文本按需生成、按原文显示
+    ContentPage(wxWindow* parent, size_t itemCount, const VirtualTileStrip::ItemLabelFunc& itemLabel, const wxSize& tileSize)
+        : wxPanel(parent, wxID_ANY)
+        , m_strip(nullptr)
+        , m_textLanguage(LanguageManager::Instance().GetLanguage())
+        , m_layoutLanguage(Language::English)
+        , m_layoutValid(false)
+    {
+        SetBackgroundColour(Theme::Background);
+        CreateStrip(itemCount, itemLabel, tileSize, true);
+    }
+    
     void UpdateLanguage() {
         // 更新所有 TileButton 的语言
-        for (auto tile : m_tiles) {
+        for (auto tile : GetTiles()) {
             tile->UpdateLanguage();
         }
     }
     
-    const std::vector<TileButton*>& GetTiles() const { return m_tiles; }
+    // 切换语言时隐藏的页面不立即更新，显示前发现文本语言过期再重绘 Tile
+    void EnsureLanguage(Language language) {
+        if (m_textLanguage == language)
+            return;
+        m_textLanguage = language;
+        UpdateLanguage();
+    }
+    
+    // 虚拟条带各项显示台标（普通页面不支持）
+    void SetItemLogos(const VirtualTileStrip::ItemLogoFunc& itemLogo, const VirtualTileStrip::ItemRangeFunc& onRange)
+    {
+        if (m_strip) m_strip->SetItemLogos(itemLogo, onRange);
+    }
+    
+    void RefreshLogos()
+    {
+        if (m_strip) m_strip->RefreshLogos();
+    }
+    
+    // 数据驱动的页面换了数据（普通页面不支持）
+    void SetItemCount(size_t count)
+    {
+        if (m_strip) m_strip->SetItemCount(count);
+    }
+    
+    // 已创建的 Tile；虚拟条带只含当前复用的那几个
+    const std::vector<TileButton*>& GetTiles() const { return m_strip ? m_strip->GetTiles() : m_tiles; }
+    
+    size_t GetItemCount() const { return m_strip ? m_strip->GetItemCount() : m_tiles.size(); }
+    
+    // 高亮第 index 项，-1 清除高亮
+    void SetSelection(int index)
+    {
+        if (m_strip) {
+            m_strip->SetSelection(index);
+            return;
+        }
+        for (size_t i = 0; i < m_tiles.size(); ++i) {
+            m_tiles[i]->SetHighlighted(static_cast<int>(i) == index);
+        }
+    }
+    
+    // 单选勾选第 index 项，返回勾选后是否为选中状态
+    bool ToggleChecked(int index)
+    {
+        if (index < 0 || index >= static_cast<int>(GetItemCount()))
+            return false;
+        if (m_strip)
+            return m_strip->ToggleChecked(index);
+        
+        TileButton* target = m_tiles[index];
+        if (target->IsChecked()) {
+            target->SetChecked(false);
+            return false;
+        }
+        
+        for (size_t i = 0; i < m_tiles.size(); ++i) {
+            m_tiles[i]->SetChecked(static_cast<int>(i) == index);
+        }
+        return true;
+    }
+    
+    // 直接设置勾选项（-1 全部取消），用于恢复保存的状态
+    void SetChecked(int index)
+    {
+        if (m_strip) {
+            m_strip->SetChecked(index);
+            return;
+        }
+        for (size_t i = 0; i < m_tiles.size(); ++i) {
+            m_tiles[i]->SetChecked(static_cast<int>(i) == index);
+        }
+    }
+    
+    // 按下第 index 项（与鼠标点击走同一条事件路径）
+    void ActivateItem(int index)
+    {
+        if (index < 0 || index >= static_cast<int>(GetItemCount()))
+            return;
+        TileButton* tile = m_strip ? m_strip->BringIntoView(index) : m_tiles[index];
+        if (!tile)
+            return;
+        wxCommandEvent clickEvent(wxEVT_TILE_CLICKED, tile->GetId());
+        clickEvent.SetEventObject(tile);
+        tile->GetEventHandler()->ProcessEvent(clickEvent);
+    }
+    
+    // Tile 当前对应的项，不属于本页时返回 -1
+    int FindItem(TileButton* tile) const
+    {
+        if (m_strip)
+            return m_strip->FindItem(tile);
+        for (size_t i = 0; i < m_tiles.size(); ++i) {
+            if (m_tiles[i] == tile)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // 按 (尺寸, 语言) 缓存布局，输入未变时切换到本页不再重新计算 sizer
+    void EnsureLayout(const wxSize& size, Language language)
+    {
+        if (m_layoutValid && m_layoutSize == size && m_layoutLanguage == language)
+            return;
+
+        SetSize(0, 0, size.x, size.y);
+        Layout();
+        m_layoutSize = size;
+        m_layoutLanguage = language;
+        m_layoutValid = true;
+    }
 
 private:
+    static const size_t kVirtualizeThreshold = 32;
+    
     std::vector<TileButton*> m_tiles;
+    VirtualTileStrip* m_strip;
+    Language m_textLanguage;
+    wxSize m_layoutSize;
+    Language m_layoutLanguage;
+    bool m_layoutValid;
+    
+    void CreateStrip(size_t itemCount, const VirtualTileStrip::ItemLabelFunc& itemLabel, const wxSize& tileSize,
+                     bool literal)
+    {
+        m_strip = new VirtualTileStrip(this, itemCount, itemLabel, tileSize, literal);
+        wxBoxSizer* stripSizer = new wxBoxSizer(wxVERTICAL);
+        stripSizer->Add(m_strip, 0, wxEXPAND);
+        SetSizer(stripSizer);
+    }
     
     void OnTileClicked(TileButton* clicked)
     {
@@ -455,15 +1062,101 @@ private:
     }
 };
 
+// 页面描述：页面在首次显示时才按描述创建
+struct PageSpec
+{
+    PageSpec(const std::vector<wxString>& itemKeys, const std::vector<wxString>& iconSvgPaths = {}, const wxSize& size = wxSize(150, 60))
+        : keys(itemKeys)
+        , icons(iconSvgPaths)
+        , tileSize(size)
+        , itemCount(0)
+        , checkedItem(-1)
+    {
+    }
+
+    // 数据驱动的页面：itemCount 项，文本由 itemLabel 按需生成
+    PageSpec(size_t count, const VirtualTileStrip::ItemLabelFunc& label, const wxSize& size = wxSize(150, 60))
+        : tileSize(size)
+        , itemCount(count)
+        , itemLabel(label)
+        , checkedItem(-1)
+    {
+    }
+
+    std::vector<wxString> keys;
+    std::vector<wxString> icons;
+    wxSize tileSize;
+    size_t itemCount;
+    VirtualTileStrip::ItemLabelFunc itemLabel;
+    int checkedItem;    // 勾选的项，页面创建时恢复
+};
+
+// 命令管线统计（server 线程与主线程共享）
+struct CommandStats {
+    std::atomic<unsigned long long> received{0};   // server 线程收到的命令数
+    std::atomic<unsigned long long> handled{0};    // OnSocketCommand 处理完的命令数
+    std::atomic<unsigned long long> acked{0};      // 已回 ACK 的命令数
+    std::atomic<unsigned long long> rejected{0};   // 超长或无法识别而丢弃的行
+    std::atomic<int> clients{0};                   // 当前连接数
+    std::atomic<unsigned long long> disconnects{0};  // 累计断开的连接数
+
+    // 已投递但主线程尚未处理的命令数
+    unsigned long long Pending() const {
+        unsigned long long r = received.load(), h = handled.load();
+        return r > h ? r - h : 0;
+    }
+
+    std::string Format() const {
+        return "STATS received=" + std::to_string(received.load()) +
+               " handled=" + std::to_string(handled.load()) +
+               " pending=" + std::to_string(Pending()) +
+               " acked=" + std::to_string(acked.load()) +
+               " rejected=" + std::to_string(rejected.load()) +
+               " clients=" + std::to_string(clients.load()) +
+               " disconnects=" + std::to_string(disconnects.load()) +
+#ifdef TV_ALLOC_STATS
+               AllocStats::Format() +
+#endif
+               "\n";
+    }
+};
+
 // Socket Server 线程 - 接收遥控器命令
+// 支持多个客户端同时连接（遥控器 + loadgen），命令按行分帧
 class RemoteServerThread : public wxThread
 {
 public:
-    RemoteServerThread(wxEvtHandler* handler) 
+    RemoteServerThread(wxEvtHandler* handler, CommandStats* stats) 
         : wxThread(wxTHREAD_DETACHED)
         , m_handler(handler)
+        , m_stats(stats)
         , m_serverSocket(INVALID_SOCKET)
+        , m_nextClientId(1)
+    {
+    }
+
+    // 开始录制收到的命令，recorder 所有权转交给线程
+    void SetRecorder(CommandLogWriter* recorder)
+    {
+        wxCriticalSectionLocker lock(m_recorderLock);
+        m_recorder.reset(recorder);
+    }
+
+    // 主线程处理完带序号的命令后调用，回 ACK 给对应客户端。客户端 socket 是非阻塞的，
+    // 对方不读导致发送缓冲满时不等待，交给 server 线程断开该客户端，UI 线程不会被卡住
+    void SendAck(int clientId, long long seq)
     {
+        wxCriticalSectionLocker lock(m_clientsLock);
+        for (const auto& client : m_clients) {
+            if (client.id == clientId) {
+                if (RemoteLink::SendAll(client.socket, "ACK " + std::to_string(seq) + "\n")) {
+                    ++m_stats->acked;
+                } else {
+                    m_droppedClients.push_back(clientId);
+                }
+                return;
+            }
+        }
     }
 
 protected:
@@ -493,7 +1186,7 @@ protected:
         // 绑定端口
         sockaddr_in addr = {0};
         addr.sin_family = AF_INET;
-        addr.sin_port = htons(5050);
+        addr.sin_port = htons(RemoteLink::kPort);
         addr.sin_addr.s_addr = INADDR_ANY;
 
         if (bind(m_serverSocket, (sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR) {
@@ -505,7 +1198,7 @@ protected:
         }
 
         // 监听
-        if (listen(m_serverSocket, 1) == SOCKET_ERROR) {
+        if (listen(m_serverSocket, SOMAXCONN) == SOCKET_ERROR) {
             closesocket(m_serverSocket);
 #ifdef _WIN32
             WSACleanup();
@@ -515,85 +1208,88 @@ protected:
 
         // wxLogMessage(wxString::FromUTF8("遥控器服务已启动，监听端口 5050..."));
 
-        // 主循环：接受连接并处理
+        // 主循环：同时等待新连接和所有客户端的数据
+        char buffer[4096];
         while (!TestDestroy()) {
-            // 使用 select 等待连接（带超时，避免阻塞太久）
+            CloseDroppedClients();
             fd_set readfds;
             FD_ZERO(&readfds);
             FD_SET(m_serverSocket, &readfds);
+            SOCKET maxSocket = m_serverSocket;
+            for (const auto& client : m_clients) {
+                FD_SET(client.socket, &readfds);
+                if (client.socket > maxSocket) maxSocket = client.socket;
+            }
             
             timeval timeout;
             timeout.tv_sec = 1;  // 1秒超时，定期检查 TestDestroy()
             timeout.tv_usec = 0;
             
-            int sel = select(0, &readfds, nullptr, nullptr, &timeout);
+            int sel = select(static_cast<int>(maxSocket) + 1, &readfds, nullptr, nullptr, &timeout);
             
-            // 超时或出错，继续循环
-            if (sel <= 0) {
+            if (sel < 0) {
+                wxLogMessage(wxString::FromUTF8("Socket 错误，断开所有连接"));
+                CloseAllClients();
                 continue;
             }
             
-            // 有新连接
-            sockaddr_in clientAddr;
-            socklen_t clientLen = sizeof(clientAddr);
-            SOCKET clientSocket = accept(m_serverSocket, (sockaddr*)&clientAddr, &clientLen);
+            // 超时，继续循环（这样可以检查 TestDestroy()）
+            if (sel == 0) {
+                continue;
+            }
             
-            if (clientSocket == INVALID_SOCKET) {
-                continue;  // 接受失败，继续等待下一个
+            // 有新连接（FD_SETSIZE 以内）
+            if (FD_ISSET(m_serverSocket, &readfds)) {
+                sockaddr_in clientAddr;
+                socklen_t clientLen = sizeof(clientAddr);
+                SOCKET clientSocket = accept(m_serverSocket, (sockaddr*)&clientAddr, &clientLen);
+                if (clientSocket != INVALID_SOCKET) {
+                    if (m_clients.size() + 1 >= FD_SETSIZE) {
+                        closesocket(clientSocket);
+                    } else {
+                        int nodelay = 1;
+                        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+                        RemoteLink::SetNonBlocking(clientSocket, true);
+                        wxCriticalSectionLocker lock(m_clientsLock);
+                        m_clients.push_back(Client{m_nextClientId++, clientSocket, std::string()});
+                        ++m_stats->clients;
+                        // wxLogMessage(wxString::FromUTF8("遥控器已连接！"));
+                    }
+                }
             }
 
-            // wxLogMessage(wxString::FromUTF8("遥控器已连接！"));
+            // 接收各客户端的命令
+            for (size_t i = 0; i < m_clients.size(); ) {
+                Client& client = m_clients[i];
+                if (!FD_ISSET(client.socket, &readfds)) {
+                    ++i;
+                    continue;
+                }
 
-            // 接收命令循环
-            char buffer[256];
-            while (!TestDestroy()) {
-                // 同样使用 select 检查是否有数据可读（带超时）
-                FD_ZERO(&readfds);
-                FD_SET(clientSocket, &readfds);
-                
-                timeout.tv_sec = 1;  // 1秒超时
-                timeout.tv_usec = 0;
-                
-                sel = select(0, &readfds, nullptr, nullptr, &timeout);
-                
-                if (sel < 0) {
-                    // 出错，断开
-                    wxLogMessage(wxString::FromUTF8("Socket 错误，断开连接"));
-                    break;
-                }
-                
-                if (sel == 0) {
-                    // 超时，继续循环（这样可以检查 TestDestroy()）
+                int n = recv(client.socket, buffer, sizeof(buffer), 0);
+                if (n < 0 && WSAGetLastError() == WSAEWOULDBLOCK) {
+                    ++i;
                     continue;
                 }
-                
-                // 有数据可读
-                int n = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
                 if (n <= 0) {
-                    // 连接关闭或出错
+                    // 连接关闭或出错。loadgen 每次运行都会开关多个连接，只记详细日志，次数见 STATS
                     if (n == 0) {
-                        wxLogMessage(wxString::FromUTF8("遥控器正常断开连接"));
+                        wxLogVerbose(wxString::FromUTF8("遥控器正常断开连接"));
                     } else {
-                        wxLogMessage(wxString::FromUTF8("遥控器异常断开连接"));
+                        wxLogVerbose(wxString::FromUTF8("遥控器异常断开连接"));
                     }
-                    break;
+                    CloseClient(i);
+                    continue;
                 }
-                
-                buffer[n] = 0;
-                wxString cmd(buffer, wxConvUTF8);
-                cmd.Trim();
-
-                // 发送事件到主线程
-                wxCommandEvent* event = new wxCommandEvent(wxEVT_SOCKET_CMD, wxID_ANY);
-                event->SetString(cmd);
-                wxQueueEvent(m_handler, event);
-            }
 
-            closesocket(clientSocket);
-            wxLogMessage(wxString::FromUTF8("等待新的遥控器连接..."));
+                client.pending.append(buffer, n);
+                DispatchLines(client);
+                ++i;
+            }
         }
 
         // 清理
+        CloseAllClients();
         if (m_serverSocket != INVALID_SOCKET) {
             closesocket(m_serverSocket);
         }
@@ -604,10 +1300,186 @@ protected:
     }
 
 private:
+    struct Client {
+        int id;
+        SOCKET socket;
+        std::string pending;  // 尚未凑成整行的数据
+    };
+
     wxEvtHandler* m_handler;
+    CommandStats* m_stats;
     SOCKET m_serverSocket;
+    std::vector<Client> m_clients;   // 仅 server 线程增删，SendAck 在锁内只读
+    std::vector<int> m_droppedClients;  // 回复发不出去、待 server 线程断开的客户端 id
+    wxCriticalSection m_clientsLock;
+    int m_nextClientId;
+    std::unique_ptr<CommandLogWriter> m_recorder;
+    wxCriticalSection m_recorderLock;
+
+    void DispatchLines(Client& client)
+    {
+        // 解析与投递命令的分配算进 Command 作用域（UI 线程处理部分在 OnSocketCommand）
+        ALLOC_TAG(Command);
+        std::string line, key;
+        long long seq;
+        while (RemoteLink::TakeLine(client.pending, line)) {
+            RemoteLink::ParseLine(line, key, seq);
+            if (key.empty()) {
+                continue;
+            }
+            if (key.size() > RemoteLink::kMaxLineLength) {
+                ++m_stats->rejected;
+                continue;
+            }
+            if (key == "STATS") {
+                wxCriticalSectionLocker lock(m_clientsLock);
+                if (!RemoteLink::SendAll(client.socket, m_stats->Format())) {
+                    m_droppedClients.push_back(client.id);
+                }
+                continue;
+            }
+
+            ++m_stats->received;
+            Record(key);
+
+            // 发送事件到主线程，Int 携带客户端 id，Payload 携带完整的 64 位序号
+            wxThreadEvent* event = new wxThreadEvent(wxEVT_SOCKET_CMD, wxID_ANY);
+            event->SetString(wxString(key.c_str(), wxConvUTF8));
+            event->SetInt(client.id);
+            event->SetPayload<long long>(seq);
+            wxQueueEvent(m_handler, event);
+        }
+
+        FlushRecorder();
+
+        // 一直没有换行的超长数据直接丢弃，防止缓冲无限增长
+        if (client.pending.size() > RemoteLink::kMaxLineLength) {
+            client.pending.clear();
+            ++m_stats->rejected;
+        }
+    }
+
+    void Record(const std::string& key)
+    {
+        wxCriticalSectionLocker lock(m_recorderLock);
+        if (m_recorder) m_recorder->Append(key);
+    }
+
+    void FlushRecorder()
+    {
+        wxCriticalSectionLocker lock(m_recorderLock);
+        if (m_recorder) m_recorder->Flush();
+    }
+
+    void CloseClient(size_t index)
+    {
+        wxCriticalSectionLocker lock(m_clientsLock);
+        closesocket(m_clients[index].socket);
+        m_clients.erase(m_clients.begin() + index);
+        --m_stats->clients;
+        ++m_stats->disconnects;
+        if (m_clients.empty()) {
+            wxLogVerbose(wxString::FromUTF8("等待新的遥控器连接..."));
+        }
+    }
+
+    void CloseDroppedClients()
+    {
+        std::vector<int> dropped;
+        {
+            wxCriticalSectionLocker lock(m_clientsLock);
+            dropped.swap(m_droppedClients);
+        }
+        for (int id : dropped) {
+            for (size_t i = 0; i < m_clients.size(); ++i) {
+                if (m_clients[i].id == id) {
+                    wxLogVerbose(wxString::FromUTF8("遥控器不读回复，断开连接"));
+                    CloseClient(i);
+                    break;
+                }
+            }
+        }
+    }
+
+    void CloseAllClients()
+    {
+        while (!m_clients.empty()) {
+            CloseClient(m_clients.size() - 1);
+        }
+    }
+};
+
+// 命令回放线程 - 按录制时间把命令重新投递到 OnSocketCommand
+// speed 为倍速，<= 0 表示尽可能快（作为 UI 热路径的回归基准）
+class CommandReplayThread : public wxThread
+{
+public:
+    CommandReplayThread(wxEvtHandler* handler, CommandStats* stats, const std::string& path, double speed)
+        : wxThread(wxTHREAD_JOINABLE)
+        , m_handler(handler)
+        , m_stats(stats)
+        , m_path(path)
+        , m_speed(speed)
+    {
+    }
+
+protected:
+    virtual ExitCode Entry() override
+    {
+        CommandLogReader reader;
+        if (!reader.Open(m_path)) {
+            wxLogError(wxString::FromUTF8("无法打开命令录制文件: %s"), wxString::FromUTF8(m_path.c_str()));
+            return (ExitCode)0;
+        }
+
+        // 全速回放时限制在途命令数，避免事件队列无限堆积
+        const unsigned long long kMaxPending = 256;
+        const uint64_t kSleepSliceMicros = 10000;
+        const uint64_t start = CommandLog::NowMicros();
+        long count = 0;
+        CommandLog::Record record;
+        while (!TestDestroy() && reader.Next(record)) {
+            if (m_speed > 0) {
+                uint64_t due = start + static_cast<uint64_t>(record.time / m_speed);
+                uint64_t now = CommandLog::NowMicros();
+                // 分段等待，窗口关闭时（Delete）不必等到下一条命令的时间
+                while (due > now && !TestDestroy()) {
+                    wxMicroSleep(std::min<uint64_t>(due - now, kSleepSliceMicros));
+                    now = CommandLog::NowMicros();
+                }
+                if (TestDestroy()) break;
+            } else {
+                while (m_stats->Pending() >= kMaxPending && !TestDestroy()) {
+                    wxMicroSleep(100);
+                }
+            }
+
+            ++m_stats->received;
+            wxThreadEvent* event = new wxThreadEvent(wxEVT_SOCKET_CMD, wxID_ANY);
+            event->SetString(wxString(record.key.c_str(), wxConvUTF8));
+            event->SetPayload<long long>(-1);
+            wxQueueEvent(m_handler, event);
+            ++count;
+        }
+
+        if (TestDestroy()) return (ExitCode)0;
+        // 排在所有命令之后，主线程收到即表示回放处理完毕
+        wxCommandEvent* done = new wxCommandEvent(wxEVT_REPLAY_DONE, wxID_ANY);
+        done->SetInt(count);
+        wxQueueEvent(m_handler, done);
+        return (ExitCode)0;
+    }
+
+private:
+    wxEvtHandler* m_handler;
+    CommandStats* m_stats;
+    std::string m_path;
+    double m_speed;
 };
 
+// 菜单后面的视频层：没有视频时为黑色，播放时显示 VideoPlayer 的最新一帧；启用模拟信号源后改为显示当前信号源的帧，
+// 启用换台画面后显示当前频道的第一帧。
+// 窗口尺寸变化时（MyFrame::UpdateBackgroundLayer 调整本窗口）让播放线程把视频按比例缩放到窗口内，居中显示
 class BackgroundFrame : public wxFrame
 {
 public:
@@ -615,15 +1487,478 @@ public:
         : wxFrame(nullptr, wxID_ANY, wxEmptyString,
                   wxDefaultPosition, size,
                   wxFRAME_NO_TASKBAR | wxBORDER_NONE)
+        , m_frameSequence(0)
+        , m_framePosted(false)
+        , m_reportSwitches(false)
+        , m_thumbnailPosted(false)
+        , m_reportZaps(false)
     {
         SetBackgroundColour(*wxBLACK);
+        SetBackgroundStyle(wxBG_STYLE_PAINT);
+        Bind(wxEVT_PAINT, &BackgroundFrame::OnPaint, this);
+        Bind(wxEVT_SIZE, &BackgroundFrame::OnSize, this);
+        Bind(wxEVT_VIDEO_FRAME, &BackgroundFrame::OnVideoFrame, this);
+        Bind(wxEVT_SOURCE_THUMBNAIL, &BackgroundFrame::OnThumbnail, this);
+    }
+
+    ~BackgroundFrame()
+    {
+        // 播放线程、缩略图线程和信号源线程会向本窗口投递事件，先停掉；缩略图线程用到信号源，先于信号源停
+        m_player.Stop();
+        m_thumbnailer.reset();
+        m_sources.reset();
+        m_zap.reset();
+    }
+
+    // 转换输出直接采用位图原始像素的字节顺序，复制时不必再调换
+    static Yuv::PixelOrder VideoPixelOrder()
+    {
+        return wxAlphaPixelFormat::RED == 0 ? Yuv::PixelOrder::Rgba : Yuv::PixelOrder::Bgra;
+    }
+
+    // 按 VideoPixelOrder 排列、alpha 已预乘的像素复制进位图
+    static void CopyToBitmap(wxBitmap& bitmap, int width, int height, const std::vector<uint8_t>& pixels)
+    {
+        if (!bitmap.IsOk() || bitmap.GetWidth() != width || bitmap.GetHeight() != height) {
+            bitmap.Create(width, height, 32);
+        }
+        wxAlphaPixelData data(bitmap);
+        if (!data)
+            return;
+        // 位图的行可能自底向上存放，按行复制
+        size_t rowBytes = static_cast<size_t>(width) * 4;
+        wxAlphaPixelData::Iterator row(data);
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(&row.Data(), pixels.data() + y * rowBytes, rowBytes);
+            row.OffsetY(data, 1);
+        }
+    }
+
+    bool PlayVideo(const VideoPlayer::Options& options)
+    {
+        m_videoSize = wxSize(options.width, options.height);
+        UpdateVideoSize();
+        return m_player.Start(options, [this] {
+            // 上一帧的事件还没处理时不再投递，UI 忙时直接显示最新一帧
+            if (!m_framePosted.exchange(true)) {
+                wxQueueEvent(this, new wxCommandEvent(wxEVT_VIDEO_FRAME, wxID_ANY));
+            }
+        });
+    }
+
+    VideoPlayer::Stats GetVideoStats() const { return m_player.GetStats(); }
+
+    // 从下一帧起生效
+    void SetPictureMode(Picture::Mode mode)
+    {
+        m_player.SetPictureMode(mode);
+        if (m_sources) m_sources->SetPictureMode(mode);
+    }
+
+    // 启用模拟信号源（此后不再显示 VideoPlayer 的帧）。各源的线程创建后即停着，SwitchSource 后才出帧；
+    // reportSwitches 时每次切换收到第一帧都打印延迟
+    void EnableSources(const std::vector<InputSource::Options>& sources, bool reportSwitches)
+    {
+        m_player.Stop();
+        m_sources.reset(new SourceSwitcher([this] {
+            if (!m_framePosted.exchange(true)) {
+                wxQueueEvent(this, new wxCommandEvent(wxEVT_VIDEO_FRAME, wxID_ANY));
+            }
+        }));
+        for (const InputSource::Options& options : sources) m_sources->Add(options);
+        m_reportSwitches = reportSwitches;
+        if (!sources.empty()) m_videoSize = wxSize(sources[0].width, sources[0].height);
+        UpdateVideoSize();
+    }
+
+    bool HasSources() const { return m_sources != nullptr; }
+    int SourceCount() const { return m_sources ? m_sources->Count() : 0; }
+
+    // 切换信号源，-1 为不选；切换期间黑屏，直到新源的第一帧到达
+    void SwitchSource(int index, SourceSwitcher::Clock::time_point requested)
+    {
+        if (!m_sources)
+            return;
+        m_sources->Switch(index, requested);
+        m_frameBitmap = wxBitmap();
+        Refresh(false);
+    }
+
+    SourceSwitcher::Stats GetSourceStats() const
+    {
+        return m_sources ? m_sources->GetStats() : SourceSwitcher::Stats();
+    }
+
+    // 启用换台画面（此后不再显示 VideoPlayer 的帧）：ZapToChannel 后显示新频道的第一帧，
+    // 预取相邻频道与最近看过的频道；reportZaps 时每次换台都打印到画面就绪的延迟
+    void EnableZap(const ZapPrefetcher::Options& options, bool reportZaps)
+    {
+        m_player.Stop();
+        m_zap.reset(new ZapPrefetcher(options, [this] {
+            if (!m_framePosted.exchange(true)) {
+                wxQueueEvent(this, new wxCommandEvent(wxEVT_VIDEO_FRAME, wxID_ANY));
+            }
+        }));
+        m_reportZaps = reportZaps;
+        m_videoSize = wxSize(options.width, options.height);
+        UpdateVideoSize();
+    }
+
+    bool HasZap() const { return m_zap != nullptr; }
+
+    // 换到 number 频道，neighbours 为预测接下来会切到的频道。缓存命中时立即显示，否则黑屏到画面加载好
+    void ZapToChannel(uint32_t number, const std::vector<uint32_t>& neighbours,
+                      ZapPrefetcher::Clock::time_point requested)
+    {
+        if (!m_zap)
+            return;
+        ZapPrefetcher::FramePtr frame = m_zap->Zap(number, neighbours, requested);
+        if (frame) {
+            CopyToBitmap(m_frameBitmap, frame->width, frame->height, frame->pixels);
+            ReportZap();
+        } else {
+            m_frameBitmap = wxBitmap();
+        }
+        Refresh(false);
+    }
+
+    ZapPrefetcher::Stats GetZapStats() const
+    {
+        return m_zap ? m_zap->GetStats() : ZapPrefetcher::Stats();
+    }
+
+    // 为各信号源生成缩略图（须在 EnableSources 之后），SetThumbnailsActive(true) 后才开始；
+    // 有新缩略图时在 UI 线程中调用 onUpdate，由它 TakeThumbnail
+    void EnableThumbnails(const SourceThumbnailer::Options& options, const std::function<void()>& onUpdate)
+    {
+        if (!m_sources)
+            return;
+        m_onThumbnail = onUpdate;
+        m_thumbnailer.reset(new SourceThumbnailer(*m_sources, options, [this] {
+            if (!m_thumbnailPosted.exchange(true)) {
+                wxQueueEvent(this, new wxCommandEvent(wxEVT_SOURCE_THUMBNAIL, wxID_ANY));
+            }
+        }));
+    }
+
+    // 主窗口销毁前调用，此后不再回调 onUpdate
+    void StopThumbnails()
+    {
+        m_thumbnailer.reset();
+        m_onThumbnail = nullptr;
+    }
+
+    bool HasThumbnails() const { return m_thumbnailer != nullptr; }
+
+    // Source 页不可见时停下，不占 CPU
+    void SetThumbnailsActive(bool active, const wxSize& size)
+    {
+        if (!m_thumbnailer)
+            return;
+        if (active) m_thumbnailer->SetSize(size.x, size.y);
+        m_thumbnailer->SetEnabled(active);
+    }
+
+    // 第 index 个信号源有比 sequence 新的缩略图时转成位图
+    bool TakeThumbnail(int index, uint64_t& sequence, wxBitmap& bitmap)
+    {
+        int width, height;
+        if (!m_thumbnailer || !m_thumbnailer->Take(index, sequence, m_thumbnailPixels, width, height))
+            return false;
+        CopyToBitmap(bitmap, width, height, m_thumbnailPixels);
+        return true;
+    }
+
+    SourceThumbnailer::Stats GetThumbnailStats() const
+    {
+        return m_thumbnailer ? m_thumbnailer->GetStats() : SourceThumbnailer::Stats();
+    }
+
+private:
+    VideoPlayer m_player;
+    wxBitmap m_frameBitmap;
+    wxSize m_videoSize;
+    uint64_t m_frameSequence;
+    std::atomic<bool> m_framePosted;
+    std::unique_ptr<SourceSwitcher> m_sources;
+    bool m_reportSwitches;
+    std::unique_ptr<SourceThumbnailer> m_thumbnailer;
+    std::atomic<bool> m_thumbnailPosted;
+    std::function<void()> m_onThumbnail;
+    std::vector<uint8_t> m_thumbnailPixels;
+    std::unique_ptr<ZapPrefetcher> m_zap;
+    bool m_reportZaps;
+
+    // 保持源的宽高比放进客户区
+    void UpdateVideoSize()
+    {
+        wxSize client = GetClientSize();
+        if (m_videoSize.x <= 0 || m_videoSize.y <= 0 || client.x <= 0 || client.y <= 0) return;
+        int width = client.x;
+        int height = static_cast<int>(static_cast<int64_t>(client.x) * m_videoSize.y / m_videoSize.x);
+        if (height > client.y) {
+            height = client.y;
+            width = static_cast<int>(static_cast<int64_t>(client.y) * m_videoSize.x / m_videoSize.y);
+        }
+        m_player.SetOutputSize(wxMax(width, 1), wxMax(height, 1));
+        if (m_sources) m_sources->SetOutputSize(wxMax(width, 1), wxMax(height, 1));
+        if (m_zap) m_zap->SetOutputSize(wxMax(width, 1), wxMax(height, 1));
+    }
+
+    void OnSize(wxSizeEvent& evt)
+    {
+        UpdateVideoSize();
+        Refresh(false);
+        evt.Skip();
+    }
+
+    void OnVideoFrame(wxCommandEvent& evt)
+    {
+        m_framePosted = false;
+        if (m_zap) {
+            double zapMillis;
+            ZapPrefetcher::FramePtr frame = m_zap->TakeZapFrame(zapMillis);
+            if (!frame)
+                return;
+            CopyToBitmap(m_frameBitmap, frame->width, frame->height, frame->pixels);
+            Refresh(false);
+            ReportZap();
+            return;
+        }
+        if (m_sources) {
+            double switchMillis;
+            std::unique_ptr<SourceFrame> frame = m_sources->TakeLatest(switchMillis);
+            if (!frame)
+                return;
+            CopyToBitmap(m_frameBitmap, frame->width, frame->height, frame->pixels);
+            m_sources->Recycle(std::move(frame));
+            Refresh(false);
+            if (switchMillis >= 0 && m_reportSwitches) {
+                SourceSwitcher::Stats stats = m_sources->GetStats();
+                wxPrintf("source: %s first frame %.1f ms after KEY_OK (average %.1f ms, max %.1f ms over %llu switches)\n",
+                         wxString::FromUTF8(m_sources->At(stats.active).GetOptions().name.c_str()), switchMillis,
+                         stats.averageMillis, stats.maxMillis, static_cast<unsigned long long>(stats.measured));
+            }
+            return;
+        }
+        if (m_player.WithLatestFrame(m_frameSequence, [this](const VideoFrame& frame) {
+                CopyToBitmap(m_frameBitmap, frame.width, frame.height, frame.pixels);
+            })) {
+            Refresh(false);
+        }
+    }
+
+    void ReportZap()
+    {
+        if (!m_reportZaps)
+            return;
+        ZapPrefetcher::Stats stats = m_zap->GetStats();
+        wxPrintf("zap: frame ready %.1f ms after key (%llu/%llu hits avg %.1f ms, misses avg %.1f ms, "
+                 "cache %zu frames %.1f MB)\n",
+                 stats.lastMillis, static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.zaps),
+                 stats.hitMillis, stats.missMillis, stats.cachedFrames, stats.cachedBytes / 1048576.0);
+    }
+
+    void OnThumbnail(wxCommandEvent& evt)
+    {
+        m_thumbnailPosted = false;
+        if (m_onThumbnail) m_onThumbnail();
+    }
+
+    void OnPaint(wxPaintEvent& evt)
+    {
+        wxPaintDC dc(this);
+        wxSize size = GetClientSize();
+        dc.SetBrush(*wxBLACK_BRUSH);
+        dc.SetPen(*wxTRANSPARENT_PEN);
+        if (!m_frameBitmap.IsOk()) {
+            dc.DrawRectangle(0, 0, size.x, size.y);
+            return;
+        }
+        // 居中绘制，四周未覆盖的部分保持黑色。尺寸刚变化时新尺寸的帧还没到，先照旧尺寸居中
+        int width = m_frameBitmap.GetWidth();
+        int height = m_frameBitmap.GetHeight();
+        int left = (size.x - width) / 2;
+        int top = (size.y - height) / 2;
+        dc.DrawBitmap(m_frameBitmap, left, top);
+        if (top > 0) dc.DrawRectangle(0, 0, size.x, top);
+        if (top + height < size.y) dc.DrawRectangle(0, top + height, size.x, size.y - top - height);
+        if (left > 0) dc.DrawRectangle(0, top, left, height);
+        if (left + width < size.x) dc.DrawRectangle(left + width, top, size.x - left - width, height);
+    }
+};
+
+// UI 定时调度器 - 由 MyApp 持有，所有弹窗、动画、按键重复共用一个 wxTimer
+// 内部是分层时间轮，wxTimer 只在最近的期限到达时触发一次，空闲时没有唤醒
+class UiScheduler : public wxEvtHandler
+{
+public:
+    typedef TimerWheel::TimerId TimerId;
+
+    UiScheduler()
+        : m_wheel(NowMs())
+        , m_timer(this)
+    {
+        Bind(wxEVT_TIMER, &UiScheduler::OnTimer, this);
+    }
+
+    ~UiScheduler()
+    {
+        m_timer.Stop();
+    }
+
+    // 一次性回调。这里不推进时间轮（可能正处在某个回调中），期限按当前时间直接算出
+    TimerId Schedule(unsigned delayMs, const TimerWheel::Callback& callback)
+    {
+        TimerId id = m_wheel.ScheduleAt(NowMs() + delayMs, 0, callback);
+        Rearm();
+        return id;
+    }
+
+    // 周期回调，直到 Cancel
+    TimerId ScheduleRepeating(unsigned intervalMs, const TimerWheel::Callback& callback)
+    {
+        if (intervalMs == 0) intervalMs = 1;
+        TimerId id = m_wheel.ScheduleAt(NowMs() + intervalMs, intervalMs, callback);
+        Rearm();
+        return id;
+    }
+
+    // 取消后句柄置 0，可重复调用
+    void Cancel(TimerId& id)
+    {
+        if (id && m_wheel.Cancel(id)) {
+            Rearm();
+        }
+        id = 0;
+    }
+
+    bool IsPending(TimerId id) const { return id && m_wheel.IsPending(id); }
+
+private:
+    TimerWheel m_wheel;
+    wxTimer m_timer;
+
+    // 单调时钟：系统时间被调整时定时器不会提前或推迟
+    static uint64_t NowMs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void Rearm()
+    {
+        uint64_t deadline;
+        if (!m_wheel.NextDeadline(deadline)) {
+            m_timer.Stop();
+            return;
+        }
+        uint64_t now = NowMs();
+        int delay = deadline > now ? static_cast<int>(deadline - now) : 1;
+        m_timer.StartOnce(delay);
+    }
+
+    void OnTimer(wxTimerEvent&)
+    {
+        m_wheel.Advance(NowMs());
+        Rearm();
+    }
+};
+
+// 提示浮层 - 预先创建一次，切换 Tab 时只更新文字并重启定时器，到时淡出隐藏
+class ToastOverlay : public wxFrame
+{
+public:
+    ToastOverlay(wxWindow* parent, UiScheduler* scheduler)
+        : wxFrame(parent, wxID_ANY, wxEmptyString,
+                  wxDefaultPosition, wxSize(300, 100),
+                  wxFRAME_NO_TASKBAR | wxFRAME_TOOL_WINDOW | wxSTAY_ON_TOP | wxBORDER_NONE)
+        , m_scheduler(scheduler)
+        , m_hideTimer(0)
+        , m_fadeTimer(0)
+        , m_alpha(kOpaque)
+    {
+        SetBackgroundColour(Theme::Background);
+
+        wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+        m_text = new wxStaticText(this, wxID_ANY, wxEmptyString);
+        m_text->SetForegroundColour(Theme::TextSelected);
+        m_text->SetFont(GetFont().Bold().Scale(1.2));
+        sizer->AddStretchSpacer();
+        sizer->Add(m_text, 0, wxALL | wxALIGN_CENTER, 20);
+        sizer->AddStretchSpacer();
+        SetSizer(sizer);
+    }
+
+    ~ToastOverlay()
+    {
+        m_scheduler->Cancel(m_hideTimer);
+        m_scheduler->Cancel(m_fadeTimer);
+    }
+
+    // 显示消息；已在显示时只替换文字并重新计时
+    void ShowMessage(const wxString& message)
+    {
+        if (m_text->GetLabel() != message) {
+            m_text->SetLabel(message);
+            Layout();
+        }
+
+        m_scheduler->Cancel(m_fadeTimer);
+        SetAlpha(kOpaque);
+        if (!IsShown()) {
+            Centre();
+            ShowWithoutActivating();  // 不抢焦点，按键仍由菜单处理
+        }
+
+        m_scheduler->Cancel(m_hideTimer);
+        m_hideTimer = m_scheduler->Schedule(kVisibleMs, [this] { StartFade(); });
+    }
+
+private:
+    static const int kVisibleMs = 3000;   // 完全显示 3 秒
+    static const int kFadeStepMs = 30;
+    static const int kFadeStep = 25;      // 每步降低的不透明度，约 300ms 淡出
+    static const int kOpaque = 255;
+
+    wxStaticText* m_text;
+    UiScheduler* m_scheduler;
+    UiScheduler::TimerId m_hideTimer;
+    UiScheduler::TimerId m_fadeTimer;
+    int m_alpha;
+
+    void SetAlpha(int alpha)
+    {
+        if (alpha == m_alpha)
+            return;
+        m_alpha = alpha;
+        if (CanSetTransparent()) {
+            SetTransparent(static_cast<wxByte>(alpha));
+        }
+    }
+
+    void StartFade()
+    {
+        m_hideTimer = 0;
+        m_fadeTimer = m_scheduler->ScheduleRepeating(kFadeStepMs, [this] { FadeStep(); });
+    }
+
+    void FadeStep()
+    {
+        if (m_alpha <= kFadeStep) {
+            m_scheduler->Cancel(m_fadeTimer);
+            Hide();
+            SetAlpha(kOpaque);
+        } else {
+            SetAlpha(m_alpha - kFadeStep);
+        }
     }
 };
 
 class MyFrame : public wxFrame
 {
 public:
-    MyFrame(BackgroundFrame* backgroundFrame) 
+    MyFrame(BackgroundFrame* backgroundFrame, UiScheduler* scheduler) 
         : wxFrame(nullptr, wxID_ANY, TR("window_title"), 
                   wxDefaultPosition, wxSize(750, 205))
         , m_menuVisible(true)
@@ -632,6 +1967,32 @@ public:
         , m_currentTileIndex(0)
         , m_inTabSelectionMode(true)
         , m_backgroundFrame(backgroundFrame)
+        , m_scheduler(scheduler)
+        , m_visiblePage(nullptr)
+        , m_layoutCacheEnabled(true)
+        , m_prebuildTimer(0)
+        , m_channelListPage(-1)
+        , m_logosPosted(false)
+        , m_logoStatsTimer(0)
+        , m_currentNumber(0)
+        , m_zapDirection(1)
+        , m_digitValue(0)
+        , m_digitCount(0)
+        , m_digitTimer(0)
+        , m_scanTimer(0)
+        , m_languagesPending(0)
+        , m_languageTimer(0)
+        , m_scanThreads(0)
+        , m_settingsTimer(0)
+        , m_videoStatsTimer(0)
+        , m_audioStatsTimer(0)
+        , m_thumbnailStatsTimer(0)
+        , m_timeShiftStatsTimer(0)
+        , m_confirmPending(false)
+        , m_exitAfterFirstFrame(false)
+        , m_replayThread(nullptr)
+        , m_replayStart(0)
+        , m_exitAfterReplay(false)
     {
         SetBackgroundColour(Theme::Background);
         
@@ -639,6 +2000,7 @@ public:
         wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
         
         // 1. 顶部 TabBar
+        StartupPhase phase("TabBar");
         m_tabBar = new TabBar(this);
         mainSizer->Add(m_tabBar, 0, wxEXPAND | wxALL, 10);
         
@@ -648,57 +2010,448 @@ public:
         m_contentSizer = new wxBoxSizer(wxVERTICAL);
         m_contentPanel->SetSizer(m_contentSizer);
         mainSizer->Add(m_contentPanel, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 10);
+        m_contentPanel->Bind(wxEVT_SIZE, &MyFrame::OnContentSize, this);
         
-        // 创建各个页面
+        // 登记各个页面，首次显示时才创建
+        phase.Next("CreatePages");
         CreatePages();
         
         // 显示第一个页面
+        phase.Next("ShowPage");
         ShowPage(0, false);
+        phase.End();
         
         // 绑定 Tab 切换事件
         m_tabBar->Bind(wxEVT_TAB_CHANGED, &MyFrame::OnTabChanged, this);
         
-        // 绑定所有页面的 Tile 点击事件
-        BindTileClickEvents();
-        
         // 绑定键盘事件
         Bind(wxEVT_CHAR_HOOK, &MyFrame::OnKeyDown, this);
         
         // 绑定 socket 命令事件
         Bind(wxEVT_SOCKET_CMD, &MyFrame::OnSocketCommand, this);
+        Bind(wxEVT_REPLAY_DONE, &MyFrame::OnReplayDone, this);
+        Bind(wxEVT_CHANNEL_LOGO, &MyFrame::OnChannelLogo, this);
 
         Bind(wxEVT_MOVE, &MyFrame::OnMove, this);
         Bind(wxEVT_SIZE, &MyFrame::OnSize, this);
         Bind(wxEVT_CLOSE_WINDOW, &MyFrame::OnClose, this);
         
+        // 提示浮层只创建一次，随主窗口一起销毁
+        phase.Next("ToastOverlay");
+        m_toast = new ToastOverlay(this, m_scheduler);
+
         // 启动 socket server 线程
-        m_serverThread = new RemoteServerThread(this);
+        phase.Next("RemoteServerThread");
+        m_serverThread = new RemoteServerThread(this, &m_commandStats);
         if (m_serverThread->Run() != wxTHREAD_NO_ERROR) {
             wxLogError(wxString::FromUTF8("无法启动遥控器服务线程"));
             delete m_serverThread;
             m_serverThread = nullptr;
         }
         
+        phase.Next("Centre");
         SetSizer(mainSizer);
         Centre();
 
+        phase.Next("UpdateBackgroundLayer");
         UpdateBackgroundLayer();
     }
     
     ~MyFrame()
     {
-        // 停止 socket server 线程
-        if (m_serverThread) {
+        m_scheduler->Cancel(m_prebuildTimer);
+        m_scheduler->Cancel(m_videoStatsTimer);
+        m_scheduler->Cancel(m_audioStatsTimer);
+        m_scheduler->Cancel(m_thumbnailStatsTimer);
+        m_scheduler->Cancel(m_timeShiftStatsTimer);
+        m_timeShiftRecorder.reset();
+        m_timeShift.reset();
+        m_scheduler->Cancel(m_logoStatsTimer);
+        m_logos.reset();
+        m_scheduler->Cancel(m_digitTimer);
+        m_scheduler->Cancel(m_scanTimer);
+        m_scanner.reset();
+        m_scheduler->Cancel(m_languageTimer);
+        if (m_languageThread.joinable()) {
+            m_languageThread.join();
+        }
+        // 还在去抖等待中的设置立即交给写线程，m_settingsWriter 析构时会写完
+        if (m_settingsTimer) {
+            m_scheduler->Cancel(m_settingsTimer);
+            SaveSettings();
+        }
+
+        // 停止 socket server 线程
+        if (m_serverThread) {
             m_serverThread->Delete();
         }
+        // 回放线程引用本窗口与 m_commandStats，等它退出后才能析构
+        if (m_replayThread) {
+            m_replayThread->Delete();
+            delete m_replayThread;
+            m_replayThread = nullptr;
+        }
 
         if (m_backgroundFrame) {
+            m_backgroundFrame->StopThumbnails();
             m_backgroundFrame->Destroy();
             m_backgroundFrame = nullptr;
         }
     }
 
+    // 录制遥控器命令到文件，用于现场问题复现
+    bool StartRecording(const wxString& path)
+    {
+        if (!m_serverThread)
+            return false;
+
+        CommandLogWriter* recorder = new CommandLogWriter();
+        if (!recorder->Open(std::string(path.utf8_str()))) {
+            delete recorder;
+            wxLogError(wxString::FromUTF8("无法创建命令录制文件: %s"), path);
+            return false;
+        }
+        m_serverThread->SetRecorder(recorder);
+        return true;
+    }
+
+    // 回放录制文件；speed <= 0 为全速，exitWhenDone 时打印耗时后退出（用于基准测试）
+    bool StartReplay(const wxString& path, double speed, bool exitWhenDone)
+    {
+        if (m_replayThread)
+            return false;
+        CommandReplayThread* replay = new CommandReplayThread(this, &m_commandStats, std::string(path.utf8_str()), speed);
+        if (replay->Run() != wxTHREAD_NO_ERROR) {
+            delete replay;
+            return false;
+        }
+        m_replayThread = replay;
+        m_replayStart = CommandLog::NowMicros();
+        m_exitAfterReplay = exitWhenDone;
+        return true;
+    }
+
+    // 映射频道库文件；文件不存在时频道列表为空
+    bool LoadChannels(const wxString& path)
+    {
+        m_channelsPath = std::string(path.utf8_str());
+        return m_channels.Open(m_channelsPath);
+    }
+
+    // 启动时读到的设置快照，需在窗口首次显示前调用（语言在创建窗口前已设置）
+    void RestoreSettings(const SettingsSnapshot& snapshot)
+    {
+        for (size_t i = 0; i < snapshot.checkedItems.size() && i < m_pageSpecs.size(); ++i) {
+            m_pageSpecs[i].checkedItem = snapshot.checkedItems[i];
+            if (m_pages[i]) {
+                m_pages[i]->SetChecked(snapshot.checkedItems[i]);
+            }
+        }
+        ApplySourceSelection();
+        ApplyPictureMode();
+        ApplySoundMode();
+        if (snapshot.currentChannel != 0 && m_channels.FindByNumber(snapshot.currentChannel) >= 0) {
+            m_currentNumber = snapshot.currentChannel;
+            ZapBackground(CurrentChannelRow());
+        }
+        int page = snapshot.currentPage;
+        if (page > 0 && page < m_tabBar->GetTabCount()) {
+            m_tabBar->SelectTab(page, false);
+            ShowPage(page, false);
+            m_pendingTabIndex = page;
+        }
+    }
+
+    // 启动计时：记录各控件的首次绘制，首帧（首次绘制后的第一个空闲事件）时输出报告。
+    // exitAfter 时随即打印首帧时间并退出，用于循环测量启动耗时。需在 Show 之前调用
+    void WatchFirstFrame(bool exitAfter)
+    {
+        m_exitAfterFirstFrame = exitAfter;
+        TraceFirstPaint(this);
+        if (m_backgroundFrame) {
+            TraceFirstPaint(m_backgroundFrame);
+        }
+        Bind(wxEVT_IDLE, &MyFrame::OnStartupIdle, this);
+    }
+
+    // 之后语言、勾选、页面或频道变化时写出设置快照
+    void SetSettingsPath(const wxString& path)
+    {
+        m_settingsPath = std::string(path.utf8_str());
+    }
+
+    // 搜台信号源：tsDirectory 非空时读取录制的 <频点kHz>.ts，否则使用模拟信号；threads 为 0 时按 CPU 核数
+    void SetScanOptions(const wxString& tsDirectory, unsigned threads)
+    {
+        m_scanTsDirectory = std::string(tsDirectory.utf8_str());
+        m_scanThreads = threads;
+    }
+
+    // 开关页面布局缓存（关闭时回到每次切换都 Clear + Layout 的旧路径，用于对比）
+    void SetLayoutCacheEnabled(bool enabled)
+    {
+        if (enabled == m_layoutCacheEnabled)
+            return;
+
+        m_layoutCacheEnabled = enabled;
+        m_visiblePage = nullptr;
+        m_contentSizer->Clear();
+        for (auto page : m_pages) {
+            if (page) page->Hide();
+        }
+        ShowPage(m_currentPageIndex, false);
+    }
+
+    // 每 intervalMs 打印一次背景视频的播放统计与各阶段的单帧耗时
+    void StartVideoStats(unsigned intervalMs)
+    {
+        m_scheduler->Cancel(m_videoStatsTimer);
+        m_videoStatsTimer = m_scheduler->ScheduleRepeating(intervalMs, [this] {
+            VideoPlayer::Stats stats = m_backgroundFrame->GetVideoStats();
+            wxPrintf("video: %llu frames, %llu dropped, convert %.0f us, scale %.0f us, picture %s %.0f us, "
+                     "analysis %.0f us (%llu skipped)\n",
+                     static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.dropped),
+                     stats.convertMicros, stats.scaleMicros, Picture::ModeName(stats.pictureMode), stats.pictureMicros,
+                     stats.analysisMicros, static_cast<unsigned long long>(stats.analysisSkipped));
+        });
+    }
+
+    bool PlayAudio(const SoundEngine::Options& options)
+    {
+        return m_sound.Start(options);
+    }
+
+    // 每 intervalMs 打印一次声音引擎的输出统计
+    void StartAudioStats(unsigned intervalMs)
+    {
+        m_scheduler->Cancel(m_audioStatsTimer);
+        m_audioStatsTimer = m_scheduler->ScheduleRepeating(intervalMs, [this] {
+            SoundEngine::Stats stats = m_sound.GetStats();
+            wxPrintf("audio: %d ch %d Hz, %llu frames, %llu underruns (%llu frames), %s %.0f us/period, %.0fx realtime\n",
+                     stats.channels, stats.sampleRate, static_cast<unsigned long long>(stats.frames),
+                     static_cast<unsigned long long>(stats.underruns), static_cast<unsigned long long>(stats.underrunFrames),
+                     Sound::ModeName(stats.mode), stats.processMicros, stats.realtimeFactor);
+        });
+    }
+
+    // Source 图块显示各信号源的缩略图（须在 EnableSources 之后），只在菜单显示且停在 Source 页时生成
+    void EnableSourceThumbnails(const SourceThumbnailer::Options& options)
+    {
+        if (!m_backgroundFrame || !m_backgroundFrame->HasSources())
+            return;
+        m_thumbnailSequences.assign(m_backgroundFrame->SourceCount(), 0);
+        m_backgroundFrame->EnableThumbnails(options, [this] { UpdateSourceThumbnails(); });
+        UpdateThumbnailsActive();
+    }
+
+    void StartThumbnailStats(unsigned intervalMs)
+    {
+        m_scheduler->Cancel(m_thumbnailStatsTimer);
+        m_thumbnailStatsTimer = m_scheduler->ScheduleRepeating(intervalMs, [this] {
+            if (!m_backgroundFrame || !m_backgroundFrame->HasThumbnails())
+                return;
+            SourceThumbnailer::Stats stats = m_backgroundFrame->GetThumbnailStats();
+            wxPrintf("thumbnails: %llu made, %llu timeouts, last %.0f us source + %.0f us scale, %.1f%% cpu\n",
+                     static_cast<unsigned long long>(stats.thumbnails), static_cast<unsigned long long>(stats.timeouts),
+                     stats.lastRenderMicros, stats.lastScaleMicros, stats.cpuShare * 100);
+        });
+    }
+
+    // 选中 DTV 信号源期间把它的传输流写进时移缓冲（须在 EnableSources 之后），切到其他信号源时暂停写入
+    bool EnableTimeShift(const TimeShiftBuffer::Options& options, double megabitsPerSecond)
+    {
+        if (!m_backgroundFrame || !m_backgroundFrame->HasSources())
+            return false;
+        m_timeShiftRecorder.reset();
+        m_timeShift.reset(new TimeShiftBuffer());
+        if (!m_timeShift->Open(options)) {
+            m_timeShift.reset();
+            return false;
+        }
+        m_timeShiftRecorder.reset(new TimeShiftRecorder(*m_timeShift, megabitsPerSecond));
+        m_timeShiftRecorder->SetActive(m_pageSpecs[kSourcePageIndex].checkedItem == kDtvSourceIndex);
+        return true;
+    }
+
+    // 每次打印窗口长度与占用，并定位到窗口中点测一次回看定位的耗时
+    void StartTimeShiftStats(unsigned intervalMs)
+    {
+        m_scheduler->Cancel(m_timeShiftStatsTimer);
+        m_timeShiftStatsTimer = m_scheduler->ScheduleRepeating(intervalMs, [this] {
+            if (!m_timeShift)
+                return;
+            TimeShiftBuffer::Stats stats = m_timeShift->GetStats();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            m_timeShift->Seek(stats.windowStartMicros + (stats.windowEndMicros - stats.windowStartMicros) / 2);
+            double seekMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            wxPrintf("timeshift: %.1f s window, %.1f MB written, %llu segments recycled, %zu index points, seek %.1f us\n",
+                     (stats.windowEndMicros - stats.windowStartMicros) / 1e6,
+                     stats.packets * TimeShift::kPacketSize / 1048576.0, static_cast<unsigned long long>(stats.recycled),
+                     stats.indexEntries, seekMicros);
+        });
+    }
+
+    // 频道列表显示台标 <directory>/<频道号>.png（须在进入频道列表前调用）。台标在工作线程上解码缩小，
+    // 还没解码好的图块先显示频道名占位
+    void EnableChannelLogos(const std::string& directory, const LogoCache::Options& options)
+    {
+        if (!wxImage::FindHandler(wxBITMAP_TYPE_PNG)) {
+            wxImage::AddHandler(new wxPNGHandler());
+        }
+        LogoCache::Options logoOptions = options;
+        logoOptions.order = BackgroundFrame::VideoPixelOrder();
+        m_logos.reset(new LogoCache(logoOptions,
+            [directory](uint32_t number, LogoCache::Image& image) { return DecodeChannelLogo(directory, number, image); },
+            [this] {
+                // 上一批的事件还没处理时不再投递，处理时一并刷新
+                if (!m_logosPosted.exchange(true)) {
+                    wxQueueEvent(this, new wxCommandEvent(wxEVT_CHANNEL_LOGO, wxID_ANY));
+                }
+            }));
+    }
+
+    void StartLogoStats(unsigned intervalMs)
+    {
+        m_scheduler->Cancel(m_logoStatsTimer);
+        m_logoStatsTimer = m_scheduler->ScheduleRepeating(intervalMs, [this] {
+            if (!m_logos)
+                return;
+            LogoCache::Stats stats = m_logos->GetStats();
+            wxPrintf("logos: %.1f%% hits (%llu/%llu, %llu prefetched), %llu decoded, %llu missing, %llu dropped, "
+                     "%llu evicted, cache %zu logos %.0f KB, %.0f us/logo\n",
+                     stats.hitRate * 100, static_cast<unsigned long long>(stats.hits),
+                     static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.prefetchHits),
+                     static_cast<unsigned long long>(stats.decoded), static_cast<unsigned long long>(stats.missing),
+                     static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(stats.evicted),
+                     stats.cachedLogos, stats.cachedBytes / 1024.0, stats.decodeMicros);
+        });
+    }
+
+    // 启动后空闲时逐个预建尚未访问的页面：delayMs 后开始，每 intervalMs 建一页
+    void StartPagePrebuild(unsigned delayMs, unsigned intervalMs)
+    {
+        m_scheduler->Cancel(m_prebuildTimer);
+        m_prebuildTimer = m_scheduler->Schedule(delayMs, [this, intervalMs] {
+            m_prebuildTimer = m_scheduler->ScheduleRepeating(intervalMs, [this] { PrebuildNextPage(); });
+        });
+    }
+
+    // 基准：连续切换 switches 次页面并同步重绘，打印单次切换耗时后退出
+    void RunTabSwitchBenchmark(int switches)
+    {
+        std::vector<double> samples;
+        samples.reserve(switches);
+        wxStopWatch watch;
+        for (int i = 0; i < switches; ++i) {
+            int index = (m_currentPageIndex + 1) % m_tabBar->GetTabCount();
+            watch.Start();
+            ShowPage(index, false);
+            m_tabBar->SelectTab(index, false);
+            for (auto tile : GetPage(index)->GetTiles()) {
+                tile->Update();
+            }
+            samples.push_back(watch.TimeInMicro().ToDouble());
+        }
+
+        PrintLatencyReport(m_layoutCacheEnabled ? "tab switch (layout cache on)" : "tab switch (layout cache off)", samples);
+        Close(true);
+    }
+
+    // 基准：在 items 项的虚拟条带页上用 NavigateTile 逐项走完一圈（含回绕），
+    // 打印单步耗时与实际创建的 Tile 数后退出
+    void RunStripBenchmark(int items)
+    {
+        std::vector<wxString> keys;
+        keys.reserve(items);
+        for (int i = 0; i < items; ++i) {
+            keys.push_back(wxString::Format("CH %05d", i + 1));
+        }
+        m_pageSpecs.push_back(PageSpec(keys));
+        m_pages.push_back(nullptr);
+        int index = static_cast<int>(m_pages.size()) - 1;
+
+        wxStopWatch watch;
+        ShowPage(index, false);
+        m_inTabSelectionMode = false;
+        UpdateTileSelection();
+        Update();
+        double buildMicros = watch.TimeInMicro().ToDouble();
+
+        ContentPage* page = m_pages[index];
+        std::vector<double> samples;
+        samples.reserve(items);
+        for (int i = 0; i < items; ++i) {
+            watch.Start();
+            NavigateTile(1);
+            for (auto tile : page->GetTiles()) {
+                tile->Update();
+            }
+            samples.push_back(watch.TimeInMicro().ToDouble());
+        }
+
+        wxPrintf("strip build: %d items, %d tiles, %.1f us\n", items,
+                 static_cast<int>(page->GetTiles().size()), buildMicros);
+        PrintLatencyReport("strip scroll step", samples);
+        Close(true);
+    }
+
+    // 在后台为当前语言以外的语言预取文本，取好后在 UI 线程量好 Tile 文本尺寸；
+    // 之后切换语言只剩标签更新与当前页重绘
+    void StartLanguagePrepare(unsigned delayMs)
+    {
+        m_scheduler->Cancel(m_languageTimer);
+        m_languageTimer = m_scheduler->Schedule(delayMs, [this] {
+            m_languageTimer = 0;
+            PrepareLanguages();
+        });
+    }
+
+    // 基准：在当前页上来回切换 switches 次语言并同步重绘，打印单次切换耗时后退出。
+    // 先同步完成预取，测的是切换本身
+    void RunLanguageSwitchBenchmark(int switches)
+    {
+        LanguageManager& manager = LanguageManager::Instance();
+        std::vector<wxString> keys = CollectTextKeys();
+        std::string fallbackPath(manager.GetCatalogPath(Language::English).utf8_str());
+        for (size_t i = 0; i < kLanguageCount; ++i) {
+            Language language = static_cast<Language>(i);
+            std::string path(manager.GetCatalogPath(language).utf8_str());
+            ApplyPreparedTexts(language, LanguageManager::LoadTexts(path, fallbackPath, keys));
+        }
+
+        std::vector<double> samples;
+        samples.reserve(switches);
+        wxStopWatch watch;
+        for (int i = 0; i < switches; ++i) {
+            Language language = static_cast<Language>((static_cast<size_t>(manager.GetLanguage()) + 1) % kLanguageCount);
+            watch.Start();
+            manager.SetLanguage(language);
+            UpdateAllLanguages();
+            m_tabBar->Update();
+            for (auto tile : GetPage(m_currentPageIndex)->GetTiles()) {
+                tile->Update();
+            }
+            samples.push_back(watch.TimeInMicro().ToDouble());
+        }
+
+        PrintLatencyReport("language switch", samples);
+        Close(true);
+    }
+
 private:
+    // 打印一组耗时样本（微秒）的均值与分位数
+    static void PrintLatencyReport(const char* label, std::vector<double>& samples)
+    {
+        if (samples.empty())
+            return;
+        std::sort(samples.begin(), samples.end());
+        double total = 0;
+        for (double sample : samples) total += sample;
+        wxPrintf("%s: n=%d mean %.1f us p50 %.1f us p99 %.1f us max %.1f us\n",
+                 label, static_cast<int>(samples.size()), total / samples.size(),
+                 samples[samples.size() / 2], samples[samples.size() * 99 / 100], samples.back());
+    }
+
     void UpdateBackgroundLayer()
     {
         if (!m_backgroundFrame) return;
@@ -719,90 +2472,497 @@ private:
         event.Skip();
     }
 
-    void OnSize(wxSizeEvent& event)
+    void OnSize(wxSizeEvent& event)
+    {
+        event.Skip();
+        UpdateBackgroundLayer();
+    }
+
+    // 系统控件没有自己的 OnPaint，挂一个只记录首次绘制、然后交给默认处理的钩子
+    // （TileButton 在自己的 OnPaint 中记录）
+    void TraceFirstPaint(wxWindow* window)
+    {
+        if (!dynamic_cast<TileButton*>(window)) {
+            std::string name = "paint " + std::string(wxString(window->GetClassInfo()->GetClassName()).utf8_str());
+            window->Bind(wxEVT_PAINT, [window, name](wxPaintEvent& evt) {
+                StartupTrace& trace = StartupTrace::Instance();
+                if (!trace.IsFinished() && trace.IsFirstPaint(window)) {
+                    trace.Mark(name);
+                }
+                evt.Skip();
+            });
+        }
+        for (wxWindow* child : window->GetChildren()) {
+            TraceFirstPaint(child);
+        }
+    }
+
+    void OnStartupIdle(wxIdleEvent& evt)
+    {
+        evt.Skip();
+        StartupTrace& trace = StartupTrace::Instance();
+        if (trace.PaintCount() == 0)
+            return;
+
+        Unbind(wxEVT_IDLE, &MyFrame::OnStartupIdle, this);
+        double firstFrameMs = trace.Finish();
+        if (m_exitAfterFirstFrame) {
+            wxPrintf("first frame %.2f ms\n", firstFrameMs);
+            Close(true);
+        }
+    }
+
+    void OnClose(wxCloseEvent& event)
+    {
+        if (m_backgroundFrame) {
+            m_backgroundFrame->StopThumbnails();
+            m_backgroundFrame->Destroy();
+            m_backgroundFrame = nullptr;
+        }
+        event.Skip();
+    }
+
+    BackgroundFrame* m_backgroundFrame;
+    ToastOverlay* m_toast;
+    UiScheduler* m_scheduler;
+    TabBar* m_tabBar;
+    wxPanel* m_contentPanel;
+    wxBoxSizer* m_contentSizer;     // 仅在关闭布局缓存时使用
+    ContentPage* m_visiblePage;
+    bool m_layoutCacheEnabled;
+    std::vector<ContentPage*> m_pages;     // 未访问过的页面为 nullptr
+    std::vector<PageSpec> m_pageSpecs;
+    UiScheduler::TimerId m_prebuildTimer;
+    
+    // Source 页的五个图块依次对应 EnableSources 传入的 DTV、ATV、AV、HDMI1、HDMI2
+    static const int kSourcePageIndex = 0;
+    static const int kDtvSourceIndex = 0;
+    // Picture 页的四个图块依次对应 Picture::Mode 的 Standard、Dynamic、Movie、Game
+    static const int kPicturePageIndex = 1;
+    // Sound 页的四个图块依次对应 Sound::Mode 的 Standard、Music、Movie、Sports
+    static const int kSoundPageIndex = 2;
+    // 频道列表页不在 TabBar 中，由 Channel 页的 Channel List 进入
+    static const int kChannelPageIndex = 3;
+    static const unsigned kDigitEntryTimeoutMs = 1500;
+    ChannelStore m_channels;
+    int m_channelListPage;
+    // 频道列表的台标：解码好后投递 wxEVT_CHANNEL_LOGO 刷新还在占位的图块
+    static const size_t kLogoPrefetchRows = 8;
+    std::unique_ptr<LogoCache> m_logos;
+    std::atomic<bool> m_logosPosted;
+    UiScheduler::TimerId m_logoStatsTimer;
+    uint32_t m_currentNumber;   // 正在看的频道号，0 表示没有；频道库被替换后按号重新找行
+    int m_zapDirection;         // 最近一次频道加减的方向，预取时优先同方向
+    uint32_t m_digitValue;      // 数字键已输入的频道号
+    int m_digitCount;
+    UiScheduler::TimerId m_digitTimer;
+    std::string m_channelsPath;
+    
+    // 搜台在后台线程池中进行，UI 线程每 100ms 取一次进度并提交新的频道快照
+    static const unsigned kScanProgressMs = 100;
+    static const unsigned kLanguagePollMs = 50;
+    std::unique_ptr<ChannelScanner> m_scanner;
+    // 语言预取：后台线程把取好的文本放进 m_preparedTexts，UI 定时取走
+    std::thread m_languageThread;
+    std::mutex m_preparedLock;
+    std::vector<std::pair<Language, LanguageManager::TextTable>> m_preparedTexts;
+    size_t m_languagesPending;
+    UiScheduler::TimerId m_languageTimer;
+    UiScheduler::TimerId m_scanTimer;
+    std::string m_scanTsDirectory;
+    unsigned m_scanThreads;
+    
+    // 设置快照：状态变化后等 500ms 没有新的变化再交给写线程，连续操作只写一次
+    static const unsigned kSettingsSaveDelayMs = 500;
+    std::string m_settingsPath;
+    SettingsWriter m_settingsWriter;
+    UiScheduler::TimerId m_settingsTimer;
+    UiScheduler::TimerId m_videoStatsTimer;
+    UiScheduler::TimerId m_audioStatsTimer;
+    UiScheduler::TimerId m_thumbnailStatsTimer;
+    UiScheduler::TimerId m_timeShiftStatsTimer;
+    // 录制线程引用缓冲，须先于缓冲销毁
+    std::unique_ptr<TimeShiftBuffer> m_timeShift;
+    std::unique_ptr<TimeShiftRecorder> m_timeShiftRecorder;
+    SoundEngine m_sound;
+    // Source 各图块已显示的缩略图序号
+    std::vector<uint64_t> m_thumbnailSequences;
+    // 最近一次确认键的时间，确认键的处理过程中 m_confirmPending 为 true
+    std::chrono::steady_clock::time_point m_confirmTime;
+    bool m_confirmPending;
+    bool m_exitAfterFirstFrame;
+    
+    bool m_menuVisible;
+    int m_currentPageIndex;
+    int m_pendingTabIndex;
+    int m_currentTileIndex;
+    bool m_inTabSelectionMode;
+    
+    RemoteServerThread* m_serverThread;
+    CommandReplayThread* m_replayThread;   // 可等待的线程，在析构时停止并释放
+    CommandStats m_commandStats;
+    uint64_t m_replayStart;
+    bool m_exitAfterReplay;
+    
+    void CreatePages()
+    {
+        // Source 页 - 使用文本键
+        std::vector<wxString> sourceKeys = {
+            "source_dtv", "source_atv", "source_av", "source_hdmi1", "source_hdmi2"
+        };
+
+        std::vector<wxString> sourceIcons = {
+            "C:\\wxwidgets-vscode\\icon\\tv.svg",
+            "C:\\wxwidgets-vscode\\icon\\tv.svg",
+            "C:\\wxwidgets-vscode\\icon\\channel.svg",
+            "C:\\wxwidgets-vscode\\icon\\hdmi.svg",
+            "C:\\wxwidgets-vscode\\icon\\hdmi.svg"
+        };
+
+        m_pageSpecs.push_back(PageSpec(sourceKeys, sourceIcons, wxSize(150, 90)));
+        
+        // Picture 页
+        std::vector<wxString> pictureKeys = {
+            "picture_standard", "picture_dynamic", "picture_movie", "picture_game"
+        };
+        m_pageSpecs.push_back(PageSpec(pictureKeys));
+        
+        // Sound 页
+        std::vector<wxString> soundKeys = {
+            "sound_standard", "sound_music", "sound_movie", "sound_sports"
+        };
+        m_pageSpecs.push_back(PageSpec(soundKeys));
+        
+        // Channel 页
+        std::vector<wxString> channelKeys = {
+            "channel_auto", "channel_manual", "channel_list"
+        };
+        m_pageSpecs.push_back(PageSpec(channelKeys));
+        
+        // Common 页
+        std::vector<wxString> commonKeys = {
+            "common_language_english", "common_language_chinese"
+        };
+        m_pageSpecs.push_back(PageSpec(commonKeys));
+        
+        m_pages.assign(m_pageSpecs.size(), nullptr);
+    }
+
+    // 取页面，首次访问时才创建 Tile、原生窗口并加载 SVG 图标
+    ContentPage* GetPage(int index)
+    {
+        ContentPage*& page = m_pages[index];
+        if (!page) {
+            // 首次建页单独统计，不算进 ShowPage 的每次分配
+            ALLOC_SCOPE_EXCLUSIVE(BuildPage);
+            const PageSpec& spec = m_pageSpecs[index];
+            if (spec.itemLabel) {
+                page = new ContentPage(m_contentPanel, spec.itemCount, spec.itemLabel, spec.tileSize);
+            } else {
+                page = new ContentPage(m_contentPanel, spec.keys, spec.icons, spec.tileSize);
+            }
+            page->Hide();
+            if (index == m_channelListPage && m_logos) {
+                page->SetItemLogos([this](size_t row, wxBitmap& logo, wxString& placeholder) {
+                                       return ChannelLogo(row, logo, placeholder);
+                                   },
+                                   [this](size_t first, size_t last) { PrefetchChannelLogos(first, last); });
+            }
+            if (spec.checkedItem >= 0) {
+                page->SetChecked(spec.checkedItem);
+            }
+            BindTileClickEvents(page);
+        }
+        return page;
+    }
+
+    // 预建下一个尚未创建的页面，全部建完后停止
+    void PrebuildNextPage()
+    {
+        for (size_t i = 0; i < m_pages.size(); ++i) {
+            if (!m_pages[i]) {
+                GetPage(static_cast<int>(i));
+                return;
+            }
+        }
+        m_scheduler->Cancel(m_prebuildTimer);
+    }
+    
+    void BindTileClickEvents(ContentPage* page) {
+        // Tile 点击事件会向上传播到页面，在页面上统一绑定到主窗口（虚拟条带复用的 Tile 也能收到）
+        page->Bind(wxEVT_TILE_CLICKED, &MyFrame::OnTileButtonClicked, this);
+    }
+    
+    // 频道列表条目："001 CCTV-1"
+    wxString FormatChannel(size_t row) const
+    {
+        size_t length;
+        const char* name = m_channels.Name(row, length);
+        return wxString::Format("%03u ", m_channels.Number(row)) + wxString::FromUTF8(name, length);
+    }
+
+    bool ChannelLogo(size_t row, wxBitmap& logo, wxString& placeholder)
+    {
+        LogoCache::LogoPtr decoded = m_logos->Get(m_channels.Number(row));
+        if (decoded && decoded->width > 0) {
+            BackgroundFrame::CopyToBitmap(logo, decoded->width, decoded->height, decoded->pixels);
+            return true;
+        }
+        size_t length;
+        const char* name = m_channels.Name(row, length);
+        placeholder = wxString::FromUTF8(name, length);
+        return decoded != nullptr;
+    }
+
+    // 绑定的行之外，两侧各预取 kLogoPrefetchRows 行，近的先解码
+    void PrefetchChannelLogos(size_t first, size_t last)
+    {
+        size_t count = m_channels.Count();
+        std::vector<uint32_t> numbers;
+        for (size_t row = first; row < last && row < count; ++row) numbers.push_back(m_channels.Number(row));
+        for (size_t distance = 1; distance <= kLogoPrefetchRows; ++distance) {
+            if (last + distance - 1 < count) numbers.push_back(m_channels.Number(last + distance - 1));
+            if (first >= distance) numbers.push_back(m_channels.Number(first - distance));
+        }
+        m_logos->Prefetch(numbers);
+    }
+
+    // 台标文件 <directory>/<频道号>.png，在台标缓存的工作线程中解码；读不出的文件按没有台标处理
+    static bool DecodeChannelLogo(const std::string& directory, uint32_t number, LogoCache::Image& image)
+    {
+        wxString path = wxString::FromUTF8((directory + "/" + std::to_string(number) + ".png").c_str());
+        if (!wxFileExists(path))
+            return false;
+        wxLogNull noLog;
+        wxImage png;
+        if (!png.LoadFile(path, wxBITMAP_TYPE_PNG))
+            return false;
+        if (png.HasMask() && !png.HasAlpha()) png.InitAlpha();
+        image.width = png.GetWidth();
+        image.height = png.GetHeight();
+        size_t pixels = static_cast<size_t>(image.width) * image.height;
+        image.rgba.resize(pixels * 4);
+        const unsigned char* rgb = png.GetData();
+        const unsigned char* alpha = png.HasAlpha() ? png.GetAlpha() : nullptr;
+        for (size_t i = 0; i < pixels; ++i) {
+            image.rgba[i * 4 + 0] = rgb[i * 3 + 0];
+            image.rgba[i * 4 + 1] = rgb[i * 3 + 1];
+            image.rgba[i * 4 + 2] = rgb[i * 3 + 2];
+            image.rgba[i * 4 + 3] = alpha ? alpha[i] : 255;
+        }
+        return true;
+    }
+
+    void OnChannelLogo(wxCommandEvent& evt)
+    {
+        m_logosPosted = false;
+        if (m_channelListPage >= 0 && m_pages[m_channelListPage]) {
+            m_pages[m_channelListPage]->RefreshLogos();
+        }
+    }
+
+    // 进入频道列表页（首次进入时才创建），高亮当前频道
+    void OpenChannelList()
+    {
+        if (m_channels.Count() == 0) {
+            m_toast->ShowMessage(TR("channel_list_empty"));
+            return;
+        }
+        if (m_channelListPage < 0) {
+            // 有台标时图块加高，台标在上、频道名在下
+            m_pageSpecs.push_back(PageSpec(m_channels.Count(), [this](size_t row) { return FormatChannel(row); },
+                                           m_logos ? wxSize(150, 90) : wxSize(150, 60)));
+            m_pages.push_back(nullptr);
+            m_channelListPage = static_cast<int>(m_pages.size()) - 1;
+        }
+        ShowPage(m_channelListPage, false);
+        long current = CurrentChannelRow();
+        m_currentTileIndex = current >= 0 ? static_cast<int>(current) : 0;
+        m_inTabSelectionMode = false;
+        UpdateTileSelection();
+    }
+
+    // 从频道列表返回 Channel 页，焦点停在 Channel List 上
+    void CloseChannelList()
+    {
+        ShowPage(kChannelPageIndex, false);
+        const auto& tiles = m_pages[kChannelPageIndex]->GetTiles();
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            if (tiles[i]->GetTextKey() == "channel_list") {
+                m_currentTileIndex = static_cast<int>(i);
+            }
+        }
+        m_inTabSelectionMode = false;
+        UpdateTileSelection();
+    }
+
+    // 正在看的频道在当前频道库中的行号，不在库中返回 -1
+    long CurrentChannelRow() const
+    {
+        return m_currentNumber ? m_channels.FindByNumber(m_currentNumber) : -1;
+    }
+
+    void TuneToChannel(long row)
+    {
+        m_currentNumber = m_channels.Number(row);
+        if (m_channelListPage >= 0) {
+            // 数字键、频道加减换台时频道列表的勾选跟着走
+            m_pageSpecs[m_channelListPage].checkedItem = static_cast<int>(row);
+            if (m_pages[m_channelListPage]) m_pages[m_channelListPage]->SetChecked(static_cast<int>(row));
+        }
+        ZapBackground(row);
+        m_toast->ShowMessage(FormatChannel(row));
+        ScheduleSettingsSave();
+        if (m_channelListPage >= 0 && m_currentPageIndex == m_channelListPage) {
+            m_currentTileIndex = static_cast<int>(row);
+            UpdateTileSelection();
+        }
+    }
+
+    // 频道加减键：按频道表顺序循环换台
+    void ZapChannel(int direction)
+    {
+        if (m_channels.Count() == 0)
+            return;
+        long count = static_cast<long>(m_channels.Count());
+        long current = CurrentChannelRow();
+        long row = current < 0 ? 0 : (current + direction + count) % count;
+        m_zapDirection = direction;
+        TuneToChannel(row);
+    }
+
+    // 背景显示 row 频道的画面（启用换台画面时），并预取沿换台方向的下一个、反方向的一个频道
+    void ZapBackground(long row)
+    {
+        if (!m_backgroundFrame || !m_backgroundFrame->HasZap() || row < 0)
+            return;
+        long count = static_cast<long>(m_channels.Count());
+        std::vector<uint32_t> neighbours;
+        if (count > 1) {
+            neighbours.push_back(m_channels.Number((row + m_zapDirection + count) % count));
+            neighbours.push_back(m_channels.Number((row - m_zapDirection + count) % count));
+        }
+        m_backgroundFrame->ZapToChannel(m_channels.Number(row), neighbours, std::chrono::steady_clock::now());
+    }
+
+    // 遥控器数字键：已输入的位数不可能再组成更长的频道号时立即换台，否则等待下一位
+    void OnDigitKey(int digit)
+    {
+        if (m_channels.Count() == 0)
+            return;
+
+        m_scheduler->Cancel(m_digitTimer);
+        m_digitValue = m_digitValue * 10 + static_cast<uint32_t>(digit);
+        ++m_digitCount;
+        if (m_digitCount >= 5 || !m_channels.HasLongerNumber(m_digitValue)) {
+            CommitDigitEntry();
+            return;
+        }
+        m_toast->ShowMessage(wxString::Format("%u-", m_digitValue));
+        m_digitTimer = m_scheduler->Schedule(kDigitEntryTimeoutMs, [this] {
+            m_digitTimer = 0;
+            CommitDigitEntry();
+        });
+    }
+
+    // 自动搜台扫描整个 UHF 频段并重建频道表；手动搜台只重扫当前频道所在频点，其余频道保留
+    void StartScan(bool manual)
     {
-        event.Skip();
-        UpdateBackgroundLayer();
+        if (m_scanner)
+            return;
+
+        std::vector<uint32_t> plan;
+        std::vector<ChannelInfo> existing;
+        if (manual) {
+            long current = CurrentChannelRow();
+            plan.push_back(current >= 0 ? m_channels.FrequencyKhz(current) : ScanPlan::Uhf().front());
+            for (size_t row = 0; row < m_channels.Count(); ++row) {
+                ChannelInfo channel;
+                channel.number = m_channels.Number(row);
+                channel.frequencyKhz = m_channels.FrequencyKhz(row);
+                channel.flags = m_channels.Flags(row);
+                channel.name = m_channels.Name(row);
+                existing.push_back(channel);
+            }
+        } else {
+            plan = ScanPlan::Uhf();
+        }
+
+        std::unique_ptr<SignalSource> source;
+        if (!m_scanTsDirectory.empty()) {
+            source.reset(new TsFileSignalSource(m_scanTsDirectory));
+        } else {
+            // 模拟每个频点 50ms 的锁频时间，否则搜台瞬间完成、看不到进度
+            source.reset(new SimulatedSignalSource(1, 4096, 60, 50));
+        }
+        m_scanner.reset(new ChannelScanner(std::move(source), plan, existing, m_channelsPath, m_scanThreads));
+        m_scanner->Start();
+        m_scheduler->Cancel(m_scanTimer);
+        m_scanTimer = m_scheduler->ScheduleRepeating(kScanProgressMs, [this] { UpdateScanProgress(); });
+        UpdateScanProgress();
     }
 
-    void OnClose(wxCloseEvent& event)
+    void UpdateScanProgress()
     {
-        if (m_backgroundFrame) {
-            m_backgroundFrame->Destroy();
-            m_backgroundFrame = nullptr;
+        if (!m_scanner)
+            return;
+
+        ChannelScanner::Progress progress = m_scanner->GetProgress();
+        // 频道库替换后行号会变，列表中高亮的频道按频道号找回
+        long highlighted = m_currentPageIndex == m_channelListPage ? m_currentTileIndex : -1;
+        uint32_t highlightedNumber = highlighted >= 0 && highlighted < static_cast<long>(m_channels.Count())
+                                         ? m_channels.Number(highlighted) : 0;
+        if (m_scanner->CommitSnapshot(m_channels)) {
+            RefreshChannelList(highlightedNumber);
         }
-        event.Skip();
+        if (!progress.finished) {
+            int percent = progress.total ? static_cast<int>(progress.done * 100 / progress.total) : 0;
+            m_toast->ShowMessage(wxString::Format(TR("scan_progress"), percent, static_cast<int>(progress.found)));
+            return;
+        }
+        // 结束后协调线程已写出最终快照，上面已经提交
+        m_scheduler->Cancel(m_scanTimer);
+        m_scanner.reset();
+        m_toast->ShowMessage(wxString::Format(TR(progress.cancelled ? "scan_cancelled" : "scan_done"),
+                                              static_cast<int>(m_channels.Count())));
     }
 
-    BackgroundFrame* m_backgroundFrame;
-    TabBar* m_tabBar;
-    wxPanel* m_contentPanel;
-    wxBoxSizer* m_contentSizer;
-    std::vector<ContentPage*> m_pages;
-    
-    bool m_menuVisible;
-    int m_currentPageIndex;
-    int m_pendingTabIndex;
-    int m_currentTileIndex;
-    bool m_inTabSelectionMode;
-    
-    RemoteServerThread* m_serverThread;
-    
-    void CreatePages()
+    // 频道库被替换后原地更新已创建的频道列表页：项数、勾选的当前频道按新库重新计算，
+    // 正在浏览列表时高亮停在原来的频道（highlightedNumber）上，不会被踢出列表
+    void RefreshChannelList(uint32_t highlightedNumber)
     {
-        // Source 页 - 使用文本键
-        std::vector<wxString> sourceKeys = {
-            "source_dtv", "source_atv", "source_av", "source_hdmi1", "source_hdmi2"
-        };
-
-        std::vector<wxString> sourceIcons = {
-            "C:\\wxwidgets-vscode\\icon\\tv.svg",
-            "C:\\wxwidgets-vscode\\icon\\tv.svg",
-            "C:\\wxwidgets-vscode\\icon\\channel.svg",
-            "C:\\wxwidgets-vscode\\icon\\hdmi.svg",
-            "C:\\wxwidgets-vscode\\icon\\hdmi.svg"
-        };
+        if (m_channelListPage < 0)
+            return;
 
-        m_pages.push_back(new ContentPage(m_contentPanel, sourceKeys, sourceIcons, wxSize(150, 90)));
-        
-        // Picture 页
-        std::vector<wxString> pictureKeys = {
-            "picture_standard", "picture_dynamic", "picture_movie", "picture_game"
-        };
-        m_pages.push_back(new ContentPage(m_contentPanel, pictureKeys));
-        
-        // Sound 页
-        std::vector<wxString> soundKeys = {
-            "sound_standard", "sound_music", "sound_movie", "sound_sports"
-        };
-        m_pages.push_back(new ContentPage(m_contentPanel, soundKeys));
-        
-        // Channel 页
-        std::vector<wxString> channelKeys = {
-            "channel_auto", "channel_manual", "channel_list"
-        };
-        m_pages.push_back(new ContentPage(m_contentPanel, channelKeys));
-        
-        // Common 页
-        std::vector<wxString> commonKeys = {
-            "common_language_english", "common_language_chinese"
-        };
-        m_pages.push_back(new ContentPage(m_contentPanel, commonKeys));
-        
-        // 初始隐藏所有页面
-        for (auto page : m_pages) {
-            page->Hide();
+        long current = CurrentChannelRow();
+        m_pageSpecs[m_channelListPage].itemCount = m_channels.Count();
+        m_pageSpecs[m_channelListPage].checkedItem = static_cast<int>(current);
+        ContentPage* page = m_pages[m_channelListPage];
+        if (!page)
+            return;
+        if (m_currentPageIndex == m_channelListPage && m_channels.Count() == 0) {
+            CloseChannelList();
+        }
+        page->SetItemCount(m_channels.Count());
+        page->SetChecked(static_cast<int>(current));
+        if (m_currentPageIndex == m_channelListPage) {
+            long row = highlightedNumber ? m_channels.FindByNumber(highlightedNumber) : -1;
+            if (row >= 0) m_currentTileIndex = static_cast<int>(row);
+            UpdateTileSelection();
         }
     }
-    
-    void BindTileClickEvents() {
-        // 为所有页面的所有 TileButton 绑定点击事件到主窗口
-        for (auto page : m_pages) {
-            const auto& tiles = page->GetTiles();
-            for (auto tile : tiles) {
-                tile->Bind(wxEVT_TILE_CLICKED, &MyFrame::OnTileButtonClicked, this);
-            }
+
+    void CommitDigitEntry()
+    {
+        uint32_t number = m_digitValue;
+        m_digitValue = 0;
+        m_digitCount = 0;
+        long row = m_channels.FindByNumber(number);
+        if (row < 0) {
+            m_toast->ShowMessage(wxString::Format(TR("channel_not_found"), wxString::Format("%u", number)));
+            return;
         }
+        TuneToChannel(row);
     }
     
     void OnTileButtonClicked(wxCommandEvent& evt) {
@@ -813,20 +2973,43 @@ private:
         bool found = false;
         bool toggledOn = false;
         for (size_t pageIdx = 0; pageIdx < m_pages.size() && !found; ++pageIdx) {
-            const auto& tiles = m_pages[pageIdx]->GetTiles();
-            for (size_t tileIdx = 0; tileIdx < tiles.size(); ++tileIdx) {
-                if (tiles[tileIdx] == clickedTile) {
-                    m_currentPageIndex = static_cast<int>(pageIdx);
-                    m_currentTileIndex = static_cast<int>(tileIdx);
-                    m_pendingTabIndex = m_currentPageIndex;
-                    m_inTabSelectionMode = false;
-                    UpdateTileSelection();
-                    
+            if (!m_pages[pageIdx])
+                continue;
+            int tileIdx = m_pages[pageIdx]->FindItem(clickedTile);
+            if (tileIdx >= 0) {
+                m_currentPageIndex = static_cast<int>(pageIdx);
+                m_currentTileIndex = tileIdx;
+                m_pendingTabIndex = m_currentPageIndex;
+                m_inTabSelectionMode = false;
+                UpdateTileSelection();
+                
+                if (m_currentPageIndex == m_channelListPage) {
+                    // 频道列表的勾选是正在看的频道，再选一次只是重新换台，不取消勾选
+                    m_pages[pageIdx]->SetChecked(tileIdx);
+                    m_pageSpecs[pageIdx].checkedItem = tileIdx;
+                    toggledOn = true;
+                } else {
                     toggledOn = ToggleTileChecked(m_currentPageIndex, m_currentTileIndex);
-                    found = true;
-                    break;
                 }
+                found = true;
+            }
+        }
+        
+        // 频道列表中选中即换台
+        if (found && m_currentPageIndex == m_channelListPage) {
+            if (toggledOn) {
+                TuneToChannel(m_currentTileIndex);
             }
+            return;
+        }
+        
+        if (clickedTile->GetTextKey() == "channel_list") {
+            OpenChannelList();
+            return;
+        }
+        if (clickedTile->GetTextKey() == "channel_auto" || clickedTile->GetTextKey() == "channel_manual") {
+            StartScan(clickedTile->GetTextKey() == "channel_manual");
+            return;
         }
         
         // 检查是否是 Language 按钮
@@ -844,42 +3027,147 @@ private:
     }
     
     void UpdateAllLanguages() {
+        Language language = LanguageManager::Instance().GetLanguage();
+        
         // 更新窗口标题
         SetTitle(TR("window_title"));
         
         // 更新 TabBar
         m_tabBar->UpdateLanguage();
         
-        // 更新所有页面
-        for (auto page : m_pages) {
-            page->UpdateLanguage();
+        // 只更新当前页；其余已创建的页面语言过期，下次 ShowPage 时再更新，未创建的页面构造时直接使用当前语言
+        if (m_currentPageIndex >= 0 && m_currentPageIndex < (int)m_pages.size() && m_pages[m_currentPageIndex]) {
+            m_pages[m_currentPageIndex]->EnsureLanguage(language);
         }
         
-        Layout();
-        Refresh();
+        // 各页布局按语言缓存：当前页立即按新语言校验，其余页下次显示时再校验
+        if (m_layoutCacheEnabled) {
+            if (m_visiblePage) {
+                m_visiblePage->EnsureLayout(m_contentPanel->GetClientSize(), language);
+            }
+        } else {
+            Layout();
+        }
+    }
+
+    // 界面上用到的全部文本键：窗口标题、Tab 标签与各页 Tile
+    std::vector<wxString> CollectTextKeys() const
+    {
+        std::vector<wxString> keys;
+        keys.push_back("window_title");
+        for (int i = 0; i < m_tabBar->GetTabCount(); ++i) {
+            keys.push_back(m_tabBar->GetTabKey(i));
+        }
+        for (const PageSpec& spec : m_pageSpecs) {
+            keys.insert(keys.end(), spec.keys.begin(), spec.keys.end());
+        }
+        return keys;
+    }
+
+    void PrepareLanguages()
+    {
+        if (m_languageThread.joinable())
+            return;
+
+        LanguageManager& manager = LanguageManager::Instance();
+        std::vector<wxString> keys = CollectTextKeys();
+        std::string fallbackPath(manager.GetCatalogPath(Language::English).utf8_str());
+        std::vector<std::pair<Language, std::string>> targets;
+        for (size_t i = 0; i < kLanguageCount; ++i) {
+            Language language = static_cast<Language>(i);
+            if (language != manager.GetLanguage()) {
+                targets.push_back(std::make_pair(language, std::string(manager.GetCatalogPath(language).utf8_str())));
+            }
+        }
+        if (targets.empty())
+            return;
+
+        m_languagesPending = targets.size();
+        m_languageThread = std::thread([this, keys, targets, fallbackPath] {
+            for (const auto& target : targets) {
+                LanguageManager::TextTable texts = LanguageManager::LoadTexts(target.second, fallbackPath, keys);
+                std::lock_guard<std::mutex> lock(m_preparedLock);
+                m_preparedTexts.push_back(std::make_pair(target.first, std::move(texts)));
+            }
+        });
+        m_languageTimer = m_scheduler->ScheduleRepeating(kLanguagePollMs, [this] { ApplyPreparedLanguages(); });
+    }
+
+    void ApplyPreparedLanguages()
+    {
+        std::vector<std::pair<Language, LanguageManager::TextTable>> prepared;
+        {
+            std::lock_guard<std::mutex> lock(m_preparedLock);
+            prepared.swap(m_preparedTexts);
+        }
+        for (const auto& entry : prepared) {
+            ApplyPreparedTexts(entry.first, entry.second);
+            --m_languagesPending;
+        }
+        if (m_languagesPending == 0) {
+            m_scheduler->Cancel(m_languageTimer);
+            m_languageThread.join();
+        }
+    }
+
+    // 文本尺寸要用 GUI 字体测量，只能在 UI 线程做；几十条文本约 1ms
+    void ApplyPreparedTexts(Language language, const LanguageManager::TextTable& texts)
+    {
+        TextMetrics::Instance().Measure(language, texts, m_contentPanel->GetFont(), {kTileIconTextScale, kTileTextScale});
+        LanguageManager::Instance().AddPreparedTexts(language, texts);
+    }
+
+    void OnContentSize(wxSizeEvent& event)
+    {
+        event.Skip();
+        if (m_layoutCacheEnabled && m_visiblePage) {
+            m_visiblePage->EnsureLayout(m_contentPanel->GetClientSize(), LanguageManager::Instance().GetLanguage());
+        }
     }
     
     void ShowPage(int index, bool showPopup)
     {
         if (index < 0 || index >= (int)m_pages.size())
             return;
+
+        ALLOC_SCOPE(ShowPage);
         
+        if (index != m_currentPageIndex) {
+            ScheduleSettingsSave();
+        }
         m_currentPageIndex = index;
         m_currentTileIndex = 0;
         
-        // 隐藏所有页面
-        for (auto page : m_pages) {
-            page->Hide();
+        if (m_layoutCacheEnabled) {
+            // 布局已缓存：只需校验缓存并切换可见性
+            ContentPage* page = GetPage(index);
+            page->EnsureLanguage(LanguageManager::Instance().GetLanguage());
+            page->EnsureLayout(m_contentPanel->GetClientSize(), LanguageManager::Instance().GetLanguage());
+            if (page != m_visiblePage) {
+                if (m_visiblePage) {
+                    m_visiblePage->Hide();
+                }
+                page->Show();
+                m_visiblePage = page;
+            }
+        } else {
+            // 隐藏所有页面
+            for (auto page : m_pages) {
+                if (page) page->Hide();
+            }
+            
+            // 显示选中的页面
+            ContentPage* page = GetPage(index);
+            page->EnsureLanguage(LanguageManager::Instance().GetLanguage());
+            m_contentSizer->Clear();
+            m_contentSizer->Add(page, 1, wxEXPAND);
+            page->Show();
+            
+            m_contentPanel->Layout();
         }
         
-        // 显示选中的页面
-        m_contentSizer->Clear();
-        m_contentSizer->Add(m_pages[index], 1, wxEXPAND);
-        m_pages[index]->Show();
-        
-        m_contentPanel->Layout();
-        
         UpdateTileSelection();
+        UpdateThumbnailsActive();
         
         if (showPopup) {
             ShowTabSwitchPopup(index);
@@ -891,21 +3179,19 @@ private:
         if (m_currentPageIndex < 0 || m_currentPageIndex >= (int)m_pages.size())
             return;
         
-        const auto& tiles = m_pages[m_currentPageIndex]->GetTiles();
-        if (tiles.empty())
+        ContentPage* page = m_pages[m_currentPageIndex];
+        int count = static_cast<int>(page->GetItemCount());
+        if (count == 0)
             return;
         
         if (m_currentTileIndex < 0) {
             m_currentTileIndex = 0;
-        } else if (m_currentTileIndex >= static_cast<int>(tiles.size())) {
-            m_currentTileIndex = static_cast<int>(tiles.size()) - 1;
+        } else if (m_currentTileIndex >= count) {
+            m_currentTileIndex = count - 1;
         }
         
         bool highlightTiles = !m_inTabSelectionMode;
-        for (size_t i = 0; i < tiles.size(); ++i) {
-            bool shouldSelect = highlightTiles && static_cast<int>(i) == m_currentTileIndex;
-            tiles[i]->SetHighlighted(shouldSelect);
-        }
+        page->SetSelection(highlightTiles ? m_currentTileIndex : -1);
     }
 
     bool ToggleTileChecked(int pageIndex, int tileIndex)
@@ -913,55 +3199,119 @@ private:
         if (pageIndex < 0 || pageIndex >= static_cast<int>(m_pages.size()))
             return false;
 
-        const auto& tiles = m_pages[pageIndex]->GetTiles();
-        if (tileIndex < 0 || tileIndex >= static_cast<int>(tiles.size()))
+        if (!m_pages[pageIndex])
             return false;
 
-        TileButton* target = tiles[tileIndex];
-        if (!target)
-            return false;
+        bool checked = m_pages[pageIndex]->ToggleChecked(tileIndex);
+        m_pageSpecs[pageIndex].checkedItem = checked ? tileIndex : -1;
+        if (pageIndex == kSourcePageIndex) {
+            ApplySourceSelection();
+        } else if (pageIndex == kPicturePageIndex) {
+            ApplyPictureMode();
+        } else if (pageIndex == kSoundPageIndex) {
+            ApplySoundMode();
+        }
+        ScheduleSettingsSave();
+        return checked;
+    }
 
-        if (target->IsChecked()) {
-            target->SetChecked(false);
-            return false;
+    // Source 页勾选的信号源交给背景视频层（启用了模拟信号源时），未勾选时黑屏。
+    // 由确认键触发时以按键时间为切换延迟的起点
+    void ApplySourceSelection()
+    {
+        if (!m_backgroundFrame || !m_backgroundFrame->HasSources())
+            return;
+        m_backgroundFrame->SwitchSource(m_pageSpecs[kSourcePageIndex].checkedItem,
+                                        m_confirmPending ? m_confirmTime : std::chrono::steady_clock::now());
+        if (m_timeShiftRecorder) {
+            m_timeShiftRecorder->SetActive(m_pageSpecs[kSourcePageIndex].checkedItem == kDtvSourceIndex);
         }
+    }
 
-        for (size_t i = 0; i < tiles.size(); ++i) {
-            tiles[i]->SetChecked(static_cast<int>(i) == tileIndex);
+    // 缩略图只在看得见时生成：菜单显示且停在 Source 页
+    void UpdateThumbnailsActive()
+    {
+        if (!m_backgroundFrame || !m_backgroundFrame->HasThumbnails())
+            return;
+        bool active = m_menuVisible && m_currentPageIndex == kSourcePageIndex && m_pages[kSourcePageIndex];
+        wxSize size(1, 1);
+        if (active && !m_pages[kSourcePageIndex]->GetTiles().empty()) {
+            size = m_pages[kSourcePageIndex]->GetTiles()[0]->ThumbnailSize();
         }
-        return true;
+        m_backgroundFrame->SetThumbnailsActive(active, size);
+    }
+
+    // 把新的缩略图交给对应的图块
+    void UpdateSourceThumbnails()
+    {
+        if (!m_backgroundFrame || !m_pages[kSourcePageIndex])
+            return;
+        const std::vector<TileButton*>& tiles = m_pages[kSourcePageIndex]->GetTiles();
+        int count = wxMin(static_cast<int>(tiles.size()), static_cast<int>(m_thumbnailSequences.size()));
+        for (int i = 0; i < count; ++i) {
+            // 每次用新的位图：图块还持有上一张，不能原地改写
+            wxBitmap bitmap;
+            if (m_backgroundFrame->TakeThumbnail(i, m_thumbnailSequences[i], bitmap)) {
+                tiles[i]->SetThumbnail(bitmap);
+            }
+        }
+    }
+
+    // Picture 页勾选的预设交给背景视频，未勾选时不处理
+    void ApplyPictureMode()
+    {
+        if (!m_backgroundFrame)
+            return;
+        int checked = m_pageSpecs[kPicturePageIndex].checkedItem;
+        Picture::Mode mode = Picture::Mode::Off;
+        if (checked >= 0 && checked <= static_cast<int>(Picture::Mode::Game) - static_cast<int>(Picture::Mode::Standard)) {
+            mode = static_cast<Picture::Mode>(static_cast<int>(Picture::Mode::Standard) + checked);
+        }
+        m_backgroundFrame->SetPictureMode(mode);
+    }
+
+    // Sound 页勾选的预设交给声音引擎（没有在播放时也记下，开始播放后生效），未勾选时直通
+    void ApplySoundMode()
+    {
+        int checked = m_pageSpecs[kSoundPageIndex].checkedItem;
+        Sound::Mode mode = Sound::Mode::Off;
+        if (checked >= 0 && checked <= static_cast<int>(Sound::Mode::Sports) - static_cast<int>(Sound::Mode::Standard)) {
+            mode = static_cast<Sound::Mode>(static_cast<int>(Sound::Mode::Standard) + checked);
+        }
+        m_sound.SetMode(mode);
+    }
+
+    void ScheduleSettingsSave()
+    {
+        if (m_settingsPath.empty())
+            return;
+        m_scheduler->Cancel(m_settingsTimer);
+        m_settingsTimer = m_scheduler->Schedule(kSettingsSaveDelayMs, [this] {
+            m_settingsTimer = 0;
+            SaveSettings();
+        });
+    }
+
+    // 在 UI 线程抓取当前状态，序列化与写文件在写线程中完成
+    void SaveSettings()
+    {
+        SettingsSnapshot snapshot;
+        snapshot.language = static_cast<uint8_t>(LanguageManager::Instance().GetLanguage());
+        // 频道列表页不在 TabBar 中，记为 Channel 页
+        snapshot.currentPage = m_currentPageIndex == m_channelListPage ? kChannelPageIndex : m_currentPageIndex;
+        snapshot.currentChannel = m_currentNumber;
+        int tabCount = std::min(m_tabBar->GetTabCount(), static_cast<int>(m_pageSpecs.size()));
+        for (int i = 0; i < tabCount; ++i) {
+            snapshot.checkedItems.push_back(m_pageSpecs[i].checkedItem);
+        }
+        m_settingsWriter.Post(m_settingsPath, snapshot);
     }
     
     void ShowTabSwitchPopup(int index)
     {
         wxString tabKey = m_tabBar->GetTabKey(index);
         wxString tabLabel = tabKey.IsEmpty() ? wxString::Format("%d", index + 1) : TR(tabKey);
-        wxString message = wxString::Format(TR("popup_switch_success"), tabLabel);
-        
-        // 创建自动关闭的对话框
-        wxDialog* popup = new wxDialog(this, wxID_ANY, TR("window_title"), 
-                                       wxDefaultPosition, wxSize(300, 100),
-                                       wxCAPTION | wxSTAY_ON_TOP);
-        popup->SetBackgroundColour(Theme::Background);
-        
-        wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
-        
-        wxStaticText* text = new wxStaticText(popup, wxID_ANY, message);
-        text->SetForegroundColour(Theme::TextSelected);
-        text->SetFont(popup->GetFont().Bold().Scale(1.2));
-        
-        sizer->Add(text, 1, wxALL | wxALIGN_CENTER, 20);
-        popup->SetSizer(sizer);
-        popup->Centre();
-        
-        // 创建定时器，3秒后关闭
-        wxTimer* timer = new wxTimer(popup, wxID_ANY);
-        popup->Bind(wxEVT_TIMER, [popup](wxTimerEvent&) {
-            popup->Close();
-        });
-        timer->StartOnce(3000); // 3000 毫秒 = 3 秒
-        
-        popup->Show();
+        m_toast->ShowMessage(wxString::Format(TR("popup_switch_success"), tabLabel));
     }
     
     // 键盘事件处理
@@ -1008,13 +3358,19 @@ private:
                 break;
                 
             case WXK_BACK:
-                if (m_menuVisible) {
+                if (m_menuVisible || m_scanner) {
                     OnBackKey();
                 }
                 break;
                 
             default:
-                event.Skip();
+                if (keyCode >= '0' && keyCode <= '9') {
+                    OnDigitKey(keyCode - '0');
+                } else if (keyCode >= WXK_NUMPAD0 && keyCode <= WXK_NUMPAD9) {
+                    OnDigitKey(keyCode - WXK_NUMPAD0);
+                } else {
+                    event.Skip();
+                }
                 break;
         }
     }
@@ -1048,6 +3404,7 @@ private:
             Show(false);
             UpdateBackgroundLayer();
         }
+        UpdateThumbnailsActive();
     }
     
     void EnterContentMode()
@@ -1055,8 +3412,7 @@ private:
         if (m_currentPageIndex < 0 || m_currentPageIndex >= (int)m_pages.size())
             return;
         
-        const auto& tiles = m_pages[m_currentPageIndex]->GetTiles();
-        if (tiles.empty())
+        if (m_pages[m_currentPageIndex]->GetItemCount() == 0)
             return;
         
         m_currentTileIndex = 0;
@@ -1073,17 +3429,7 @@ private:
         if (m_currentPageIndex < 0 || m_currentPageIndex >= (int)m_pages.size())
             return;
         
-        const auto& tiles = m_pages[m_currentPageIndex]->GetTiles();
-        if (tiles.empty())
-            return;
-        
-        if (m_currentTileIndex < 0 || m_currentTileIndex >= (int)tiles.size())
-            return;
-        
-        TileButton* selectedTile = tiles[m_currentTileIndex];
-        wxCommandEvent clickEvent(wxEVT_TILE_CLICKED, selectedTile->GetId());
-        clickEvent.SetEventObject(selectedTile);
-        selectedTile->GetEventHandler()->ProcessEvent(clickEvent);
+        m_pages[m_currentPageIndex]->ActivateItem(m_currentTileIndex);
     }
     
     // 在 Tile 之间导航
@@ -1095,16 +3441,11 @@ private:
         if (m_currentPageIndex < 0 || m_currentPageIndex >= (int)m_pages.size())
             return;
         
-        const auto& tiles = m_pages[m_currentPageIndex]->GetTiles();
-        if (tiles.empty())
+        int count = static_cast<int>(m_pages[m_currentPageIndex]->GetItemCount());
+        if (count == 0)
             return;
         
-        m_currentTileIndex += direction;
-        if (m_currentTileIndex < 0) {
-            m_currentTileIndex = static_cast<int>(tiles.size()) - 1;
-        } else if (m_currentTileIndex >= static_cast<int>(tiles.size())) {
-            m_currentTileIndex = 0;
-        }
+        m_currentTileIndex = VirtualStrip::Wrap(m_currentTileIndex + direction, count);
         
         UpdateTileSelection();
     }
@@ -1145,13 +3486,25 @@ private:
             m_pendingTabIndex = m_currentPageIndex;
             EnterContentMode();
         } else {
+            m_confirmTime = std::chrono::steady_clock::now();
+            m_confirmPending = true;
             ActivateCurrentTile();
+            m_confirmPending = false;
         }
     }
     
     // 返回键处理
     void OnBackKey()
     {
+        // 搜台过程中返回键取消搜台，已找到的频道保留
+        if (m_scanner) {
+            m_scanner->Cancel();
+            return;
+        }
+        if (m_currentPageIndex == m_channelListPage) {
+            CloseChannelList();
+            return;
+        }
         if (!m_inTabSelectionMode) {
             m_inTabSelectionMode = true;
             m_pendingTabIndex = m_currentPageIndex;
@@ -1177,10 +3530,32 @@ private:
         m_pendingTabIndex = m_currentPageIndex;
     }
     
+    void OnReplayDone(wxCommandEvent& event)
+    {
+        double elapsedMs = (CommandLog::NowMicros() - m_replayStart) / 1000.0;
+        int count = event.GetInt();
+        double rate = elapsedMs > 0 ? count * 1000.0 / elapsedMs : 0;
+        wxString report = wxString::Format(wxString::FromUTF8("回放完成: %d 条命令, 用时 %.1f ms, %.0f 条/秒"),
+                                           count, elapsedMs, rate);
+        if (m_exitAfterReplay) {
+            wxPrintf("%s\n", report);
+#ifdef TV_ALLOC_STATS
+            // 分配统计构建下，回放结束时检查每次操作的分配预算，超出则以非零码退出
+            AllocStats::CheckBudgets(stdout);
+#endif
+            Close(true);
+        } else {
+            wxLogMessage(report);
+        }
+    }
+
     // Socket 命令处理
-    void OnSocketCommand(wxCommandEvent& event)
+    void OnSocketCommand(wxThreadEvent& event)
     {
+        ALLOC_SCOPE(Command);
         wxString cmd = event.GetString();
+        wxString digitText;
+        long digit;
         // wxLogMessage(wxString::Format(wxString::FromUTF8("收到遥控器命令: %s"), cmd));
         
         if (cmd == "KEY_MENU") {
@@ -1206,16 +3581,32 @@ private:
                 HandleHorizontalNavigation(1);
             }
         }
+        else if (cmd == "KEY_CHANNELUP" || cmd == "KEY_CHANNELDOWN") {
+            // 频道加减键在菜单显示时也直接换台
+            ZapChannel(cmd == "KEY_CHANNELUP" ? 1 : -1);
+        }
         else if (cmd == "KEY_OK") {
             if (m_menuVisible) {
                 OnConfirmKey();
             }
         }
         else if (cmd == "KEY_RETURN" || cmd == "KEY_BACK") {
-            if (m_menuVisible) {
+            if (m_menuVisible || m_scanner) {
                 OnBackKey();
             }
         }
+        else if (cmd.length() == 5 && cmd.StartsWith("KEY_", &digitText) && digitText.ToLong(&digit)) {
+            // 数字键 KEY_0 ~ KEY_9，菜单隐藏时也可直接换台
+            OnDigitKey(static_cast<int>(digit));
+        }
+
+        ++m_commandStats.handled;
+
+        // 带序号的命令处理完后回 ACK，供 loadgen 统计往返延迟
+        long long seq = event.GetPayload<long long>();
+        if (seq >= 0 && event.GetInt() > 0 && m_serverThread) {
+            m_serverThread->SendAck(event.GetInt(), seq);
+        }
     }
 };
 
@@ -1225,17 +3616,320 @@ private:
 class MyApp : public wxApp
 {
 public:
+    MyApp() : m_scheduler(nullptr) {}
+
+#ifdef TV_ALLOC_STATS
+    virtual int OnRun() override
+    {
+        int rc = wxApp::OnRun();
+        return AllocStats::BudgetExceeded() ? 1 : rc;
+    }
+#endif
+
     virtual bool OnInit()
     {
+        StartupPhase initPhase("OnInit");
+        StartupPhase phase("BackgroundFrame");
         BackgroundFrame* background = new BackgroundFrame(wxSize(205, 1000));
         background->Show();
         background->Lower();
 
-        MyFrame* frame = new MyFrame(background);
+        // 调度器内含 wxTimer，需在应用初始化后创建
+        phase.Next("UiScheduler");
+        m_scheduler = new UiScheduler();
+
+        // 设置快照在创建窗口之前读取，窗口一出现就是上次的语言，不需要再切换一次
+        wxString settingsPath = "settings.tvst";
+        for (int i = 1; i < argc; ++i) {
+            if (argv[i] == "--settings" && i + 1 < argc) {
+                settingsPath = argv[i + 1];
+            } else if (argv[i] == "--no-settings") {
+                settingsPath.Clear();
+            } else if (argv[i] == "--lang-dir" && i + 1 < argc) {
+                LanguageManager::Instance().SetCatalogDirectory(argv[i + 1]);
+            }
+        }
+        phase.Next("LoadSettings");
+        SettingsSnapshot settings;
+        bool settingsLoaded = !settingsPath.IsEmpty() && SettingsFile::Load(std::string(settingsPath.utf8_str()), settings);
+        if (settingsLoaded && settings.language < kLanguageCount) {
+            LanguageManager::Instance().SetLanguage(static_cast<Language>(settings.language));
+        }
+
+        phase.Next("MyFrame");
+        MyFrame* frame = new MyFrame(background, m_scheduler);
+        phase.End();
+
+        // 命令行：--record <文件>  --replay <文件> [--replay-speed <倍速|max>] [--replay-exit]
+        //         --alloc-budget <作用域>=<次数>（仅 -DTV_ALLOC_STATS 构建，可重复；不传时只报告不检查）
+        //         --bench-tabs <次数>  --bench-strip <项数>  --no-layout-cache  --prebuild-pages
+        //         --channels <频道库文件>（默认 channels.tvch）  --scan-ts <录制 TS 目录>  --scan-threads <线程数>
+        //         --settings <设置快照文件>（默认 settings.tvst）  --no-settings  --exit-after-first-frame
+        //         --lang-dir <翻译目录所在目录>（默认程序所在目录下的 lang）  --bench-language <次数>
+        //         --video <原始 YUV 文件>  --video-size <宽x高>（默认 1920x1080）
+        //         --video-format <i420|nv12>（默认 i420）  --video-fps <帧率>（默认 60）  --video-stats
+        //         --audio <WAV 文件>  --audio-out <输出 WAV 文件>（默认不输出）  --audio-stats
+        //         --sources（启用模拟信号源，DTV 播放 --video 文件，其余为测试图）  --source-stats
+        //         --thumbnail-budget <CPU 百分比>（默认 5，0 为不显示缩略图）  --thumbnail-fps <每块帧率>（默认 4）
+        //         --zap（换台显示频道画面，各频道取 --zap-dir 下的 <频道号>.yuv，没有时取 --video 文件的一帧）
+        //         --zap-dir <目录>  --zap-tune <调谐毫秒>（默认 120）  --zap-cache <MB>（默认 48）  --no-zap-prefetch  --zap-stats
+        //         --timeshift <段文件目录>（选中 DTV 时录入时移缓冲，须同时 --sources）  --timeshift-mb <MB>（默认 512）
+        //         --timeshift-mbps <码率>（默认 20）  --timeshift-stats
+        //         --logo-dir <台标目录>（频道列表显示 <频道号>.png）  --logo-cache <MB>（默认 4）  --logo-stats
+        wxString recordPath, replayPath;
+        double replaySpeed = 1.0;
+        bool replaySpeedInvalid = false;
+        bool replayExit = false;
+        bool exitAfterFirstFrame = false;
+        long benchTabs = 0;
+        long benchStrip = 0;
+        long benchLanguage = 0;
+        VideoPlayer::Options video;
+        video.format = Yuv::Format::I420;
+        video.width = 1920;
+        video.height = 1080;
+        video.fps = 60;
+        video.order = BackgroundFrame::VideoPixelOrder();
+        SoundEngine::Options audio;
+        bool sources = false;
+        bool sourceStats = false;
+        SourceThumbnailer::Options thumbnails;
+        double thumbnailBudget = thumbnails.cpuBudget * 100;
+        bool zap = false;
+        bool zapStats = false;
+        ZapPrefetcher::Options zapOptions;
+        bool timeShift = false;
+        bool timeShiftStats = false;
+        long timeShiftMegabytes = 512;
+        double timeShiftMbps = 20;
+        TimeShiftBuffer::Options timeShiftOptions;
+        std::string logoDirectory;
+        LogoCache::Options logoOptions;
+        bool logoStats = false;
+        wxString channelsPath = "channels.tvch";
+        wxString scanTsDirectory;
+        long scanThreads = 0;
+        for (int i = 1; i < argc; ++i) {
+            wxString arg = argv[i];
+            if (arg == "--record" && i + 1 < argc) {
+                recordPath = argv[++i];
+            } else if (arg == "--replay" && i + 1 < argc) {
+                replayPath = argv[++i];
+            } else if (arg == "--replay-speed" && i + 1 < argc) {
+                wxString speed = argv[++i];
+                if (speed == "max") {
+                    replaySpeed = 0;
+                } else if (!speed.ToDouble(&replaySpeed) || !(replaySpeed > 0)) {
+                    wxLogError(wxString::FromUTF8("无效的回放倍速: %s（应为正数或 max）"), speed);
+                    replaySpeedInvalid = true;
+                }
+            } else if (arg == "--replay-exit") {
+                replayExit = true;
+#ifdef TV_ALLOC_STATS
+            } else if (arg == "--alloc-budget" && i + 1 < argc) {
+                wxString budget = argv[++i];
+                if (!AllocStats::SetBudget(budget.utf8_str())) {
+                    wxLogError(wxString::FromUTF8("无效的分配预算: %s（应为 <作用域>=<次数>）"), budget);
+                }
+#endif
+            } else if (arg == "--exit-after-first-frame") {
+                exitAfterFirstFrame = true;
+            } else if (arg == "--bench-tabs" && i + 1 < argc) {
+                argv[++i].ToLong(&benchTabs);
+            } else if (arg == "--bench-strip" && i + 1 < argc) {
+                argv[++i].ToLong(&benchStrip);
+            } else if (arg == "--bench-language" && i + 1 < argc) {
+                argv[++i].ToLong(&benchLanguage);
+            } else if (arg == "--video" && i + 1 < argc) {
+                video.path = std::string(argv[++i].utf8_str());
+            } else if (arg == "--video-size" && i + 1 < argc) {
+                wxString size = argv[++i];
+                long width = 0, height = 0;
+                if (size.BeforeFirst('x').ToLong(&width) && size.AfterFirst('x').ToLong(&height)) {
+                    video.width = static_cast<int>(width);
+                    video.height = static_cast<int>(height);
+                }
+            } else if (arg == "--video-format" && i + 1 < argc) {
+                video.format = argv[++i] == "nv12" ? Yuv::Format::NV12 : Yuv::Format::I420;
+            } else if (arg == "--video-fps" && i + 1 < argc) {
+                argv[++i].ToDouble(&video.fps);
+            } else if (arg == "--video-stats") {
+                frame->StartVideoStats(1000);
+            } else if (arg == "--sources") {
+                sources = true;
+            } else if (arg == "--source-stats") {
+                sourceStats = true;
+            } else if (arg == "--thumbnail-budget" && i + 1 < argc) {
+                argv[++i].ToDouble(&thumbnailBudget);
+            } else if (arg == "--thumbnail-fps" && i + 1 < argc) {
+                argv[++i].ToDouble(&thumbnails.maxFps);
+            } else if (arg == "--zap") {
+                zap = true;
+            } else if (arg == "--zap-dir" && i + 1 < argc) {
+                zapOptions.directory = std::string(argv[++i].utf8_str());
+            } else if (arg == "--zap-tune" && i + 1 < argc) {
+                long tuneMs = 0;
+                if (argv[++i].ToLong(&tuneMs) && tuneMs >= 0) zapOptions.tuneMs = static_cast<unsigned>(tuneMs);
+            } else if (arg == "--zap-cache" && i + 1 < argc) {
+                long megabytes = 0;
+                if (argv[++i].ToLong(&megabytes) && megabytes >= 0) zapOptions.cacheBytes = static_cast<size_t>(megabytes) << 20;
+            } else if (arg == "--no-zap-prefetch") {
+                zapOptions.prefetch = false;
+            } else if (arg == "--zap-stats") {
+                zapStats = true;
+            } else if (arg == "--timeshift" && i + 1 < argc) {
+                timeShift = true;
+                timeShiftOptions.directory = std::string(argv[++i].utf8_str());
+            } else if (arg == "--timeshift-mb" && i + 1 < argc) {
+                argv[++i].ToLong(&timeShiftMegabytes);
+            } else if (arg == "--timeshift-mbps" && i + 1 < argc) {
+                argv[++i].ToDouble(&timeShiftMbps);
+            } else if (arg == "--timeshift-stats") {
+                timeShiftStats = true;
+            } else if (arg == "--logo-dir" && i + 1 < argc) {
+                logoDirectory = std::string(argv[++i].utf8_str());
+            } else if (arg == "--logo-cache" && i + 1 < argc) {
+                long megabytes = 0;
+                if (argv[++i].ToLong(&megabytes) && megabytes > 0) logoOptions.cacheBytes = static_cast<size_t>(megabytes) << 20;
+            } else if (arg == "--logo-stats") {
+                logoStats = true;
+            } else if (arg == "--audio" && i + 1 < argc) {
+                audio.path = std::string(argv[++i].utf8_str());
+            } else if (arg == "--audio-out" && i + 1 < argc) {
+                audio.outputPath = std::string(argv[++i].utf8_str());
+            } else if (arg == "--audio-stats") {
+                frame->StartAudioStats(1000);
+            } else if (arg == "--channels" && i + 1 < argc) {
+                channelsPath = argv[++i];
+            } else if ((arg == "--settings" || arg == "--lang-dir") && i + 1 < argc) {
+                ++i;   // 已在创建窗口前处理
+            } else if (arg == "--scan-ts" && i + 1 < argc) {
+                scanTsDirectory = argv[++i];
+            } else if (arg == "--scan-threads" && i + 1 < argc) {
+                argv[++i].ToLong(&scanThreads);
+            } else if (arg == "--no-layout-cache") {
+                frame->SetLayoutCacheEnabled(false);
+            } else if (arg == "--prebuild-pages") {
+                // 启动 1 秒后利用空闲时间每 200ms 预建一页
+                frame->StartPagePrebuild(1000, 200);
+            }
+        }
+        if (!recordPath.IsEmpty()) {
+            frame->StartRecording(recordPath);
+        }
+        if (sources) {
+            background->EnableSources(SimulatedSources(video), sourceStats);
+            if (thumbnailBudget > 0) {
+                thumbnails.cpuBudget = thumbnailBudget / 100;
+                frame->EnableSourceThumbnails(thumbnails);
+                if (sourceStats) frame->StartThumbnailStats(1000);
+            }
+            if (timeShift) {
+                timeShiftOptions.segmentBytes = static_cast<size_t>(wxMax(timeShiftMegabytes, 2L)) << 20;
+                timeShiftOptions.segmentBytes /= timeShiftOptions.segments;
+                if (!frame->EnableTimeShift(timeShiftOptions, timeShiftMbps)) {
+                    wxLogError(wxString::FromUTF8("无法创建时移缓冲: %s"),
+                               wxString::FromUTF8(timeShiftOptions.directory.c_str()));
+                } else if (timeShiftStats) {
+                    frame->StartTimeShiftStats(1000);
+                }
+            }
+        } else if (zap) {
+            zapOptions.fallbackPath = video.path;
+            zapOptions.format = video.format;
+            zapOptions.width = video.width;
+            zapOptions.height = video.height;
+            zapOptions.order = video.order;
+            background->EnableZap(zapOptions, zapStats);
+        } else if (!video.path.empty() && !background->PlayVideo(video)) {
+            wxLogError(wxString::FromUTF8("无法播放视频文件: %s"), wxString::FromUTF8(video.path.c_str()));
+        }
+        if (!audio.path.empty() && !frame->PlayAudio(audio)) {
+            wxLogError(wxString::FromUTF8("无法播放音频文件: %s"), wxString::FromUTF8(audio.path.c_str()));
+        }
+        if (!logoDirectory.empty()) {
+            frame->EnableChannelLogos(logoDirectory, logoOptions);
+            if (logoStats) frame->StartLogoStats(1000);
+        }
+        phase.Next("LoadChannels");
+        frame->LoadChannels(channelsPath);
+        frame->SetScanOptions(scanTsDirectory, scanThreads > 0 ? static_cast<unsigned>(scanThreads) : 0);
+        phase.Next("RestoreSettings");
+        if (settingsLoaded) {
+            frame->RestoreSettings(settings);
+        }
+        frame->SetSettingsPath(settingsPath);
+        if (exitAfterFirstFrame) {
+            StartupTrace::Instance().Enable();
+        }
+        if (StartupTrace::Instance().IsEnabled()) {
+            frame->WatchFirstFrame(exitAfterFirstFrame);
+        }
+        phase.Next("Show");
         frame->Show(true);
         frame->Raise();
+        phase.End();
+        if (!replayPath.IsEmpty() && replaySpeedInvalid) {
+            // 倍速写错时不回放；作为基准运行（--replay-exit）时直接退出，不挂在那里
+            if (replayExit) {
+                frame->CallAfter([frame] { frame->Close(true); });
+            }
+        } else if (!replayPath.IsEmpty()) {
+            frame->StartReplay(replayPath, replaySpeed, replayExit);
+        }
+        if (benchTabs > 0) {
+            // 等窗口完成首次显示后再开始计时
+            frame->CallAfter([frame, benchTabs] { frame->RunTabSwitchBenchmark(static_cast<int>(benchTabs)); });
+        } else if (benchStrip > 0) {
+            frame->CallAfter([frame, benchStrip] { frame->RunStripBenchmark(static_cast<int>(benchStrip)); });
+        } else if (benchLanguage > 0) {
+            frame->CallAfter([frame, benchLanguage] { frame->RunLanguageSwitchBenchmark(static_cast<int>(benchLanguage)); });
+        } else {
+            // 启动完成后再在后台预取其他语言，不和首帧争抢
+            frame->StartLanguagePrepare(1000);
+        }
         return true;
     }
+
+    virtual int OnExit() override
+    {
+        // 此时所有窗口都已销毁，不会再有回调引用调度器
+        delete m_scheduler;
+        m_scheduler = nullptr;
+        return wxApp::OnExit();
+    }
+
+private:
+    UiScheduler* m_scheduler;
+
+    // Source 页各图块对应的模拟信号源；锁定时间取自常见电视的量级（数字调谐锁定与首个 I 帧、HDMI 握手）
+    static std::vector<InputSource::Options> SimulatedSources(const VideoPlayer::Options& video)
+    {
+        struct Spec { const char* name; Source::Pattern pattern; unsigned lockMs; };
+        static const Spec kSpecs[] = {
+            { "dtv", Source::Pattern::Bars, 120 },
+            { "atv", Source::Pattern::Snow, 60 },
+            { "av", Source::Pattern::Ramp, 40 },
+            { "hdmi1", Source::Pattern::Checker, 250 },
+            { "hdmi2", Source::Pattern::Bars, 250 },
+        };
+        std::vector<InputSource::Options> sources;
+        for (const Spec& spec : kSpecs) {
+            InputSource::Options options;
+            options.name = spec.name;
+            options.pattern = spec.pattern;
+            options.lockMs = spec.lockMs;
+            options.width = video.width;
+            options.height = video.height;
+            options.fps = video.fps;
+            options.format = video.format;
+            options.order = video.order;
+            sources.push_back(options);
+        }
+        // DTV 播放录制的文件（如有）
+        sources[0].path = video.path;
+        return sources;
+    }
 };
 
 wxIMPLEMENT_APP(MyApp);
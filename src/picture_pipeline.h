@@ -0,0 +1,357 @@
+// 图像模式 - Picture 页的四个预设对应的逐像素处理链，作用在背景视频帧上
+//
+// 每个预设由锐化、3x3 色彩矩阵、饱和度和色调曲线（对比度 + gamma）组成。Compile 把它们编译成一条处理链：
+// 饱和度是线性变换，直接乘进色彩矩阵；对比度与 gamma 合成一张查找表。处理时逐行一次完成：
+//   锐化  V = C + ((4C - 上 - 下 - 左 - 右) * 32 * k) >> 16       k 为 9 位定点
+//   矩阵  O = (Σ M * V + 2048) >> 12                              M 为 12 位定点
+//   查表  RGB 三个通道查同一张表，Alpha 不变
+// 动态模式的对比度由 FrameAnalyzer 按画面内容自适应给出：ApplyToneCurve 把分析得到的曲线与预设的 gamma 表合成。
+// 标量、SSE2、AVX2 内核的输出逐字节一致。锐化要读上下两行原始像素，输出不能与输入是同一块内存；
+// 游戏模式只有一张查找表，可以原地处理，是延迟最小的链。
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "yuv_convert.h"
+
+namespace Picture {
+    // Off 为未选择任何预设（不处理）；其余依次对应 Picture 页的四个图块
+    enum class Mode : uint8_t { Off, Standard, Dynamic, Movie, Game };
+
+    const int kMatrixBits = 12;
+    const int kSharpenBits = 9;
+
+    inline const char* ModeName(Mode mode)
+    {
+        switch (mode) {
+            case Mode::Standard: return "standard";
+            case Mode::Dynamic: return "dynamic";
+            case Mode::Movie: return "movie";
+            case Mode::Game: return "game";
+            default: return "off";
+        }
+    }
+
+    struct Preset {
+        double gains[3];        // 白平衡（R、G、B 增益），即色彩矩阵的对角线
+        double saturation;
+        double contrast;        // 以中灰为中心拉伸
+        double gamma;           // 输出 = 输入 ^ gamma，小于 1 提亮暗部
+        double sharpen;         // 0 为不锐化，1 为加上一倍的拉普拉斯细节
+        bool adaptive;          // 对比度曲线由帧分析得出（此时 contrast 不生效）
+    };
+
+    inline Preset GetPreset(Mode mode)
+    {
+        switch (mode) {
+            case Mode::Standard: return { { 1.0, 1.0, 1.0 }, 1.0, 1.0, 1.0, 0.25, false };
+            case Mode::Dynamic: return { { 0.96, 1.0, 1.06 }, 1.25, 1.0, 0.95, 0.6, true };
+            case Mode::Movie: return { { 1.04, 1.0, 0.9 }, 0.95, 1.0, 1.1, 0.0, false };
+            case Mode::Game: return { { 1.0, 1.0, 1.0 }, 1.0, 1.05, 0.85, 0.0, false };
+            default: return { { 1.0, 1.0, 1.0 }, 1.0, 1.0, 1.0, 0.0, false };
+        }
+    }
+
+    // 编译后的处理链，矩阵按内存中的字节顺序排列：out[k] = Σ weights[k][j] * in[j]
+    struct Chain {
+        Mode mode;
+        bool sharpen;
+        bool matrix;
+        bool lut;
+        bool adaptive;
+        int16_t sharpenAmount;
+        int16_t weights[4][4];
+        uint8_t table[256];
+        uint8_t baseTable[256];     // 预设本身的色调表，自适应曲线在它之前查
+
+        bool Empty() const { return !sharpen && !matrix && !lut; }
+        bool InPlace() const { return !sharpen; }
+    };
+
+    inline Chain Compile(Mode mode, Yuv::PixelOrder order)
+    {
+        Preset preset = GetPreset(mode);
+        Chain chain;
+        chain.mode = mode;
+        chain.adaptive = preset.adaptive;
+
+        double amount = std::lround(preset.sharpen * (1 << kSharpenBits));
+        chain.sharpenAmount = static_cast<int16_t>(std::min(std::max(amount, 0.0), 2.0 * (1 << kSharpenBits)));
+        chain.sharpen = chain.sharpenAmount != 0;
+
+        // 饱和度矩阵 S = s * I + (1 - s) * 每行都是亮度系数（BT.709），再乘白平衡
+        static const double kLuma[3] = { 0.2126, 0.7152, 0.0722 };
+        int position[3] = { 0, 1, 2 };       // R、G、B 在内存中的位置
+        if (order == Yuv::PixelOrder::Bgra) {
+            position[0] = 2;
+            position[2] = 0;
+        }
+        std::memset(chain.weights, 0, sizeof(chain.weights));
+        chain.weights[3][3] = 1 << kMatrixBits;
+        chain.matrix = false;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                double value = ((i == j ? preset.saturation : 0.0) + (1.0 - preset.saturation) * kLuma[j]) *
+                               preset.gains[j];
+                int16_t weight = static_cast<int16_t>(std::lround(value * (1 << kMatrixBits)));
+                chain.weights[position[i]][position[j]] = weight;
+                if (weight != (i == j ? (1 << kMatrixBits) : 0)) chain.matrix = true;
+            }
+        }
+
+        chain.lut = false;
+        double contrast = preset.adaptive ? 1.0 : preset.contrast;
+        for (int i = 0; i < 256; ++i) {
+            double value = 0.5 + (i / 255.0 - 0.5) * contrast;
+            value = std::pow(std::min(std::max(value, 0.0), 1.0), preset.gamma);
+            chain.table[i] = static_cast<uint8_t>(std::lround(value * 255));
+            chain.baseTable[i] = chain.table[i];
+            if (chain.table[i] != i) chain.lut = true;
+        }
+        return chain;
+    }
+
+    // 换上新的自适应对比度曲线：table = baseTable(curve(x))
+    inline void ApplyToneCurve(Chain& chain, const uint8_t curve[256])
+    {
+        chain.lut = false;
+        for (int i = 0; i < 256; ++i) {
+            chain.table[i] = chain.baseTable[curve[i]];
+            if (chain.table[i] != i) chain.lut = true;
+        }
+    }
+
+    inline uint8_t ClampByte(int value)
+    {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    // 锐化和矩阵，[begin, end) 个像素；up / down 为上下两行（边缘行为本行）
+    inline void ProcessRowScalar(const Chain& chain, const uint8_t* up, const uint8_t* row, const uint8_t* down,
+                                 int width, int begin, int end, uint8_t* dst)
+    {
+        for (int x = begin; x < end; ++x) {
+            int left = x > 0 ? x - 1 : x;
+            int right = x + 1 < width ? x + 1 : x;
+            int value[4];
+            for (int c = 0; c < 4; ++c) {
+                int center = row[x * 4 + c];
+                if (chain.sharpen) {
+                    int detail = 4 * center - up[x * 4 + c] - down[x * 4 + c] - row[left * 4 + c] - row[right * 4 + c];
+                    center = ClampByte(center + ((detail * 32 * chain.sharpenAmount) >> 16));
+                }
+                value[c] = center;
+            }
+            for (int k = 0; k < 4; ++k) {
+                int out = value[k];
+                if (chain.matrix) {
+                    int sum = 1 << (kMatrixBits - 1);
+                    for (int j = 0; j < 4; ++j) sum += chain.weights[k][j] * value[j];
+                    out = ClampByte(sum >> kMatrixBits);
+                }
+                dst[x * 4 + k] = static_cast<uint8_t>(out);
+            }
+        }
+    }
+
+    // 一个输出通道的矩阵行，按 4 个 int16 重复填满向量
+    inline int64_t MatrixRow(const Chain& chain, int k)
+    {
+        uint64_t packed = 0;
+        for (int j = 0; j < 4; ++j) packed |= static_cast<uint64_t>(static_cast<uint16_t>(chain.weights[k][j])) << (16 * j);
+        return static_cast<int64_t>(packed);
+    }
+
+#if YUV_HAVE_X86
+    // 两个像素（8 个 int16）乘矩阵：每个输出通道一次 madd 得到两两部分和，再转置相加
+    __attribute__((target("sse2")))
+    inline __m128i MatrixSse2(__m128i pixels, const __m128i* rows, __m128i round)
+    {
+        __m128i m0 = _mm_madd_epi16(pixels, rows[0]);
+        __m128i m1 = _mm_madd_epi16(pixels, rows[1]);
+        __m128i m2 = _mm_madd_epi16(pixels, rows[2]);
+        __m128i m3 = _mm_madd_epi16(pixels, rows[3]);
+        __m128i first01 = _mm_unpacklo_epi32(m0, m1);
+        __m128i first23 = _mm_unpacklo_epi32(m2, m3);
+        __m128i second01 = _mm_unpackhi_epi32(m0, m1);
+        __m128i second23 = _mm_unpackhi_epi32(m2, m3);
+        __m128i first = _mm_add_epi32(_mm_unpacklo_epi64(first01, first23), _mm_unpackhi_epi64(first01, first23));
+        __m128i second = _mm_add_epi32(_mm_unpacklo_epi64(second01, second23), _mm_unpackhi_epi64(second01, second23));
+        return _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(first, round), kMatrixBits),
+                               _mm_srai_epi32(_mm_add_epi32(second, round), kMatrixBits));
+    }
+
+    // 8 个 int16 的锐化：细节乘 32 后仍在 int16 内，mulhi 即 (detail * 32 * k) >> 16
+    __attribute__((target("sse2")))
+    inline __m128i SharpenSse2(__m128i center, __m128i neighbours, __m128i amount)
+    {
+        __m128i detail = _mm_sub_epi16(_mm_slli_epi16(center, 2), neighbours);
+        __m128i value = _mm_add_epi16(center, _mm_mulhi_epi16(_mm_slli_epi16(detail, 5), amount));
+        return _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+    }
+
+    // 每次 4 个像素，从 begin 处理到 end，返回处理到的位置
+    __attribute__((target("sse2")))
+    inline int ProcessRowSse2(const Chain& chain, const uint8_t* up, const uint8_t* row, const uint8_t* down,
+                              int begin, int end, uint8_t* dst)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i amount = _mm_set1_epi16(chain.sharpenAmount);
+        const __m128i round = _mm_set1_epi32(1 << (kMatrixBits - 1));
+        __m128i rows[4];
+        for (int k = 0; k < 4; ++k) rows[k] = _mm_set1_epi64x(MatrixRow(chain, k));
+
+        int x = begin;
+        for (; x + 4 <= end; x += 4) {
+            __m128i center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4));
+            __m128i low = _mm_unpacklo_epi8(center, zero);
+            __m128i high = _mm_unpackhi_epi8(center, zero);
+            if (chain.sharpen) {
+                __m128i sides[4] = {
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + x * 4)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + x * 4)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4 - 4)),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x * 4 + 4)),
+                };
+                __m128i sumLow = zero;
+                __m128i sumHigh = zero;
+                for (const __m128i& side : sides) {
+                    sumLow = _mm_add_epi16(sumLow, _mm_unpacklo_epi8(side, zero));
+                    sumHigh = _mm_add_epi16(sumHigh, _mm_unpackhi_epi8(side, zero));
+                }
+                low = SharpenSse2(low, sumLow, amount);
+                high = SharpenSse2(high, sumHigh, amount);
+            }
+            if (chain.matrix) {
+                low = MatrixSse2(low, rows, round);
+                high = MatrixSse2(high, rows, round);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(low, high));
+        }
+        return x;
+    }
+#endif
+
+#if YUV_HAVE_AVX2
+    // 与 SSE2 相同，一次 8 个像素。unpack、madd、pack 都在 128 位通道内进行，
+    // 最后的 packus 把两半拼回原来的顺序
+    __attribute__((target("avx2")))
+    inline __m256i MatrixAvx2(__m256i pixels, const __m256i* rows, __m256i round)
+    {
+        __m256i m0 = _mm256_madd_epi16(pixels, rows[0]);
+        __m256i m1 = _mm256_madd_epi16(pixels, rows[1]);
+        __m256i m2 = _mm256_madd_epi16(pixels, rows[2]);
+        __m256i m3 = _mm256_madd_epi16(pixels, rows[3]);
+        __m256i first01 = _mm256_unpacklo_epi32(m0, m1);
+        __m256i first23 = _mm256_unpacklo_epi32(m2, m3);
+        __m256i second01 = _mm256_unpackhi_epi32(m0, m1);
+        __m256i second23 = _mm256_unpackhi_epi32(m2, m3);
+        __m256i first = _mm256_add_epi32(_mm256_unpacklo_epi64(first01, first23),
+                                         _mm256_unpackhi_epi64(first01, first23));
+        __m256i second = _mm256_add_epi32(_mm256_unpacklo_epi64(second01, second23),
+                                          _mm256_unpackhi_epi64(second01, second23));
+        return _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(first, round), kMatrixBits),
+                                  _mm256_srai_epi32(_mm256_add_epi32(second, round), kMatrixBits));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i SharpenAvx2(__m256i center, __m256i neighbours, __m256i amount)
+    {
+        __m256i detail = _mm256_sub_epi16(_mm256_slli_epi16(center, 2), neighbours);
+        __m256i value = _mm256_add_epi16(center, _mm256_mulhi_epi16(_mm256_slli_epi16(detail, 5), amount));
+        return _mm256_min_epi16(_mm256_max_epi16(value, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+    }
+
+    __attribute__((target("avx2")))
+    inline int ProcessRowAvx2(const Chain& chain, const uint8_t* up, const uint8_t* row, const uint8_t* down,
+                              int begin, int end, uint8_t* dst)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i amount = _mm256_set1_epi16(chain.sharpenAmount);
+        const __m256i round = _mm256_set1_epi32(1 << (kMatrixBits - 1));
+        __m256i rows[4];
+        for (int k = 0; k < 4; ++k) rows[k] = _mm256_set1_epi64x(MatrixRow(chain, k));
+
+        int x = begin;
+        for (; x + 8 <= end; x += 8) {
+            __m256i center = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x * 4));
+            __m256i low = _mm256_unpacklo_epi8(center, zero);
+            __m256i high = _mm256_unpackhi_epi8(center, zero);
+            if (chain.sharpen) {
+                __m256i sides[4] = {
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + x * 4)),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + x * 4)),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x * 4 - 4)),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x * 4 + 4)),
+                };
+                __m256i sumLow = zero;
+                __m256i sumHigh = zero;
+                for (const __m256i& side : sides) {
+                    sumLow = _mm256_add_epi16(sumLow, _mm256_unpacklo_epi8(side, zero));
+                    sumHigh = _mm256_add_epi16(sumHigh, _mm256_unpackhi_epi8(side, zero));
+                }
+                low = SharpenAvx2(low, sumLow, amount);
+                high = SharpenAvx2(high, sumHigh, amount);
+            }
+            if (chain.matrix) {
+                low = MatrixAvx2(low, rows, round);
+                high = MatrixAvx2(high, rows, round);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_packus_epi16(low, high));
+        }
+        return x;
+    }
+#endif
+
+    // 查表：RGB 查同一张表，Alpha 照抄。src 可以等于 dst
+    inline void ApplyTable(const Chain& chain, const uint8_t* src, int width, uint8_t* dst)
+    {
+        for (int x = 0; x < width; ++x) {
+            dst[x * 4] = chain.table[src[x * 4]];
+            dst[x * 4 + 1] = chain.table[src[x * 4 + 1]];
+            dst[x * 4 + 2] = chain.table[src[x * 4 + 2]];
+            dst[x * 4 + 3] = src[x * 4 + 3];
+        }
+    }
+
+    // 处理 [rowBegin, rowEnd) 行，不同行段可由不同线程并行处理。
+    // chain.InPlace() 为 false 时 dst 不能与 src 重叠
+    inline void ProcessRows(const Chain& chain, const uint8_t* src, ptrdiff_t srcStride, uint8_t* dst,
+                            ptrdiff_t dstStride, int width, int height, int rowBegin, int rowEnd,
+                            Yuv::Kernel kernel = Yuv::BestKernel())
+    {
+        for (int y = rowBegin; y < rowEnd; ++y) {
+            const uint8_t* row = src + y * srcStride;
+            uint8_t* out = dst + y * dstStride;
+            if (!chain.sharpen && !chain.matrix) {
+                if (chain.lut) ApplyTable(chain, row, width, out);
+                else if (out != row) std::memcpy(out, row, static_cast<size_t>(width) * 4);
+                continue;
+            }
+            const uint8_t* up = y > 0 ? row - srcStride : row;
+            const uint8_t* down = y + 1 < height ? row + srcStride : row;
+            // 锐化时首尾两列缺少左右邻居，交给标量处理
+            int begin = chain.sharpen ? std::min(1, width) : 0;
+            int end = chain.sharpen ? std::max(width - 1, begin) : width;
+            int done = begin;
+#if YUV_HAVE_AVX2
+            if (kernel == Yuv::Kernel::Avx2) done = ProcessRowAvx2(chain, up, row, down, done, end, out);
+#endif
+#if YUV_HAVE_X86
+            if (kernel != Yuv::Kernel::Scalar) done = ProcessRowSse2(chain, up, row, down, done, end, out);
+#endif
+            ProcessRowScalar(chain, up, row, down, width, 0, begin, out);
+            ProcessRowScalar(chain, up, row, down, width, done, width, out);
+            if (chain.lut) ApplyTable(chain, out, width, out);
+        }
+    }
+
+    inline void Process(const Chain& chain, const uint8_t* src, ptrdiff_t srcStride, uint8_t* dst,
+                        ptrdiff_t dstStride, int width, int height, Yuv::Kernel kernel = Yuv::BestKernel())
+    {
+        ProcessRows(chain, src, srcStride, dst, dstStride, width, height, 0, height, kernel);
+    }
+}
@@ -5,9 +5,7 @@
 #endif
 #include <wx/graphics.h>
 #include <wx/dcbuffer.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
-typedef int socklen_t;
+#include "remote_link.h"
 
 // 遥控器主题色
 namespace RemoteTheme {
@@ -124,7 +122,7 @@ class RemoteFrame : public wxFrame
 public:
     RemoteFrame()
         : wxFrame(nullptr, wxID_ANY, wxString::FromUTF8("电视遥控器"), 
-                  wxDefaultPosition, wxSize(350, 550))
+                  wxDefaultPosition, wxSize(350, 810))
         , m_socket(INVALID_SOCKET)
         , m_connected(false)
     {
@@ -187,6 +185,24 @@ public:
         RemoteButton* btnReturn = new RemoteButton(this, ID_RETURN, wxString::FromUTF8("返回"), wxSize(120, 50));
         mainSizer->Add(btnReturn, 0, wxALL | wxALIGN_CENTER, 5);
         
+        mainSizer->AddSpacer(10);
+        
+        // 频道加减键，菜单隐藏时 ▲▼ 也可换台
+        wxBoxSizer* channelSizer = new wxBoxSizer(wxHORIZONTAL);
+        channelSizer->Add(new RemoteButton(this, ID_CHANNEL_DOWN, "CH-", wxSize(75, 40)), 0, wxALL, 5);
+        channelSizer->Add(new RemoteButton(this, ID_CHANNEL_UP, "CH+", wxSize(75, 40)), 0, wxALL, 5);
+        mainSizer->Add(channelSizer, 0, wxALIGN_CENTER);
+        
+        // 数字键 1-9、0，用于直接输入频道号
+        wxGridSizer* digitSizer = new wxGridSizer(4, 3, 5, 5);
+        for (int digit = 1; digit <= 9; ++digit) {
+            digitSizer->Add(new RemoteButton(this, ID_DIGIT_0 + digit, wxString::Format("%d", digit), wxSize(50, 40)), 0, wxALIGN_CENTER);
+        }
+        digitSizer->AddSpacer(0);
+        digitSizer->Add(new RemoteButton(this, ID_DIGIT_0, "0", wxSize(50, 40)), 0, wxALIGN_CENTER);
+        digitSizer->AddSpacer(0);
+        mainSizer->Add(digitSizer, 0, wxALL | wxALIGN_CENTER, 5);
+        
         SetSizer(mainSizer);
         Centre();
         
@@ -199,6 +215,9 @@ public:
         Bind(wxEVT_BUTTON, &RemoteFrame::OnRightButton, this, ID_RIGHT);
         Bind(wxEVT_BUTTON, &RemoteFrame::OnOKButton, this, ID_OK);
         Bind(wxEVT_BUTTON, &RemoteFrame::OnReturnButton, this, ID_RETURN);
+        Bind(wxEVT_BUTTON, &RemoteFrame::OnChannelUpButton, this, ID_CHANNEL_UP);
+        Bind(wxEVT_BUTTON, &RemoteFrame::OnChannelDownButton, this, ID_CHANNEL_DOWN);
+        Bind(wxEVT_BUTTON, &RemoteFrame::OnDigitButton, this, ID_DIGIT_0, ID_DIGIT_9);
         Bind(wxEVT_CLOSE_WINDOW, &RemoteFrame::OnClose, this);
         
         // 初始化 Winsock
@@ -225,7 +244,11 @@ private:
         ID_LEFT,
         ID_RIGHT,
         ID_OK,
-        ID_RETURN
+        ID_RETURN,
+        ID_CHANNEL_UP,
+        ID_CHANNEL_DOWN,
+        ID_DIGIT_0,
+        ID_DIGIT_9 = ID_DIGIT_0 + 9
     };
     
     SOCKET m_socket;
@@ -243,82 +266,35 @@ private:
     
     void Connect()
     {
-        // 创建 socket
-        m_socket = socket(AF_INET, SOCK_STREAM, 0);
-        if (m_socket == INVALID_SOCKET) {
-            wxMessageBox(wxString::FromUTF8("创建 socket 失败"), wxString::FromUTF8("错误"), wxOK | wxICON_ERROR);
-            return;
-        }
-        
-        // 目标地址
-        sockaddr_in addr = {0};
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(5050);
-        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
-        
-        // 设置为非阻塞模式
-        u_long nonblock = 1;
-        ioctlsocket(m_socket, FIONBIO, &nonblock);
-        
-        // 尝试连接（非阻塞，立即返回）
-        int rc = connect(m_socket, (sockaddr*)&addr, sizeof(addr));
-        if (rc == SOCKET_ERROR) {
-            int err = WSAGetLastError();
-            if (err != WSAEWOULDBLOCK && err != WSAEINPROGRESS && err != WSAEINVAL) {
-                closesocket(m_socket);
-                m_socket = INVALID_SOCKET;
+        switch (RemoteLink::Connect(m_socket)) {
+            case RemoteLink::ConnectResult::Ok:
+                break;
+            case RemoteLink::ConnectResult::SocketFailed:
+                wxMessageBox(wxString::FromUTF8("创建 socket 失败"), wxString::FromUTF8("错误"), wxOK | wxICON_ERROR);
+                return;
+            case RemoteLink::ConnectResult::Refused:
                 wxMessageBox(
                     wxString::FromUTF8("连接失败！请确保 TV Menu 程序正在运行。"),
                     wxString::FromUTF8("连接错误"), 
                     wxOK | wxICON_ERROR
                 );
                 return;
-            }
-            
-            // 用 select 等待连接完成（设置 3 秒超时）
-            fd_set wset, eset;
-            FD_ZERO(&wset);
-            FD_ZERO(&eset);
-            FD_SET(m_socket, &wset);
-            FD_SET(m_socket, &eset);
-            
-            timeval tv;
-            tv.tv_sec = 3;   // 超时 3 秒
-            tv.tv_usec = 0;
-            
-            int sel = select(0, nullptr, &wset, &eset, &tv);
-            if (sel <= 0 || FD_ISSET(m_socket, &eset)) {
-                // 超时或错误
-                closesocket(m_socket);
-                m_socket = INVALID_SOCKET;
+            case RemoteLink::ConnectResult::Timeout:
                 wxMessageBox(
                     wxString::FromUTF8("连接超时或被拒绝！\n请确认 TV Menu 已运行且端口 5050 开放。"),
                     wxString::FromUTF8("连接失败"), 
                     wxOK | wxICON_ERROR
                 );
                 return;
-            }
-            
-            // 检查 SO_ERROR 确保真正连接成功
-            int so_error = 0;
-            socklen_t len = sizeof(so_error);
-            getsockopt(m_socket, SOL_SOCKET, SO_ERROR, (char*)&so_error, &len);
-            if (so_error != 0) {
-                closesocket(m_socket);
-                m_socket = INVALID_SOCKET;
+            case RemoteLink::ConnectResult::SoError:
                 wxMessageBox(
                     wxString::FromUTF8("连接失败（SO_ERROR）！\n请确保 TV Menu 程序正在运行。"),
                     wxString::FromUTF8("连接错误"), 
                     wxOK | wxICON_ERROR
                 );
                 return;
-            }
         }
         
-        // 连接成功，设回阻塞模式（便于后续 send）
-        u_long block = 0;
-        ioctlsocket(m_socket, FIONBIO, &block);
-        
         m_connected = true;
         m_statusText->SetLabel(wxString::FromUTF8("已连接"));
         m_statusText->SetForegroundColour(wxColour(100, 255, 100));
@@ -356,8 +332,7 @@ private:
             return;
         }
         
-        int result = send(m_socket, cmd.c_str(), cmd.size(), 0);
-        if (result == SOCKET_ERROR) {
+        if (!RemoteLink::SendAll(m_socket, RemoteLink::FormatCommand(cmd))) {
             wxMessageBox(wxString::FromUTF8("发送命令失败，连接可能已断开"), wxString::FromUTF8("错误"), wxOK | wxICON_ERROR);
             Disconnect();
         } else {
@@ -372,6 +347,9 @@ private:
     void OnRightButton(wxCommandEvent& evt) { SendCommand("KEY_RIGHT"); }
     void OnOKButton(wxCommandEvent& evt) { SendCommand("KEY_OK"); }
     void OnReturnButton(wxCommandEvent& evt) { SendCommand("KEY_RETURN"); }
+    void OnChannelUpButton(wxCommandEvent& evt) { SendCommand("KEY_CHANNELUP"); }
+    void OnChannelDownButton(wxCommandEvent& evt) { SendCommand("KEY_CHANNELDOWN"); }
+    void OnDigitButton(wxCommandEvent& evt) { SendCommand("KEY_" + std::to_string(evt.GetId() - ID_DIGIT_0)); }
     
     void OnClose(wxCloseEvent& evt)
     {
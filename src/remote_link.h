@@ -0,0 +1,179 @@
+// 遥控器链路 - remote / menu / loadgen 共用的 socket 连接与命令协议
+#pragma once
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/ioctl.h>
+    #include <sys/select.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    #include <errno.h>
+    typedef int SOCKET;
+    typedef unsigned long u_long;
+    #define INVALID_SOCKET (-1)
+    #define SOCKET_ERROR (-1)
+    #define closesocket close
+    #define ioctlsocket ioctl
+    #define WSAGetLastError() errno
+    #define WSAEWOULDBLOCK EWOULDBLOCK
+    #define WSAEINPROGRESS EINPROGRESS
+    #define WSAEINVAL EINVAL
+#endif
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+// 协议：每条命令一行，以 '\n' 结尾
+//   "KEY_UP"        普通按键
+//   "KEY_UP #42"    带序号的按键，menu 处理完后回 "ACK 42"
+//   "STATS"         查询命令管线统计，回 "STATS key=value ..."
+namespace RemoteLink {
+    const unsigned short kPort = 5050;
+    const char* const kHost = "127.0.0.1";
+    const size_t kMaxLineLength = 256;
+
+    // 解析一行命令，拆出按键名与可选序号（无序号时 seq = -1）
+    inline void ParseLine(const std::string& line, std::string& key, long long& seq)
+    {
+        seq = -1;
+        size_t end = line.find_last_not_of(" \t\r\n");
+        if (end == std::string::npos) {
+            key.clear();
+            return;
+        }
+        size_t hash = line.rfind(" #", end);
+        if (hash != std::string::npos) {
+            char* stop = nullptr;
+            long long value = std::strtoll(line.c_str() + hash + 2, &stop, 10);
+            if (stop == line.c_str() + end + 1 && value >= 0) {
+                seq = value;
+                end = hash;
+                while (end > 0 && line[end - 1] == ' ') --end;
+                key.assign(line, 0, end);
+                return;
+            }
+        }
+        key.assign(line, 0, end + 1);
+    }
+
+    inline std::string FormatCommand(const std::string& key, long long seq = -1)
+    {
+        if (seq < 0) return key + "\n";
+        return key + " #" + std::to_string(seq) + "\n";
+    }
+
+    // 从接收缓冲中取出一整行（不含换行符），没有完整行时返回 false
+    inline bool TakeLine(std::string& pending, std::string& line)
+    {
+        size_t nl = pending.find('\n');
+        if (nl == std::string::npos) return false;
+        line.assign(pending, 0, nl);
+        pending.erase(0, nl + 1);
+        return true;
+    }
+
+    // 完整发送一段数据（阻塞 socket 上 send 可能只发出一部分）。
+    // 非阻塞 socket 上发送缓冲满时返回 false，此时可能已发出一部分，应断开该连接
+    inline bool SendAll(SOCKET sock, const char* data, size_t len)
+    {
+        while (len > 0) {
+            int n = send(sock, data, static_cast<int>(len), 0);
+            if (n == SOCKET_ERROR || n == 0) return false;
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    inline bool SendAll(SOCKET sock, const std::string& text)
+    {
+        return SendAll(sock, text.data(), text.size());
+    }
+
+    inline void SetNonBlocking(SOCKET sock, bool nonBlocking)
+    {
+        u_long mode = nonBlocking ? 1 : 0;
+        ioctlsocket(sock, FIONBIO, &mode);
+    }
+
+    enum class ConnectResult {
+        Ok,
+        SocketFailed,   // 创建 socket 失败
+        Refused,        // connect 立即失败
+        Timeout,        // 超时或被拒绝
+        SoError         // SO_ERROR 非零
+    };
+
+    // 连接到 TV Menu（非阻塞 connect + select 超时），成功后恢复阻塞模式
+    inline ConnectResult Connect(SOCKET& sock, const char* host = kHost,
+                                 unsigned short port = kPort, int timeoutSec = 3)
+    {
+        sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock == INVALID_SOCKET) {
+            return ConnectResult::SocketFailed;
+        }
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, host, &addr.sin_addr);
+
+        // 设置为非阻塞模式
+        u_long nonblock = 1;
+        ioctlsocket(sock, FIONBIO, &nonblock);
+
+        int rc = connect(sock, (sockaddr*)&addr, sizeof(addr));
+        if (rc == SOCKET_ERROR) {
+            int err = WSAGetLastError();
+            if (err != WSAEWOULDBLOCK && err != WSAEINPROGRESS && err != WSAEINVAL) {
+                closesocket(sock);
+                sock = INVALID_SOCKET;
+                return ConnectResult::Refused;
+            }
+
+            // 用 select 等待连接完成
+            fd_set wset, eset;
+            FD_ZERO(&wset);
+            FD_ZERO(&eset);
+            FD_SET(sock, &wset);
+            FD_SET(sock, &eset);
+
+            timeval tv;
+            tv.tv_sec = timeoutSec;
+            tv.tv_usec = 0;
+
+            int sel = select(static_cast<int>(sock) + 1, nullptr, &wset, &eset, &tv);
+            if (sel <= 0 || FD_ISSET(sock, &eset)) {
+                closesocket(sock);
+                sock = INVALID_SOCKET;
+                return ConnectResult::Timeout;
+            }
+
+            // 检查 SO_ERROR 确保真正连接成功
+            int so_error = 0;
+            socklen_t len = sizeof(so_error);
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&so_error, &len);
+            if (so_error != 0) {
+                closesocket(sock);
+                sock = INVALID_SOCKET;
+                return ConnectResult::SoError;
+            }
+        }
+
+        // 连接成功，设回阻塞模式（便于后续 send）
+        u_long block = 0;
+        ioctlsocket(sock, FIONBIO, &block);
+
+        // 命令都很短，关闭 Nagle 避免攒包带来的延迟
+        int nodelay = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+        return ConnectResult::Ok;
+    }
+}
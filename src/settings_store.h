@@ -0,0 +1,188 @@
+// 设置快照 - 紧凑的版本化二进制文件，启动时映射读取，运行中在后台线程原子写出
+//
+// 文件格式（小端）：
+//   FileHeader   magic "TVST"、版本、文件大小、校验和（FNV-1a，覆盖头部之后的全部字节）
+//   Body         语言、当前页面、当前频道号、页面数
+//   int32 checkedItems[pageCount]   每个页面勾选的项，-1 为未勾选
+// 版本或校验不符的文件被忽略，按默认设置启动。
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mapped_file.h"
+
+struct SettingsSnapshot {
+    uint8_t language;                     // Language 枚举值
+    int32_t currentPage;
+    uint32_t currentChannel;              // 频道号，0 表示未选台
+    std::vector<int32_t> checkedItems;
+};
+
+namespace SettingsFile {
+    const uint32_t kVersion = 1;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t fileSize;
+        uint32_t checksum;
+    };
+
+    struct Body {
+        uint8_t language;
+        uint8_t reserved[3];
+        int32_t currentPage;
+        uint32_t currentChannel;
+        uint32_t pageCount;
+    };
+
+    inline uint32_t Checksum(const uint8_t* data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    // 映射并校验快照文件；失败时 snapshot 不变
+    inline bool Load(const std::string& path, SettingsSnapshot& snapshot)
+    {
+        MappedFile file;
+        if (!file.Open(path) || file.Size() < sizeof(FileHeader) + sizeof(Body)) return false;
+        const uint8_t* data = file.Data();
+        FileHeader header;
+        Body body;
+        std::memcpy(&header, data, sizeof(header));
+        std::memcpy(&body, data + sizeof(header), sizeof(body));
+        if (std::memcmp(header.magic, "TVST", 4) != 0 || header.version != kVersion ||
+            header.fileSize != file.Size() ||
+            header.checksum != Checksum(data + sizeof(header), file.Size() - sizeof(header)) ||
+            body.pageCount > (file.Size() - sizeof(header) - sizeof(body)) / sizeof(int32_t)) {
+            return false;
+        }
+        snapshot.language = body.language;
+        snapshot.currentPage = body.currentPage;
+        snapshot.currentChannel = body.currentChannel;
+        snapshot.checkedItems.resize(body.pageCount);
+        if (body.pageCount) {
+            std::memcpy(snapshot.checkedItems.data(), data + sizeof(header) + sizeof(body),
+                        body.pageCount * sizeof(int32_t));
+        }
+        return true;
+    }
+
+    // 先写临时文件再替换，中途断电也不会留下半个快照
+    inline bool Write(const std::string& path, const SettingsSnapshot& snapshot)
+    {
+        Body body;
+        std::memset(&body, 0, sizeof(body));
+        body.language = snapshot.language;
+        body.currentPage = snapshot.currentPage;
+        body.currentChannel = snapshot.currentChannel;
+        body.pageCount = static_cast<uint32_t>(snapshot.checkedItems.size());
+
+        std::vector<uint8_t> bytes(sizeof(FileHeader) + sizeof(Body) + body.pageCount * sizeof(int32_t));
+        std::memcpy(&bytes[sizeof(FileHeader)], &body, sizeof(body));
+        if (body.pageCount) {
+            std::memcpy(&bytes[sizeof(FileHeader) + sizeof(Body)], snapshot.checkedItems.data(),
+                        body.pageCount * sizeof(int32_t));
+        }
+        FileHeader header;
+        std::memcpy(header.magic, "TVST", 4);
+        header.version = kVersion;
+        header.fileSize = static_cast<uint32_t>(bytes.size());
+        header.checksum = Checksum(bytes.data() + sizeof(header), bytes.size() - sizeof(header));
+        std::memcpy(bytes.data(), &header, sizeof(header));
+
+        std::string tempPath = path + ".tmp";
+        FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        ok = FileUtil::SyncAndClose(file) && ok;
+        if (!ok || !FileUtil::AtomicReplace(tempPath, path)) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+}
+
+// 后台写快照：Post 只记下最新的快照并唤醒写线程，连续多次 Post 只写最后一次。
+// 写线程在第一次 Post 时启动；析构时写完尚未写出的快照再退出。
+class SettingsWriter
+{
+public:
+    SettingsWriter()
+        : m_pending(false)
+        , m_stop(false)
+        , m_writes(0)
+    {
+    }
+
+    ~SettingsWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    SettingsWriter(const SettingsWriter&) = delete;
+    SettingsWriter& operator=(const SettingsWriter&) = delete;
+
+    void Post(const std::string& path, const SettingsSnapshot& snapshot)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_path = path;
+            m_snapshot = snapshot;
+            m_pending = true;
+            if (!m_thread.joinable()) {
+                m_thread = std::thread(&SettingsWriter::Run, this);
+            }
+        }
+        m_wake.notify_all();
+    }
+
+    // 已成功写出的次数
+    size_t WriteCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_writes;
+    }
+
+private:
+    mutable std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+    std::string m_path;
+    SettingsSnapshot m_snapshot;
+    bool m_pending;
+    bool m_stop;
+    size_t m_writes;
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_pending || m_stop; });
+            if (!m_pending) return;
+            std::string path = m_path;
+            SettingsSnapshot snapshot = m_snapshot;
+            m_pending = false;
+            lock.unlock();
+            bool ok = SettingsFile::Write(path, snapshot);
+            lock.lock();
+            if (ok) ++m_writes;
+        }
+    }
+};
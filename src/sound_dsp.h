@@ -0,0 +1,424 @@
+// 声音模式 - Sound 页的四个预设对应的音频处理链：级联双二阶 EQ + 压缩器
+//
+// 样本为 float，按帧排列，每帧的声道数补齐到 4 的倍数（补出的声道恒为 0），这样 SSE 一次处理一帧的 4 个声道；
+// IIR 滤波每个样本依赖上一个样本，只能跨声道并行。滤波器用转置直接 II 型：
+//   y = b0 x + z1    z1 = (b1 x - a1 y) + z2    z2 = b2 x - a2 y
+// 压缩器每 kControlFrames 帧取一次所有声道的峰值，更新包络并算出目标增益，块内逐帧线性插值到目标，增益不会跳变。
+// 标量与 SSE 内核的运算顺序相同，输出逐样本一致。声道数不超过 8，AVX2 不再更快，选 AVX2 时用 SSE 内核。
+//
+// 切换预设时新链从旧链的状态起步，两条链同时处理 kFadeMilliseconds，输出从旧链线性过渡到新链，不会出现爆音。
+// SoundProcessor::SetMode 只写一个原子变量，切换在处理线程的下一个块生效，两边都不加锁。
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "yuv_convert.h"
+
+namespace Sound {
+    // Off 为未选择任何预设（直通）；其余依次对应 Sound 页的四个图块
+    enum class Mode : uint8_t { Off, Standard, Music, Movie, Sports };
+
+    const int kMaxChannels = 8;
+    const int kMaxStages = 4;
+    const int kLanes = 4;
+    const int kControlFrames = 16;
+    const double kFadeMilliseconds = 10;
+    const size_t kFadeBlock = 256;          // 过渡期间每次两条链各处理的帧数
+
+    inline const char* ModeName(Mode mode)
+    {
+        switch (mode) {
+            case Mode::Standard: return "standard";
+            case Mode::Music: return "music";
+            case Mode::Movie: return "movie";
+            case Mode::Sports: return "sports";
+            default: return "off";
+        }
+    }
+
+    // 补齐后每帧占的 float 数
+    inline int PaddedChannels(int channels) { return (channels + kLanes - 1) / kLanes * kLanes; }
+
+    enum class FilterType : uint8_t { LowShelf, Peaking, HighShelf };
+
+    struct Band {
+        FilterType type;
+        double frequency;
+        double gainDb;
+        double q;
+    };
+
+    struct Preset {
+        int bandCount;
+        Band bands[kMaxStages];
+        double ratio;           // 1 为不压缩
+        double thresholdDb;
+        double attackMs;
+        double releaseMs;
+        double makeupDb;
+    };
+
+    inline Preset GetPreset(Mode mode)
+    {
+        switch (mode) {
+            case Mode::Standard:
+                return { 0, {}, 2.0, -12, 10, 200, 0 };
+            case Mode::Music:
+                return { 3, { { FilterType::LowShelf, 100, 4, 0.707 }, { FilterType::Peaking, 400, -2, 1.0 },
+                              { FilterType::HighShelf, 8000, 3, 0.707 } },
+                         1.5, -18, 20, 300, 1 };
+            case Mode::Movie:
+                // 低频加重，对白频段提升，动态范围压得更窄
+                return { 3, { { FilterType::LowShelf, 80, 5, 0.707 }, { FilterType::Peaking, 2500, 3, 1.0 },
+                              { FilterType::HighShelf, 10000, 1, 0.707 } },
+                         3.0, -20, 5, 250, 4 };
+            case Mode::Sports:
+                // 削弱低频的现场轰鸣，突出解说
+                return { 3, { { FilterType::LowShelf, 150, -3, 0.707 }, { FilterType::Peaking, 2000, 4, 0.8 },
+                              { FilterType::Peaking, 5000, -2, 1.0 } },
+                         4.0, -24, 5, 150, 6 };
+            default:
+                return { 0, {}, 1.0, 0, 10, 100, 0 };
+        }
+    }
+
+    // 已按 a0 归一化
+    struct Coefficients {
+        float b0, b1, b2, a1, a2;
+    };
+
+    // RBJ Audio EQ Cookbook 的搁架与峰值滤波器
+    inline Coefficients Design(const Band& band, double sampleRate)
+    {
+        const double kPi = 3.14159265358979323846;
+        double a = std::pow(10.0, band.gainDb / 40);
+        double w0 = 2 * kPi * std::min(band.frequency, sampleRate * 0.49) / sampleRate;
+        double cosine = std::cos(w0);
+        double alpha = std::sin(w0) / (2 * band.q);
+        double root = 2 * std::sqrt(a) * alpha;
+        double b0, b1, b2, a0, a1, a2;
+        switch (band.type) {
+            case FilterType::LowShelf:
+                b0 = a * ((a + 1) - (a - 1) * cosine + root);
+                b1 = 2 * a * ((a - 1) - (a + 1) * cosine);
+                b2 = a * ((a + 1) - (a - 1) * cosine - root);
+                a0 = (a + 1) + (a - 1) * cosine + root;
+                a1 = -2 * ((a - 1) + (a + 1) * cosine);
+                a2 = (a + 1) + (a - 1) * cosine - root;
+                break;
+            case FilterType::HighShelf:
+                b0 = a * ((a + 1) + (a - 1) * cosine + root);
+                b1 = -2 * a * ((a - 1) + (a + 1) * cosine);
+                b2 = a * ((a + 1) + (a - 1) * cosine - root);
+                a0 = (a + 1) - (a - 1) * cosine + root;
+                a1 = 2 * ((a - 1) - (a + 1) * cosine);
+                a2 = (a + 1) - (a - 1) * cosine - root;
+                break;
+            default:
+                b0 = 1 + alpha * a;
+                b1 = -2 * cosine;
+                b2 = 1 - alpha * a;
+                a0 = 1 + alpha / a;
+                a1 = -2 * cosine;
+                a2 = 1 - alpha / a;
+                break;
+        }
+        return { static_cast<float>(b0 / a0), static_cast<float>(b1 / a0), static_cast<float>(b2 / a0),
+                 static_cast<float>(a1 / a0), static_cast<float>(a2 / a0) };
+    }
+
+    // 编译后的处理链
+    struct Chain {
+        Mode mode;
+        int stages;
+        Coefficients coefficients[kMaxStages];
+        bool compress;
+        float threshold;        // 线性幅度
+        float slope;            // 1 - 1/ratio，超过阈值部分的增益 = (threshold/envelope)^slope
+        float attack;           // 每个控制块包络向峰值靠近的比例
+        float release;
+        float makeup;
+
+        bool Empty() const { return stages == 0 && !compress; }
+    };
+
+    inline Chain Compile(Mode mode, double sampleRate)
+    {
+        Preset preset = GetPreset(mode);
+        Chain chain;
+        chain.mode = mode;
+        chain.stages = std::min(preset.bandCount, kMaxStages);
+        for (int i = 0; i < chain.stages; ++i) chain.coefficients[i] = Design(preset.bands[i], sampleRate);
+        chain.compress = preset.ratio > 1.0 || preset.makeupDb != 0;
+        chain.threshold = static_cast<float>(std::pow(10.0, preset.thresholdDb / 20));
+        chain.slope = static_cast<float>(1.0 - 1.0 / std::max(preset.ratio, 1.0));
+        double blockSeconds = kControlFrames / sampleRate;
+        chain.attack = static_cast<float>(1.0 - std::exp(-blockSeconds / (preset.attackMs / 1000)));
+        chain.release = static_cast<float>(1.0 - std::exp(-blockSeconds / (preset.releaseMs / 1000)));
+        chain.makeup = static_cast<float>(std::pow(10.0, preset.makeupDb / 20));
+        return chain;
+    }
+
+    // 各级滤波器每个声道的延迟单元，以及压缩器的包络与当前增益
+    struct State {
+        alignas(16) float z1[kMaxStages][kMaxChannels];
+        alignas(16) float z2[kMaxStages][kMaxChannels];
+        float envelope;
+        float gain;
+
+        void Clear()
+        {
+            std::memset(z1, 0, sizeof(z1));
+            std::memset(z2, 0, sizeof(z2));
+            envelope = 0;
+            gain = 1;
+        }
+    };
+
+    // 静音时 IIR 的尾巴会衰减成非规格化数，x86 上每次运算慢上百倍；处理线程启动时调用
+    inline void DisableDenormals()
+    {
+#if YUV_HAVE_X86
+        _mm_setcsr(_mm_getcsr() | 0x8040);     // FTZ | DAZ
+#endif
+    }
+
+    inline void FilterScalar(const Chain& chain, State& state, float* frames, size_t count, int stride)
+    {
+        for (int s = 0; s < chain.stages; ++s) {
+            const Coefficients& c = chain.coefficients[s];
+            for (int ch = 0; ch < stride; ++ch) {
+                float z1 = state.z1[s][ch];
+                float z2 = state.z2[s][ch];
+                float* sample = frames + ch;
+                for (size_t i = 0; i < count; ++i, sample += stride) {
+                    float x = *sample;
+                    float y = c.b0 * x + z1;
+                    z1 = (c.b1 * x - c.a1 * y) + z2;
+                    z2 = c.b2 * x - c.a2 * y;
+                    *sample = y;
+                }
+                state.z1[s][ch] = z1;
+                state.z2[s][ch] = z2;
+            }
+        }
+    }
+
+    // 对 [begin, end) 帧应用从 state.gain 线性过渡到 target 的增益
+    inline void RampScalar(float* frames, size_t begin, size_t end, int stride, float& gain, float target)
+    {
+        float step = (target - gain) / static_cast<float>(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            gain += step;
+            float* frame = frames + i * stride;
+            for (int ch = 0; ch < stride; ++ch) frame[ch] *= gain;
+        }
+        gain = target;
+    }
+
+    inline float TargetGain(const Chain& chain, State& state, float peak)
+    {
+        state.envelope += (peak > state.envelope ? chain.attack : chain.release) * (peak - state.envelope);
+        float gain = state.envelope > chain.threshold ? std::pow(chain.threshold / state.envelope, chain.slope) : 1.0f;
+        return gain * chain.makeup;
+    }
+
+    inline void CompressScalar(const Chain& chain, State& state, float* frames, size_t count, int stride)
+    {
+        for (size_t begin = 0; begin < count; begin += kControlFrames) {
+            size_t end = std::min(count, begin + kControlFrames);
+            float peak = 0;
+            for (size_t i = begin * stride; i < end * stride; ++i) peak = std::max(peak, std::fabs(frames[i]));
+            RampScalar(frames, begin, end, stride, state.gain, TargetGain(chain, state, peak));
+        }
+    }
+
+#if YUV_HAVE_X86
+    // 一次一帧中的 4 个声道，各级的延迟单元留在寄存器里
+    __attribute__((target("sse2")))
+    inline void FilterSse2(const Chain& chain, State& state, float* frames, size_t count, int stride)
+    {
+        for (int group = 0; group < stride; group += kLanes) {
+            __m128 b0[kMaxStages], b1[kMaxStages], b2[kMaxStages], a1[kMaxStages], a2[kMaxStages];
+            __m128 z1[kMaxStages], z2[kMaxStages];
+            for (int s = 0; s < chain.stages; ++s) {
+                const Coefficients& c = chain.coefficients[s];
+                b0[s] = _mm_set1_ps(c.b0);
+                b1[s] = _mm_set1_ps(c.b1);
+                b2[s] = _mm_set1_ps(c.b2);
+                a1[s] = _mm_set1_ps(c.a1);
+                a2[s] = _mm_set1_ps(c.a2);
+                z1[s] = _mm_load_ps(&state.z1[s][group]);
+                z2[s] = _mm_load_ps(&state.z2[s][group]);
+            }
+            float* sample = frames + group;
+            for (size_t i = 0; i < count; ++i, sample += stride) {
+                __m128 x = _mm_loadu_ps(sample);
+                for (int s = 0; s < chain.stages; ++s) {
+                    __m128 y = _mm_add_ps(_mm_mul_ps(b0[s], x), z1[s]);
+                    z1[s] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1[s], x), _mm_mul_ps(a1[s], y)), z2[s]);
+                    z2[s] = _mm_sub_ps(_mm_mul_ps(b2[s], x), _mm_mul_ps(a2[s], y));
+                    x = y;
+                }
+                _mm_storeu_ps(sample, x);
+            }
+            for (int s = 0; s < chain.stages; ++s) {
+                _mm_store_ps(&state.z1[s][group], z1[s]);
+                _mm_store_ps(&state.z2[s][group], z2[s]);
+            }
+        }
+    }
+
+    __attribute__((target("sse2")))
+    inline void CompressSse2(const Chain& chain, State& state, float* frames, size_t count, int stride)
+    {
+        const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (size_t begin = 0; begin < count; begin += kControlFrames) {
+            size_t end = std::min(count, begin + kControlFrames);
+            __m128 peaks = _mm_setzero_ps();
+            for (size_t i = begin * stride; i < end * stride; i += kLanes) {
+                peaks = _mm_max_ps(peaks, _mm_and_ps(_mm_loadu_ps(frames + i), magnitude));
+            }
+            peaks = _mm_max_ps(peaks, _mm_shuffle_ps(peaks, peaks, _MM_SHUFFLE(1, 0, 3, 2)));
+            peaks = _mm_max_ps(peaks, _mm_shuffle_ps(peaks, peaks, _MM_SHUFFLE(2, 3, 0, 1)));
+            float target = TargetGain(chain, state, _mm_cvtss_f32(peaks));
+
+            float gain = state.gain;
+            float step = (target - gain) / static_cast<float>(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                gain += step;
+                __m128 g = _mm_set1_ps(gain);
+                float* frame = frames + i * stride;
+                for (int ch = 0; ch < stride; ch += kLanes) {
+                    _mm_storeu_ps(frame + ch, _mm_mul_ps(_mm_loadu_ps(frame + ch), g));
+                }
+            }
+            state.gain = target;
+        }
+    }
+#endif
+
+    // frames 为补齐后的布局，原地处理 count 帧
+    inline void Process(const Chain& chain, State& state, float* frames, size_t count, int stride,
+                        Yuv::Kernel kernel = Yuv::BestKernel())
+    {
+#if YUV_HAVE_X86
+        if (kernel != Yuv::Kernel::Scalar) {
+            if (chain.stages) FilterSse2(chain, state, frames, count, stride);
+            if (chain.compress) CompressSse2(chain, state, frames, count, stride);
+            return;
+        }
+#endif
+        (void)kernel;
+        if (chain.stages) FilterScalar(chain, state, frames, count, stride);
+        if (chain.compress) CompressScalar(chain, state, frames, count, stride);
+    }
+
+    // 交错排列 <-> 补齐布局
+    inline void Pad(const float* interleaved, size_t count, int channels, float* frames, int stride)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(frames + i * stride, interleaved + i * channels, channels * sizeof(float));
+            for (int ch = channels; ch < stride; ++ch) frames[i * stride + ch] = 0;
+        }
+    }
+
+    inline void Unpad(const float* frames, size_t count, int stride, float* interleaved, int channels)
+    {
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(interleaved + i * channels, frames + i * stride, channels * sizeof(float));
+        }
+    }
+}
+
+// 按当前声音模式处理音频块；SetMode 可在任意线程调用，Process 只在处理线程调用
+class SoundProcessor
+{
+public:
+    SoundProcessor(int channels, double sampleRate, Yuv::Kernel kernel = Yuv::BestKernel())
+        : m_channels(std::min(std::max(channels, 1), Sound::kMaxChannels))
+        , m_stride(Sound::PaddedChannels(m_channels))
+        , m_sampleRate(sampleRate)
+        , m_kernel(kernel)
+        , m_requested(Sound::Mode::Off)
+        , m_fading(false)
+        , m_fadeLength(std::max<size_t>(static_cast<size_t>(sampleRate * Sound::kFadeMilliseconds / 1000), 1))
+        , m_fadePosition(0)
+    {
+        m_chain = Sound::Compile(Sound::Mode::Off, sampleRate);
+        m_state.Clear();
+    }
+
+    int Channels() const { return m_channels; }
+    int Stride() const { return m_stride; }
+
+    void SetMode(Sound::Mode mode) { m_requested.store(mode, std::memory_order_release); }
+
+    // 正在生效的模式（过渡期间为新模式）
+    Sound::Mode CurrentMode() const { return m_fading ? m_next.mode : m_chain.mode; }
+    bool Fading() const { return m_fading; }
+
+    // frames 为补齐布局（Stride() 个 float 一帧）
+    void Process(float* frames, size_t count)
+    {
+        Sound::Mode requested = m_requested.load(std::memory_order_acquire);
+        // 过渡中又切换时先走完当前过渡，下一块再开始新的过渡
+        if (!m_fading && requested != m_chain.mode) BeginFade(requested);
+        while (m_fading && count) {
+            size_t n = std::min(std::min(count, Sound::kFadeBlock), m_fadeLength - m_fadePosition);
+            std::memcpy(m_scratch, frames, n * m_stride * sizeof(float));
+            Sound::Process(m_chain, m_state, frames, n, m_stride, m_kernel);
+            Sound::Process(m_next, m_nextState, m_scratch, n, m_stride, m_kernel);
+            float length = static_cast<float>(m_fadeLength);
+            for (size_t i = 0; i < n; ++i) {
+                float t = static_cast<float>(m_fadePosition + i + 1) / length;
+                float* frame = frames + i * m_stride;
+                const float* next = m_scratch + i * m_stride;
+                for (int ch = 0; ch < m_stride; ++ch) frame[ch] += (next[ch] - frame[ch]) * t;
+            }
+            m_fadePosition += n;
+            frames += n * m_stride;
+            count -= n;
+            if (m_fadePosition == m_fadeLength) {
+                m_chain = m_next;
+                m_state = m_nextState;
+                m_fading = false;
+            }
+        }
+        if (count) Sound::Process(m_chain, m_state, frames, count, m_stride, m_kernel);
+    }
+
+private:
+    int m_channels;
+    int m_stride;
+    double m_sampleRate;
+    Yuv::Kernel m_kernel;
+    std::atomic<Sound::Mode> m_requested;
+    Sound::Chain m_chain;
+    Sound::State m_state;
+    // 过渡期间的新链
+    Sound::Chain m_next;
+    Sound::State m_nextState;
+    bool m_fading;
+    size_t m_fadeLength;
+    size_t m_fadePosition;
+    alignas(16) float m_scratch[Sound::kFadeBlock * Sound::kMaxChannels];
+
+    // 只做系数计算和状态复制，不分配内存
+    void BeginFade(Sound::Mode mode)
+    {
+        m_next = Sound::Compile(mode, m_sampleRate);
+        m_nextState = m_state;
+        // 旧链没有用到的级可能留着更早的状态
+        for (int s = m_chain.stages; s < Sound::kMaxStages; ++s) {
+            std::memset(m_nextState.z1[s], 0, sizeof(m_nextState.z1[s]));
+            std::memset(m_nextState.z2[s], 0, sizeof(m_nextState.z2[s]));
+        }
+        m_fading = true;
+        m_fadePosition = 0;
+    }
+};
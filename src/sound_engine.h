@@ -0,0 +1,484 @@
+// 声音引擎 - 流式读取 WAV 文件（解码器输出的替身），经 Sound 页预设的处理链后送到输出
+//
+// 读取线程把 PCM 转成 float 写入单生产者单消费者的无锁环形缓冲；输出线程模拟声卡时钟，每个周期取一块、
+// 处理后写入输出。输出为文件时写成 16 位 PCM WAV，否则直接丢弃（空输出，只计时）。
+// 到周期时环里不够一块即为欠载：缺的部分补静音并计数。环、模式切换与统计都只用原子变量，音频路径上不加锁。
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sound_dsp.h"
+
+// 读取 PCM WAV（8/16/24/32 位整数或 32 位浮点），转成交错排列的 float，到文件尾自动回到数据开头
+class WavReader
+{
+public:
+    WavReader()
+        : m_file(nullptr)
+        , m_channels(0)
+        , m_sampleRate(0)
+        , m_bits(0)
+        , m_float(false)
+        , m_dataOffset(0)
+        , m_frameCount(0)
+        , m_position(0)
+    {
+    }
+
+    ~WavReader() { Close(); }
+
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    bool Open(const std::string& path)
+    {
+        Close();
+        m_file = std::fopen(path.c_str(), "rb");
+        if (!m_file) return false;
+        if (!ReadHeader()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_file) std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    int Channels() const { return m_channels; }
+    int SampleRate() const { return m_sampleRate; }
+    uint64_t FrameCount() const { return m_frameCount; }
+
+    // 读 count 帧到 out（count * Channels() 个 float），文件尾循环；出错返回 false
+    bool Read(float* out, size_t count)
+    {
+        if (!m_file) return false;
+        size_t frameBytes = static_cast<size_t>(m_channels) * (m_bits / 8);
+        while (count) {
+            if (m_position >= m_frameCount) {
+                std::fseek(m_file, static_cast<long>(m_dataOffset), SEEK_SET);
+                m_position = 0;
+            }
+            size_t n = static_cast<size_t>(std::min<uint64_t>(count, m_frameCount - m_position));
+            m_raw.resize(n * frameBytes);
+            if (std::fread(m_raw.data(), frameBytes, n, m_file) != n) return false;
+            Convert(m_raw.data(), n * m_channels, out);
+            m_position += n;
+            out += n * m_channels;
+            count -= n;
+        }
+        return true;
+    }
+
+private:
+    FILE* m_file;
+    int m_channels;
+    int m_sampleRate;
+    int m_bits;
+    bool m_float;
+    uint64_t m_dataOffset;
+    uint64_t m_frameCount;
+    uint64_t m_position;
+    std::vector<uint8_t> m_raw;
+
+    static uint32_t Read32(const uint8_t* p) { return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24; }
+    static uint16_t Read16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+
+    bool ReadHeader()
+    {
+        uint8_t riff[12];
+        if (std::fread(riff, 1, 12, m_file) != 12 || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+            return false;
+        bool haveFormat = false;
+        uint8_t chunk[8];
+        while (std::fread(chunk, 1, 8, m_file) == 8) {
+            uint32_t size = Read32(chunk + 4);
+            if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+                uint8_t format[40] = {};
+                size_t take = std::min<size_t>(size, sizeof(format));
+                if (std::fread(format, 1, take, m_file) != take) return false;
+                uint16_t tag = Read16(format);
+                // WAVE_FORMAT_EXTENSIBLE 的真实格式在子格式 GUID 的前两个字节
+                if (tag == 0xFFFE && size >= 26) tag = Read16(format + 24);
+                m_channels = Read16(format + 2);
+                m_sampleRate = static_cast<int>(Read32(format + 4));
+                m_bits = Read16(format + 14);
+                m_float = tag == 3;
+                if (!(tag == 1 && (m_bits == 8 || m_bits == 16 || m_bits == 24 || m_bits == 32)) && !(m_float && m_bits == 32))
+                    return false;
+                if (m_channels < 1 || m_channels > Sound::kMaxChannels || m_sampleRate <= 0) return false;
+                haveFormat = true;
+                std::fseek(m_file, static_cast<long>(size - take + (size & 1)), SEEK_CUR);
+            } else if (std::memcmp(chunk, "data", 4) == 0) {
+                if (!haveFormat) return false;
+                m_dataOffset = static_cast<uint64_t>(std::ftell(m_file));
+                m_frameCount = size / (static_cast<uint64_t>(m_channels) * (m_bits / 8));
+                m_position = 0;
+                return m_frameCount > 0;
+            } else {
+                std::fseek(m_file, static_cast<long>(size + (size & 1)), SEEK_CUR);
+            }
+        }
+        return false;
+    }
+
+    void Convert(const uint8_t* src, size_t samples, float* dst) const
+    {
+        switch (m_bits) {
+            case 8:
+                for (size_t i = 0; i < samples; ++i) dst[i] = (src[i] - 128) * (1.0f / 128);
+                break;
+            case 16:
+                for (size_t i = 0; i < samples; ++i) dst[i] = static_cast<int16_t>(Read16(src + i * 2)) * (1.0f / 32768);
+                break;
+            case 24:
+                for (size_t i = 0; i < samples; ++i) {
+                    const uint8_t* p = src + i * 3;
+                    int32_t value = static_cast<int32_t>(static_cast<uint32_t>(p[0] << 8 | p[1] << 16 | p[2] << 24)) >> 8;
+                    dst[i] = value * (1.0f / 8388608);
+                }
+                break;
+            default:
+                if (m_float) std::memcpy(dst, src, samples * 4);
+                else for (size_t i = 0; i < samples; ++i) dst[i] = static_cast<int32_t>(Read32(src + i * 4)) * (1.0f / 2147483648.0f);
+                break;
+        }
+    }
+};
+
+// 16 位 PCM WAV 输出，关闭时补写文件头中的长度
+class WavWriter
+{
+public:
+    WavWriter()
+        : m_file(nullptr)
+        , m_channels(0)
+        , m_sampleRate(0)
+        , m_frames(0)
+    {
+    }
+
+    ~WavWriter() { Close(); }
+
+    WavWriter(const WavWriter&) = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    bool Open(const std::string& path, int channels, int sampleRate)
+    {
+        Close();
+        m_file = std::fopen(path.c_str(), "wb");
+        if (!m_file) return false;
+        m_channels = channels;
+        m_sampleRate = sampleRate;
+        m_frames = 0;
+        WriteHeader();
+        return true;
+    }
+
+    void Close()
+    {
+        if (!m_file) return;
+        std::fseek(m_file, 0, SEEK_SET);
+        WriteHeader();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    // 超出 [-1, 1] 的样本截断
+    bool Write(const float* interleaved, size_t count)
+    {
+        if (!m_file) return false;
+        size_t samples = count * m_channels;
+        m_pcm.resize(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            float value = std::min(std::max(interleaved[i], -1.0f), 1.0f) * 32767;
+            m_pcm[i] = static_cast<int16_t>(std::lround(value));
+        }
+        m_frames += count;
+        return std::fwrite(m_pcm.data(), 2, samples, m_file) == samples;
+    }
+
+private:
+    FILE* m_file;
+    int m_channels;
+    int m_sampleRate;
+    uint64_t m_frames;
+    std::vector<int16_t> m_pcm;
+
+    static void Put32(uint8_t* p, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i) p[i] = static_cast<uint8_t>(value >> (i * 8));
+    }
+
+    void WriteHeader()
+    {
+        uint32_t dataBytes = static_cast<uint32_t>(std::min<uint64_t>(m_frames * m_channels * 2, 0xFFFFFFFFu - 36));
+        uint8_t header[44];
+        std::memcpy(header, "RIFF", 4);
+        Put32(header + 4, 36 + dataBytes);
+        std::memcpy(header + 8, "WAVEfmt ", 8);
+        Put32(header + 16, 16);
+        Put32(header + 20, 1 | static_cast<uint32_t>(m_channels) << 16);                  // PCM，声道数
+        Put32(header + 24, static_cast<uint32_t>(m_sampleRate));
+        Put32(header + 28, static_cast<uint32_t>(m_sampleRate * m_channels * 2));
+        Put32(header + 32, static_cast<uint32_t>(m_channels * 2) | 16u << 16);              // 块对齐，位深
+        std::memcpy(header + 36, "data", 4);
+        Put32(header + 40, dataBytes);
+        std::fwrite(header, 1, sizeof(header), m_file);
+    }
+};
+
+// 单生产者单消费者无锁环形缓冲，容量向上取 2 的幂；写入与读取各只能在一个线程中进行
+class AudioRing
+{
+public:
+    explicit AudioRing(size_t capacity)
+        : m_head(0)
+        , m_tail(0)
+    {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    AudioRing(const AudioRing&) = delete;
+    AudioRing& operator=(const AudioRing&) = delete;
+
+    size_t Capacity() const { return m_buffer.size(); }
+    size_t Available() const { return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed); }
+    size_t Space() const { return Capacity() - (m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire)); }
+
+    // 返回实际写入的样本数
+    size_t Write(const float* data, size_t count)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        count = std::min(count, Capacity() - (head - m_tail.load(std::memory_order_acquire)));
+        size_t first = std::min(count, Capacity() - (head & m_mask));
+        std::memcpy(&m_buffer[head & m_mask], data, first * sizeof(float));
+        std::memcpy(&m_buffer[0], data + first, (count - first) * sizeof(float));
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // 返回实际读出的样本数
+    size_t Read(float* data, size_t count)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        count = std::min(count, m_head.load(std::memory_order_acquire) - tail);
+        size_t first = std::min(count, Capacity() - (tail & m_mask));
+        std::memcpy(data, &m_buffer[tail & m_mask], first * sizeof(float));
+        std::memcpy(data + first, &m_buffer[0], (count - first) * sizeof(float));
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::vector<float> m_buffer;
+    size_t m_mask;
+    // 读写位置只增不减，中间隔开一个缓存行，避免两个线程互相抢（C++14 的 new 不保证 alignas(64)）
+    std::atomic<size_t> m_head;
+    char m_padding[64];
+    std::atomic<size_t> m_tail;
+};
+
+class SoundEngine
+{
+public:
+    struct Options {
+        std::string path;
+        std::string outputPath;        // 空为不输出（空输出）
+        unsigned periodMs;
+        unsigned bufferMs;             // 环形缓冲的容量
+        Yuv::Kernel kernel;
+
+        Options()
+            : periodMs(10)
+            , bufferMs(200)
+            , kernel(Yuv::BestKernel())
+        {
+        }
+    };
+
+    struct Stats {
+        uint64_t frames;               // 已输出的帧
+        uint64_t underruns;            // 欠载的周期数
+        uint64_t underrunFrames;       // 欠载时补的静音帧
+        double processMicros;          // 最近一个周期的处理耗时
+        double realtimeFactor;         // 累计音频时长 / 累计处理耗时，即单核能跑到实时的多少倍
+        Sound::Mode mode;
+        int channels;
+        int sampleRate;
+    };
+
+    SoundEngine()
+        : m_stop(false)
+        , m_mode(Sound::Mode::Off)
+        , m_channels(0)
+        , m_sampleRate(0)
+        , m_frames(0)
+        , m_underruns(0)
+        , m_underrunFrames(0)
+        , m_processNanos(0)
+        , m_lastProcessNanos(0)
+        , m_currentMode(Sound::Mode::Off)
+    {
+    }
+
+    ~SoundEngine() { Stop(); }
+
+    SoundEngine(const SoundEngine&) = delete;
+    SoundEngine& operator=(const SoundEngine&) = delete;
+
+    bool Start(const Options& options)
+    {
+        Stop();
+        if (options.periodMs == 0 || !m_reader.Open(options.path)) return false;
+        m_channels = m_reader.Channels();
+        m_sampleRate = m_reader.SampleRate();
+        if (!options.outputPath.empty() && !m_writer.Open(options.outputPath, m_channels, m_sampleRate)) {
+            m_reader.Close();
+            return false;
+        }
+        m_options = options;
+        m_periodFrames = std::max<size_t>(static_cast<size_t>(m_sampleRate) * options.periodMs / 1000, 1);
+        size_t bufferFrames = std::max<size_t>(static_cast<size_t>(m_sampleRate) * options.bufferMs / 1000, m_periodFrames * 2);
+        m_ring.reset(new AudioRing(bufferFrames * m_channels));
+        m_processor.reset(new SoundProcessor(m_channels, m_sampleRate, options.kernel));
+        m_processor->SetMode(m_mode.load());
+        m_stop = false;
+        m_frames = 0;
+        m_underruns = 0;
+        m_underrunFrames = 0;
+        m_processNanos = 0;
+        m_lastProcessNanos = 0;
+        m_readThread = std::thread(&SoundEngine::ReadLoop, this);
+        m_outputThread = std::thread(&SoundEngine::OutputLoop, this);
+        return true;
+    }
+
+    void Stop()
+    {
+        m_stop = true;
+        if (m_readThread.joinable()) m_readThread.join();
+        if (m_outputThread.joinable()) m_outputThread.join();
+        m_reader.Close();
+        m_writer.Close();
+    }
+
+    bool IsPlaying() const { return m_outputThread.joinable(); }
+
+    // 任意线程调用，不加锁；输出线程在下一个周期开始交叉淡变
+    void SetMode(Sound::Mode mode)
+    {
+        m_mode = mode;
+        if (m_processor) m_processor->SetMode(mode);
+    }
+
+    Stats GetStats() const
+    {
+        Stats stats;
+        stats.frames = m_frames.load();
+        stats.underruns = m_underruns.load();
+        stats.underrunFrames = m_underrunFrames.load();
+        stats.processMicros = m_lastProcessNanos.load() / 1000.0;
+        uint64_t nanos = m_processNanos.load();
+        stats.realtimeFactor = nanos && m_sampleRate ? stats.frames * 1e9 / m_sampleRate / nanos : 0;
+        stats.mode = m_currentMode.load();
+        stats.channels = m_channels;
+        stats.sampleRate = m_sampleRate;
+        return stats;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    WavReader m_reader;
+    WavWriter m_writer;
+    Options m_options;
+    std::unique_ptr<AudioRing> m_ring;
+    std::unique_ptr<SoundProcessor> m_processor;
+    std::thread m_readThread;
+    std::thread m_outputThread;
+    std::atomic<bool> m_stop;
+    std::atomic<Sound::Mode> m_mode;
+    int m_channels;
+    int m_sampleRate;
+    size_t m_periodFrames;
+    std::atomic<uint64_t> m_frames;
+    std::atomic<uint64_t> m_underruns;
+    std::atomic<uint64_t> m_underrunFrames;
+    std::atomic<uint64_t> m_processNanos;
+    std::atomic<uint64_t> m_lastProcessNanos;
+    std::atomic<Sound::Mode> m_currentMode;
+
+    // 环里空出一个周期以上就补满；满时睡半个周期
+    void ReadLoop()
+    {
+        std::vector<float> block(m_periodFrames * m_channels);
+        while (!m_stop) {
+            size_t frames = m_ring->Space() / m_channels;
+            if (frames < m_periodFrames) {
+                std::this_thread::sleep_for(std::chrono::microseconds(m_options.periodMs * 500));
+                continue;
+            }
+            frames = std::min(frames, block.size() / m_channels);
+            if (!m_reader.Read(block.data(), frames)) break;
+            m_ring->Write(block.data(), frames * m_channels);
+        }
+    }
+
+    void OutputLoop()
+    {
+        Sound::DisableDenormals();
+        std::vector<float> interleaved(m_periodFrames * m_channels);
+        std::vector<float> padded(m_periodFrames * m_processor->Stride());
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(m_periodFrames) / m_sampleRate));
+
+        // 先等环里攒下一半再开始计时，启动时不算欠载
+        Clock::time_point waitUntil = Clock::now() + period * 20;
+        while (!m_stop && m_ring->Available() < m_ring->Capacity() / 2 && Clock::now() < waitUntil) {
+            std::this_thread::sleep_for(period / 4);
+        }
+        Clock::time_point deadline = Clock::now();
+        while (!m_stop) {
+            size_t samples = m_ring->Read(interleaved.data(), interleaved.size());
+            if (samples < interleaved.size()) {
+                std::fill(interleaved.begin() + samples, interleaved.end(), 0.0f);
+                ++m_underruns;
+                m_underrunFrames += (interleaved.size() - samples) / m_channels;
+            }
+
+            Clock::time_point start = Clock::now();
+            Sound::Pad(interleaved.data(), m_periodFrames, m_channels, padded.data(), m_processor->Stride());
+            m_processor->Process(padded.data(), m_periodFrames);
+            Sound::Unpad(padded.data(), m_periodFrames, m_processor->Stride(), interleaved.data(), m_channels);
+            uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+            m_lastProcessNanos = nanos;
+            m_processNanos += nanos;
+            m_currentMode = m_processor->CurrentMode();
+
+            m_writer.Write(interleaved.data(), m_periodFrames);
+            m_frames += m_periodFrames;
+
+            // 按声卡节奏取下一块；落后（如被调试器暂停）时从现在重新计时，不连续追赶
+            deadline += period;
+            Clock::time_point now = Clock::now();
+            if (deadline > now) std::this_thread::sleep_until(deadline);
+            else if (now - deadline > period * 4) deadline = now;
+        }
+    }
+};
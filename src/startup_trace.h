@@ -0,0 +1,240 @@
+// 启动计时 - 记录 OnInit 到首帧之间各阶段的单调时间戳，以及每个控件的首次绘制
+//
+// 设置环境变量 TV_STARTUP_TRACE 时启用：值为 Chrome trace JSON 的输出路径（为 1 时写到
+// startup_trace.json），首帧完成后把文本报告打印到标准输出并写出 JSON，
+// 可在 chrome://tracing 或 ui.perfetto.dev 中查看。未启用时每个计时点只有一次布尔判断。
+// 只在 UI 线程使用。
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class StartupTrace
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static StartupTrace& Instance()
+    {
+        static StartupTrace trace;
+        return trace;
+    }
+
+    bool IsEnabled() const { return m_enabled; }
+
+    // 没有设置环境变量时也记录（如 --exit-after-first-frame 只需要首帧时间）
+    void Enable() { m_enabled = true; }
+
+    // 阶段开始，返回 End 用的序号；阶段可以嵌套
+    size_t Begin(const char* name)
+    {
+        Event event;
+        event.name = name;
+        event.start = NowMicros();
+        event.duration = 0;
+        event.depth = m_depth++;
+        event.instant = false;
+        m_events.push_back(event);
+        return m_events.size() - 1;
+    }
+
+    void End(size_t index)
+    {
+        m_events[index].duration = NowMicros() - m_events[index].start;
+        --m_depth;
+    }
+
+    // 瞬时事件
+    void Mark(const std::string& name)
+    {
+        Event event;
+        event.name = name;
+        event.start = NowMicros();
+        event.duration = 0;
+        event.depth = m_depth;
+        event.instant = true;
+        m_events.push_back(event);
+    }
+
+    // 该控件是否第一次绘制（只记录首次）
+    bool IsFirstPaint(const void* widget)
+    {
+        return m_painted.insert(widget).second;
+    }
+
+    size_t PaintCount() const { return m_painted.size(); }
+    bool IsFinished() const { return m_finished; }
+
+    // 首帧完成：记下时间点，按环境变量输出报告；返回首帧时间（毫秒）
+    double Finish()
+    {
+        Mark("first frame");
+        m_finished = true;
+        double firstFrameMs = m_events.back().start / 1000.0;
+        if (!m_outputPath.empty()) {
+            WriteText(stdout);
+            if (WriteChromeTrace(m_outputPath)) {
+                std::printf("startup trace written to %s\n", m_outputPath.c_str());
+            }
+        }
+        return firstFrameMs;
+    }
+
+    // 文本报告：按开始时间排列、按嵌套缩进；同一层级重复出现的同名阶段（如各控件的首次绘制）合并成一行
+    void WriteText(FILE* out) const
+    {
+        std::fprintf(out, "%10s %10s  %s\n", "start ms", "dur ms", "phase");
+        std::vector<std::pair<std::string, int>> printed;
+        for (const Event& event : m_events) {
+            std::pair<std::string, int> key(event.name, event.depth);
+            if (std::find(printed.begin(), printed.end(), key) != printed.end()) continue;
+            printed.push_back(key);
+            size_t count = 0;
+            int64_t total = 0;
+            for (const Event& other : m_events) {
+                if (other.name == event.name && other.depth == event.depth) {
+                    ++count;
+                    total += other.duration;
+                }
+            }
+            char duration[32] = "-";
+            if (!event.instant) std::snprintf(duration, sizeof(duration), "%.2f", total / 1000.0);
+            std::fprintf(out, "%10.2f %10s  %*s%s", event.start / 1000.0, duration, event.depth * 2, "",
+                         event.name.c_str());
+            std::fprintf(out, count > 1 ? " x%zu\n" : "\n", count);
+        }
+    }
+
+    // Chrome trace 事件格式：阶段为 "X" 完整事件，瞬时事件为 "i"
+    bool WriteChromeTrace(const std::string& path) const
+    {
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) return false;
+        std::fprintf(file, "{\"traceEvents\":[\n");
+        for (size_t i = 0; i < m_events.size(); ++i) {
+            const Event& event = m_events[i];
+            std::string name;
+            for (char c : event.name) {
+                if (c == '"' || c == '\\') name += '\\';
+                name += c;
+            }
+            if (event.instant) {
+                std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%lld,\"pid\":1,\"tid\":1}",
+                             name.c_str(), static_cast<long long>(event.start));
+            } else {
+                std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":1}",
+                             name.c_str(), static_cast<long long>(event.start), static_cast<long long>(event.duration));
+            }
+            std::fprintf(file, i + 1 < m_events.size() ? ",\n" : "\n");
+        }
+        std::fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+        return std::fclose(file) == 0;
+    }
+
+private:
+    struct Event {
+        std::string name;
+        int64_t start;       // 相对第一次使用计时器的微秒数
+        int64_t duration;
+        int depth;
+        bool instant;
+    };
+
+    Clock::time_point m_origin;
+    std::vector<Event> m_events;
+    std::set<const void*> m_painted;
+    std::string m_outputPath;
+    int m_depth;
+    bool m_enabled;
+    bool m_finished;
+
+    StartupTrace()
+        : m_origin(Clock::now())
+        , m_depth(0)
+        , m_enabled(false)
+        , m_finished(false)
+    {
+        const char* value = std::getenv("TV_STARTUP_TRACE");
+        if (value && *value) {
+            m_enabled = true;
+            m_outputPath = std::strcmp(value, "1") == 0 ? "startup_trace.json" : value;
+        }
+    }
+
+    int64_t NowMicros() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_origin).count();
+    }
+};
+
+// RAII 阶段计时，未启用时不记录。顺序执行的几个阶段可用 Next 接续：
+//     StartupPhase phase("BackgroundFrame");
+//     ...
+//     phase.Next("MyFrame");
+class StartupPhase
+{
+public:
+    explicit StartupPhase(const char* name)
+        : m_index(kNone)
+    {
+        Next(name);
+    }
+
+    ~StartupPhase() { End(); }
+
+    // 结束当前阶段并开始下一个
+    void Next(const char* name)
+    {
+        End();
+        StartupTrace& trace = StartupTrace::Instance();
+        if (trace.IsEnabled() && !trace.IsFinished()) {
+            m_index = trace.Begin(name);
+        }
+    }
+
+    void End()
+    {
+        if (m_index != kNone) StartupTrace::Instance().End(m_index);
+        m_index = kNone;
+    }
+
+    StartupPhase(const StartupPhase&) = delete;
+    StartupPhase& operator=(const StartupPhase&) = delete;
+
+private:
+    enum : size_t { kNone = static_cast<size_t>(-1) };
+    size_t m_index;
+};
+
+// 控件的首次绘制计时：只有该控件第一次绘制时才记录
+class StartupPaintScope
+{
+public:
+    StartupPaintScope(const void* widget, const char* name)
+        : m_index(kNone)
+    {
+        StartupTrace& trace = StartupTrace::Instance();
+        if (trace.IsEnabled() && !trace.IsFinished() && trace.IsFirstPaint(widget)) {
+            m_index = trace.Begin(name);
+        }
+    }
+
+    ~StartupPaintScope()
+    {
+        if (m_index != kNone) StartupTrace::Instance().End(m_index);
+    }
+
+    StartupPaintScope(const StartupPaintScope&) = delete;
+    StartupPaintScope& operator=(const StartupPaintScope&) = delete;
+
+private:
+    enum : size_t { kNone = static_cast<size_t>(-1) };
+    size_t m_index;
+};
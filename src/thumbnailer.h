@@ -0,0 +1,364 @@
+// 信号源缩略图 - Source 页每个图块显示对应输入的实时小画面
+//
+// 缩略图线程轮流向各信号源要一帧（InputSource::Snapshot：出帧中的源复制下一帧，停着的源临时画一帧），
+// 按信号源的宽高比、区域平均缩小到图块的缩略图框内，UI 线程取走后转成位图交给 TileButton，绘制时只需贴图。
+// 每块有刷新率上限；所有缩略图合计占用的 CPU（源线程为此多花的时间加上缩小的时间）不超过设定的比例：
+// 做完一块耗时 t 后至少休息 t / budget - t 再做下一块。
+//
+// 缩小按输出像素对应的源矩形求平均：先把矩形内的各行逐字节累加到 16 位的列和（SIMD），
+// 再横向把矩形内的列和相加，最后统一用整数除法四舍五入。各内核只在逐行累加上不同，结果完全一致。
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "input_source.h"
+#include "yuv_convert.h"
+
+namespace Thumbnail {
+    // 16 位列和一次最多累加的行数：255 * 257 = 65535
+    const int kMaxRowsPerPass = 257;
+
+    // 缩小用的临时缓冲，复用后不再分配
+    struct Scratch {
+        std::vector<uint16_t> narrow;
+        std::vector<uint32_t> wide;
+    };
+
+    inline void AccumulateScalar(const uint8_t* row, uint16_t* sums, size_t begin, size_t count)
+    {
+        for (size_t i = begin; i < count; ++i) sums[i] = static_cast<uint16_t>(sums[i] + row[i]);
+    }
+
+#if YUV_HAVE_X86
+    // 每次 16 个字节，零扩展成两组 16 位后累加
+    __attribute__((target("sse2")))
+    inline size_t AccumulateSse2(const uint8_t* row, uint16_t* sums, size_t count)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            __m128i* out = reinterpret_cast<__m128i*>(sums + i);
+            _mm_storeu_si128(out, _mm_add_epi16(_mm_loadu_si128(out), _mm_unpacklo_epi8(v, zero)));
+            _mm_storeu_si128(out + 1, _mm_add_epi16(_mm_loadu_si128(out + 1), _mm_unpackhi_epi8(v, zero)));
+        }
+        return i;
+    }
+#endif
+
+#if YUV_HAVE_AVX2
+    // 每次 32 个字节
+    __attribute__((target("avx2")))
+    inline size_t AccumulateAvx2(const uint8_t* row, uint16_t* sums, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i low = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i)));
+            __m256i high = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i + 16)));
+            __m256i* out = reinterpret_cast<__m256i*>(sums + i);
+            _mm256_storeu_si256(out, _mm256_add_epi16(_mm256_loadu_si256(out), low));
+            _mm256_storeu_si256(out + 1, _mm256_add_epi16(_mm256_loadu_si256(out + 1), high));
+        }
+        return i;
+    }
+#endif
+
+    // sums[i] += row[i]，i < count
+    inline void Accumulate(const uint8_t* row, uint16_t* sums, size_t count, Yuv::Kernel kernel)
+    {
+        size_t done = 0;
+#if YUV_HAVE_AVX2
+        if (kernel == Yuv::Kernel::Avx2) done = AccumulateAvx2(row, sums, count);
+#endif
+#if YUV_HAVE_X86
+        if (kernel != Yuv::Kernel::Scalar) done += AccumulateSse2(row + done, sums + done, count - done);
+#endif
+        AccumulateScalar(row, sums, done, count);
+    }
+
+    // 横向：输出行的每个像素把对应的 [left, right) 列的列和相加，除以矩形的像素数
+    template <typename Sum>
+    inline void SumColumns(const Sum* sums, int srcWidth, int rows, uint8_t* out, int dstWidth)
+    {
+        for (int x = 0; x < dstWidth; ++x) {
+            int left = static_cast<int>(static_cast<int64_t>(x) * srcWidth / dstWidth);
+            int right = std::max(static_cast<int>(static_cast<int64_t>(x + 1) * srcWidth / dstWidth), left + 1);
+            uint32_t area = static_cast<uint32_t>((right - left) * rows);
+            uint64_t sum[4] = { 0, 0, 0, 0 };
+            for (int column = left; column < right; ++column) {
+                const Sum* pixel = sums + static_cast<size_t>(column) * 4;
+                sum[0] += pixel[0];
+                sum[1] += pixel[1];
+                sum[2] += pixel[2];
+                sum[3] += pixel[3];
+            }
+            for (int channel = 0; channel < 4; ++channel) {
+                out[x * 4 + channel] = static_cast<uint8_t>((sum[channel] + area / 2) / area);
+            }
+        }
+    }
+
+    // 把 32 位像素的源图按区域平均缩小到 dstWidth x dstHeight（四个字节各自平均）。
+    // 目标比源大的方向上退化为取最近的像素
+    inline void BoxDownscale(const uint8_t* src, ptrdiff_t srcStride, int srcWidth, int srcHeight,
+                             uint8_t* dst, ptrdiff_t dstStride, int dstWidth, int dstHeight, Scratch& scratch,
+                             Yuv::Kernel kernel = Yuv::BestKernel())
+    {
+        if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) return;
+        size_t rowBytes = static_cast<size_t>(srcWidth) * 4;
+        scratch.narrow.resize(rowBytes);
+        if (srcHeight > kMaxRowsPerPass) scratch.wide.resize(rowBytes);
+        for (int y = 0; y < dstHeight; ++y) {
+            int top = static_cast<int>(static_cast<int64_t>(y) * srcHeight / dstHeight);
+            int bottom = std::max(static_cast<int>(static_cast<int64_t>(y + 1) * srcHeight / dstHeight), top + 1);
+            uint8_t* out = dst + y * dstStride;
+            if (bottom - top <= kMaxRowsPerPass) {
+                // 常见情况：一次累加完，直接从 16 位列和横向求和
+                std::fill(scratch.narrow.begin(), scratch.narrow.end(), static_cast<uint16_t>(0));
+                for (int r = top; r < bottom; ++r) Accumulate(src + r * srcStride, scratch.narrow.data(), rowBytes, kernel);
+                SumColumns(scratch.narrow.data(), srcWidth, bottom - top, out, dstWidth);
+                continue;
+            }
+            // 纵向：16 位列和每满 kMaxRowsPerPass 行并入 32 位列和
+            std::fill(scratch.wide.begin(), scratch.wide.end(), 0u);
+            for (int row = top; row < bottom; row += kMaxRowsPerPass) {
+                int end = std::min(row + kMaxRowsPerPass, bottom);
+                std::fill(scratch.narrow.begin(), scratch.narrow.end(), static_cast<uint16_t>(0));
+                for (int r = row; r < end; ++r) Accumulate(src + r * srcStride, scratch.narrow.data(), rowBytes, kernel);
+                for (size_t i = 0; i < rowBytes; ++i) scratch.wide[i] += scratch.narrow[i];
+            }
+            SumColumns(scratch.wide.data(), srcWidth, bottom - top, out, dstWidth);
+        }
+    }
+}
+
+// 缩略图线程：构造时启动，SetEnabled(true) 后才工作（Source 页不可见时停在条件变量上）。
+// sources 须已添加全部信号源，且比本对象活得久
+class SourceThumbnailer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Options {
+        int width;                 // 缩略图框，每个信号源的画面按自身宽高比缩放到框内
+        int height;
+        double maxFps;             // 每块的刷新上限
+        double cpuBudget;          // 全部缩略图合计占一个核的比例
+        unsigned timeoutMs;        // 等信号源交出一帧的最长时间（锁定中的源会超时，本轮跳过）
+        Yuv::Kernel kernel;
+
+        Options()
+            : width(128)
+            , height(68)
+            , maxFps(4)
+            , cpuBudget(0.05)
+            , timeoutMs(100)
+            , kernel(Yuv::BestKernel())
+        {
+        }
+    };
+
+    struct Stats {
+        uint64_t thumbnails;
+        uint64_t timeouts;
+        double lastRenderMicros;   // 最近一块信号源交出画面的耗时（源线程中）
+        double lastScaleMicros;    // 最近一块缩小的耗时
+        double cpuShare;           // 启用期间缩略图实际占用的 CPU 比例
+    };
+
+    SourceThumbnailer(SourceSwitcher& sources, const Options& options, const std::function<void()>& onThumbnail)
+        : m_sources(sources)
+        , m_options(options)
+        , m_onThumbnail(onThumbnail)
+        , m_tiles(sources.Count())
+        , m_enabled(false)
+        , m_stop(false)
+        , m_thumbnails(0)
+        , m_timeouts(0)
+        , m_lastRenderMicros(0)
+        , m_lastScaleMicros(0)
+        , m_workMicros(0)
+        , m_enabledMicros(0)
+    {
+        m_options.maxFps = m_options.maxFps > 0 ? m_options.maxFps : 4;
+        m_options.cpuBudget = std::min(std::max(m_options.cpuBudget, 0.001), 1.0);
+        m_thread = std::thread(&SourceThumbnailer::Run, this);
+    }
+
+    ~SourceThumbnailer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    SourceThumbnailer(const SourceThumbnailer&) = delete;
+    SourceThumbnailer& operator=(const SourceThumbnailer&) = delete;
+
+    void SetEnabled(bool enabled)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (enabled == m_enabled) return;
+            m_enabled = enabled;
+            if (enabled) {
+                m_enabledSince = Clock::now();
+            } else {
+                m_enabledMicros += std::chrono::duration<double, std::micro>(Clock::now() - m_enabledSince).count();
+            }
+        }
+        m_wake.notify_all();
+    }
+
+    // 从下一块起生效
+    void SetSize(int width, int height)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_options.width = std::max(width, 1);
+        m_options.height = std::max(height, 1);
+    }
+
+    // 第 index 块有比 sequence 新的缩略图时复制出来并更新 sequence
+    bool Take(int index, uint64_t& sequence, std::vector<uint8_t>& pixels, int& width, int& height) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (index < 0 || index >= static_cast<int>(m_tiles.size())) return false;
+        const Tile& tile = m_tiles[index];
+        if (tile.sequence == sequence) return false;
+        sequence = tile.sequence;
+        pixels = tile.pixels;
+        width = tile.width;
+        height = tile.height;
+        return true;
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        Stats stats;
+        stats.thumbnails = m_thumbnails;
+        stats.timeouts = m_timeouts;
+        stats.lastRenderMicros = m_lastRenderMicros;
+        stats.lastScaleMicros = m_lastScaleMicros;
+        double enabledMicros = m_enabledMicros;
+        if (m_enabled) enabledMicros += std::chrono::duration<double, std::micro>(Clock::now() - m_enabledSince).count();
+        stats.cpuShare = enabledMicros > 0 ? m_workMicros / enabledMicros : 0;
+        return stats;
+    }
+
+private:
+    struct Tile {
+        uint64_t sequence;
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+        Clock::time_point due;     // 到这个时间才刷新下一次
+
+        Tile() : sequence(0), width(0), height(0) {}
+    };
+
+    SourceSwitcher& m_sources;
+    Options m_options;
+    std::function<void()> m_onThumbnail;
+    std::thread m_thread;
+    mutable std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::vector<Tile> m_tiles;
+    bool m_enabled;
+    bool m_stop;
+    Clock::time_point m_resume;    // 预算要求的休息到这个时间为止
+    Clock::time_point m_enabledSince;
+    uint64_t m_thumbnails;
+    uint64_t m_timeouts;
+    double m_lastRenderMicros;
+    double m_lastScaleMicros;
+    double m_workMicros;
+    double m_enabledMicros;
+    // 以下只在缩略图线程中访问
+    std::vector<uint8_t> m_frame;
+    std::vector<uint8_t> m_scaled;
+    Thumbnail::Scratch m_scratch;
+
+    void Run()
+    {
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / m_options.maxFps));
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || (m_enabled && !m_tiles.empty()); });
+            if (m_stop) return;
+
+            // 到期最早的一块，且预算要求的休息已结束
+            size_t next = 0;
+            for (size_t i = 1; i < m_tiles.size(); ++i) {
+                if (m_tiles[i].due < m_tiles[next].due) next = i;
+            }
+            Clock::time_point start = std::max(m_tiles[next].due, m_resume);
+            if (m_wake.wait_until(lock, start, [this] { return m_stop || !m_enabled; })) continue;
+
+            int width = m_options.width;
+            int height = m_options.height;
+            lock.unlock();
+
+            Clock::time_point begin = Clock::now();
+            int frameWidth = 0;
+            int frameHeight = 0;
+            double renderMicros = 0;
+            bool taken = m_sources.At(static_cast<int>(next)).Snapshot(
+                m_frame, frameWidth, frameHeight, renderMicros, std::chrono::milliseconds(m_options.timeoutMs));
+            double scaleMicros = 0;
+            if (taken && frameWidth > 0 && frameHeight > 0) {
+                // 与背景视频相同的等比适配：先按框宽算高，超出框高时改按框高算宽
+                int fitHeight = static_cast<int>(static_cast<int64_t>(width) * frameHeight / frameWidth);
+                if (fitHeight > height) {
+                    width = static_cast<int>(static_cast<int64_t>(height) * frameWidth / frameHeight);
+                } else {
+                    height = fitHeight;
+                }
+                width = std::max(width, 1);
+                height = std::max(height, 1);
+            }
+            if (taken) {
+                Clock::time_point scaleStart = Clock::now();
+                m_scaled.resize(static_cast<size_t>(width) * height * 4);
+                Thumbnail::BoxDownscale(m_frame.data(), static_cast<ptrdiff_t>(frameWidth) * 4, frameWidth, frameHeight,
+                                        m_scaled.data(), static_cast<ptrdiff_t>(width) * 4, width, height, m_scratch,
+                                        m_options.kernel);
+                scaleMicros = std::chrono::duration<double, std::micro>(Clock::now() - scaleStart).count();
+            }
+
+            lock.lock();
+            Tile& tile = m_tiles[next];
+            tile.due = begin + period;
+            double work = renderMicros + scaleMicros;
+            m_workMicros += work;
+            m_resume = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::micro>(work / m_options.cpuBudget - work));
+            if (!taken) {
+                ++m_timeouts;
+                continue;
+            }
+            tile.pixels.swap(m_scaled);
+            tile.width = width;
+            tile.height = height;
+            ++tile.sequence;
+            ++m_thumbnails;
+            m_lastRenderMicros = renderMicros;
+            m_lastScaleMicros = scaleMicros;
+            lock.unlock();
+            if (m_onThumbnail) m_onThumbnail();
+            lock.lock();
+        }
+    }
+};
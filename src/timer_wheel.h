@@ -0,0 +1,316 @@
+// 分层时间轮 - 毫秒精度，插入与取消 O(1)
+//
+// 4 层、每层 64 个槽，第 l 层每槽跨度 64^l 毫秒，覆盖约 4.6 小时；更远的期限先挂在顶层，
+// 到时再重新分配。每层有一个占用位图，NextDeadline 可直接算出最近的到期时间，
+// 调用方只需在那个时刻唤醒一次，空闲时没有任何周期性唤醒。
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class TimerWheel
+{
+public:
+    typedef uint64_t TimerId;   // 0 表示无效
+    typedef std::function<void()> Callback;
+
+    explicit TimerWheel(uint64_t nowMs = 0)
+        : m_now(nowMs)
+        , m_freeHead(kNil)
+        , m_size(0)
+        , m_firing(kNil)
+        , m_dispatching(false)
+    {
+        for (int i = 0; i <= kLists; ++i) m_heads[i] = kNil;
+        for (int l = 0; l < kLevels; ++l) m_occupied[l] = 0;
+    }
+
+    // 一次性定时器：delayMs 毫秒后回调
+    TimerId Schedule(uint64_t delayMs, Callback callback)
+    {
+        return Add(m_now + delayMs, 0, std::move(callback));
+    }
+
+    // 周期定时器：每 intervalMs 毫秒回调一次，直到 Cancel
+    TimerId ScheduleRepeating(uint64_t intervalMs, Callback callback)
+    {
+        if (intervalMs == 0) intervalMs = 1;
+        return Add(m_now + intervalMs, intervalMs, std::move(callback));
+    }
+
+    // 在绝对时间 deadlineMs 首次回调（早于当前时间则下一毫秒）；intervalMs 为 0 时只回调一次。
+    // 时间轮长时间未推进时，调用方用它按真实时间算期限，而不是相对滞后的 Now()
+    TimerId ScheduleAt(uint64_t deadlineMs, uint64_t intervalMs, Callback callback)
+    {
+        return Add(deadlineMs, intervalMs, std::move(callback));
+    }
+
+    // 取消定时器；回调中取消自己或其他定时器都是安全的
+    bool Cancel(TimerId id)
+    {
+        uint32_t index;
+        if (!Lookup(id, index)) return false;
+        Node& node = m_nodes[index];
+        if (node.list != kFiring || index != m_firing) {
+            Unlink(index);
+        }
+        Release(index);
+        return true;
+    }
+
+    bool IsPending(TimerId id) const
+    {
+        uint32_t index;
+        return Lookup(id, index);
+    }
+
+    size_t Size() const { return m_size; }
+    uint64_t Now() const { return m_now; }
+
+    // 最近一个定时器的到期时间；没有定时器时返回 false
+    bool NextDeadline(uint64_t& deadline) const
+    {
+        bool found = false;
+        for (int l = 0; l < kLevels; ++l) {
+            if (!m_occupied[l]) continue;
+            int slot = NextOccupiedSlot(l);
+            // 同层更靠后的槽时间区间更晚，只需看第一个有定时器的槽
+            for (uint32_t i = m_heads[l * kSlots + slot]; i != kNil; i = m_nodes[i].next) {
+                if (!found || m_nodes[i].deadline < deadline) {
+                    deadline = m_nodes[i].deadline;
+                    found = true;
+                }
+            }
+        }
+        return found;
+    }
+
+    // 推进到 nowMs，依次触发所有已到期的定时器。
+    // 回调中再次调用（如回调里跑了嵌套事件循环）直接返回，由外层继续处理，否则会覆盖正在触发的链表
+    void Advance(uint64_t nowMs)
+    {
+        if (m_dispatching) return;
+        m_dispatching = true;
+        uint64_t tick;
+        while (NextEventTick(tick) && tick <= nowMs) {
+            ProcessTick(tick);
+        }
+        if (nowMs > m_now) m_now = nowMs;
+        m_dispatching = false;
+    }
+
+private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 6;
+    static const int kSlots = 1 << kSlotBits;
+    static const int kLists = kLevels * kSlots;
+    static const uint32_t kNil = 0xFFFFFFFFu;
+    static const int kFiring = kLists;   // 正在触发的节点不在任何槽中
+    static const int kFree = kLists + 1;
+
+    struct Node {
+        uint64_t deadline;
+        uint64_t interval;   // 0 表示一次性
+        Callback callback;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+        int list;
+    };
+
+    uint64_t m_now;
+    std::vector<Node> m_nodes;
+    uint32_t m_heads[kLists + 1];   // 最后一个是触发链表
+    uint64_t m_occupied[kLevels];   // 每层的槽占用位图
+    uint32_t m_freeHead;
+    size_t m_size;
+    uint32_t m_firing;              // 当前正在执行回调的节点
+    bool m_dispatching;             // Advance 正在触发回调
+
+    static int SlotOf(uint64_t time, int level)
+    {
+        return static_cast<int>((time >> (level * kSlotBits)) & (kSlots - 1));
+    }
+
+    TimerId Add(uint64_t deadline, uint64_t interval, Callback callback)
+    {
+        uint32_t index;
+        if (m_freeHead != kNil) {
+            index = m_freeHead;
+            m_freeHead = m_nodes[index].next;
+        } else {
+            index = static_cast<uint32_t>(m_nodes.size());
+            m_nodes.push_back(Node());
+            m_nodes[index].generation = 0;
+        }
+        Node& node = m_nodes[index];
+        node.deadline = deadline;
+        node.interval = interval;
+        node.callback = std::move(callback);
+        ++m_size;
+        Place(index);
+        return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+    }
+
+    bool Lookup(TimerId id, uint32_t& index) const
+    {
+        uint32_t low = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+        if (low == 0 || low > m_nodes.size()) return false;
+        index = low - 1;
+        const Node& node = m_nodes[index];
+        return node.list != kFree && node.generation == static_cast<uint32_t>(id >> 32);
+    }
+
+    void Release(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        node.callback = Callback();
+        node.list = kFree;
+        ++node.generation;   // 旧句柄失效
+        node.next = m_freeHead;
+        m_freeHead = index;
+        --m_size;
+    }
+
+    // 按距当前时间的远近选择层与槽；已到期的放到下一毫秒
+    void Place(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        uint64_t deadline = node.deadline <= m_now ? m_now + 1 : node.deadline;
+        uint64_t delta = deadline - m_now;
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (uint64_t(1) << ((level + 1) * kSlotBits))) {
+            ++level;
+        }
+        if (delta >= (uint64_t(1) << (kLevels * kSlotBits))) {
+            // 超出时间轮范围，先放在顶层最远的槽，到时重新分配
+            deadline = m_now + (uint64_t(1) << (kLevels * kSlotBits)) - 1;
+        }
+        Link(index, level * kSlots + SlotOf(deadline, level));
+    }
+
+    void Link(uint32_t index, int list)
+    {
+        Node& node = m_nodes[index];
+        node.list = list;
+        node.prev = kNil;
+        node.next = m_heads[list];
+        if (node.next != kNil) m_nodes[node.next].prev = index;
+        m_heads[list] = index;
+        if (list < kLists) m_occupied[list / kSlots] |= uint64_t(1) << (list % kSlots);
+    }
+
+    void Unlink(uint32_t index)
+    {
+        Node& node = m_nodes[index];
+        if (node.prev != kNil) m_nodes[node.prev].next = node.next;
+        else m_heads[node.list] = node.next;
+        if (node.next != kNil) m_nodes[node.next].prev = node.prev;
+        if (node.list < kLists && m_heads[node.list] == kNil) {
+            m_occupied[node.list / kSlots] &= ~(uint64_t(1) << (node.list % kSlots));
+        }
+    }
+
+    // 第 level 层在当前位置之后（循环方向）第一个有定时器的槽
+    int NextOccupiedSlot(int level) const
+    {
+        int current = SlotOf(m_now, level);
+        int shift = (current + 1) & (kSlots - 1);
+        uint64_t bits = m_occupied[level];
+        uint64_t rotated = shift ? (bits >> shift) | (bits << (kSlots - shift)) : bits;
+        int offset = 0;
+        while (!(rotated & 1)) {
+            rotated >>= 1;
+            ++offset;
+        }
+        return (shift + offset) & (kSlots - 1);
+    }
+
+    // 下一个需要处理的时刻：某层第一个非空槽被走到的时刻
+    bool NextEventTick(uint64_t& tick) const
+    {
+        bool found = false;
+        for (int l = 0; l < kLevels; ++l) {
+            if (!m_occupied[l]) continue;
+            int slot = NextOccupiedSlot(l);
+            uint64_t base = m_now >> (l * kSlotBits);
+            uint64_t ahead = static_cast<uint64_t>((slot - static_cast<int>(base & (kSlots - 1)) - 1) & (kSlots - 1)) + 1;
+            uint64_t t = (base + ahead) << (l * kSlotBits);
+            if (!found || t < tick) {
+                tick = t;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    void ProcessTick(uint64_t tick)
+    {
+        m_now = tick;
+
+        // 由高到低把走到的高层槽重新分配到低层
+        for (int l = kLevels - 1; l >= 1; --l) {
+            if (tick & ((uint64_t(1) << (l * kSlotBits)) - 1)) continue;
+            int list = l * kSlots + SlotOf(tick, l);
+            uint32_t i = m_heads[list];
+            m_heads[list] = kNil;
+            m_occupied[l] &= ~(uint64_t(1) << (list % kSlots));
+            while (i != kNil) {
+                uint32_t next = m_nodes[i].next;
+                if (m_nodes[i].deadline <= tick) {
+                    Link(i, SlotOf(tick, 0));   // 正好本毫秒到期，放进马上要触发的槽
+                } else {
+                    Place(i);
+                }
+                i = next;
+            }
+        }
+
+        // 把到期槽整体移到触发链表，逐个取出执行，回调中可任意增删定时器
+        int list = SlotOf(tick, 0);
+        uint32_t i = m_heads[list];
+        m_heads[list] = kNil;
+        m_occupied[0] &= ~(uint64_t(1) << list);
+        uint32_t firingHead = kNil;
+        while (i != kNil) {
+            uint32_t next = m_nodes[i].next;
+            if (m_nodes[i].deadline > tick) {
+                Place(i);   // 超出时间轮范围的定时器，继续等待
+            } else {
+                m_nodes[i].list = kFiring;
+                m_nodes[i].prev = kNil;
+                m_nodes[i].next = firingHead;
+                if (firingHead != kNil) m_nodes[firingHead].prev = i;
+                firingHead = i;
+            }
+            i = next;
+        }
+        m_heads[kFiring] = firingHead;
+
+        while (m_heads[kFiring] != kNil) {
+            uint32_t index = m_heads[kFiring];
+            Unlink(index);
+            uint32_t generation = m_nodes[index].generation;
+
+            // 回调可能新增定时器导致 m_nodes 扩容，先把回调移出来
+            m_firing = index;
+            Callback callback = std::move(m_nodes[index].callback);
+            callback();
+            m_firing = kNil;
+
+            Node& node = m_nodes[index];
+            if (node.list == kFree || node.generation != generation) {
+                continue;   // 回调中已取消
+            }
+            if (node.interval) {
+                node.callback = std::move(callback);
+                node.deadline = tick + node.interval;
+                Place(index);
+            } else {
+                Release(index);
+            }
+        }
+    }
+};
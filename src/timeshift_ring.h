@@ -0,0 +1,329 @@
+// 时移缓冲 - 直播 DTV 的暂停与回看
+//
+// 当前 DTV 信号源的传输流连续写进固定数量的段文件组成的环：每段是一个整体映射的可写文件，
+// 写入只是把一批 TS 包复制进映射内存，由系统按顺序写回磁盘，没有逐包的系统调用。写满最后一段后回到
+// 第一段覆盖最旧的内容，所以窗口是最近 (segments - 1) 到 segments 段的数据。
+//
+// 位置以包序号表示（从开始录制起第几个包）。每隔 indexIntervalBytes 记一个时间索引点 {时间, 包序号}，
+// 一批写入跨过多个间隔时逐个记，时间按包序号在这批的起止时间间线性插值。索引按时间递增，回看时二分查找到不晚于目标时间的最后一个索引点，O(log n)。回收一段时同时丢弃
+// 指向它的索引点。读者在锁内复制数据，写入线程只在发布新写入的包和回收最旧的段时短暂取锁，
+// 复制数据进映射时不持锁（读者不会读到写入点之后，也不会读到已移出窗口的段）。
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mapped_file.h"
+#include "ts_section.h"
+
+namespace TimeShift {
+    const size_t kPacketSize = TsScan::kPacketSize;
+
+    // 模拟传输流的包：只写包头与负载开头的 8 字节序号（小端），负载其余部分沿用缓冲中原有的内容。
+    // 回看时可按序号核对读到的是否是当初写入的包
+    inline void FillPackets(uint8_t* packets, size_t count, uint64_t& sequence, uint16_t pid)
+    {
+        for (size_t i = 0; i < count; ++i, ++sequence) {
+            uint8_t* packet = packets + i * kPacketSize;
+            packet[0] = TsScan::kSyncByte;
+            packet[1] = static_cast<uint8_t>((pid >> 8) & 0x1F);
+            packet[2] = static_cast<uint8_t>(pid & 0xFF);
+            packet[3] = static_cast<uint8_t>(0x10 | (sequence & 0x0F));
+            for (int byte = 0; byte < 8; ++byte) packet[4 + byte] = static_cast<uint8_t>(sequence >> (8 * byte));
+        }
+    }
+
+    inline uint64_t PacketSequence(const uint8_t* packet)
+    {
+        uint64_t sequence = 0;
+        for (int byte = 7; byte >= 0; --byte) sequence = sequence << 8 | packet[4 + byte];
+        return sequence;
+    }
+}
+
+// 写入只能由一个线程进行；Seek、Read、GetStats 可在任意线程与写入同时调用，Open、Close 不可以
+class TimeShiftBuffer
+{
+public:
+    struct Options {
+        std::string directory;
+        std::string name;              // 段文件为 <directory>/<name>_<i>.seg
+        size_t segmentBytes;
+        unsigned segments;
+        size_t indexIntervalBytes;     // 时间索引的间隔，决定回看定位的精度
+
+        Options()
+            : name("timeshift")
+            , segmentBytes(64u << 20)
+            , segments(8)
+            , indexIntervalBytes(64u << 10)
+        {
+        }
+    };
+
+    struct Stats {
+        uint64_t packets;              // 写入的包总数
+        uint64_t windowFirst;          // 窗口内最早的包序号
+        int64_t windowStartMicros;     // 窗口内最早索引点的时间
+        int64_t windowEndMicros;       // 最近写入的时间
+        uint64_t recycled;             // 回收（覆盖）的段数
+        size_t indexEntries;
+    };
+
+    TimeShiftBuffer()
+        : m_packetsPerSegment(0)
+        , m_indexIntervalPackets(1)
+        , m_written(0)
+        , m_windowStart(0)
+        , m_lastMicros(0)
+        , m_recycled(0)
+    {
+    }
+
+    ~TimeShiftBuffer() { Close(); }
+
+    TimeShiftBuffer(const TimeShiftBuffer&) = delete;
+    TimeShiftBuffer& operator=(const TimeShiftBuffer&) = delete;
+
+    // 创建全部段文件并映射；段大小向下取整到整包，包不会跨段
+    bool Open(const Options& options)
+    {
+        Close();
+        m_options = options;
+        m_packetsPerSegment = options.segmentBytes / TimeShift::kPacketSize;
+        if (m_packetsPerSegment == 0 || options.segments < 2) return false;
+        m_indexIntervalPackets = std::max<uint64_t>(options.indexIntervalBytes / TimeShift::kPacketSize, 1);
+        for (unsigned i = 0; i < options.segments; ++i) {
+            std::unique_ptr<WritableMappedFile> segment(new WritableMappedFile());
+            if (!segment->Create(SegmentPath(i), m_packetsPerSegment * TimeShift::kPacketSize)) {
+                Close();
+                return false;
+            }
+            m_segments.push_back(std::move(segment));
+        }
+        return true;
+    }
+
+    // 段文件只在录制期间有意义，关闭时删除
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (size_t i = 0; i < m_segments.size(); ++i) {
+            m_segments[i]->Close();
+            std::remove(SegmentPath(static_cast<unsigned>(i)).c_str());
+        }
+        m_segments.clear();
+        m_index.clear();
+        m_written = 0;
+        m_windowStart = 0;
+        m_lastMicros = 0;
+        m_recycled = 0;
+    }
+
+    bool IsOpen() const { return !m_segments.empty(); }
+
+    // 追加 count 个完整的包：micros 为第一个包的时间，endMicros 为最后一个包之后的时间（均单调不减）
+    void Append(const uint8_t* packets, size_t count, int64_t micros, int64_t endMicros)
+    {
+        if (m_segments.empty() || count == 0) return;
+        endMicros = std::max(endMicros, micros);
+        const uint64_t first = m_written;
+        const int64_t span = endMicros - micros;
+        const int64_t total = static_cast<int64_t>(count);
+        uint64_t capacity = m_packetsPerSegment * m_segments.size();
+        while (count > 0) {
+            uint64_t offset = m_written % m_packetsPerSegment;
+            if (offset == 0 && m_written >= capacity) {
+                // 进入下一段前先把它移出窗口：读者此后不再读它
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_windowStart = m_written - capacity + m_packetsPerSegment;
+                while (!m_index.empty() && m_index.front().packet < m_windowStart) m_index.pop_front();
+                ++m_recycled;
+            }
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(count, m_packetsPerSegment - offset));
+            std::memcpy(SegmentData(m_written) + offset * TimeShift::kPacketSize, packets,
+                        chunk * TimeShift::kPacketSize);
+
+            std::lock_guard<std::mutex> lock(m_lock);
+            uint64_t next = m_index.empty()
+                ? m_written : std::max(m_index.back().packet + m_indexIntervalPackets, m_written);
+            for (; next < m_written + chunk; next += m_indexIntervalPackets) {
+                IndexEntry entry;
+                entry.micros = micros + span * static_cast<int64_t>(next - first) / total;
+                entry.packet = next;
+                m_index.push_back(entry);
+            }
+            m_written += chunk;
+            m_lastMicros = micros + span * static_cast<int64_t>(m_written - 1 - first) / total;
+            packets += chunk * TimeShift::kPacketSize;
+            count -= chunk;
+        }
+    }
+
+    // 不晚于 micros 的最后一个索引点的包序号；早于窗口时为窗口内最早的索引点，还没有数据时为写入点
+    uint64_t Seek(int64_t micros) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_index.empty()) return m_written;
+        auto after = std::upper_bound(m_index.begin(), m_index.end(), micros,
+                                      [](int64_t value, const IndexEntry& entry) { return value < entry.micros; });
+        if (after == m_index.begin()) return m_index.front().packet;
+        return (after - 1)->packet;
+    }
+
+    // 从 packet 起复制最多 maxPackets 个包到 out，packet 前移；已追上写入点时返回 0。
+    // packet 所在的段已被覆盖时先跳到窗口起点，lost 置为 true
+    size_t Read(uint64_t& packet, uint8_t* out, size_t maxPackets, bool* lost = nullptr) const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (lost) *lost = packet < m_windowStart;
+        if (packet < m_windowStart) packet = m_windowStart;
+        if (packet >= m_written) return 0;
+        uint64_t offset = packet % m_packetsPerSegment;
+        size_t count = static_cast<size_t>(
+            std::min<uint64_t>(std::min<uint64_t>(maxPackets, m_written - packet), m_packetsPerSegment - offset));
+        std::memcpy(out, SegmentData(packet) + offset * TimeShift::kPacketSize, count * TimeShift::kPacketSize);
+        packet += count;
+        return count;
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        Stats stats;
+        stats.packets = m_written;
+        stats.windowFirst = m_windowStart;
+        stats.windowStartMicros = m_index.empty() ? m_lastMicros : m_index.front().micros;
+        stats.windowEndMicros = m_lastMicros;
+        stats.recycled = m_recycled;
+        stats.indexEntries = m_index.size();
+        return stats;
+    }
+
+private:
+    struct IndexEntry {
+        int64_t micros;
+        uint64_t packet;
+    };
+
+    Options m_options;
+    std::vector<std::unique_ptr<WritableMappedFile>> m_segments;
+    uint64_t m_packetsPerSegment;
+    uint64_t m_indexIntervalPackets;
+    mutable std::mutex m_lock;
+    std::deque<IndexEntry> m_index;
+    uint64_t m_written;                // 写入点；此前的包已完整写入
+    uint64_t m_windowStart;
+    int64_t m_lastMicros;
+    uint64_t m_recycled;
+
+    std::string SegmentPath(unsigned index) const
+    {
+        std::string prefix = m_options.directory.empty() ? std::string() : m_options.directory + "/";
+        return prefix + m_options.name + "_" + std::to_string(index) + ".seg";
+    }
+
+    uint8_t* SegmentData(uint64_t packet) const
+    {
+        return m_segments[(packet / m_packetsPerSegment) % m_segments.size()]->Data();
+    }
+};
+
+// 把模拟的 DTV 传输流按固定码率实时写进时移缓冲：SetActive(true) 期间每 10ms 写一块，其余时间停在条件变量上。
+// 时间为 steady_clock 的微秒数
+class TimeShiftRecorder
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    TimeShiftRecorder(TimeShiftBuffer& buffer, double megabitsPerSecond, uint16_t pid = 0x100)
+        : m_buffer(buffer)
+        , m_packetsPerSecond(std::max(megabitsPerSecond, 0.1) * 1e6 / 8 / TimeShift::kPacketSize)
+        , m_pid(pid)
+        , m_active(false)
+        , m_stop(false)
+    {
+        m_thread = std::thread(&TimeShiftRecorder::Run, this);
+    }
+
+    ~TimeShiftRecorder()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        m_thread.join();
+    }
+
+    TimeShiftRecorder(const TimeShiftRecorder&) = delete;
+    TimeShiftRecorder& operator=(const TimeShiftRecorder&) = delete;
+
+    void SetActive(bool active)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_active = active;
+        }
+        m_wake.notify_all();
+    }
+
+    static int64_t NowMicros()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+private:
+    TimeShiftBuffer& m_buffer;
+    double m_packetsPerSecond;
+    uint16_t m_pid;
+    std::thread m_thread;
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    bool m_active;
+    bool m_stop;
+
+    void Run()
+    {
+        const Clock::duration period = std::chrono::milliseconds(10);
+        std::vector<uint8_t> packets;
+        uint64_t sequence = 0;
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || m_active; });
+            if (m_stop) return;
+            // 按经过的时间补齐应到的包数，不因调度抖动丢失码率
+            Clock::time_point start = Clock::now();
+            Clock::time_point deadline = start;
+            const int64_t startMicros = NowMicros();
+            uint64_t sent = 0;
+            while (!m_stop && m_active) {
+                lock.unlock();
+                double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+                uint64_t due = static_cast<uint64_t>(elapsed * m_packetsPerSecond);
+                if (due > sent) {
+                    size_t count = static_cast<size_t>(due - sent);
+                    packets.resize(count * TimeShift::kPacketSize);
+                    TimeShift::FillPackets(packets.data(), count, sequence, m_pid);
+                    m_buffer.Append(packets.data(), count,
+                                    startMicros + static_cast<int64_t>(sent * 1e6 / m_packetsPerSecond),
+                                    startMicros + static_cast<int64_t>(due * 1e6 / m_packetsPerSecond));
+                    sent = due;
+                }
+                lock.lock();
+                deadline += period;
+                m_wake.wait_until(lock, deadline, [this] { return m_stop || !m_active; });
+            }
+        }
+    }
+};
@@ -0,0 +1,292 @@
+// 翻译目录 - 每种语言一个紧凑的二进制文件，映射后直接查表，打开时不解析任何条目
+//
+// 文件格式（小端，各段 4 字节对齐）：
+//   FileHeader                      magic "TVTC"、版本、文件大小、语言代码、条目数、桶数
+//   uint32 buckets[bucketCount + 1] 第 b 个桶的条目范围为 [buckets[b], buckets[b + 1])
+//   Entry entries[entryCount]       按 (桶号, 哈希, key) 排序
+//   字符串区                         UTF-8，各自以 0 结尾
+// 桶数为 2 的幂、不少于条目数，查找只需计算一次哈希并比较同桶的一两个条目。
+// 源文件为 gettext 风格的 .po 文本（msgid / msgstr），由 catalog_tool 编译。
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mapped_file.h"
+
+namespace CatalogFile {
+    const uint32_t kVersion = 1;
+    const size_t kLanguageCodeSize = 8;
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t fileSize;
+        char language[kLanguageCodeSize];     // 语言代码，以 0 结尾，如 "zh"
+        uint32_t entryCount;
+        uint32_t bucketCount;
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        uint32_t hash;
+        uint32_t keyOffset;                   // 相对文件开头
+        uint32_t keyLength;
+        uint32_t valueOffset;
+        uint32_t valueLength;
+    };
+
+    // key -> 译文
+    typedef std::vector<std::pair<std::string, std::string>> Messages;
+
+    inline uint32_t Hash(const char* data, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+        }
+        return hash;
+    }
+
+    // 编译成目录文件；同一个 key 出现多次时以最后一次为准。先写临时文件再替换
+    inline bool Write(const std::string& path, const std::string& language, const Messages& messages)
+    {
+        if (language.empty() || language.size() >= kLanguageCodeSize) return false;
+
+        uint32_t bucketCount = 1;
+        while (bucketCount < messages.size()) bucketCount <<= 1;
+        std::vector<uint32_t> hashes(messages.size());
+        std::vector<size_t> order(messages.size());
+        for (size_t i = 0; i < messages.size(); ++i) {
+            hashes[i] = Hash(messages[i].first.data(), messages[i].first.size());
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            uint32_t bucketA = hashes[a] & (bucketCount - 1);
+            uint32_t bucketB = hashes[b] & (bucketCount - 1);
+            if (bucketA != bucketB) return bucketA < bucketB;
+            if (hashes[a] != hashes[b]) return hashes[a] < hashes[b];
+            return messages[a].first < messages[b].first;
+        });
+        // 排序稳定，相同 key 的一段里最后一个就是最后出现的
+        std::vector<size_t> unique;
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (i + 1 < order.size() && messages[order[i]].first == messages[order[i + 1]].first) continue;
+            unique.push_back(order[i]);
+        }
+
+        size_t bucketsOffset = sizeof(FileHeader);
+        size_t entriesOffset = bucketsOffset + (bucketCount + 1) * sizeof(uint32_t);
+        size_t stringsOffset = entriesOffset + unique.size() * sizeof(Entry);
+        std::vector<uint8_t> bytes(stringsOffset);
+        std::vector<uint32_t> buckets(bucketCount + 1, 0);
+        for (size_t i = 0; i < unique.size(); ++i) {
+            const std::pair<std::string, std::string>& message = messages[unique[i]];
+            ++buckets[(hashes[unique[i]] & (bucketCount - 1)) + 1];
+            Entry entry;
+            entry.hash = hashes[unique[i]];
+            entry.keyOffset = static_cast<uint32_t>(bytes.size());
+            entry.keyLength = static_cast<uint32_t>(message.first.size());
+            bytes.insert(bytes.end(), message.first.begin(), message.first.end());
+            bytes.push_back(0);
+            entry.valueOffset = static_cast<uint32_t>(bytes.size());
+            entry.valueLength = static_cast<uint32_t>(message.second.size());
+            bytes.insert(bytes.end(), message.second.begin(), message.second.end());
+            bytes.push_back(0);
+            std::memcpy(&bytes[entriesOffset + i * sizeof(Entry)], &entry, sizeof(entry));
+        }
+        for (uint32_t b = 0; b < bucketCount; ++b) buckets[b + 1] += buckets[b];
+        std::memcpy(&bytes[bucketsOffset], buckets.data(), buckets.size() * sizeof(uint32_t));
+        bytes.resize((bytes.size() + 3) & ~static_cast<size_t>(3), 0);
+
+        FileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "TVTC", 4);
+        header.version = kVersion;
+        header.fileSize = static_cast<uint32_t>(bytes.size());
+        std::memcpy(header.language, language.c_str(), language.size());
+        header.entryCount = static_cast<uint32_t>(unique.size());
+        header.bucketCount = bucketCount;
+        std::memcpy(bytes.data(), &header, sizeof(header));
+
+        std::string tempPath = path + ".tmp";
+        FILE* file = std::fopen(tempPath.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        ok = FileUtil::SyncAndClose(file) && ok;
+        if (!ok || !FileUtil::AtomicReplace(tempPath, path)) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // 解析 .po 文本中的一个带引号的字符串，处理 \" \\ \n \t 转义；成功时返回 true
+    inline bool ParseQuoted(const char* text, std::string& out)
+    {
+        while (*text == ' ' || *text == '\t') ++text;
+        if (*text++ != '"') return false;
+        for (; *text && *text != '"'; ++text) {
+            if (*text != '\\') {
+                out += *text;
+                continue;
+            }
+            switch (*++text) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                default: return false;
+            }
+        }
+        return *text == '"';
+    }
+
+    // 读取 gettext 风格的 .po 文本：msgid / msgstr 成对出现，紧跟的引号行接在前一项后面。
+    // 空 msgid（文件头）和空 msgstr（未翻译）跳过。失败时 error 为 "行号: 原因"
+    inline bool ParsePo(const std::string& path, Messages& messages, std::string& error)
+    {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::string id, value;
+        std::string* current = nullptr;
+        bool hasValue = false;
+        auto flush = [&]() {
+            if (hasValue && !id.empty() && !value.empty()) messages.emplace_back(id, value);
+            id.clear();
+            value.clear();
+            hasValue = false;
+        };
+
+        char line[4096];
+        int lineNumber = 0;
+        bool ok = true;
+        while (ok && std::fgets(line, sizeof(line), file)) {
+            ++lineNumber;
+            const char* text = line;
+            if (lineNumber == 1 && std::strncmp(text, "\xEF\xBB\xBF", 3) == 0) text += 3;   // UTF-8 BOM
+            while (*text == ' ' || *text == '\t') ++text;
+            if (*text == '#' || *text == '\r' || *text == '\n' || *text == 0) continue;
+
+            const char* reason = nullptr;
+            if (std::strncmp(text, "msgid", 5) == 0) {
+                flush();
+                current = &id;
+                if (!ParseQuoted(text + 5, id)) reason = "bad msgid";
+            } else if (std::strncmp(text, "msgstr", 6) == 0) {
+                if (current != &id) {
+                    reason = "msgstr without msgid";
+                } else {
+                    current = &value;
+                    hasValue = true;
+                    if (!ParseQuoted(text + 6, value)) reason = "bad msgstr";
+                }
+            } else if (*text == '"' && current) {
+                if (!ParseQuoted(text, *current)) reason = "bad string";
+            } else {
+                reason = "unexpected line";
+            }
+            if (reason) {
+                error = std::to_string(lineNumber) + ": " + reason;
+                ok = false;
+            }
+        }
+        std::fclose(file);
+        if (ok) flush();
+        return ok;
+    }
+}
+
+// 一种语言的目录：Open 只映射文件并检查头部，条目在查找时才被访问（按页载入）
+class TranslationCatalog
+{
+public:
+    TranslationCatalog()
+        : m_header(nullptr)
+        , m_buckets(nullptr)
+        , m_entries(nullptr)
+    {
+    }
+
+    TranslationCatalog(const TranslationCatalog&) = delete;
+    TranslationCatalog& operator=(const TranslationCatalog&) = delete;
+
+    bool Open(const std::string& path)
+    {
+        Close();
+        if (!m_file.Open(path) || m_file.Size() < sizeof(CatalogFile::FileHeader)) {
+            Close();
+            return false;
+        }
+        const uint8_t* data = m_file.Data();
+        const CatalogFile::FileHeader* header = reinterpret_cast<const CatalogFile::FileHeader*>(data);
+        uint32_t bucketCount = header->bucketCount;
+        size_t tableSize = (static_cast<size_t>(bucketCount) + 1) * sizeof(uint32_t) +
+                           static_cast<size_t>(header->entryCount) * sizeof(CatalogFile::Entry);
+        if (std::memcmp(header->magic, "TVTC", 4) != 0 || header->version != CatalogFile::kVersion ||
+            header->fileSize != m_file.Size() || bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0 ||
+            tableSize > m_file.Size() - sizeof(CatalogFile::FileHeader) ||
+            std::memchr(header->language, 0, CatalogFile::kLanguageCodeSize) == nullptr) {
+            Close();
+            return false;
+        }
+        m_header = header;
+        m_buckets = reinterpret_cast<const uint32_t*>(data + sizeof(CatalogFile::FileHeader));
+        m_entries = reinterpret_cast<const CatalogFile::Entry*>(m_buckets + bucketCount + 1);
+        if (m_buckets[bucketCount] != header->entryCount) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        m_file.Close();
+        m_header = nullptr;
+        m_buckets = nullptr;
+        m_entries = nullptr;
+    }
+
+    bool IsOpen() const { return m_header != nullptr; }
+    const char* Language() const { return m_header ? m_header->language : ""; }
+    size_t Count() const { return m_header ? m_header->entryCount : 0; }
+
+    // 查找 key，找到时 value 指向映射内存中以 0 结尾的 UTF-8 译文
+    bool Find(const char* key, size_t keyLength, const char*& value, size_t& valueLength) const
+    {
+        if (!m_header) return false;
+        uint32_t hash = CatalogFile::Hash(key, keyLength);
+        uint32_t bucket = hash & (m_header->bucketCount - 1);
+        uint32_t end = std::min(m_buckets[bucket + 1], m_header->entryCount);
+        for (uint32_t i = m_buckets[bucket]; i < end; ++i) {
+            const CatalogFile::Entry& entry = m_entries[i];
+            if (entry.hash != hash || entry.keyLength != keyLength) continue;
+            if (!InFile(entry.keyOffset, entry.keyLength) || !InFile(entry.valueOffset, entry.valueLength)) return false;
+            if (std::memcmp(m_file.Data() + entry.keyOffset, key, keyLength) != 0) continue;
+            value = reinterpret_cast<const char*>(m_file.Data() + entry.valueOffset);
+            valueLength = entry.valueLength;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    MappedFile m_file;
+    const CatalogFile::FileHeader* m_header;
+    const uint32_t* m_buckets;
+    const CatalogFile::Entry* m_entries;
+
+    // 字符串及其结尾的 0 都在文件内
+    bool InFile(uint32_t offset, uint32_t length) const
+    {
+        return offset < m_file.Size() && length < m_file.Size() - offset;
+    }
+};
@@ -0,0 +1,160 @@
+// MPEG-2 传输流公共工具 - CRC32、TS 包负载、按 pointer_field 拼装 PSI/SI 段、文件流式读包
+//
+// 搜台（PAT/SDT）与节目指南（EIT）共用；只处理长格式段（section_syntax_indicator = 1）。
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace TsScan {
+    const size_t kPacketSize = 188;
+    const uint8_t kSyncByte = 0x47;
+    const uint16_t kNullPid = 0x1FFF;
+
+    // MPEG-2 PSI 使用的 CRC32（多项式 0x04C11DB7，不反射）
+    inline uint32_t Crc32(const uint8_t* data, size_t size)
+    {
+        static const struct Table {
+            uint32_t values[256];
+            Table()
+            {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t crc = i << 24;
+                    for (int bit = 0; bit < 8; ++bit) {
+                        crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : crc << 1;
+                    }
+                    values[i] = crc;
+                }
+            }
+        } table;
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; ++i) {
+            crc = (crc << 8) ^ table.values[((crc >> 24) ^ data[i]) & 0xFF];
+        }
+        return crc;
+    }
+
+    // 取 TS 包的负载；失步、传输错误或没有负载时返回 false
+    inline bool PacketPayload(const uint8_t* packet, uint16_t& pid, bool& unitStart,
+                              const uint8_t*& payload, size_t& size)
+    {
+        if (packet[0] != kSyncByte || (packet[1] & 0x80)) return false;
+        pid = static_cast<uint16_t>(((packet[1] & 0x1F) << 8) | packet[2]);
+        unitStart = (packet[1] & 0x40) != 0;
+        int adaptation = (packet[3] >> 4) & 0x3;
+        size_t offset = 4;
+        if (adaptation & 0x2) offset += 1 + packet[4];
+        if (!(adaptation & 0x1) || offset >= kPacketSize) return false;
+        payload = packet + offset;
+        size = kPacketSize - offset;
+        return true;
+    }
+
+    // 一个 PID 上的段拼装器：完整且 CRC 正确的段交给 onSection(data, length)
+    class SectionAssembler
+    {
+    public:
+        template <class Handler>
+        void Push(bool unitStart, const uint8_t* payload, size_t size, Handler& onSection)
+        {
+            if (unitStart) {
+                size_t pointer = payload[0];
+                if (pointer + 1 > size) return;
+                // pointer_field 之前是上一段的结尾
+                if (!m_section.empty()) {
+                    m_section.insert(m_section.end(), payload + 1, payload + 1 + pointer);
+                    TryComplete(onSection);
+                }
+                m_section.assign(payload + 1 + pointer, payload + size);
+            } else if (!m_section.empty()) {
+                m_section.insert(m_section.end(), payload, payload + size);
+            } else {
+                return;   // 还没遇到段起始
+            }
+            // 一个包内可能连续放多个段
+            while (TryComplete(onSection)) {
+            }
+        }
+
+        void Reset() { m_section.clear(); }
+
+    private:
+        std::vector<uint8_t> m_section;
+
+        // 段已完整时交出并从缓冲中移除，返回是否还有后续段
+        template <class Handler>
+        bool TryComplete(Handler& onSection)
+        {
+            if (m_section.size() < 3) return false;
+            if (m_section[0] == 0xFF) {   // 填充
+                m_section.clear();
+                return false;
+            }
+            size_t length = 3 + (((m_section[1] & 0x0F) << 8) | m_section[2]);
+            if (m_section.size() < length) return false;
+            if (length >= 12 && Crc32(m_section.data(), length) == 0) {
+                onSection(m_section.data(), length);
+            }
+            m_section.erase(m_section.begin(), m_section.begin() + length);
+            return !m_section.empty();
+        }
+    };
+
+    // 填写 section_length 并追加 CRC32（section 中已有除 CRC 外的全部字节）
+    inline void FinishSection(std::vector<uint8_t>& section)
+    {
+        size_t length = section.size() + 4 - 3;
+        section[1] = static_cast<uint8_t>((section[1] & 0xF0) | ((length >> 8) & 0x0F));
+        section[2] = static_cast<uint8_t>(length & 0xFF);
+        uint32_t crc = Crc32(section.data(), section.size());
+        for (int shift = 24; shift >= 0; shift -= 8) section.push_back(static_cast<uint8_t>(crc >> shift));
+    }
+
+    // 把一个段切成连续的 TS 包追加到 stream 末尾，最后一包用 0xFF 填充
+    inline void AppendSection(std::vector<uint8_t>& stream, const std::vector<uint8_t>& section,
+                              uint16_t pid, uint8_t& counter)
+    {
+        size_t written = 0;
+        while (written < section.size()) {
+            size_t at = stream.size();
+            stream.resize(at + kPacketSize, 0xFF);
+            uint8_t* packet = &stream[at];
+            bool first = written == 0;
+            packet[0] = kSyncByte;
+            packet[1] = static_cast<uint8_t>((first ? 0x40 : 0x00) | (pid >> 8));
+            packet[2] = static_cast<uint8_t>(pid);
+            packet[3] = static_cast<uint8_t>(0x10 | (counter++ & 0x0F));
+            size_t offset = 4;
+            if (first) packet[offset++] = 0;   // pointer_field
+            size_t chunk = std::min(kPacketSize - offset, section.size() - written);
+            std::copy(section.begin() + written, section.begin() + written + chunk, packet + offset);
+            written += chunk;
+        }
+    }
+
+    // 从文件流式读取整包：每次把一块整数个 TS 包交给 feed(data, size)，块之间自动找回同步字节。
+    // feed 返回 false 时停止；返回读到的字节数
+    template <class Feed>
+    size_t ReadPackets(FILE* file, Feed feed, size_t chunkPackets = 512)
+    {
+        std::vector<uint8_t> buffer(chunkPackets * kPacketSize);
+        size_t carry = 0;
+        size_t total = 0;
+        for (;;) {
+            size_t n = std::fread(buffer.data() + carry, 1, buffer.size() - carry, file);
+            if (n == 0) break;
+            total += n;
+            size_t available = carry + n;
+            size_t start = 0;
+            while (start < available && buffer[start] != kSyncByte) ++start;   // 找同步字节
+            size_t whole = (available - start) / kPacketSize * kPacketSize;
+            carry = available - start - whole;
+            bool more = whole == 0 || feed(buffer.data() + start, whole);
+            std::copy(buffer.begin() + start + whole, buffer.begin() + available, buffer.begin());
+            if (!more) break;
+        }
+        return total;
+    }
+}
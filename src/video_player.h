@@ -0,0 +1,382 @@
+// 背景视频播放 - 流式读取原始 YUV420 文件（解码器输出的替身），转换成 32 位 RGB 并按源帧率放出
+//
+// 播放线程每次只读一帧到复用的缓冲区，文件读完从头循环。转换结果写入后台帧，写完后与前台帧交换；
+// UI 线程在 onFrame 通知后用 WithLatestFrame 取前台帧。播放线程落后超过一帧时跳过文件中的帧追上时间，
+// 不会越积越慢。设置了输出尺寸时，转换后的帧在播放线程中用 VideoScaler 缩放到该尺寸；
+// 设置了图像模式时，再经过该模式的处理链（picture_pipeline.h）。两者都从下一帧起生效。
+// 动态模式下每帧处理前交给 FrameAnalyzer 分析（忙时跳过），分析出的对比度曲线从之后的帧起生效。
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "frame_analyzer.h"
+#include "picture_pipeline.h"
+#include "video_scaler.h"
+#include "yuv_convert.h"
+
+// 顺序读取原始 YUV 帧，到文件尾自动回到开头
+class YuvFileReader
+{
+public:
+    YuvFileReader()
+        : m_file(nullptr)
+        , m_frameSize(0)
+        , m_frameCount(0)
+        , m_position(0)
+    {
+    }
+
+    ~YuvFileReader() { Close(); }
+
+    YuvFileReader(const YuvFileReader&) = delete;
+    YuvFileReader& operator=(const YuvFileReader&) = delete;
+
+    bool Open(const std::string& path, Yuv::Format format, int width, int height)
+    {
+        Close();
+        if (width <= 0 || height <= 0) return false;
+        m_file = std::fopen(path.c_str(), "rb");
+        if (!m_file) return false;
+        m_frameSize = Yuv::FrameSize(format, width, height);
+        SeekBytes(0, SEEK_END);
+        m_frameCount = TellBytes() / m_frameSize;
+        Seek(0);
+        if (m_frameCount == 0) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_file) std::fclose(m_file);
+        m_file = nullptr;
+    }
+
+    size_t FrameSize() const { return m_frameSize; }
+    uint64_t FrameCount() const { return m_frameCount; }
+
+    bool ReadFrame(uint8_t* frame)
+    {
+        if (!m_file) return false;
+        if (m_position >= m_frameCount) Seek(0);
+        if (std::fread(frame, 1, m_frameSize, m_file) != m_frameSize) return false;
+        ++m_position;
+        return true;
+    }
+
+    // 跳过 count 帧（循环计算），用于追赶播放时间
+    void Skip(uint64_t count)
+    {
+        Seek((m_position + count) % m_frameCount);
+    }
+
+    // 跳到第 frame 帧（frame < FrameCount()）
+    void Seek(uint64_t frame)
+    {
+        SeekBytes(frame * m_frameSize, SEEK_SET);
+        m_position = frame;
+    }
+
+private:
+    FILE* m_file;
+    size_t m_frameSize;
+    uint64_t m_frameCount;
+    uint64_t m_position;
+
+    // 4K 素材很快超过 2GB，用 64 位偏移定位（Windows 上 long 只有 32 位）
+    void SeekBytes(uint64_t offset, int origin)
+    {
+#ifdef _WIN32
+        _fseeki64(m_file, static_cast<__int64>(offset), origin);
+#else
+        fseeko(m_file, static_cast<off_t>(offset), origin);
+#endif
+    }
+
+    uint64_t TellBytes()
+    {
+#ifdef _WIN32
+        __int64 position = _ftelli64(m_file);
+#else
+        off_t position = ftello(m_file);
+#endif
+        return position > 0 ? static_cast<uint64_t>(position) : 0;
+    }
+};
+
+// 一帧 32 位像素，行紧密排列
+struct VideoFrame {
+    int width;
+    int height;
+    std::vector<uint8_t> pixels;
+    uint64_t sequence;                 // 从 1 开始，每放出一帧加一
+};
+
+class VideoPlayer
+{
+public:
+    struct Options {
+        std::string path;
+        Yuv::Format format;
+        int width;
+        int height;
+        double fps;
+        Yuv::PixelOrder order;
+    };
+
+    struct Stats {
+        uint64_t frames;               // 已放出的帧
+        uint64_t dropped;              // 为追赶时间跳过的帧
+        double convertMicros;          // 最近一帧的转换耗时
+        double averageConvertMicros;
+        double scaleMicros;            // 最近一帧的缩放耗时，不缩放时为 0
+        double pictureMicros;          // 最近一帧图像模式处理耗时，未选模式时为 0
+        Picture::Mode pictureMode;     // 最近一帧使用的图像模式
+        double analysisMicros;         // 最近一次自适应对比度分析的耗时（在分析线程中）
+        uint64_t analysisSkipped;      // 分析线程忙而没有分析的帧
+    };
+
+    VideoPlayer()
+        : m_stop(false)
+        , m_frames(0)
+        , m_dropped(0)
+        , m_lastConvertMicros(0)
+        , m_totalConvertMicros(0)
+        , m_lastScaleMicros(0)
+        , m_outputWidth(0)
+        , m_outputHeight(0)
+        , m_lastPictureMicros(0)
+        , m_lastPictureMode(Picture::Mode::Off)
+        , m_pictureMode(Picture::Mode::Off)
+    {
+        m_front.sequence = 0;
+        m_back.sequence = 0;
+    }
+
+    ~VideoPlayer() { Stop(); }
+
+    VideoPlayer(const VideoPlayer&) = delete;
+    VideoPlayer& operator=(const VideoPlayer&) = delete;
+
+    // onFrame 在播放线程中调用，只应做线程安全的通知（如 wxQueueEvent）
+    bool Start(const Options& options, const std::function<void()>& onFrame)
+    {
+        Stop();
+        if (options.fps <= 0 || !m_reader.Open(options.path, options.format, options.width, options.height))
+            return false;
+        m_options = options;
+        m_onFrame = onFrame;
+        for (VideoFrame* frame : { &m_front, &m_back }) {
+            frame->width = options.width;
+            frame->height = options.height;
+            frame->pixels.assign(static_cast<size_t>(options.width) * options.height * 4, 0);
+            frame->sequence = 0;
+        }
+        m_stop = false;
+        m_frames = 0;
+        m_dropped = 0;
+        m_totalConvertMicros = 0;
+        m_lastScaleMicros = 0;
+        m_lastPictureMicros = 0;
+        if (!m_scaler) m_scaler.reset(new VideoScaler());
+        if (!m_analyzer) m_analyzer.reset(new FrameAnalyzer());
+        m_thread = std::thread(&VideoPlayer::Run, this);
+        return true;
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        if (m_thread.joinable()) m_thread.join();
+        m_reader.Close();
+    }
+
+    bool IsPlaying() const { return m_thread.joinable(); }
+
+    // 输出帧的尺寸，从下一帧起生效；0 或与源相同时不缩放
+    void SetOutputSize(int width, int height)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_outputWidth = width;
+        m_outputHeight = height;
+    }
+
+    void SetPictureMode(Picture::Mode mode)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_pictureMode = mode;
+    }
+
+    // 前台帧比 lastSequence 新时在锁内调用 use(frame) 并更新 lastSequence，返回是否有新帧。
+    // use 期间播放线程不会交换缓冲，应尽快复制走
+    template <class Use>
+    bool WithLatestFrame(uint64_t& lastSequence, Use use)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_front.sequence == lastSequence) return false;
+        use(static_cast<const VideoFrame&>(m_front));
+        lastSequence = m_front.sequence;
+        return true;
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        Stats stats;
+        stats.frames = m_frames;
+        stats.dropped = m_dropped;
+        stats.convertMicros = m_lastConvertMicros;
+        stats.averageConvertMicros = m_frames ? m_totalConvertMicros / m_frames : 0;
+        stats.scaleMicros = m_lastScaleMicros;
+        stats.pictureMicros = m_lastPictureMicros;
+        stats.pictureMode = m_lastPictureMode;
+        FrameAnalyzer::Stats analysis = m_analyzer ? m_analyzer->GetStats() : FrameAnalyzer::Stats();
+        stats.analysisMicros = analysis.analysisMicros;
+        stats.analysisSkipped = analysis.skipped;
+        return stats;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    YuvFileReader m_reader;
+    Options m_options;
+    std::function<void()> m_onFrame;
+    std::thread m_thread;
+    mutable std::mutex m_lock;
+    std::condition_variable m_wake;
+    VideoFrame m_front;
+    VideoFrame m_back;
+    bool m_stop;
+    uint64_t m_frames;
+    uint64_t m_dropped;
+    double m_lastConvertMicros;
+    double m_totalConvertMicros;
+    double m_lastScaleMicros;
+    int m_outputWidth;
+    int m_outputHeight;
+    double m_lastPictureMicros;
+    Picture::Mode m_lastPictureMode;
+    Picture::Mode m_pictureMode;
+    std::unique_ptr<VideoScaler> m_scaler;    // 只在播放线程中使用
+    std::unique_ptr<FrameAnalyzer> m_analyzer;
+
+    void Run()
+    {
+        std::vector<uint8_t> yuv(m_reader.FrameSize());
+        std::vector<uint8_t> converted;
+        std::vector<uint8_t> processed;
+        Picture::Chain chain = Picture::Compile(Picture::Mode::Off, m_options.order);
+        uint64_t curveVersion = 0;
+        Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / m_options.fps));
+        Clock::time_point deadline = Clock::now();
+        uint64_t sequence = 0;
+        for (;;) {
+            if (!m_reader.ReadFrame(yuv.data())) break;
+
+            int outputWidth, outputHeight;
+            Picture::Mode pictureMode;
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                outputWidth = m_outputWidth;
+                outputHeight = m_outputHeight;
+                pictureMode = m_pictureMode;
+            }
+            // 处理链编译只有几微秒，切换模式时在这里重新编译，下一帧即生效
+            if (pictureMode != chain.mode) {
+                chain = Picture::Compile(pictureMode, m_options.order);
+                // 重新进入动态模式时从恒等曲线开始，不沿用上次的画面
+                if (chain.adaptive) m_analyzer->Reset();
+            }
+            bool scale = outputWidth > 0 && outputHeight > 0 &&
+                         (outputWidth != m_options.width || outputHeight != m_options.height);
+
+            // 后台帧只有本线程访问，转换和缩放时不持锁；要缩放时先转换到中间缓冲
+            Clock::time_point start = Clock::now();
+            Yuv::Planes planes = Yuv::FromBuffer(yuv.data(), m_options.format, m_options.width, m_options.height);
+            size_t sourceBytes = static_cast<size_t>(m_options.width) * m_options.height * 4;
+            if (scale) converted.resize(sourceBytes);
+            else m_back.pixels.resize(sourceBytes);
+            uint8_t* target = scale ? converted.data() : m_back.pixels.data();
+            Yuv::Convert(planes, target, static_cast<ptrdiff_t>(m_options.width) * 4, m_options.order);
+            Clock::time_point convertedAt = Clock::now();
+            double micros = std::chrono::duration<double, std::micro>(convertedAt - start).count();
+            double scaleMicros = 0;
+            if (scale) {
+                m_back.pixels.resize(static_cast<size_t>(outputWidth) * outputHeight * 4);
+                m_scaler->Scale(converted.data(), static_cast<ptrdiff_t>(m_options.width) * 4,
+                                m_options.width, m_options.height,
+                                m_back.pixels.data(), static_cast<ptrdiff_t>(outputWidth) * 4, outputWidth, outputHeight,
+                                Scaler::ChooseFilter(m_options.width, m_options.height, outputWidth, outputHeight));
+                scaleMicros = std::chrono::duration<double, std::micro>(Clock::now() - convertedAt).count();
+            }
+            m_back.width = scale ? outputWidth : m_options.width;
+            m_back.height = scale ? outputHeight : m_options.height;
+
+            // 在最终尺寸上处理，缩小时像素更少；需要邻行的链输出到另一块缓冲再交换
+            double pictureMicros = 0;
+            if (chain.adaptive) {
+                ptrdiff_t stride = static_cast<ptrdiff_t>(m_back.width) * 4;
+                m_analyzer->Submit(m_back.pixels.data(), stride, m_back.width, m_back.height, m_options.order);
+                uint8_t curve[256];
+                if (m_analyzer->LatestCurve(curveVersion, curve)) Picture::ApplyToneCurve(chain, curve);
+            }
+            if (!chain.Empty()) {
+                Clock::time_point pictureStart = Clock::now();
+                ptrdiff_t stride = static_cast<ptrdiff_t>(m_back.width) * 4;
+                if (chain.InPlace()) {
+                    Picture::Process(chain, m_back.pixels.data(), stride, m_back.pixels.data(), stride,
+                                     m_back.width, m_back.height);
+                } else {
+                    processed.resize(m_back.pixels.size());
+                    Picture::Process(chain, m_back.pixels.data(), stride, processed.data(), stride,
+                                     m_back.width, m_back.height);
+                    m_back.pixels.swap(processed);
+                }
+                pictureMicros = std::chrono::duration<double, std::micro>(Clock::now() - pictureStart).count();
+            }
+            m_back.sequence = ++sequence;
+
+            // 等到这一帧的显示时间再交换，保证按源帧率放出
+            deadline += period;
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                if (m_wake.wait_until(lock, deadline, [this] { return m_stop; })) break;
+                std::swap(m_front, m_back);
+                ++m_frames;
+                m_lastConvertMicros = micros;
+                m_totalConvertMicros += micros;
+                m_lastScaleMicros = scaleMicros;
+                m_lastPictureMicros = pictureMicros;
+                m_lastPictureMode = chain.mode;
+            }
+            if (m_onFrame) m_onFrame();
+
+            // 落后超过一帧：跳过源中的帧，保持与时间同步
+            Clock::time_point now = Clock::now();
+            if (now > deadline + period) {
+                uint64_t behind = static_cast<uint64_t>((now - deadline) / period);
+                m_reader.Skip(behind);
+                deadline += period * behind;
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_dropped += behind;
+            }
+        }
+    }
+};
@@ -0,0 +1,395 @@
+// 视频缩放 - 32 位像素的可分离缩放（双线性 / 面积平均），行分段后在线程池中并行
+//
+// 每个方向预先算好系数表：目标的第 i 个像素取源中从 begin[i] 开始的 taps 个连续像素，
+// 权重为 14 位定点、和恰为 16384。每个目标行先纵向合成到 int16 中间行（多保留 7 位小数），再横向缩放：
+//   V = (Σ src * wy + 64) >> 7
+//   D = (Σ V * wx + (1 << 20)) >> 21
+// 纵向是整行连续的乘加，最适合 SIMD；横向要逐像素取不规则位置的源，放在后面只处理目标行数。
+// 所有权重非负，累加不会溢出 int32。标量、SSE2、AVX2 内核的输出逐字节一致。
+// 系数表按 (源尺寸, 目标尺寸, 滤波器) 缓存，窗口来回调整时不重复计算。
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "work_pool.h"
+#include "yuv_convert.h"
+
+namespace Scaler {
+    const int kWeightBits = 14;
+    const int kVerticalShift = 7;
+    const int kHorizontalShift = 2 * kWeightBits - kVerticalShift;
+
+    // 一个方向的系数：weights[i * taps + t] 为目标 i 对源 begin[i] + t 的权重；
+    // pairs 为同样的权重两两打包成 madd 用的 (w0, w1)，每个目标 (taps + 1) / 2 个，奇数时最后一对 w1 为 0
+    struct Axis {
+        int taps;
+        std::vector<int32_t> begin;
+        std::vector<int16_t> weights;
+        std::vector<int32_t> pairs;
+    };
+
+    enum class Filter { Bilinear, Area };
+
+    inline const char* FilterName(Filter filter)
+    {
+        return filter == Filter::Area ? "area" : "bilinear";
+    }
+
+    // 缩小时面积平均不产生混叠，放大时双线性更平滑
+    inline Filter ChooseFilter(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+    {
+        return (dstWidth < srcWidth && dstHeight < srcHeight) ? Filter::Area : Filter::Bilinear;
+    }
+
+    // 两个 int16 权重打包成 madd 用的 (w0, w1) 对
+    inline int32_t WeightPair(int16_t first, int16_t second)
+    {
+        return static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint16_t>(second)) << 16 |
+                                    static_cast<uint16_t>(first));
+    }
+
+    inline Axis BuildAxis(int srcSize, int dstSize, Filter filter)
+    {
+        // 先按浮点算出每个目标像素覆盖的源像素与权重
+        std::vector<std::vector<std::pair<int, double>>> contributions(dstSize);
+        double scale = static_cast<double>(srcSize) / dstSize;
+        for (int i = 0; i < dstSize; ++i) {
+            std::vector<std::pair<int, double>>& list = contributions[i];
+            if (filter == Filter::Area) {
+                double low = i * scale;
+                double high = (i + 1) * scale;
+                for (int s = static_cast<int>(low); s < srcSize && s < high; ++s) {
+                    double overlap = std::min(high, s + 1.0) - std::max(low, static_cast<double>(s));
+                    if (overlap > 1e-9) list.emplace_back(s, overlap / scale);
+                }
+            } else {
+                double center = std::min(std::max((i + 0.5) * scale - 0.5, 0.0), srcSize - 1.0);
+                int s = static_cast<int>(center);
+                double fraction = center - s;
+                list.emplace_back(s, 1.0 - fraction);
+                if (s + 1 < srcSize && fraction > 1e-9) list.emplace_back(s + 1, fraction);
+            }
+        }
+
+        Axis axis;
+        axis.taps = 1;
+        for (const auto& list : contributions) axis.taps = std::max(axis.taps, static_cast<int>(list.size()));
+        axis.begin.resize(dstSize);
+        axis.weights.assign(static_cast<size_t>(dstSize) * axis.taps, 0);
+        for (int i = 0; i < dstSize; ++i) {
+            const std::vector<std::pair<int, double>>& list = contributions[i];
+            // 靠近右/下边缘时把起点左移，让 taps 个像素都在源内，多出的位置权重为 0
+            int begin = std::min(list.front().first, srcSize - axis.taps);
+            int16_t* weights = &axis.weights[static_cast<size_t>(i) * axis.taps];
+            int sum = 0;
+            int largest = list.front().first - begin;
+            for (const auto& item : list) {
+                int t = item.first - begin;
+                weights[t] = static_cast<int16_t>(std::lround(item.second * (1 << kWeightBits)));
+                sum += weights[t];
+                if (weights[t] > weights[largest]) largest = t;
+            }
+            // 舍入误差补到最大的权重上，保证和恰为 1
+            weights[largest] = static_cast<int16_t>(weights[largest] + (1 << kWeightBits) - sum);
+            axis.begin[i] = begin;
+        }
+        int pairCount = (axis.taps + 1) / 2;
+        axis.pairs.resize(static_cast<size_t>(dstSize) * pairCount);
+        for (int i = 0; i < dstSize; ++i) {
+            const int16_t* weights = &axis.weights[static_cast<size_t>(i) * axis.taps];
+            for (int p = 0; p < pairCount; ++p) {
+                int t = p * 2;
+                axis.pairs[static_cast<size_t>(i) * pairCount + p] =
+                    WeightPair(weights[t], t + 1 < axis.taps ? weights[t + 1] : 0);
+            }
+        }
+        return axis;
+    }
+
+    inline uint8_t ClampByte(int value)
+    {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    // 纵向：taps 行源像素按 weights 合成中间行，从第 begin 个值处理到 count（每像素 4 个值）
+    inline void VerticalRowScalar(const uint8_t* const* rows, const int16_t* weights, int taps,
+                                  int begin, int count, int16_t* out)
+    {
+        for (int i = begin; i < count; ++i) {
+            int sum = 0;
+            for (int t = 0; t < taps; ++t) sum += rows[t][i] * weights[t];
+            out[i] = static_cast<int16_t>((sum + (1 << (kVerticalShift - 1))) >> kVerticalShift);
+        }
+    }
+
+    // 横向：从第 begin 个目标像素处理到 width
+    inline void HorizontalRowScalar(const int16_t* src, const Axis& axis, int begin, int width, uint8_t* dst)
+    {
+        for (int x = begin; x < width; ++x) {
+            const int16_t* values = src + axis.begin[x] * 4;
+            const int16_t* weights = &axis.weights[static_cast<size_t>(x) * axis.taps];
+            for (int c = 0; c < 4; ++c) {
+                int sum = 0;
+                for (int t = 0; t < axis.taps; ++t) sum += values[t * 4 + c] * weights[t];
+                dst[x * 4 + c] = ClampByte((sum + (1 << (kHorizontalShift - 1))) >> kHorizontalShift);
+            }
+        }
+    }
+
+#if YUV_HAVE_X86
+    // 一次 16 个值：两行源字节交错后扩展成 (a, b) 对，与 (w0, w1) 做 madd，返回处理到的位置
+    __attribute__((target("sse2")))
+    inline int VerticalRowSse2(const uint8_t* const* rows, const int32_t* pairs, int taps,
+                               int begin, int count, int16_t* out)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi32(1 << (kVerticalShift - 1));
+        int i = begin;
+        for (; i + 16 <= count; i += 16) {
+            __m128i sum0 = round, sum1 = round, sum2 = round, sum3 = round;
+            for (int t = 0; t < taps; t += 2) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t] + i));
+                __m128i b = t + 1 < taps ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t + 1] + i)) : zero;
+                __m128i w = _mm_set1_epi32(pairs[t / 2]);
+                __m128i low = _mm_unpacklo_epi8(a, b);
+                __m128i high = _mm_unpackhi_epi8(a, b);
+                sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_unpacklo_epi8(low, zero), w));
+                sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_unpackhi_epi8(low, zero), w));
+                sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_unpacklo_epi8(high, zero), w));
+                sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_unpackhi_epi8(high, zero), w));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                             _mm_packs_epi32(_mm_srai_epi32(sum0, kVerticalShift), _mm_srai_epi32(sum1, kVerticalShift)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8),
+                             _mm_packs_epi32(_mm_srai_epi32(sum2, kVerticalShift), _mm_srai_epi32(sum3, kVerticalShift)));
+        }
+        return i;
+    }
+
+    // 一个目标像素的 4 个通道：相邻两个源像素（8 个 int16）整理成 (p0, p1) 交错后与 (w0, w1) 做 madd
+    __attribute__((target("sse2")))
+    inline __m128i HorizontalPixelSse2(const int16_t* values, const int32_t* pairs, int taps)
+    {
+        __m128i sum = _mm_set1_epi32(1 << (kHorizontalShift - 1));
+        int t = 0;
+        for (; t + 1 < taps; t += 2) {
+            __m128i pair = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + t * 4));
+            pair = _mm_unpacklo_epi16(pair, _mm_srli_si128(pair, 8));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pair, _mm_set1_epi32(pairs[t / 2])));
+        }
+        if (t < taps) {
+            // 最后一个源像素单独读 8 字节，不越过行尾
+            __m128i single = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + t * 4));
+            single = _mm_unpacklo_epi16(single, _mm_setzero_si128());
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(single, _mm_set1_epi32(pairs[t / 2])));
+        }
+        return _mm_srai_epi32(sum, kHorizontalShift);
+    }
+
+    // 一次两个目标像素，合成 8 个字节写出。源位置逐像素不规则，横向的 AVX2 路径也用这个内核。
+    // 双线性和 2 倍以内的面积平均都是 2 个抽头，单独展开
+    __attribute__((target("sse2")))
+    inline int HorizontalRowSse2(const int16_t* src, const Axis& axis, int width, uint8_t* dst)
+    {
+        int pairCount = (axis.taps + 1) / 2;
+        int x = 0;
+        if (axis.taps == 2) {
+            const __m128i round = _mm_set1_epi32(1 << (kHorizontalShift - 1));
+            for (; x + 2 <= width; x += 2) {
+                __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + axis.begin[x] * 4));
+                __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + axis.begin[x + 1] * 4));
+                first = _mm_madd_epi16(_mm_unpacklo_epi16(first, _mm_srli_si128(first, 8)), _mm_set1_epi32(axis.pairs[x]));
+                second = _mm_madd_epi16(_mm_unpacklo_epi16(second, _mm_srli_si128(second, 8)),
+                                        _mm_set1_epi32(axis.pairs[x + 1]));
+                __m128i words = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(first, round), kHorizontalShift),
+                                                _mm_srai_epi32(_mm_add_epi32(second, round), kHorizontalShift));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(words, words));
+            }
+            return x;
+        }
+        for (; x + 2 <= width; x += 2) {
+            const int32_t* pairs = &axis.pairs[static_cast<size_t>(x) * pairCount];
+            __m128i first = HorizontalPixelSse2(src + axis.begin[x] * 4, pairs, axis.taps);
+            __m128i second = HorizontalPixelSse2(src + axis.begin[x + 1] * 4, pairs + pairCount, axis.taps);
+            __m128i words = _mm_packs_epi32(first, second);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(words, words));
+        }
+        return x;
+    }
+#endif
+
+#if YUV_HAVE_AVX2
+    // 与 SSE2 相同，一次 16 个值。源字节先扩展成 16 个 int16，unpack 与 pack 都在 128 位通道内进行，
+    // 一进一出顺序恰好还原
+    __attribute__((target("avx2")))
+    inline int VerticalRowAvx2(const uint8_t* const* rows, const int32_t* pairs, int taps,
+                               int begin, int count, int16_t* out)
+    {
+        const __m256i round = _mm256_set1_epi32(1 << (kVerticalShift - 1));
+        int i = begin;
+        for (; i + 16 <= count; i += 16) {
+            __m256i low = round;
+            __m256i high = round;
+            for (int t = 0; t < taps; t += 2) {
+                __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t] + i)));
+                __m256i b = t + 1 < taps
+                    ? _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t + 1] + i)))
+                    : _mm256_setzero_si256();
+                __m256i w = _mm256_set1_epi32(pairs[t / 2]);
+                low = _mm256_add_epi32(low, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w));
+                high = _mm256_add_epi32(high, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                                _mm256_packs_epi32(_mm256_srai_epi32(low, kVerticalShift),
+                                                   _mm256_srai_epi32(high, kVerticalShift)));
+        }
+        return i;
+    }
+#endif
+
+    // 目标第 y 行的纵向合成，rows 为该行用到的 taps 行源
+    inline void VerticalRow(const uint8_t* const* rows, const Axis& axis, int y, int count, int16_t* out,
+                            Yuv::Kernel kernel)
+    {
+        int taps = axis.taps;
+        int done = 0;
+#if YUV_HAVE_X86
+        const int32_t* pairs = &axis.pairs[static_cast<size_t>(y) * ((taps + 1) / 2)];
+#endif
+#if YUV_HAVE_AVX2
+        if (kernel == Yuv::Kernel::Avx2) done = VerticalRowAvx2(rows, pairs, taps, done, count, out);
+#endif
+#if YUV_HAVE_X86
+        if (kernel != Yuv::Kernel::Scalar) done = VerticalRowSse2(rows, pairs, taps, done, count, out);
+#endif
+        VerticalRowScalar(rows, &axis.weights[static_cast<size_t>(y) * taps], taps, done, count, out);
+    }
+
+    inline void HorizontalRow(const int16_t* src, const Axis& axis, int width, uint8_t* dst, Yuv::Kernel kernel)
+    {
+        int done = 0;
+#if YUV_HAVE_X86
+        if (kernel != Yuv::Kernel::Scalar) done = HorizontalRowSse2(src, axis, width, dst);
+#endif
+        HorizontalRowScalar(src, axis, done, width, dst);
+    }
+}
+
+// 32 位像素缩放器：目标行分成若干段，由线程池并行处理。
+// 同一时间只能由一个线程调用 Scale（内部的系数缓存和每段的临时行不加锁）
+class VideoScaler
+{
+public:
+    // threads 为 0 时使用硬件线程数；为 1 时在调用线程中完成，不创建线程池
+    explicit VideoScaler(unsigned threads = 0, Yuv::Kernel kernel = Yuv::BestKernel())
+        : m_threads(threads ? threads : WorkStealingPool::DefaultThreads())
+        , m_kernel(kernel)
+        , m_useCounter(0)
+    {
+        if (m_threads > 1) m_pool.reset(new WorkStealingPool(m_threads));
+    }
+
+    VideoScaler(const VideoScaler&) = delete;
+    VideoScaler& operator=(const VideoScaler&) = delete;
+
+    unsigned ThreadCount() const { return m_threads; }
+    Yuv::Kernel GetKernel() const { return m_kernel; }
+    size_t CachedPlanCount() const { return m_plans.size(); }
+
+    // 步长单位为字节，可为负（自底向上的位图）
+    void Scale(const uint8_t* src, ptrdiff_t srcStride, int srcWidth, int srcHeight,
+               uint8_t* dst, ptrdiff_t dstStride, int dstWidth, int dstHeight, Scaler::Filter filter)
+    {
+        if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) return;
+        const Plan& plan = GetPlan(srcWidth, srcHeight, dstWidth, dstHeight, filter);
+
+        // 每个线程分两段，工作窃取可以平衡各段的耗时差异
+        int bands = std::min(dstHeight, static_cast<int>(m_pool ? m_threads * 2 : 1));
+        if (m_scratch.size() < static_cast<size_t>(bands)) m_scratch.resize(bands);
+        if (!m_pool) {
+            ScaleBand(plan, src, srcStride, dst, dstStride, 0, dstHeight, m_scratch[0]);
+            return;
+        }
+        for (int band = 0; band < bands; ++band) {
+            int begin = static_cast<int>(static_cast<int64_t>(dstHeight) * band / bands);
+            int end = static_cast<int>(static_cast<int64_t>(dstHeight) * (band + 1) / bands);
+            Scratch* scratch = &m_scratch[band];
+            const Plan* planPtr = &plan;
+            m_pool->Submit([=] { ScaleBand(*planPtr, src, srcStride, dst, dstStride, begin, end, *scratch); });
+        }
+        m_pool->WaitIdle();
+    }
+
+private:
+    // 窗口尺寸会来回变化，缓存最近用过的几组系数
+    static const size_t kMaxPlans = 8;
+
+    struct Plan {
+        int srcWidth;
+        int srcHeight;
+        int dstWidth;
+        int dstHeight;
+        Scaler::Filter filter;
+        Scaler::Axis horizontal;
+        Scaler::Axis vertical;
+        uint64_t lastUse;
+    };
+
+    // 每段一行纵向中间结果
+    struct Scratch {
+        std::vector<int16_t> row;
+    };
+
+    unsigned m_threads;
+    Yuv::Kernel m_kernel;
+    std::unique_ptr<WorkStealingPool> m_pool;
+    std::vector<std::unique_ptr<Plan>> m_plans;
+    std::vector<Scratch> m_scratch;
+    uint64_t m_useCounter;
+
+    const Plan& GetPlan(int srcWidth, int srcHeight, int dstWidth, int dstHeight, Scaler::Filter filter)
+    {
+        for (const std::unique_ptr<Plan>& plan : m_plans) {
+            if (plan->srcWidth == srcWidth && plan->srcHeight == srcHeight && plan->dstWidth == dstWidth &&
+                plan->dstHeight == dstHeight && plan->filter == filter) {
+                plan->lastUse = ++m_useCounter;
+                return *plan;
+            }
+        }
+        if (m_plans.size() >= kMaxPlans) {
+            auto oldest = std::min_element(m_plans.begin(), m_plans.end(),
+                [](const std::unique_ptr<Plan>& a, const std::unique_ptr<Plan>& b) { return a->lastUse < b->lastUse; });
+            m_plans.erase(oldest);
+        }
+        std::unique_ptr<Plan> plan(new Plan());
+        plan->srcWidth = srcWidth;
+        plan->srcHeight = srcHeight;
+        plan->dstWidth = dstWidth;
+        plan->dstHeight = dstHeight;
+        plan->filter = filter;
+        plan->horizontal = Scaler::BuildAxis(srcWidth, dstWidth, filter);
+        plan->vertical = Scaler::BuildAxis(srcHeight, dstHeight, filter);
+        plan->lastUse = ++m_useCounter;
+        m_plans.push_back(std::move(plan));
+        return *m_plans.back();
+    }
+
+    void ScaleBand(const Plan& plan, const uint8_t* src, ptrdiff_t srcStride, uint8_t* dst, ptrdiff_t dstStride,
+                   int begin, int end, Scratch& scratch) const
+    {
+        int taps = plan.vertical.taps;
+        int rowValues = plan.srcWidth * 4;
+        scratch.row.resize(rowValues);
+        std::vector<const uint8_t*> rows(taps);
+        for (int y = begin; y < end; ++y) {
+            for (int t = 0; t < taps; ++t) rows[t] = src + (plan.vertical.begin[y] + t) * srcStride;
+            Scaler::VerticalRow(rows.data(), plan.vertical, y, rowValues, scratch.row.data(), m_kernel);
+            Scaler::HorizontalRow(scratch.row.data(), plan.horizontal, plan.dstWidth, dst + y * dstStride, m_kernel);
+        }
+    }
+};
@@ -0,0 +1,128 @@
+// 虚拟化横向条带 - 只为可见项加少量预留分配槽位，滚动时按 item % 槽数 复用
+//
+// 槽数只取决于视口宽度，与总项数无关；滚动一格只有移出窗口的那个槽需要重新绑定。
+// 本文件只做窗口计算，不依赖 wx，由 VirtualTileStrip 驱动真正的 TileButton。
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+class VirtualStrip
+{
+public:
+    enum : size_t { kNone = static_cast<size_t>(-1) };
+
+    struct Binding {
+        size_t slot;
+        size_t item;   // kNone 表示该槽空闲，应隐藏
+    };
+
+    VirtualStrip(size_t itemCount, int itemPitch, int overscan)
+        : m_count(itemCount)
+        , m_pitch(itemPitch > 0 ? itemPitch : 1)
+        , m_overscan(overscan > 0 ? overscan : 0)
+        , m_viewport(0)
+        , m_offset(0)
+    {
+    }
+
+    size_t GetItemCount() const { return m_count; }
+    int GetPitch() const { return m_pitch; }
+    int GetOffset() const { return m_offset; }
+    size_t GetPoolSize() const { return m_slotItems.size(); }
+
+    // 项数变化（数据被替换）时重新计算槽数，所有槽需要重新绑定
+    void SetItemCount(size_t count)
+    {
+        m_count = count;
+        SetViewport(m_viewport);
+    }
+
+    // 视口宽度变化时重新计算槽数，所有槽需要重新绑定
+    void SetViewport(int extent)
+    {
+        m_viewport = extent > 0 ? extent : 0;
+        size_t visible = static_cast<size_t>((m_viewport + m_pitch - 1) / m_pitch) + 1;
+        size_t pool = visible + 2 * static_cast<size_t>(m_overscan);
+        if (pool > m_count) pool = m_count;
+        m_slotItems.assign(pool, kNone);
+        ScrollTo(m_offset);
+    }
+
+    void ScrollTo(int offset)
+    {
+        int maxOffset = static_cast<int>(m_count) * m_pitch - m_viewport;
+        if (offset > maxOffset) offset = maxOffset;
+        if (offset < 0) offset = 0;
+        m_offset = offset;
+    }
+
+    void ScrollBy(int delta) { ScrollTo(m_offset + delta); }
+
+    // 最少量滚动使 index 完整可见
+    void EnsureVisible(size_t index)
+    {
+        if (index >= m_count) return;
+        int left = static_cast<int>(index) * m_pitch;
+        if (left < m_offset) {
+            ScrollTo(left);
+        } else if (left + m_pitch > m_offset + m_viewport) {
+            ScrollTo(left + m_pitch - m_viewport);
+        }
+    }
+
+    // 当前应绑定的项区间 [first, last)，含两侧预留
+    void GetRange(size_t& first, size_t& last) const
+    {
+        size_t begin = static_cast<size_t>(m_offset / m_pitch);
+        first = begin > static_cast<size_t>(m_overscan) ? begin - m_overscan : 0;
+        last = first + m_slotItems.size();
+        if (last > m_count) {
+            last = m_count;
+            first = last > m_slotItems.size() ? last - m_slotItems.size() : 0;
+        }
+    }
+
+    // 项在视口中的横坐标
+    int ItemPosition(size_t item) const { return static_cast<int>(item) * m_pitch - m_offset; }
+
+    size_t SlotItem(size_t slot) const { return slot < m_slotItems.size() ? m_slotItems[slot] : kNone; }
+
+    size_t SlotOf(size_t item) const { return m_slotItems.empty() ? kNone : item % m_slotItems.size(); }
+
+    // 按当前滚动位置重新分配槽，只输出绑定发生变化的槽
+    void Update(std::vector<Binding>& rebinds)
+    {
+        rebinds.clear();
+        size_t first, last;
+        GetRange(first, last);
+        size_t pool = m_slotItems.size();
+        for (size_t slot = 0; slot < pool; ++slot) {
+            // 区间长度不超过槽数，区间内每个槽恰好对应一个项
+            size_t item = first + (slot + pool - first % pool) % pool;
+            if (item >= last) item = kNone;
+            if (m_slotItems[slot] != item) {
+                m_slotItems[slot] = item;
+                Binding binding = { slot, item };
+                rebinds.push_back(binding);
+            }
+        }
+    }
+
+    // 导航环绕：越过两端回到另一端
+    static int Wrap(int index, int count)
+    {
+        if (count <= 0) return 0;
+        if (index < 0) return count - 1;
+        if (index >= count) return 0;
+        return index;
+    }
+
+private:
+    size_t m_count;
+    int m_pitch;
+    int m_overscan;
+    int m_viewport;
+    int m_offset;
+    std::vector<size_t> m_slotItems;   // 每个槽当前绑定的项
+};
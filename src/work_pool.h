@@ -0,0 +1,155 @@
+// 工作窃取线程池 - 每个工作线程一个双端队列，自己从队尾取，空闲时从其他线程的队首偷
+//
+// 工作线程内提交的任务进入自己的队列（局部性好），外部线程提交的任务轮流分配。
+// 任务不应抛出异常；析构时等待已提交的任务全部执行完。
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    // threads 为 0 时使用硬件线程数
+    explicit WorkStealingPool(unsigned threads = 0)
+        : m_queued(0)
+        , m_pending(0)
+        , m_next(0)
+        , m_stop(false)
+    {
+        if (threads == 0) threads = DefaultThreads();
+        for (unsigned i = 0; i < threads; ++i) {
+            m_queues.push_back(std::unique_ptr<Queue>(new Queue()));
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            m_threads.push_back(std::thread(&WorkStealingPool::WorkerLoop, this, i));
+        }
+    }
+
+    ~WorkStealingPool()
+    {
+        WaitIdle();
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    static unsigned DefaultThreads()
+    {
+        unsigned n = std::thread::hardware_concurrency();
+        return n ? n : 2;
+    }
+
+    unsigned ThreadCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+    void Submit(Task task)
+    {
+        const Worker& worker = CurrentWorker();
+        size_t index = worker.pool == this ? worker.index : m_next.fetch_add(1) % m_queues.size();
+        ++m_pending;
+        ++m_queued;
+        {
+            std::lock_guard<std::mutex> lock(m_queues[index]->lock);
+            m_queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            // 与等待方的谓词检查串行化，避免丢失唤醒
+            std::lock_guard<std::mutex> lock(m_lock);
+        }
+        m_wake.notify_one();
+    }
+
+    // 等待已提交的任务（包括任务中再提交的）全部完成；不能在工作线程中调用
+    void WaitIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_idle.wait(lock, [this] { return m_pending.load() == 0; });
+    }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    struct Worker {
+        WorkStealingPool* pool;
+        size_t index;
+    };
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_lock;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::atomic<size_t> m_queued;    // 已入队未取走的任务数
+    std::atomic<size_t> m_pending;   // 已提交未执行完的任务数
+    std::atomic<size_t> m_next;
+    bool m_stop;
+
+    static Worker& CurrentWorker()
+    {
+        static thread_local Worker worker = { nullptr, 0 };
+        return worker;
+    }
+
+    bool TakeTask(size_t self, Task& task)
+    {
+        {
+            Queue& own = *m_queues[self];
+            std::lock_guard<std::mutex> lock(own.lock);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < m_queues.size(); ++i) {
+            Queue& victim = *m_queues[(self + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkerLoop(size_t self)
+    {
+        Worker& worker = CurrentWorker();
+        worker.pool = this;
+        worker.index = self;
+
+        for (;;) {
+            Task task;
+            if (TakeTask(self, task)) {
+                --m_queued;
+                task();
+                if (--m_pending == 0) {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_idle.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+            if (m_stop && m_queued.load() == 0) return;
+        }
+    }
+};
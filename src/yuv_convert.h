@@ -0,0 +1,306 @@
+// YUV420 -> 32 位 RGB 转换 - I420（三平面）与 NV12（Y + UV 交错），BT.709 有限范围
+//
+// 所有内核使用同一套 13 位定点系数与舍入，标量、SSE2、AVX2 的输出逐字节一致：
+//   C = 9535 * (Y - 16) + 4096
+//   R = (C + 14688 * (V - 128)) >> 13
+//   G = (C - 1745 * (U - 128) - 4366 * (V - 128)) >> 13
+//   B = (C + 17302 * (U - 128)) >> 13
+// 结果饱和到 0..255，Alpha 固定 255。SIMD 内核只在 x86 的 GCC/Clang 下编译，运行时按 CPU 选择，
+// 不需要给整个程序加 -mavx2。MinGW 的 GCC 不保证 32 字节栈对齐（GCC bug 54412），
+// 未优化构建溢出 ymm 寄存器时会崩溃，所以 Windows 上的 GCC 只用 SSE2。
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define YUV_HAVE_X86 1
+    #include <immintrin.h>
+    #if defined(_WIN32) && !defined(__clang__)
+        #define YUV_HAVE_AVX2 0
+    #else
+        #define YUV_HAVE_AVX2 1
+    #endif
+#else
+    #define YUV_HAVE_X86 0
+    #define YUV_HAVE_AVX2 0
+#endif
+
+namespace Yuv {
+    enum class Format { I420, NV12 };
+
+    // 输出字节顺序：Windows DIB 为 BGRA，GTK 等为 RGBA
+    enum class PixelOrder { Bgra, Rgba };
+
+    enum class Kernel { Scalar, Sse2, Avx2 };
+
+    const int kShift = 13;
+    const int kCoefY = 9535;
+    const int kCoefRV = 14688;
+    const int kCoefGU = -1745;
+    const int kCoefGV = -4366;
+    const int kCoefBU = 17302;
+    const int kRound = 1 << (kShift - 1);
+
+    // 一帧 YUV 的平面视图；NV12 时 u 指向 UV 交错平面，v 不用
+    struct Planes {
+        const uint8_t* y;
+        const uint8_t* u;
+        const uint8_t* v;
+        size_t yStride;
+        size_t uvStride;
+        int width;
+        int height;
+        Format format;
+    };
+
+    inline size_t FrameSize(Format format, int width, int height)
+    {
+        (void)format;
+        size_t chromaWidth = static_cast<size_t>(width + 1) / 2;
+        size_t chromaHeight = static_cast<size_t>(height + 1) / 2;
+        return static_cast<size_t>(width) * height + 2 * chromaWidth * chromaHeight;
+    }
+
+    // 紧密排列的一帧（原始 .yuv 文件中的格式）
+    inline Planes FromBuffer(const uint8_t* data, Format format, int width, int height)
+    {
+        size_t chromaWidth = static_cast<size_t>(width + 1) / 2;
+        size_t chromaHeight = static_cast<size_t>(height + 1) / 2;
+        Planes planes;
+        planes.y = data;
+        planes.u = data + static_cast<size_t>(width) * height;
+        planes.yStride = width;
+        planes.width = width;
+        planes.height = height;
+        planes.format = format;
+        if (format == Format::NV12) {
+            planes.v = nullptr;
+            planes.uvStride = chromaWidth * 2;
+        } else {
+            planes.v = planes.u + chromaWidth * chromaHeight;
+            planes.uvStride = chromaWidth;
+        }
+        return planes;
+    }
+
+    inline uint8_t Clamp(int value)
+    {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    // 标量实现，也用于 SIMD 内核处理行尾
+    inline void ConvertRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, bool interleaved,
+                                 int begin, int width, uint8_t* dst, PixelOrder order)
+    {
+        int red = order == PixelOrder::Bgra ? 2 : 0;
+        int blue = 2 - red;
+        for (int x = begin; x < width; ++x) {
+            int cu, cv;
+            if (interleaved) {
+                cu = u[(x / 2) * 2] - 128;
+                cv = u[(x / 2) * 2 + 1] - 128;
+            } else {
+                cu = u[x / 2] - 128;
+                cv = v[x / 2] - 128;
+            }
+            int c = kCoefY * (y[x] - 16) + kRound;
+            uint8_t* pixel = dst + x * 4;
+            pixel[red] = Clamp((c + kCoefRV * cv) >> kShift);
+            pixel[1] = Clamp((c + kCoefGU * cu + kCoefGV * cv) >> kShift);
+            pixel[blue] = Clamp((c + kCoefBU * cu) >> kShift);
+            pixel[3] = 255;
+        }
+    }
+
+#if YUV_HAVE_X86
+    // 每次 8 个像素（4 个色度样本）。色度与亮度项都用 madd 计算：
+    // 色度按 (U, V) 交错成对乘 (系数U, 系数V)，亮度按 (Y, 1) 成对乘 (系数Y, 舍入)
+    __attribute__((target("sse2")))
+    inline int ConvertRowSse2(const uint8_t* y, const uint8_t* u, const uint8_t* v, bool interleaved,
+                              int width, uint8_t* dst, PixelOrder order)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bias16 = _mm_set1_epi16(16);
+        const __m128i bias128 = _mm_set1_epi16(128);
+        const __m128i coefY = _mm_set_epi16(kRound, kCoefY, kRound, kCoefY, kRound, kCoefY, kRound, kCoefY);
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128i coefR = _mm_set_epi16(kCoefRV, 0, kCoefRV, 0, kCoefRV, 0, kCoefRV, 0);
+        const __m128i coefG = _mm_set_epi16(kCoefGV, kCoefGU, kCoefGV, kCoefGU, kCoefGV, kCoefGU, kCoefGV, kCoefGU);
+        const __m128i coefB = _mm_set_epi16(0, kCoefBU, 0, kCoefBU, 0, kCoefBU, 0, kCoefBU);
+        const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+
+        int x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m128i y16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero), bias16);
+            __m128i uv8;
+            if (interleaved) {
+                uv8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x));
+            } else {
+                int32_t u4, v4;
+                std::memcpy(&u4, u + x / 2, 4);
+                std::memcpy(&v4, v + x / 2, 4);
+                uv8 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), _mm_cvtsi32_si128(v4));
+            }
+            __m128i uv16 = _mm_sub_epi16(_mm_unpacklo_epi8(uv8, zero), bias128);
+
+            __m128i chromaR = _mm_madd_epi16(uv16, coefR);
+            __m128i chromaG = _mm_madd_epi16(uv16, coefG);
+            __m128i chromaB = _mm_madd_epi16(uv16, coefB);
+            __m128i lumaLo = _mm_madd_epi16(_mm_unpacklo_epi16(y16, ones), coefY);
+            __m128i lumaHi = _mm_madd_epi16(_mm_unpackhi_epi16(y16, ones), coefY);
+
+            // 每个色度样本对应相邻两个像素
+            __m128i r = _mm_packs_epi32(
+                _mm_srai_epi32(_mm_add_epi32(lumaLo, _mm_unpacklo_epi32(chromaR, chromaR)), kShift),
+                _mm_srai_epi32(_mm_add_epi32(lumaHi, _mm_unpackhi_epi32(chromaR, chromaR)), kShift));
+            __m128i g = _mm_packs_epi32(
+                _mm_srai_epi32(_mm_add_epi32(lumaLo, _mm_unpacklo_epi32(chromaG, chromaG)), kShift),
+                _mm_srai_epi32(_mm_add_epi32(lumaHi, _mm_unpackhi_epi32(chromaG, chromaG)), kShift));
+            __m128i b = _mm_packs_epi32(
+                _mm_srai_epi32(_mm_add_epi32(lumaLo, _mm_unpacklo_epi32(chromaB, chromaB)), kShift),
+                _mm_srai_epi32(_mm_add_epi32(lumaHi, _mm_unpackhi_epi32(chromaB, chromaB)), kShift));
+
+            __m128i first = _mm_packus_epi16(order == PixelOrder::Bgra ? b : r, zero);
+            __m128i third = _mm_packus_epi16(order == PixelOrder::Bgra ? r : b, zero);
+            __m128i firstSecond = _mm_unpacklo_epi8(first, _mm_packus_epi16(g, zero));
+            __m128i thirdAlpha = _mm_unpacklo_epi8(third, alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_unpacklo_epi16(firstSecond, thirdAlpha));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4 + 16), _mm_unpackhi_epi16(firstSecond, thirdAlpha));
+        }
+        return x;
+    }
+#endif
+
+#if YUV_HAVE_AVX2
+    // 每次 16 个像素。256 位的 unpack/pack 在两个 128 位通道内各自进行，
+    // 最后用 permute2x128 把 [0-3 | 8-11] [4-7 | 12-15] 两组拼回顺序
+    __attribute__((target("avx2")))
+    inline int ConvertRowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v, bool interleaved,
+                              int width, uint8_t* dst, PixelOrder order)
+    {
+        const __m256i bias16 = _mm256_set1_epi16(16);
+        const __m256i bias128 = _mm256_set1_epi16(128);
+        const __m256i ones = _mm256_set1_epi16(1);
+        const __m256i coefY = _mm256_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(kRound) << 16) | kCoefY));
+        const __m256i coefR = _mm256_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(kCoefRV) << 16));
+        const __m256i coefG = _mm256_set1_epi32(static_cast<int32_t>((static_cast<uint32_t>(kCoefGV) << 16) |
+                                                                     static_cast<uint16_t>(kCoefGU)));
+        const __m256i coefB = _mm256_set1_epi32(kCoefBU);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i alpha = _mm256_set1_epi8(static_cast<char>(0xFF));
+
+        int x = 0;
+        for (; x + 16 <= width; x += 16) {
+            __m256i y16 = _mm256_sub_epi16(
+                _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x))), bias16);
+            __m128i uv8;
+            if (interleaved) {
+                uv8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x));
+            } else {
+                uv8 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)),
+                                        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)));
+            }
+            __m256i uv16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(uv8), bias128);
+
+            __m256i chromaR = _mm256_madd_epi16(uv16, coefR);
+            __m256i chromaG = _mm256_madd_epi16(uv16, coefG);
+            __m256i chromaB = _mm256_madd_epi16(uv16, coefB);
+            __m256i lumaLo = _mm256_madd_epi16(_mm256_unpacklo_epi16(y16, ones), coefY);
+            __m256i lumaHi = _mm256_madd_epi16(_mm256_unpackhi_epi16(y16, ones), coefY);
+
+            __m256i r = _mm256_packs_epi32(
+                _mm256_srai_epi32(_mm256_add_epi32(lumaLo, _mm256_unpacklo_epi32(chromaR, chromaR)), kShift),
+                _mm256_srai_epi32(_mm256_add_epi32(lumaHi, _mm256_unpackhi_epi32(chromaR, chromaR)), kShift));
+            __m256i g = _mm256_packs_epi32(
+                _mm256_srai_epi32(_mm256_add_epi32(lumaLo, _mm256_unpacklo_epi32(chromaG, chromaG)), kShift),
+                _mm256_srai_epi32(_mm256_add_epi32(lumaHi, _mm256_unpackhi_epi32(chromaG, chromaG)), kShift));
+            __m256i b = _mm256_packs_epi32(
+                _mm256_srai_epi32(_mm256_add_epi32(lumaLo, _mm256_unpacklo_epi32(chromaB, chromaB)), kShift),
+                _mm256_srai_epi32(_mm256_add_epi32(lumaHi, _mm256_unpackhi_epi32(chromaB, chromaB)), kShift));
+
+            __m256i first = _mm256_packus_epi16(order == PixelOrder::Bgra ? b : r, zero);
+            __m256i third = _mm256_packus_epi16(order == PixelOrder::Bgra ? r : b, zero);
+            __m256i firstSecond = _mm256_unpacklo_epi8(first, _mm256_packus_epi16(g, zero));
+            __m256i thirdAlpha = _mm256_unpacklo_epi8(third, alpha);
+            __m256i lo = _mm256_unpacklo_epi16(firstSecond, thirdAlpha);
+            __m256i hi = _mm256_unpackhi_epi16(firstSecond, thirdAlpha);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+        return x;
+    }
+#endif
+
+    inline bool IsSupported(Kernel kernel)
+    {
+        switch (kernel) {
+            case Kernel::Scalar:
+                return true;
+#if YUV_HAVE_X86
+            case Kernel::Sse2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("sse2");
+#endif
+#if YUV_HAVE_AVX2
+            case Kernel::Avx2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2");
+#endif
+            default:
+                return false;
+        }
+    }
+
+    inline Kernel BestKernel()
+    {
+        static const Kernel best = IsSupported(Kernel::Avx2) ? Kernel::Avx2
+                                 : IsSupported(Kernel::Sse2) ? Kernel::Sse2 : Kernel::Scalar;
+        return best;
+    }
+
+    inline const char* KernelName(Kernel kernel)
+    {
+        switch (kernel) {
+            case Kernel::Sse2: return "sse2";
+            case Kernel::Avx2: return "avx2";
+            default: return "scalar";
+        }
+    }
+
+    // 转换 [rowBegin, rowEnd) 行，dst 指向第 0 行（dstStride 可为负，用于自底向上的位图）。
+    // 不同行段可由不同线程并行转换
+    inline void ConvertRows(const Planes& src, int rowBegin, int rowEnd, uint8_t* dst, ptrdiff_t dstStride,
+                            PixelOrder order, Kernel kernel = BestKernel())
+    {
+        bool interleaved = src.format == Format::NV12;
+        for (int row = rowBegin; row < rowEnd; ++row) {
+            const uint8_t* y = src.y + row * src.yStride;
+            const uint8_t* u = src.u + (row / 2) * src.uvStride;
+            const uint8_t* v = interleaved ? nullptr : src.v + (row / 2) * src.uvStride;
+            uint8_t* out = dst + row * dstStride;
+            int done = 0;
+#if YUV_HAVE_AVX2
+            if (kernel == Kernel::Avx2) {
+                done = ConvertRowAvx2(y, u, v, interleaved, src.width & ~1, out, order);
+            }
+#endif
+#if YUV_HAVE_X86
+            // SIMD 一次处理偶数个像素，奇数宽度的最后一列和不足一组的行尾交给标量
+            if (kernel == Kernel::Sse2 || kernel == Kernel::Avx2) {
+                done += ConvertRowSse2(y + done, u + (interleaved ? done : done / 2), interleaved ? nullptr : v + done / 2,
+                                       interleaved, (src.width & ~1) - done, out + done * 4, order);
+            }
+#endif
+            ConvertRowScalar(y, u, v, interleaved, done, src.width, out, order);
+        }
+    }
+
+    inline void Convert(const Planes& src, uint8_t* dst, ptrdiff_t dstStride, PixelOrder order,
+                        Kernel kernel = BestKernel())
+    {
+        ConvertRows(src, 0, src.height, dst, dstStride, order, kernel);
+    }
+}
@@ -0,0 +1,416 @@
+// 换台预取 - 频道加减键换台时立即显示新频道的画面
+//
+// 换台本来要经过调谐锁定、等第一个完整帧、解码、缩放，才有画面。这里按预测提前在后台做好：
+// 每次换台后，把下一个可能切到的频道（按换台方向的相邻两个频道，再加上最近看过的几个）排进加载队列，
+// 后台线程模拟调谐等待，从录制的 YUV 文件读出第一帧，转换并缩放到显示尺寸，放进有内存上限的缓存。
+// 换台时命中缓存立即给出画面；未命中时目标频道插到队列最前，加载好后回调 onReady。
+//
+// 预测变化后，还在调谐等待中的过时预取直接放弃（模拟释放调谐器）；缓存超出上限时先淘汰不在预测中的
+// 最久未用的帧。输出尺寸变化后缓存全部作废。
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "input_source.h"
+#include "video_player.h"
+#include "video_scaler.h"
+#include "yuv_convert.h"
+
+class ZapPrefetcher
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::shared_ptr<const SourceFrame> FramePtr;
+
+    struct Options {
+        std::string directory;         // 各频道的录制文件 <频道号>.yuv
+        std::string fallbackPath;      // 频道没有自己的文件时，从这个文件按频道号取一帧；也没有时画测试图
+        Yuv::Format format;
+        int width;                     // 录制文件的尺寸
+        int height;
+        Yuv::PixelOrder order;
+        unsigned tuneMs;               // 模拟调谐锁定加等待第一个完整帧的时间
+        size_t cacheBytes;             // 缓存帧的内存上限
+        unsigned threads;              // 同时加载的频道数（模拟的调谐器数）
+        size_t historySize;            // 预取最近看过的频道数
+        bool prefetch;                 // false 时只加载换台的目标，用于对比
+
+        Options()
+            : format(Yuv::Format::I420)
+            , width(1920)
+            , height(1080)
+            , order(Yuv::PixelOrder::Bgra)
+            , tuneMs(120)
+            , cacheBytes(48u << 20)
+            , threads(2)
+            , historySize(3)
+            , prefetch(true)
+        {
+        }
+    };
+
+    struct Stats {
+        uint64_t zaps;
+        uint64_t hits;                 // 换台时画面已在缓存中
+        uint64_t misses;               // 换台后等后台加载出画面
+        uint64_t loads;                // 完成的加载（含预取）
+        uint64_t cancelled;            // 预测变化后放弃的预取
+        uint64_t evicted;
+        size_t cachedFrames;
+        size_t cachedBytes;
+        double lastMillis;             // 最近一次换台到画面就绪
+        double hitMillis;              // 命中时的平均延迟
+        double missMillis;             // 未命中时的平均延迟
+        double maxMissMillis;
+    };
+
+    ZapPrefetcher(const Options& options, const std::function<void()>& onReady)
+        : m_options(options)
+        , m_onReady(onReady)
+        , m_stop(false)
+        , m_generation(0)
+        , m_outputWidth(options.width)
+        , m_outputHeight(options.height)
+        , m_hasTarget(false)
+        , m_target(0)
+        , m_delivered(false)
+        , m_cachedBytes(0)
+        , m_zaps(0)
+        , m_hits(0)
+        , m_misses(0)
+        , m_loads(0)
+        , m_cancelled(0)
+        , m_evicted(0)
+        , m_lastMillis(0)
+        , m_hitMillis(0)
+        , m_missMillis(0)
+        , m_maxMissMillis(0)
+    {
+        unsigned threads = std::max(m_options.threads, 1u);
+        for (unsigned i = 0; i < threads; ++i) m_threads.emplace_back(&ZapPrefetcher::Run, this);
+    }
+
+    ~ZapPrefetcher()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    ZapPrefetcher(const ZapPrefetcher&) = delete;
+    ZapPrefetcher& operator=(const ZapPrefetcher&) = delete;
+
+    // 显示尺寸变化：缓存作废，正在加载的结果丢弃，目标与预测按新尺寸重新加载
+    void SetOutputSize(int width, int height)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            width = std::max(width, 1);
+            height = std::max(height, 1);
+            if (width == m_outputWidth && height == m_outputHeight) return;
+            m_outputWidth = width;
+            m_outputHeight = height;
+            ++m_generation;
+            m_cache.clear();
+            m_recent.clear();
+            m_cachedBytes = 0;
+            m_loading.clear();
+            m_pending.clear();
+            if (m_hasTarget && !m_delivered) Enqueue(m_target, true);
+            for (uint32_t number : m_wantedOrder) Enqueue(number, false);
+        }
+        m_wake.notify_all();
+    }
+
+    // 换到 number 频道，neighbours 为接下来最可能切到的频道（按可能性排列），requested 为按键时间。
+    // 命中缓存时直接返回画面；否则返回空，画面加载好后回调 onReady，由 TakeZapFrame 取走
+    FramePtr Zap(uint32_t number, const std::vector<uint32_t>& neighbours, Clock::time_point requested)
+    {
+        FramePtr frame;
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            ++m_zaps;
+            if (m_hasTarget && m_target != number) {
+                m_history.erase(std::remove(m_history.begin(), m_history.end(), m_target), m_history.end());
+                m_history.push_front(m_target);
+                if (m_history.size() > m_options.historySize) m_history.resize(m_options.historySize);
+            }
+            m_hasTarget = true;
+            m_target = number;
+            m_requested = requested;
+            m_targetFrame.reset();
+            m_delivered = false;
+
+            m_wantedOrder.clear();
+            if (m_options.prefetch) {
+                for (uint32_t candidate : neighbours) AddWanted(candidate);
+                for (uint32_t candidate : m_history) AddWanted(candidate);
+            }
+            m_wanted.clear();
+            m_wanted.insert(number);
+            m_wanted.insert(m_wantedOrder.begin(), m_wantedOrder.end());
+
+            m_pending.clear();
+            auto cached = m_cache.find(number);
+            if (cached != m_cache.end()) {
+                Touch(cached);
+                frame = cached->second.frame;
+                m_delivered = true;
+                ++m_hits;
+                m_lastMillis = MillisSince(requested);
+                m_hitMillis += m_lastMillis;
+            } else {
+                Enqueue(number, true);
+            }
+            for (uint32_t candidate : m_wantedOrder) Enqueue(candidate, false);
+        }
+        m_wake.notify_all();
+        return frame;
+    }
+
+    // 取走换台目标加载好的画面；zapMillis 为从按键到画面就绪的延迟
+    FramePtr TakeZapFrame(double& zapMillis)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        zapMillis = -1;
+        if (!m_targetFrame) return FramePtr();
+        FramePtr frame = std::move(m_targetFrame);
+        m_targetFrame.reset();
+        zapMillis = m_lastMillis;
+        return frame;
+    }
+
+    Stats GetStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        Stats stats;
+        stats.zaps = m_zaps;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.loads = m_loads;
+        stats.cancelled = m_cancelled;
+        stats.evicted = m_evicted;
+        stats.cachedFrames = m_cache.size();
+        stats.cachedBytes = m_cachedBytes;
+        stats.lastMillis = m_lastMillis;
+        stats.hitMillis = m_hits ? m_hitMillis / m_hits : 0;
+        stats.missMillis = m_misses ? m_missMillis / m_misses : 0;
+        stats.maxMissMillis = m_maxMissMillis;
+        return stats;
+    }
+
+private:
+    struct Entry {
+        FramePtr frame;
+        std::list<uint32_t>::iterator recent;
+    };
+
+    // 每个加载线程自己的读取、转换、缩放缓冲
+    struct Loader {
+        YuvFileReader fallback;
+        bool fallbackOpen;
+        VideoScaler scaler;
+        std::vector<uint8_t> yuv;
+        std::vector<uint8_t> converted;
+
+        Loader() : fallbackOpen(false), scaler(1) {}
+    };
+
+    Options m_options;
+    std::function<void()> m_onReady;
+    std::vector<std::thread> m_threads;
+    mutable std::mutex m_lock;
+    std::condition_variable m_wake;
+    bool m_stop;
+    uint64_t m_generation;
+    int m_outputWidth;
+    int m_outputHeight;
+    // 换台目标
+    bool m_hasTarget;
+    uint32_t m_target;
+    Clock::time_point m_requested;
+    bool m_delivered;
+    FramePtr m_targetFrame;
+    std::deque<uint32_t> m_history;    // 最近看过的频道，最近的在前
+    // 预测与加载队列
+    std::vector<uint32_t> m_wantedOrder;
+    std::set<uint32_t> m_wanted;       // 目标加预测，缓存淘汰时保留
+    std::deque<uint32_t> m_pending;
+    std::set<uint32_t> m_loading;
+    // 缓存：m_recent 最近用过的在前
+    std::map<uint32_t, Entry> m_cache;
+    std::list<uint32_t> m_recent;
+    size_t m_cachedBytes;
+    uint64_t m_zaps;
+    uint64_t m_hits;
+    uint64_t m_misses;
+    uint64_t m_loads;
+    uint64_t m_cancelled;
+    uint64_t m_evicted;
+    double m_lastMillis;
+    double m_hitMillis;
+    double m_missMillis;
+    double m_maxMissMillis;
+
+    static double MillisSince(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // 以下持有 m_lock 时调用
+    void AddWanted(uint32_t number)
+    {
+        if (number == m_target) return;
+        if (std::find(m_wantedOrder.begin(), m_wantedOrder.end(), number) != m_wantedOrder.end()) return;
+        m_wantedOrder.push_back(number);
+    }
+
+    void Enqueue(uint32_t number, bool first)
+    {
+        if (m_cache.count(number) || m_loading.count(number)) return;
+        if (std::find(m_pending.begin(), m_pending.end(), number) != m_pending.end()) return;
+        if (first) {
+            m_pending.push_front(number);
+        } else {
+            m_pending.push_back(number);
+        }
+    }
+
+    void Touch(std::map<uint32_t, Entry>::iterator entry)
+    {
+        m_recent.splice(m_recent.begin(), m_recent, entry->second.recent);
+    }
+
+    // 放进缓存，超出上限时从最久未用的一端淘汰不在预测中的帧；还放不下时放弃（目标帧另有 m_targetFrame 持有）
+    void Insert(uint32_t number, const FramePtr& frame)
+    {
+        size_t bytes = frame->pixels.size();
+        if (bytes > m_options.cacheBytes) return;
+        for (auto it = m_recent.end(); m_cachedBytes + bytes > m_options.cacheBytes && it != m_recent.begin();) {
+            --it;
+            if (m_wanted.count(*it)) continue;
+            auto entry = m_cache.find(*it);
+            m_cachedBytes -= entry->second.frame->pixels.size();
+            m_cache.erase(entry);
+            it = m_recent.erase(it);
+            ++m_evicted;
+        }
+        if (m_cachedBytes + bytes > m_options.cacheBytes) return;
+        m_recent.push_front(number);
+        Entry entry;
+        entry.frame = frame;
+        entry.recent = m_recent.begin();
+        m_cache[number] = entry;
+        m_cachedBytes += bytes;
+    }
+
+    void Run()
+    {
+        Loader loader;
+        if (!m_options.fallbackPath.empty()) {
+            loader.fallbackOpen = loader.fallback.Open(m_options.fallbackPath, m_options.format, m_options.width,
+                                                       m_options.height);
+        }
+        std::unique_lock<std::mutex> lock(m_lock);
+        for (;;) {
+            m_wake.wait(lock, [this] { return m_stop || !m_pending.empty(); });
+            if (m_stop) return;
+            uint32_t number = m_pending.front();
+            m_pending.pop_front();
+            m_loading.insert(number);
+            uint64_t generation = m_generation;
+            int width = m_outputWidth;
+            int height = m_outputHeight;
+
+            // 模拟调谐：不占 CPU 地等待，期间不再需要这个频道（预测已变）时放弃
+            auto abandoned = [this, number] { return m_stop || !m_wanted.count(number); };
+            if (m_wake.wait_for(lock, std::chrono::milliseconds(m_options.tuneMs), abandoned)) {
+                m_loading.erase(number);
+                if (m_stop) return;
+                ++m_cancelled;
+                continue;
+            }
+            lock.unlock();
+
+            std::shared_ptr<SourceFrame> frame(new SourceFrame());
+            Decode(loader, number, width, height, *frame);
+
+            lock.lock();
+            m_loading.erase(number);
+            if (generation != m_generation) continue;
+            ++m_loads;
+            bool ready = number == m_target && !m_delivered;
+            if (ready) {
+                m_targetFrame = frame;
+                m_delivered = true;
+                ++m_misses;
+                m_lastMillis = MillisSince(m_requested);
+                m_missMillis += m_lastMillis;
+                m_maxMissMillis = std::max(m_maxMissMillis, m_lastMillis);
+            }
+            if (m_wanted.count(number)) Insert(number, frame);
+            if (ready && m_onReady) {
+                lock.unlock();
+                m_onReady();
+                lock.lock();
+            }
+        }
+    }
+
+    // 读出频道的第一帧，转换并缩放到 width x height
+    void Decode(Loader& loader, uint32_t number, int width, int height, SourceFrame& frame)
+    {
+        frame.source = static_cast<int>(number);
+        frame.generation = 0;
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+        size_t nativeBytes = static_cast<size_t>(m_options.width) * m_options.height * 4;
+        bool native = width == m_options.width && height == m_options.height;
+        uint8_t* converted = frame.pixels.data();
+        if (!native) {
+            loader.converted.resize(nativeBytes);
+            converted = loader.converted.data();
+        }
+        ptrdiff_t nativeStride = static_cast<ptrdiff_t>(m_options.width) * 4;
+
+        YuvFileReader own;
+        YuvFileReader* reader = nullptr;
+        if (!m_options.directory.empty() &&
+            own.Open(m_options.directory + "/" + std::to_string(number) + ".yuv", m_options.format, m_options.width,
+                     m_options.height)) {
+            reader = &own;
+        } else if (loader.fallbackOpen) {
+            loader.fallback.Seek(number % loader.fallback.FrameCount());
+            reader = &loader.fallback;
+        }
+        loader.yuv.resize(Yuv::FrameSize(m_options.format, m_options.width, m_options.height));
+        if (reader && reader->ReadFrame(loader.yuv.data())) {
+            Yuv::Planes planes = Yuv::FromBuffer(loader.yuv.data(), m_options.format, m_options.width, m_options.height);
+            Yuv::Convert(planes, converted, nativeStride, m_options.order);
+        } else {
+            Source::Render(static_cast<Source::Pattern>(number % 4), converted, m_options.width, m_options.height, number,
+                           m_options.order);
+        }
+        if (native) return;
+        loader.scaler.Scale(converted, nativeStride, m_options.width, m_options.height, frame.pixels.data(),
+                            static_cast<ptrdiff_t>(width) * 4, width, height,
+                            Scaler::ChooseFilter(m_options.width, m_options.height, width, height));
+    }
+};